@@ -0,0 +1,630 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "bench.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Database/GTable.h"
+#include "Backend/Database/SaveFolder.h"
+#include "Backend/Database/Serializable.h"
+#include "Backend/Machine Learning/DataObjects/NumberInput.h"
+#include "Backend/Machine Learning/GMath/gmath.h"
+#include "Backend/Machine Learning/Networks/network.h"
+#include "Backend/Machine Learning/State/Terminator.h"
+#include "Backend/Machine Learning/Structure/hiddenlayerinfo.h"
+#include "Backend/Machine Learning/Structure/inputlayerinfo.h"
+#include "Backend/Machine Learning/Structure/nninfo.h"
+#include "Backend/Machine Learning/Structure/outputlayerinfo.h"
+#include "Backend/Machine Learning/main.h"
+#include "core/random.h"
+#include "core/stopwatch.h"
+#include "core/version.h"
+#include "crt0.h"
+#include "data/csvreader.h"
+#include "data/denseinput.h"
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace glades;
+
+// bundled datasets timed on every run
+static const char* BUNDLED[] = {"iris.data", "wine.data", "xorparity3.csv"};
+static const char LARGE_NAME[] = "bench-large.csv";
+static const char TRAIN_NAME[] = "bench-train.csv";
+static const char BENCH_NET[] = "nncreator-bench";
+static const char E2E_NAME[] = "bench-e2e.csv";
+
+// every run of the suite and the harness trains from the same state
+static const uint64_t SEED = 0x6e6e63ULL;
+
+#ifdef NNC_COUNT_ALLOCS
+// Heap allocation counter for the regression harness, compiled in with
+// -DNNC_COUNT_ALLOCS=ON
+static volatile long allocCount = 0;
+
+#if __cplusplus >= 201103L
+#define NNC_THROW_BAD_ALLOC
+#define NNC_NOTHROW noexcept
+#else
+#define NNC_THROW_BAD_ALLOC throw(std::bad_alloc)
+#define NNC_NOTHROW throw()
+#endif
+
+void* operator new(size_t size) NNC_THROW_BAD_ALLOC
+{
+	__sync_fetch_and_add(&allocCount, 1);
+	void* ptr = malloc((size > 0) ? size : 1);
+	if (!ptr)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](size_t size) NNC_THROW_BAD_ALLOC
+{
+	return operator new(size);
+}
+
+void operator delete(void* ptr) NNC_NOTHROW
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr) NNC_NOTHROW
+{
+	free(ptr);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	free(ptr);
+}
+#endif
+
+static long allocations()
+{
+	return __sync_fetch_and_add(&allocCount, 0);
+}
+#else
+static long allocations()
+{
+	return -1;
+}
+#endif
+
+static long peakRSSKB()
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+	return usage.ru_maxrss;
+}
+
+/*!
+ * @brief run the suite
+ * @details the synthetic datasets are written to datasets/ and removed afterwards
+ * @param argc from main
+ * @param argv from main; "--json FILE" writes the results to FILE instead of stdout
+ * @return the process exit code
+ */
+int Bench::run(int argc, char* argv[])
+{
+	const char* jsonFName = NULL;
+	for (int i = 2; i < argc - 1; ++i)
+	{
+		if (strcmp(argv[i], "--json") == 0)
+			jsonFName = argv[i + 1];
+	}
+
+	for (int i = 2; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--regress") == 0)
+			return regress(argc, argv);
+	}
+
+	std::string largeFName = std::string("datasets/") + LARGE_NAME;
+	std::string trainFName = std::string("datasets/") + TRAIN_NAME;
+	if ((!writeSynthetic(largeFName, LARGE_ROWS, FEATURES)) ||
+		(!writeSynthetic(trainFName, TRAIN_ROWS, FEATURES)))
+	{
+		printf("[BENCH] Unable to write the synthetic datasets\n");
+		return EXIT_FAILURE;
+	}
+
+	for (unsigned int i = 0; i < sizeof(BUNDLED) / sizeof(BUNDLED[0]); ++i)
+		benchImport(std::string("datasets/") + BUNDLED[i]);
+	benchImport(largeFName);
+
+	benchSerialize();
+
+	static const int SHAPES[] = {16, 128};
+	static const int ACTIVATIONS[] = {GMath::TANH, GMath::SIGMOID, GMath::RELU};
+	for (unsigned int s = 0; s < sizeof(SHAPES) / sizeof(SHAPES[0]); ++s)
+	{
+		for (unsigned int a = 0; a < sizeof(ACTIVATIONS) / sizeof(ACTIVATIONS[0]); ++a)
+			benchNetwork(SHAPES[s], ACTIVATIONS[a], trainFName);
+	}
+
+	benchSaveLoad(trainFName);
+
+	unlink(largeFName.c_str());
+	unlink(trainFName.c_str());
+
+	FILE* fd = stdout;
+	if (jsonFName)
+	{
+		fd = fopen(jsonFName, "w");
+		if (!fd)
+		{
+			printf("[BENCH] Unable to write \"%s\"\n", jsonFName);
+			return EXIT_FAILURE;
+		}
+	}
+
+	bool written = writeJSON(fd);
+	if (fd != stdout)
+		fclose(fd);
+
+	return (written) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+void Bench::add(const std::string& name, const std::string& metric, double value,
+				const std::string& unit)
+{
+	BenchResult result;
+	result.name = name;
+	result.metric = metric;
+	result.value = value;
+	result.unit = unit;
+	results.push_back(result);
+
+	printf("[BENCH] %s %s: %.3f %s\n", name.c_str(), metric.c_str(), value, unit.c_str());
+}
+
+/*!
+ * @brief time reading a csv
+ * @details the raw tokenizer, the glades import and, for files big enough for it, the parallel
+ * dense import
+ * @param fname the csv path
+ */
+void Bench::benchImport(const std::string& fname)
+{
+	int64_t bytes = CSVReader::fileSize(fname.c_str());
+	if (bytes <= 0)
+		return;
+	double mb = bytes / (1024.0 * 1024.0);
+
+	Stopwatch timer;
+	CSVReader reader;
+	if (!reader.open(fname.c_str()))
+		return;
+	std::vector<CSVField> fields;
+	while (reader.readRecord(fields))
+		;
+	reader.close();
+	double scanMs = timer.lap();
+	if (scanMs > 0)
+		add(fname, "csv_scan", mb / (scanMs / 1000.0), "MB/s");
+
+	NumberInput numbers;
+	timer.lap();
+	numbers.import(fname.c_str());
+	double importMs = timer.lap();
+	if (importMs > 0)
+		add(fname, "number_input", mb / (importMs / 1000.0), "MB/s");
+
+	if (bytes < 1024 * 1024)
+		return;
+
+	DenseInput dense;
+	timer.lap();
+	bool parsed = dense.importParallel(fname.c_str());
+	double denseMs = timer.lap();
+	if ((parsed) && (denseMs > 0))
+		add(fname, "dense_parallel", mb / (denseMs / 1000.0), "MB/s");
+}
+
+/*!
+ * @brief time the text serialization of a float table both ways
+ */
+void Bench::benchSerialize()
+{
+	shmea::GTable table(',');
+	for (unsigned int r = 0; r < TRAIN_ROWS; ++r)
+	{
+		shmea::GList row;
+		for (unsigned int c = 0; c < FEATURES; ++c)
+			row.addFloat(Random::local()->nextFloat());
+		table.addRow(row);
+	}
+
+	Stopwatch timer;
+	shmea::GString serial = shmea::Serializable::Serialize(table);
+	double encodeMs = timer.lap();
+
+	shmea::GTable decoded;
+	shmea::Serializable::Deserialize(decoded, serial);
+	double decodeMs = timer.lap();
+
+	double mb = serial.length() / (1024.0 * 1024.0);
+	if (encodeMs > 0)
+		add("serialize_table", "encode", mb / (encodeMs / 1000.0), "MB/s");
+	if (decodeMs > 0)
+		add("serialize_table", "decode", mb / (decodeMs / 1000.0), "MB/s");
+}
+
+/*!
+ * @brief time training and testing one layer shape
+ * @details one hidden layer of the given width between FEATURES inputs and a regression
+ * output; the flop estimate counts a multiply-add per weight forward and two backward
+ * @param width the hidden layer size
+ * @param activation the GMath activation of the hidden layer
+ * @param fname the training csv
+ */
+void Bench::benchNetwork(int width, int activation, const std::string& fname)
+{
+	NumberInput numbers;
+	numbers.import(fname.c_str());
+	unsigned int rows = numbers.getTrainSize();
+	if (rows == 0)
+		return;
+
+	InputLayerInfo* inputLayer = new InputLayerInfo(32, 0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 0, 0.0f);
+	std::vector<HiddenLayerInfo*> hiddenLayers;
+	hiddenLayers.push_back(
+		new HiddenLayerInfo(width, 0.01f, 0.0f, 0.0f, 0.0f, 0.0f, activation, 0.0f));
+	OutputLayerInfo* outputLayer = new OutputLayerInfo(1, OutputLayerInfo::REGRESSION);
+	NNInfo* skeleton = new NNInfo(BENCH_NET, inputLayer, hiddenLayers, outputLayer);
+
+	char name[64];
+	snprintf(name, sizeof(name), "dense_%ux%dx1_act%d", FEATURES, width, activation);
+	double weights = (double)(FEATURES + 1) * width + (width + 1);
+
+	NNetwork* cNetwork = new NNetwork(skeleton);
+	cNetwork->terminator.setEpoch(EPOCHS);
+
+	Stopwatch timer;
+	glades::train(cNetwork, &numbers);
+	double trainMs = timer.lap();
+	cNetwork->test(&numbers);
+	double testMs = timer.lap();
+
+	if (trainMs > 0)
+	{
+		double samples = (double)rows * EPOCHS / (trainMs / 1000.0);
+		add(name, "train", samples, "samples/s");
+		add(name, "train_gflops", samples * weights * 6.0 / 1e9, "GFLOP/s");
+	}
+
+	unsigned int testRows = numbers.getTestSize();
+	if ((testMs > 0) && (testRows > 0))
+		add(name, "test", testRows / (testMs / 1000.0), "samples/s");
+
+	delete cNetwork;
+	delete skeleton;
+}
+
+/*!
+ * @brief time saving and reloading a trained network
+ * @details the network is deleted from the database afterwards
+ * @param fname the training csv
+ */
+void Bench::benchSaveLoad(const std::string& fname)
+{
+	NumberInput numbers;
+	numbers.import(fname.c_str());
+
+	InputLayerInfo* inputLayer = new InputLayerInfo(32, 0.01f, 0.0f, 0.0f, 0.0f, 0.0f, 0, 0.0f);
+	std::vector<HiddenLayerInfo*> hiddenLayers;
+	hiddenLayers.push_back(
+		new HiddenLayerInfo(128, 0.01f, 0.0f, 0.0f, 0.0f, 0.0f, GMath::TANH, 0.0f));
+	OutputLayerInfo* outputLayer = new OutputLayerInfo(1, OutputLayerInfo::REGRESSION);
+	NNInfo* skeleton = new NNInfo(BENCH_NET, inputLayer, hiddenLayers, outputLayer);
+
+	NNetwork* cNetwork = new NNetwork(skeleton);
+	cNetwork->terminator.setEpoch(1);
+	glades::train(cNetwork, &numbers);
+
+	Stopwatch timer;
+	bool saved = cNetwork->save();
+	double saveMs = timer.lap();
+
+	NNetwork loadedNetwork;
+	bool loaded = loadedNetwork.load(BENCH_NET);
+	double loadMs = timer.lap();
+
+	if (saved)
+		add("network_128", "save", saveMs, "ms");
+	if (loaded)
+		add("network_128", "load", loadMs, "ms");
+
+	shmea::SaveFolder nnList("neuralnetworks");
+	nnList.deleteItem(BENCH_NET);
+
+	delete cNetwork;
+	delete skeleton;
+}
+
+/*!
+ * @brief write a random regression csv
+ * @param fname the path
+ * @param rows the number of rows
+ * @param features the feature columns; one target column follows
+ * @return whether the file was written
+ */
+bool Bench::writeSynthetic(const std::string& fname, unsigned int rows, unsigned int features)
+{
+	FILE* fd = fopen(fname.c_str(), "w");
+	if (!fd)
+		return false;
+
+	// datasets start with a header line
+	for (unsigned int c = 0; c < features; ++c)
+		fprintf(fd, "f%u,", c);
+	fprintf(fd, "target\n");
+
+	Random rng(SEED);
+	for (unsigned int r = 0; r < rows; ++r)
+	{
+		float target = 0.0f;
+		for (unsigned int c = 0; c < features; ++c)
+		{
+			float value = rng.nextFloat();
+			target += value * ((c % 2 == 0) ? 1.0f : -1.0f);
+			fprintf(fd, "%.4f,", value);
+		}
+		fprintf(fd, "%.4f\n", target / features);
+	}
+
+	return fclose(fd) == 0;
+}
+
+/*!
+ * @brief write the results as JSON
+ * @param fd the open output
+ * @return whether everything was written
+ */
+bool Bench::writeJSON(FILE* fd) const
+{
+	fprintf(fd, "{\n\t\"version\": \"%s\",\n\t\"results\": [\n",
+			NNCreator::getVersion().getString().c_str());
+	for (unsigned int i = 0; i < results.size(); ++i)
+	{
+		const BenchResult& result = results[i];
+		fprintf(fd, "\t\t{\"name\": \"%s\", \"metric\": \"%s\", ", result.name.c_str(),
+				result.metric.c_str());
+		fprintf(fd, "\"value\": %.6g, \"unit\": \"%s\"}%s\n", result.value, result.unit.c_str(),
+				(i + 1 < results.size()) ? "," : "");
+	}
+	fprintf(fd, "\t]\n}\n");
+
+	return ferror(fd) == 0;
+}
+
+/*!
+ * @brief train one fixed configuration to its target
+ * @details reseeds before building the network so every run starts from the same weights and
+ * shuffles; peak RSS is the process high water mark after this configuration
+ * @param name the result name
+ * @param fname the csv path
+ * @param width the hidden layer size
+ * @param outputs the output layer size
+ * @param outputType the OutputLayerInfo type
+ * @param target the accuracy to stop at
+ * @param maxEpochs the epoch cap
+ */
+void Bench::trainToTarget(const std::string& name, const std::string& fname, int width,
+						  int outputs, int outputType, float target, int maxEpochs)
+{
+	Random::setSeed(SEED);
+	srand((unsigned int)SEED);
+
+	Stopwatch timer;
+	NumberInput numbers;
+	numbers.import(fname.c_str());
+	if (numbers.getTrainSize() == 0)
+	{
+		printf("[BENCH] Unable to load \"%s\"\n", fname.c_str());
+		return;
+	}
+	double loadMs = timer.lap();
+
+	InputLayerInfo* inputLayer = new InputLayerInfo(8, 0.1f, 0.5f, 0.0f, 0.0f, 0.0f, 0, 0.0f);
+	std::vector<HiddenLayerInfo*> hiddenLayers;
+	hiddenLayers.push_back(
+		new HiddenLayerInfo(width, 0.1f, 0.5f, 0.0f, 0.0f, 0.0f, GMath::TANH, 0.0f));
+	OutputLayerInfo* outputLayer = new OutputLayerInfo(outputs, outputType);
+	NNInfo* skeleton = new NNInfo(BENCH_NET, inputLayer, hiddenLayers, outputLayer);
+
+	NNetwork* cNetwork = new NNetwork(skeleton);
+	cNetwork->terminator.setEpoch(maxEpochs);
+	cNetwork->terminator.setAccuracy(target);
+
+	long allocsBefore = allocations();
+	timer.lap();
+	glades::train(cNetwork, &numbers);
+	double trainMs = timer.lap();
+	long allocsAfter = allocations();
+
+	int epochs = cNetwork->getEpochs();
+	add(name, "load", loadMs, "ms");
+	add(name, "wall", trainMs, "ms");
+	add(name, "epochs", epochs, "epochs");
+	add(name, "accuracy", cNetwork->getAccuracy(), "%");
+	add(name, "peak_rss", peakRSSKB(), "KB");
+	if ((allocsBefore >= 0) && (epochs > 0))
+		add(name, "allocs_per_epoch", (double)(allocsAfter - allocsBefore) / epochs, "allocs");
+
+	delete cNetwork;
+	delete skeleton;
+}
+
+/*!
+ * @brief run the end to end regression harness
+ * @details trains fixed, seeded configurations and compares their lower-is-better results with
+ * a stored baseline
+ * @param argc from main
+ * @param argv from main; "--baseline FILE" compares against FILE, "--save FILE" writes this run
+ * as the new baseline, "--tolerance PCT" sets the allowed regression (default 10)
+ * @return EXIT_FAILURE when a result regressed past the tolerance
+ */
+int Bench::regress(int argc, char* argv[])
+{
+	const char* baselineFName = NULL;
+	const char* saveFName = NULL;
+	double tolerance = REGRESS_TOLERANCE;
+	for (int i = 2; i < argc - 1; ++i)
+	{
+		if (strcmp(argv[i], "--baseline") == 0)
+			baselineFName = argv[i + 1];
+		else if (strcmp(argv[i], "--save") == 0)
+			saveFName = argv[i + 1];
+		else if (strcmp(argv[i], "--tolerance") == 0)
+			tolerance = atof(argv[i + 1]);
+	}
+
+	std::string e2eFName = std::string("datasets/") + E2E_NAME;
+	if (!writeSynthetic(e2eFName, E2E_ROWS, FEATURES))
+	{
+		printf("[BENCH] Unable to write the synthetic dataset\n");
+		return EXIT_FAILURE;
+	}
+
+	trainToTarget("e2e_iris", "datasets/iris.data", 8, 3, OutputLayerInfo::CLASSIFICATION, 95.0f,
+				  500);
+	trainToTarget("e2e_wine", "datasets/wine.data", 16, 3, OutputLayerInfo::CLASSIFICATION,
+				  95.0f, 500);
+	trainToTarget("e2e_synthetic_1m", e2eFName, 32, 1, OutputLayerInfo::REGRESSION, 100.0f, 1);
+	unlink(e2eFName.c_str());
+
+	if (saveFName)
+	{
+		FILE* fd = fopen(saveFName, "w");
+		if ((!fd) || (!writeJSON(fd)))
+		{
+			printf("[BENCH] Unable to write \"%s\"\n", saveFName);
+			if (fd)
+				fclose(fd);
+			return EXIT_FAILURE;
+		}
+		fclose(fd);
+	}
+	else
+		writeJSON(stdout);
+
+	if (!baselineFName)
+		return EXIT_SUCCESS;
+
+	std::vector<BenchResult> baseline;
+	if (!readJSON(baselineFName, baseline))
+	{
+		printf("[BENCH] No baseline at \"%s\", save one with \"make regress-baseline\"\n",
+			   baselineFName);
+		return EXIT_FAILURE;
+	}
+
+	// accuracy is reported but is not a cost, and load time is too noisy to gate on
+	unsigned int regressions = 0;
+	unsigned int compared = 0;
+	for (unsigned int i = 0; i < results.size(); ++i)
+	{
+		const BenchResult& cResult = results[i];
+		if ((cResult.metric == "accuracy") || (cResult.metric == "load"))
+			continue;
+
+		for (unsigned int j = 0; j < baseline.size(); ++j)
+		{
+			const BenchResult& cBase = baseline[j];
+			if ((cBase.name != cResult.name) || (cBase.metric != cResult.metric))
+				continue;
+
+			++compared;
+			double limit = cBase.value * (1.0 + tolerance / 100.0);
+			if ((cBase.value > 0) && (cResult.value > limit))
+			{
+				printf("[BENCH] REGRESSION %s %s: %.3f %s, baseline %.3f\n", cResult.name.c_str(),
+					   cResult.metric.c_str(), cResult.value, cResult.unit.c_str(), cBase.value);
+				++regressions;
+			}
+			break;
+		}
+	}
+
+	// a baseline from another harness would otherwise pass without checking anything
+	if (compared == 0)
+	{
+		printf("[BENCH] \"%s\" has none of these results\n", baselineFName);
+		return EXIT_FAILURE;
+	}
+
+	printf("[BENCH] %u regressions beyond %.1f%%\n", regressions, tolerance);
+	return (regressions == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*!
+ * @brief read results written by writeJSON
+ * @details expects writeJSON's one result per line layout, not arbitrary JSON
+ * @param fname the path
+ * @param dest filled with the results
+ * @return whether the file could be read
+ */
+bool Bench::readJSON(const char* fname, std::vector<BenchResult>& dest)
+{
+	FILE* fd = fopen(fname, "r");
+	if (!fd)
+		return false;
+
+	char line[512];
+	while (fgets(line, sizeof(line), fd))
+	{
+		char name[128];
+		char metric[64];
+		char unit[32];
+		double value = 0.0;
+		if (sscanf(line, " {\"name\": \"%127[^\"]\", \"metric\": \"%63[^\"]\", \"value\": %lf, "
+						 "\"unit\": \"%31[^\"]\"",
+				   name, metric, &value, unit) != 4)
+			continue;
+
+		BenchResult result;
+		result.name = name;
+		result.metric = metric;
+		result.value = value;
+		result.unit = unit;
+		dest.push_back(result);
+	}
+	fclose(fd);
+
+	return true;
+}
@@ -0,0 +1,83 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _BENCH
+#define _BENCH
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// One measured quantity of a benchmark run
+struct BenchResult
+{
+	std::string name;
+	std::string metric;
+	double value;
+	std::string unit;
+};
+
+// The built in benchmark suite behind "nncreator bench" and "make bench":
+// csv import, table serialization, training and inference throughput per
+// layer shape and activation, and network save/load times. Results are
+// printed as they are measured and written out as JSON for tracking.
+// "bench --regress" is the end to end harness: fixed, seeded networks are
+// trained to a target and fail the run when they get slower than a baseline.
+class Bench
+{
+private:
+	std::vector<BenchResult> results;
+
+	void add(const std::string&, const std::string&, double, const std::string&);
+
+	void benchImport(const std::string&);
+	void benchSerialize();
+	void benchNetwork(int, int, const std::string&);
+	void benchSaveLoad(const std::string&);
+
+	void trainToTarget(const std::string&, const std::string&, int, int, int, float, int);
+	int regress(int, char*[]);
+
+	static bool writeSynthetic(const std::string&, unsigned int, unsigned int);
+	static bool readJSON(const char*, std::vector<BenchResult>&);
+
+public:
+	// synthetic csv sizes
+	static const unsigned int LARGE_ROWS = 200000;
+	static const unsigned int TRAIN_ROWS = 10000;
+	static const unsigned int FEATURES = 16;
+	// epochs per training measurement
+	static const int EPOCHS = 2;
+	// rows of the generated end to end dataset
+	static const unsigned int E2E_ROWS = 1000000;
+	// percent a harness result may grow over its baseline
+	static const int REGRESS_TOLERANCE = 10;
+
+	int run(int, char*[]);
+	bool writeJSON(FILE*) const;
+};
+
+#endif
@@ -0,0 +1,695 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "cli.h"
+#include "bench.h"
+#include "core/lrschedule.h"
+#include "core/metricslog.h"
+#include "core/random.h"
+#include "core/stopwatch.h"
+#include "core/timebudget.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include "Backend/Machine Learning/DataObjects/ImageInput.h"
+#include "Backend/Machine Learning/Networks/network.h"
+#include "Backend/Machine Learning/State/Terminator.h"
+#include "Backend/Machine Learning/Structure/nninfo.h"
+#include "Backend/Machine Learning/main.h"
+#include "data/augmentinput.h"
+#include "data/autotune.h"
+#include "data/csvreader.h"
+#include "data/dedup.h"
+#include "data/denseinput.h"
+#include "data/distiller.h"
+#include "data/ensemble.h"
+#include "data/indexedinput.h"
+#include "data/inputloader.h"
+#include "data/memoryusage.h"
+#include "data/modelcache.h"
+#include "data/shardinput.h"
+#include "data/streaminput.h"
+#include "data/warmstart.h"
+#include <time.h>
+#include <vector>
+
+static double nowSeconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*!
+ * @brief train with the learning rates rescaled every UPDATE_EPOCHS
+ * @details the same stepping as ML_Train::trainChunk; the network's own rates are restored
+ * before it is saved
+ * @param cNetwork the loaded network
+ * @param di the training input
+ * @param schedule the schedule, not yet built
+ */
+static void trainScheduled(glades::NNetwork& cNetwork, glades::DataInput* di,
+						   LRSchedule& schedule)
+{
+	int64_t runStart = cNetwork.getEpochs();
+	int64_t epochLimit = cNetwork.terminator.getEpoch();
+	schedule.build((epochLimit > runStart) ? epochLimit - runStart : 0);
+
+	glades::NNInfo* skeleton = cNetwork.getNNInfo();
+	if ((!schedule.isActive()) || (!skeleton))
+	{
+		glades::train(&cNetwork, di);
+		return;
+	}
+
+	std::vector<float> baseRates;
+	for (int i = 0; i < skeleton->numHiddenLayers(); ++i)
+		baseRates.push_back(skeleton->getLearningRate(i));
+
+	while (true)
+	{
+		int64_t stepStart = cNetwork.getEpochs();
+		int64_t stepEnd = stepStart + LRSchedule::UPDATE_EPOCHS;
+		if ((epochLimit > 0) && (stepEnd > epochLimit))
+			stepEnd = epochLimit;
+		if (stepStart >= stepEnd)
+			break;
+
+		float scale = schedule.factor(stepStart - runStart);
+		for (unsigned int i = 0; i < baseRates.size(); ++i)
+			skeleton->setLearningRate(i, baseRates[i] * scale);
+
+		cNetwork.terminator.setEpoch(stepEnd);
+		glades::train(&cNetwork, di);
+		if (cNetwork.getEpochs() < stepEnd)
+			break;
+	}
+
+	cNetwork.terminator.setEpoch(epochLimit);
+	for (unsigned int i = 0; i < baseRates.size(); ++i)
+		skeleton->setLearningRate(i, baseRates[i]);
+}
+
+// trainScheduled's counterpart for a deadline: steps sized so the last one ends in time
+static void trainBudgeted(glades::NNetwork& cNetwork, glades::DataInput* di, TimeBudget& budget)
+{
+	int64_t epochLimit = cNetwork.terminator.getEpoch();
+	while (true)
+	{
+		int64_t stepStart = cNetwork.getEpochs();
+		int64_t stepEnd = stepStart + budget.epochsLeft();
+		if ((epochLimit > 0) && (stepEnd > epochLimit))
+			stepEnd = epochLimit;
+		if (stepStart >= stepEnd)
+			break;
+
+		cNetwork.terminator.setEpoch(stepEnd);
+		cNetwork.terminator.setTimestamp(budget.stopAt());
+		Stopwatch stepTime;
+		glades::train(&cNetwork, di);
+		budget.noteEpochs(cNetwork.getEpochs() - stepStart, stepTime.elapsedMs() / 1000.0);
+		if (cNetwork.getEpochs() < stepEnd)
+			break;
+	}
+
+	cNetwork.terminator.setEpoch(epochLimit);
+}
+
+// the wrappers around an input do not own what they wrap, so free them outermost first
+static void releaseLayers(std::vector<glades::DataInput*>& layers)
+{
+	for (unsigned int i = layers.size(); i > 0; --i)
+		InputLoader::release(layers[i - 1]);
+	layers.clear();
+}
+
+static int parseType(const char* typeName)
+{
+	if ((typeName) && (strcmp(typeName, "image") == 0))
+		return glades::DataInput::IMAGE;
+	if ((typeName) && (strcmp(typeName, "text") == 0))
+		return glades::DataInput::TEXT;
+	return glades::DataInput::CSV;
+}
+
+bool CLI::isCommand(const char* arg)
+{
+	return (arg) && ((strcmp(arg, "train") == 0) || (strcmp(arg, "test") == 0) ||
+					 (strcmp(arg, "predict") == 0) || (strcmp(arg, "bench") == 0) ||
+					 (strcmp(arg, "tune") == 0) || (strcmp(arg, "pack") == 0) ||
+					 (strcmp(arg, "history") == 0));
+}
+
+void CLI::usage()
+{
+	printf("usage: nncreator train --net NAME --data FILE [--type csv|image|text] [--threads N]\n"
+		   "                       [--epochs N] [--accuracy PCT] [--seconds N] [--memory MB]\n"
+		   "                       [--seed N] [--teachers NET,NET] [--replay PCT]\n"
+		   "                       [--schedule constant|step|cosine|onecycle[,WARMUP]]\n"
+		   "                       [--augment flip,crop=PX,brightness=D,contrast=F,noise=SD]\n"
+		   "       nncreator test --net NAME --data FILE [--type csv|image|text] [--threads N]\n"
+		   "       nncreator predict --net NAME --data FILE\n"
+		   "       nncreator bench --net NAME --data FILE [--repeat N] [--threads N]\n"
+		   "       nncreator bench [--json FILE]\n"
+		   "       nncreator tune --net NAME --data FILE [--type csv|image|text]\n"
+		   "       nncreator pack --data IMAGESET [--shard-rows N] [--dedup exact|near]\n"
+		   "       nncreator history --net NAME [--rows N]\n");
+}
+
+/*!
+ * @brief run a subcommand
+ * @param argc from main
+ * @param argv from main, argv[1] is the subcommand
+ * @return the process exit code
+ */
+int CLI::run(int argc, char* argv[])
+{
+	// a fixed seed makes the run repeatable
+	const char* seed = option(argc, argv, "--seed");
+	if (seed)
+	{
+		Random::setSeed(strtoull(seed, NULL, 10));
+		Random::setDeterministic(true);
+		srand((unsigned int)Random::local()->next());
+	}
+
+	// bench without a network runs the whole suite
+	if ((argc >= 2) && (strcmp(argv[1], "bench") == 0) && (!option(argc, argv, "--net")))
+	{
+		Bench suite;
+		return suite.run(argc, argv);
+	}
+
+	// pack works on the dataset alone, history on the network alone
+	bool needsNet = (argc >= 2) && (strcmp(argv[1], "pack") != 0);
+	bool needsData = (argc >= 2) && (strcmp(argv[1], "history") != 0);
+	if ((argc < 2) || (!isCommand(argv[1])) || ((needsNet) && (!option(argc, argv, "--net"))) ||
+		((needsData) && (!option(argc, argv, "--data"))))
+	{
+		usage();
+		return EXIT_FAILURE;
+	}
+
+	if (strcmp(argv[1], "train") == 0)
+		return train(argc, argv);
+	if (strcmp(argv[1], "test") == 0)
+		return test(argc, argv);
+	if (strcmp(argv[1], "predict") == 0)
+		return predict(argc, argv);
+	if (strcmp(argv[1], "tune") == 0)
+		return tune(argc, argv);
+	if (strcmp(argv[1], "pack") == 0)
+		return pack(argc, argv);
+	if (strcmp(argv[1], "history") == 0)
+		return history(argc, argv);
+	return bench(argc, argv);
+}
+
+/*!
+ * @brief find the value of a --name value option
+ * @param argc from main
+ * @param argv from main
+ * @param name the option, including its dashes
+ * @param fallback returned when the option is missing
+ * @return the value
+ */
+const char* CLI::option(int argc, char* argv[], const char* name, const char* fallback)
+{
+	for (int i = 2; i < argc - 1; ++i)
+	{
+		if (strcmp(argv[i], name) == 0)
+			return argv[i + 1];
+	}
+
+	return fallback;
+}
+
+/*!
+ * @brief apply the termination options to a network
+ * @param argc from main
+ * @param argv from main
+ * @param y the glades::NNetwork
+ */
+void CLI::applyTerminator(int argc, char* argv[], void* y)
+{
+	glades::NNetwork* cNetwork = (glades::NNetwork*)y;
+
+	const char* epochs = option(argc, argv, "--epochs");
+	if (epochs)
+		cNetwork->terminator.setEpoch(atoll(epochs));
+
+	const char* accuracy = option(argc, argv, "--accuracy");
+	if (accuracy)
+		cNetwork->terminator.setAccuracy((float)atof(accuracy));
+
+	const char* seconds = option(argc, argv, "--seconds");
+	if (seconds)
+		cNetwork->terminator.setTimestamp(time(NULL) + atoll(seconds));
+}
+
+int CLI::train(int argc, char* argv[])
+{
+	shmea::GString netName = option(argc, argv, "--net");
+	shmea::GString inputFName = option(argc, argv, "--data");
+	int inputType = parseType(option(argc, argv, "--type"));
+	unsigned int threads = Autotune::loaderThreads(atoi(option(argc, argv, "--threads", "0")));
+
+	double start = nowSeconds();
+	glades::DataInput* di = InputLoader::load(inputFName, inputType, threads);
+	if (!di)
+	{
+		printf("[CLI] Unable to load \"%s\"\n", inputFName.c_str());
+		return EXIT_FAILURE;
+	}
+
+	// Train on the teachers' outputs instead of the labels
+	const char* teacherList = option(argc, argv, "--teachers");
+	if ((teacherList) && (inputType == glades::DataInput::CSV))
+	{
+		DenseInput* dense = Distiller::toDense(di);
+		if ((!dense) ||
+			(!Distiller::apply(*dense, inputFName, Ensemble::parseNets(teacherList))))
+		{
+			printf("[CLI] Unable to distill \"%s\"\n", netName.c_str());
+			InputLoader::release(dense);
+			return EXIT_FAILURE;
+		}
+		di = dense;
+	}
+	std::vector<glades::DataInput*> layers(1, di);
+
+	// Same epoch shuffling and warm start as ML_Train
+	unsigned int datasetRows = di->getTrainSize();
+	const char* replay = option(argc, argv, "--replay");
+	bool rowFile =
+		(inputType == glades::DataInput::CSV) || (inputType == glades::DataInput::TEXT);
+	if (rowFile)
+	{
+		IndexedInput* shuffled = new IndexedInput(di);
+		if (replay)
+			WarmStart::select(*shuffled, netName, inputFName, atof(replay) / 100.0);
+		bool streamed = (dynamic_cast<StreamInput*>(di) != NULL);
+		shuffled->setShuffle(true, (streamed) ? StreamInput::WINDOW_ROWS : 0);
+		di = shuffled;
+		layers.push_back(di);
+	}
+	else if (ShardInput* shards = dynamic_cast<ShardInput*>(di))
+	{
+		IndexedInput* shuffled = new IndexedInput(di);
+		shuffled->setShuffle(true, shards->getShardRows());
+		di = shuffled;
+		layers.push_back(di);
+	}
+
+	const char* augmentSpec = option(argc, argv, "--augment");
+	if (augmentSpec)
+	{
+		AugmentInput* augmented = AugmentInput::create(di, augmentSpec);
+		if (!augmented)
+		{
+			releaseLayers(layers);
+			return EXIT_FAILURE;
+		}
+		di = augmented;
+		layers.push_back(di);
+	}
+	double loaded = nowSeconds();
+
+	glades::NNetwork cNetwork;
+	if (!cNetwork.load(netName))
+	{
+		printf("[CLI] Unable to load \"%s\"\n", netName.c_str());
+		releaseLayers(layers);
+		return EXIT_FAILURE;
+	}
+	if ((inputType == glades::DataInput::CSV) &&
+		(!WarmStart::sameEncoding(netName, inputFName, cNetwork.getEpochs() > 0)))
+	{
+		releaseLayers(layers);
+		return EXIT_FAILURE;
+	}
+	Autotune::applyBatchSize(cNetwork);
+	applyTerminator(argc, argv, &cNetwork);
+
+	size_t networkBytes = MemoryUsage::network(cNetwork.getNNInfo()).total;
+	size_t inputBytes = MemoryUsage::input(di);
+	MemoryUsage::setBudget((size_t)atoi(option(argc, argv, "--memory", "0")) * 1024 * 1024);
+	printf("[CLI] \"%s\" uses %s, its data %s\n", netName.c_str(),
+		   MemoryUsage::format(networkBytes).c_str(), MemoryUsage::format(inputBytes).c_str());
+	if (!MemoryUsage::fits(networkBytes + inputBytes))
+	{
+		printf("[CLI] \"%s\" needs %s, over the %s budget\n", netName.c_str(),
+			   MemoryUsage::format(networkBytes + inputBytes).c_str(),
+			   MemoryUsage::format(MemoryUsage::getBudget()).c_str());
+		releaseLayers(layers);
+		return EXIT_FAILURE;
+	}
+
+	LRSchedule schedule;
+	const char* scheduleSpec = option(argc, argv, "--schedule");
+	if ((scheduleSpec) && (!schedule.parse(scheduleSpec)))
+	{
+		printf("[CLI] Unknown schedule \"%s\"\n", scheduleSpec);
+		releaseLayers(layers);
+		return EXIT_FAILURE;
+	}
+
+	// --seconds is a deadline for the training and the save after it; time a save up front so
+	// the last step leaves room for it
+	TimeBudget budget;
+	budget.setDeadline(cNetwork.terminator.getTimestamp());
+	if (budget.isActive())
+	{
+		Stopwatch saveTime;
+		cNetwork.save();
+		budget.noteSave(saveTime.elapsedMs() / 1000.0);
+		cNetwork.terminator.setTimestamp(budget.stopAt());
+	}
+
+	if ((budget.isActive()) && (!scheduleSpec))
+		trainBudgeted(cNetwork, di, budget);
+	else
+		trainScheduled(cNetwork, di, schedule);
+	double trained = nowSeconds();
+
+	bool saved = cNetwork.save();
+	printf("[CLI] Trained \"%s\" for %d epochs: %f%% accuracy (load %.3fs, train %.3fs)\n",
+		   netName.c_str(), cNetwork.getEpochs(), cNetwork.getAccuracy(), loaded - start,
+		   trained - loaded);
+	if (!saved)
+		printf("[CLI] Unable to save \"%s\"\n", netName.c_str());
+	else if ((rowFile) && (!WarmStart::update(netName, inputFName, datasetRows)))
+		printf("[CLI] Unable to record what \"%s\" trained on\n", netName.c_str());
+
+	releaseLayers(layers);
+	return (saved) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int CLI::test(int argc, char* argv[])
+{
+	shmea::GString netName = option(argc, argv, "--net");
+	shmea::GString inputFName = option(argc, argv, "--data");
+	int inputType = parseType(option(argc, argv, "--type"));
+	unsigned int threads = atoi(option(argc, argv, "--threads", "0"));
+
+	glades::DataInput* di = InputLoader::load(inputFName, inputType, threads);
+	if (!di)
+	{
+		printf("[CLI] Unable to load \"%s\"\n", inputFName.c_str());
+		return EXIT_FAILURE;
+	}
+
+	glades::NNetwork cNetwork;
+	if (!cNetwork.load(netName))
+	{
+		printf("[CLI] Unable to load \"%s\"\n", netName.c_str());
+		InputLoader::release(di);
+		return EXIT_FAILURE;
+	}
+	if ((inputType == glades::DataInput::CSV) &&
+		(!WarmStart::sameEncoding(netName, inputFName, cNetwork.getEpochs() > 0)))
+	{
+		InputLoader::release(di);
+		return EXIT_FAILURE;
+	}
+
+	double start = nowSeconds();
+	glades::test(&cNetwork, di);
+	printf("[CLI] Tested \"%s\" on %u rows: %f%% accuracy (%.3fs)\n", netName.c_str(),
+		   di->getTestSize(), cNetwork.getAccuracy(), nowSeconds() - start);
+
+	InputLoader::release(di);
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * @brief print the network outputs for every row of an encoded csv
+ * @details rows whose fields do not all parse as numbers, such as a header, are skipped
+ */
+int CLI::predict(int argc, char* argv[])
+{
+	shmea::GString netName = option(argc, argv, "--net");
+	shmea::GString inputFName = shmea::GString("datasets/") + option(argc, argv, "--data");
+
+	ResidentModel* cModel = ModelCache::acquire(netName);
+	if (!cModel)
+		return EXIT_FAILURE;
+
+	CSVReader reader;
+	if (!reader.open(inputFName))
+	{
+		printf("[CLI] Unable to open \"%s\"\n", inputFName.c_str());
+		ModelCache::release(cModel);
+		return EXIT_FAILURE;
+	}
+
+	unsigned int inputCount = cModel->batcher.getInputCount();
+	std::vector<float> rows;
+	std::vector<CSVField> fields;
+	unsigned int rowCount = 0;
+	while (reader.readRecord(fields))
+	{
+		if (fields.size() < inputCount)
+			continue;
+
+		std::vector<float> cRow(inputCount);
+		bool numeric = true;
+		for (unsigned int c = 0; (c < inputCount) && (numeric); ++c)
+			numeric = CSVReader::parseFloat(fields[c], cRow[c]);
+		if (!numeric)
+			continue;
+
+		rows.insert(rows.end(), cRow.begin(), cRow.end());
+		++rowCount;
+	}
+
+	std::vector<float> outputs;
+	bool predicted = (rowCount > 0) && (cModel->batcher.predict(&rows[0], rowCount, outputs));
+	ModelCache::release(cModel);
+	if (!predicted)
+		return EXIT_FAILURE;
+
+	unsigned int width = outputs.size() / rowCount;
+	for (unsigned int r = 0; r < rowCount; ++r)
+	{
+		for (unsigned int c = 0; c < width; ++c)
+			printf((c == 0) ? "%f" : ",%f", outputs[(size_t)r * width + c]);
+		printf("\n");
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * @brief time repeated test passes
+ * @details reports the load times and the inference throughput in rows per second
+ */
+int CLI::bench(int argc, char* argv[])
+{
+	shmea::GString netName = option(argc, argv, "--net");
+	shmea::GString inputFName = option(argc, argv, "--data");
+	int inputType = parseType(option(argc, argv, "--type"));
+	unsigned int threads = atoi(option(argc, argv, "--threads", "0"));
+	int repeat = atoi(option(argc, argv, "--repeat", "5"));
+	if (repeat < 1)
+		repeat = 1;
+
+	double start = nowSeconds();
+	glades::DataInput* di = InputLoader::load(inputFName, inputType, threads);
+	if (!di)
+	{
+		printf("[CLI] Unable to load \"%s\"\n", inputFName.c_str());
+		return EXIT_FAILURE;
+	}
+	double dataLoaded = nowSeconds();
+
+	glades::NNetwork cNetwork;
+	if (!cNetwork.load(netName))
+	{
+		printf("[CLI] Unable to load \"%s\"\n", netName.c_str());
+		InputLoader::release(di);
+		return EXIT_FAILURE;
+	}
+	double netLoaded = nowSeconds();
+
+	for (int i = 0; i < repeat; ++i)
+		cNetwork.test(di);
+	double tested = nowSeconds();
+
+	double rowsPerSec = 0.0;
+	if (tested > netLoaded)
+		rowsPerSec = (double)di->getTestSize() * repeat / (tested - netLoaded);
+	printf("[CLI] data load %.3fs, net load %.3fs, %d test passes of %u rows: %.0f rows/s\n",
+		   dataLoaded - start, netLoaded - dataLoaded, repeat, di->getTestSize(), rowsPerSec);
+
+	InputLoader::release(di);
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * @brief measure and cache the fastest settings for a network on this machine
+ * @details times the csv loader thread counts on the dataset, then the batch sizes on a
+ * scratch copy of the network; train and ML_Train use the cached choices from then on
+ * @param argc from main
+ * @param argv from main
+ * @return the exit code
+ */
+int CLI::tune(int argc, char* argv[])
+{
+	shmea::GString netName = option(argc, argv, "--net");
+	shmea::GString inputFName = option(argc, argv, "--data");
+	int inputType = parseType(option(argc, argv, "--type"));
+
+	glades::DataInput* di = InputLoader::load(inputFName, inputType);
+	if (!di)
+	{
+		printf("[CLI] Unable to load \"%s\"\n", inputFName.c_str());
+		return EXIT_FAILURE;
+	}
+
+	unsigned int threads = 0;
+	if (inputType == glades::DataInput::CSV)
+		threads = Autotune::tuneThreads(inputFName);
+
+	int batchSize = Autotune::tuneBatchSize(netName, di);
+	InputLoader::release(di);
+	if (batchSize < 0)
+	{
+		printf("[CLI] Unable to tune \"%s\"\n", netName.c_str());
+		return EXIT_FAILURE;
+	}
+
+	printf("[CLI] Tuned \"%s\": batch size %d", netName.c_str(), batchSize);
+	if (threads > 0)
+		printf(", %u loader threads", threads);
+	printf(" (cached in \"%s\")\n", Autotune::path().c_str());
+	return EXIT_SUCCESS;
+}
+
+int CLI::pack(int argc, char* argv[])
+{
+	shmea::GString setName = option(argc, argv, "--data");
+	unsigned int shardRows = atoi(option(argc, argv, "--shard-rows", "0"));
+	if (shardRows == 0)
+		shardRows = ShardInput::SHARD_ROWS;
+
+	// always from the image files, never from an older pack
+	double start = nowSeconds();
+	glades::ImageInput images;
+	images.import(setName);
+	if (images.getTrainSize() == 0)
+	{
+		printf("[CLI] Unable to load \"%s\"\n", setName.c_str());
+		return EXIT_FAILURE;
+	}
+	double loaded = nowSeconds();
+
+	unsigned int width = 0;
+	unsigned int height = 0;
+	const shmea::GPointer<shmea::Image> firstImage = images.getTrainImage(0);
+	if (firstImage)
+	{
+		width = firstImage->getWidth();
+		height = firstImage->getHeight();
+	}
+
+	// duplicates only ever come out of the training rows
+	const char* dedupMode = option(argc, argv, "--dedup");
+	IndexedInput kept(&images);
+	const glades::DataInput* packSrc = &images;
+	if (dedupMode)
+	{
+		bool near = (strcmp(dedupMode, "near") == 0);
+		if ((!near) && (strcmp(dedupMode, "exact") != 0))
+		{
+			printf("[CLI] Unknown dedup mode \"%s\"\n", dedupMode);
+			return EXIT_FAILURE;
+		}
+
+		unsigned int dropped = 0;
+		Dedup dedup(near, width, height);
+		if (!dedup.filter(kept, dropped))
+		{
+			printf("[CLI] Unable to dedup \"%s\"\n", setName.c_str());
+			return EXIT_FAILURE;
+		}
+
+		printf("[CLI] Dropped %u duplicate images (%.3fs)\n", dropped, nowSeconds() - loaded);
+		packSrc = &kept;
+	}
+
+	shmea::GString packName = ShardInput::packPath(setName);
+	if (!ShardInput::pack(*packSrc, packName, shardRows, width, height))
+	{
+		printf("[CLI] Unable to pack \"%s\"\n", setName.c_str());
+		return EXIT_FAILURE;
+	}
+
+	printf("[CLI] Packed %u train and %u test images of \"%s\" into \"%s\" (load %.3fs, pack "
+		   "%.3fs)\n",
+		   packSrc->getTrainSize(), packSrc->getTestSize(), setName.c_str(), packName.c_str(),
+		   loaded - start, nowSeconds() - loaded);
+	return EXIT_SUCCESS;
+}
+
+/*!
+ * @brief print the metrics history of every training run of a network
+ * @details each run is read with one seek to its last rows, never the whole log
+ * @param argc from main
+ * @param argv from main; "--rows N" prints the last N rows of each run (default 1)
+ * @return the exit code
+ */
+int CLI::history(int argc, char* argv[])
+{
+	shmea::GString netName = option(argc, argv, "--net");
+	int64_t rows = atoll(option(argc, argv, "--rows", "1"));
+	if (rows < 1)
+		rows = 1;
+
+	std::vector<std::string> runs = MetricsLog::runs("metrics", netName.c_str());
+	if (runs.empty())
+	{
+		printf("[CLI] No runs of \"%s\"\n", netName.c_str());
+		return EXIT_FAILURE;
+	}
+
+	for (unsigned int i = 0; i < runs.size(); ++i)
+	{
+		std::vector<MetricsRecord> records;
+		int64_t count = MetricsLog::count(runs[i]);
+		if (MetricsLog::read(runs[i], -rows, rows, records) < 0)
+		{
+			printf("[CLI] Unable to read \"%s\"\n", runs[i].c_str());
+			continue;
+		}
+
+		printf("%s: %lld rows\n", runs[i].c_str(), (long long)count);
+		for (unsigned int r = 0; r < records.size(); ++r)
+			printf("  epoch %lld loss %f accuracy %f%%\n", (long long)records[r].epoch,
+				   records[r].loss, records[r].accuracy);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _CLI
+#define _CLI
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Headless subcommands: nncreator train|test|predict|bench|tune --net X --data Y,
+// pack --data Y, history --net X, or a bare bench for the benchmark suite.
+// They run glades directly on the calling thread, without starting GNet or
+// the gui, and return a process exit code.
+class CLI
+{
+private:
+	static const char* option(int, char*[], const char*, const char* = NULL);
+	static void applyTerminator(int, char*[], void*);
+
+	static int train(int, char*[]);
+	static int test(int, char*[]);
+	static int predict(int, char*[]);
+	static int bench(int, char*[]);
+	static int tune(int, char*[]);
+	static int pack(int, char*[]);
+	static int history(int, char*[]);
+
+public:
+	static bool isCommand(const char*);
+	static int run(int, char*[]);
+	static void usage();
+};
+
+#endif
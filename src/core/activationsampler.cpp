@@ -0,0 +1,169 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "activationsampler.h"
+#include <algorithm>
+#include <math.h>
+#include <utility>
+
+ActivationSampler::ActivationSampler()
+{
+	policy = STRIDE;
+	maxNeurons = DEFAULT_MAX_NEURONS;
+	totalNeurons = 0;
+}
+
+/*!
+ * @brief ActivationSampler constructor
+ * @param newPolicy STRIDE or TOP_K
+ * @param newMaxNeurons the most neurons drawn per layer
+ */
+ActivationSampler::ActivationSampler(int newPolicy, unsigned int newMaxNeurons)
+{
+	policy = newPolicy;
+	maxNeurons = (newMaxNeurons > 0) ? newMaxNeurons : 1;
+	totalNeurons = 0;
+}
+
+/*!
+ * @brief set the layer sizes of the network being drawn
+ * @param newSizes the neurons of each layer, input first
+ */
+void ActivationSampler::setLayers(const std::vector<unsigned int>& newSizes)
+{
+	layerSizes = newSizes;
+	layerStarts.resize(layerSizes.size());
+	picks.resize(layerSizes.size());
+
+	totalNeurons = 0;
+	for (unsigned int l = 0; l < layerSizes.size(); ++l)
+	{
+		layerStarts[l] = totalNeurons;
+		totalNeurons += layerSizes[l];
+
+		// evenly spaced, always keeping the first and last neuron
+		unsigned int size = layerSizes[l];
+		unsigned int kept = (size < maxNeurons) ? size : maxNeurons;
+		picks[l].resize(kept);
+		for (unsigned int i = 0; i < kept; ++i)
+			picks[l][i] = (kept > 1) ? (unsigned int)(((double)i * (size - 1)) / (kept - 1)) : 0;
+	}
+}
+
+/*!
+ * @brief reduce one update to the sampled neurons
+ * @param values every activation, layer by layer in the order given to setLayers
+ * @param sampled the activations of the sampled neurons, layer by layer
+ * @return whether values matched the layers; sampled is left empty when not
+ */
+bool ActivationSampler::sample(const std::vector<float>& values,
+							   std::vector<float>& sampled) const
+{
+	sampled.clear();
+	if ((totalNeurons == 0) || (values.size() != totalNeurons))
+		return false;
+
+	for (unsigned int l = 0; l < layerSizes.size(); ++l)
+	{
+		const float* layer = &values[layerStarts[l]];
+		if (layerSizes[l] <= maxNeurons)
+			sampled.insert(sampled.end(), layer, layer + layerSizes[l]);
+		else if (policy == TOP_K)
+			pickTopK(layer, layerSizes[l], sampled);
+		else
+		{
+			for (unsigned int i = 0; i < picks[l].size(); ++i)
+				sampled.push_back(layer[picks[l][i]]);
+		}
+	}
+
+	return true;
+}
+
+/*!
+ * @brief append the maxNeurons largest activations of a layer
+ * @details O(n) selection, then the kept neurons are put back in layer order
+ */
+void ActivationSampler::pickTopK(const float* layer, unsigned int size,
+								 std::vector<float>& sampled) const
+{
+	std::vector<std::pair<float, unsigned int> > ranked(size);
+	for (unsigned int i = 0; i < size; ++i)
+		ranked[i] = std::make_pair(-fabsf(layer[i]), i);
+	std::nth_element(ranked.begin(), ranked.begin() + maxNeurons, ranked.end());
+
+	std::vector<unsigned int> kept(maxNeurons);
+	for (unsigned int i = 0; i < maxNeurons; ++i)
+		kept[i] = ranked[i].second;
+	std::sort(kept.begin(), kept.end());
+
+	for (unsigned int i = 0; i < kept.size(); ++i)
+		sampled.push_back(layer[kept[i]]);
+}
+
+int ActivationSampler::getPolicy() const
+{
+	return policy;
+}
+
+unsigned int ActivationSampler::getMaxNeurons() const
+{
+	return maxNeurons;
+}
+
+/*!
+ * @brief whether any layer is wider than the sampled size
+ */
+bool ActivationSampler::isSampling() const
+{
+	for (unsigned int l = 0; l < layerSizes.size(); ++l)
+	{
+		if (layerSizes[l] > maxNeurons)
+			return true;
+	}
+
+	return false;
+}
+
+std::vector<unsigned int> ActivationSampler::getSampledSizes() const
+{
+	std::vector<unsigned int> sizes(layerSizes.size());
+	for (unsigned int l = 0; l < layerSizes.size(); ++l)
+		sizes[l] = (layerSizes[l] < maxNeurons) ? layerSizes[l] : maxNeurons;
+
+	return sizes;
+}
+
+void ActivationSampler::setPolicy(int newPolicy)
+{
+	policy = newPolicy;
+}
+
+void ActivationSampler::setMaxNeurons(unsigned int newMaxNeurons)
+{
+	maxNeurons = (newMaxNeurons > 0) ? newMaxNeurons : 1;
+	setLayers(layerSizes);
+}
@@ -0,0 +1,72 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _ACTIVATIONSAMPLER
+#define _ACTIVATIONSAMPLER
+
+#include <vector>
+
+// Picks which neurons of each layer get drawn, so the network view stays the
+// same size however wide the layers are. STRIDE keeps a fixed, evenly spaced
+// subset of every layer; TOP_K keeps the neurons with the largest activations
+// of each update, in their layer order.
+class ActivationSampler
+{
+private:
+	int policy;
+	unsigned int maxNeurons;
+	std::vector<unsigned int> layerSizes;
+	std::vector<unsigned int> layerStarts;
+	unsigned int totalNeurons;
+
+	// the STRIDE subset of each layer
+	std::vector<std::vector<unsigned int> > picks;
+
+	void pickTopK(const float*, unsigned int, std::vector<float>&) const;
+
+public:
+	static const int STRIDE = 0;
+	static const int TOP_K = 1;
+	static const unsigned int DEFAULT_MAX_NEURONS = 32;
+
+	ActivationSampler();
+	ActivationSampler(int, unsigned int);
+
+	void setLayers(const std::vector<unsigned int>&);
+	bool sample(const std::vector<float>&, std::vector<float>&) const;
+
+	// gets
+	int getPolicy() const;
+	unsigned int getMaxNeurons() const;
+	bool isSampling() const;
+	std::vector<unsigned int> getSampledSizes() const;
+
+	// sets
+	void setPolicy(int);
+	void setMaxNeurons(unsigned int);
+};
+
+#endif
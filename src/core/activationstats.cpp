@@ -0,0 +1,149 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "activationstats.h"
+
+const float ActivationStats::DEAD_EPSILON = 1e-6f;
+
+ActivationStats::ActivationStats()
+{
+	totalNeurons = 0;
+	updates = 0;
+}
+
+/*!
+ * @brief set the layer sizes and clear the statistics
+ * @param newSizes the neurons of each layer, input first
+ */
+void ActivationStats::setLayers(const std::vector<unsigned int>& newSizes)
+{
+	layerSizes = newSizes;
+	layerStarts.resize(layerSizes.size());
+
+	totalNeurons = 0;
+	for (unsigned int i = 0; i < layerSizes.size(); ++i)
+	{
+		layerStarts[i] = totalNeurons;
+		totalNeurons += layerSizes[i];
+	}
+
+	reset();
+}
+
+void ActivationStats::reset()
+{
+	updates = 0;
+	counts.assign(layerSizes.size(), 0.0);
+	means.assign(layerSizes.size(), 0.0);
+	m2s.assign(layerSizes.size(), 0.0);
+	deadCounts.assign(layerSizes.begin(), layerSizes.end());
+	alive.assign(totalNeurons, 0);
+}
+
+/*!
+ * @brief fold in one snapshot
+ * @details each layer's snapshot mean and spread are merged into the running ones with the
+ * parallel form of Welford's update, so the result matches having seen every value at once
+ * @param values every neuron's activation, layer after layer as in setLayers
+ * @return false when the snapshot does not match the layer sizes
+ */
+bool ActivationStats::update(const std::vector<float>& values)
+{
+	if ((totalNeurons == 0) || (values.size() != totalNeurons))
+		return false;
+
+	for (unsigned int l = 0; l < layerSizes.size(); ++l)
+	{
+		unsigned int start = layerStarts[l];
+		unsigned int size = layerSizes[l];
+		if (size == 0)
+			continue;
+
+		double sum = 0.0;
+		for (unsigned int i = start; i < start + size; ++i)
+		{
+			sum += values[i];
+			if ((!alive[i]) && (values[i] > DEAD_EPSILON))
+			{
+				alive[i] = 1;
+				--deadCounts[l];
+			}
+		}
+
+		double batchMean = sum / size;
+		double batchM2 = 0.0;
+		for (unsigned int i = start; i < start + size; ++i)
+		{
+			double diff = values[i] - batchMean;
+			batchM2 += diff * diff;
+		}
+
+		double total = counts[l] + size;
+		double delta = batchMean - means[l];
+		means[l] += delta * size / total;
+		m2s[l] += batchM2 + delta * delta * counts[l] * size / total;
+		counts[l] = total;
+	}
+
+	++updates;
+	return true;
+}
+
+unsigned int ActivationStats::numLayers() const
+{
+	return layerSizes.size();
+}
+
+int64_t ActivationStats::getUpdates() const
+{
+	return updates;
+}
+
+float ActivationStats::getMean(unsigned int layer) const
+{
+	if (layer >= means.size())
+		return 0.0f;
+	return (float)means[layer];
+}
+
+float ActivationStats::getVariance(unsigned int layer) const
+{
+	if ((layer >= m2s.size()) || (counts[layer] < 2.0))
+		return 0.0f;
+	return (float)(m2s[layer] / (counts[layer] - 1.0));
+}
+
+/*!
+ * @brief the share of a layer's neurons that have not fired in any snapshot
+ * @param layer the layer, 0 is the input
+ * @return the fraction, 0 before the first update
+ */
+float ActivationStats::getDeadFraction(unsigned int layer) const
+{
+	if ((layer >= layerSizes.size()) || (layerSizes[layer] == 0) || (updates == 0))
+		return 0.0f;
+	return (float)deadCounts[layer] / layerSizes[layer];
+}
@@ -0,0 +1,72 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _ACTIVATIONSTATS
+#define _ACTIVATIONSTATS
+
+#include <stdint.h>
+#include <vector>
+
+// Running per layer statistics over a stream of activation snapshots: mean
+// and variance of every value seen (merged in one pass per snapshot) and the
+// fraction of neurons that have never been above DEAD_EPSILON, which for a
+// ReLU layer are the dead units. Each update is O(neurons) and the state is
+// a few numbers per layer plus one flag per neuron.
+class ActivationStats
+{
+private:
+	std::vector<unsigned int> layerSizes;
+	std::vector<unsigned int> layerStarts;
+	unsigned int totalNeurons;
+	int64_t updates;
+
+	// per layer
+	std::vector<double> counts;
+	std::vector<double> means;
+	std::vector<double> m2s;
+	std::vector<unsigned int> deadCounts;
+
+	// per neuron, whether it has fired yet
+	std::vector<char> alive;
+
+public:
+	static const float DEAD_EPSILON;
+
+	ActivationStats();
+
+	void setLayers(const std::vector<unsigned int>&);
+	void reset();
+	bool update(const std::vector<float>&);
+
+	// gets
+	unsigned int numLayers() const;
+	int64_t getUpdates() const;
+	float getMean(unsigned int) const;
+	float getVariance(unsigned int) const;
+	float getDeadFraction(unsigned int) const;
+};
+
+#endif
@@ -0,0 +1,266 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "asynclog.h"
+#include <stdarg.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+int AsyncLog::level = AsyncLog::LOG_INFO;
+int AsyncLog::running = 0;
+bool AsyncLog::echo = true;
+FILE* AsyncLog::fd = NULL;
+pthread_t AsyncLog::writer;
+pthread_mutex_t AsyncLog::registryMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_key_t AsyncLog::threadKey;
+pthread_once_t AsyncLog::threadOnce = PTHREAD_ONCE_INIT;
+std::vector<AsyncLog::Ring*> AsyncLog::rings;
+
+// how long the writer sleeps once every ring is empty
+static const unsigned int FLUSH_US = 20000;
+static const char LEVEL_SYMBOLS[] = " diWE";
+
+void AsyncLog::makeKey()
+{
+	pthread_key_create(&threadKey, closeRing);
+}
+
+void AsyncLog::closeRing(void* ptr)
+{
+	__atomic_store_n(&((Ring*)ptr)->closed, 1, __ATOMIC_RELEASE);
+}
+
+AsyncLog::Ring* AsyncLog::local()
+{
+	pthread_once(&threadOnce, makeKey);
+	Ring* cRing = (Ring*)pthread_getspecific(threadKey);
+	if (cRing)
+		return cRing;
+
+	cRing = new Ring();
+	cRing->head = 0;
+	cRing->tail = 0;
+	cRing->dropped = 0;
+	cRing->closed = 0;
+
+	pthread_mutex_lock(&registryMutex);
+	rings.push_back(cRing);
+	pthread_mutex_unlock(&registryMutex);
+
+	pthread_setspecific(threadKey, cRing);
+	return cRing;
+}
+
+/*!
+ * @brief start the writer thread
+ * @details the parent directory is created if needed
+ * @param fname the log file, appended to
+ * @param newEcho whether the writer also prints each line to stdout
+ * @return whether the file could be opened
+ */
+bool AsyncLog::start(const std::string& fname, bool newEcho)
+{
+	if (__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+		return true;
+
+	std::string::size_type slash = fname.rfind('/');
+	if (slash != std::string::npos)
+		mkdir(fname.substr(0, slash).c_str(), 0755);
+
+	fd = fopen(fname.c_str(), "a");
+	if (!fd)
+		return false;
+
+	echo = newEcho;
+	__atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+	if (pthread_create(&writer, NULL, writerLoop, NULL) != 0)
+	{
+		__atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+		fclose(fd);
+		fd = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+/*!
+ * @brief flush every ring and stop the writer
+ * @details lines logged while stop() runs may be lost
+ */
+void AsyncLog::stop()
+{
+	if (!__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+		return;
+
+	__atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+	pthread_join(writer, NULL);
+
+	// the writer is gone, so this thread is the only consumer
+	drain();
+	fclose(fd);
+	fd = NULL;
+}
+
+void AsyncLog::setLevel(int newLevel)
+{
+	__atomic_store_n(&level, newLevel, __ATOMIC_RELAXED);
+}
+
+int AsyncLog::getLevel()
+{
+	return __atomic_load_n(&level, __ATOMIC_RELAXED);
+}
+
+/*!
+ * @brief check a level before building an expensive message
+ * @param cLevel the level
+ * @return whether write() would keep the line
+ */
+bool AsyncLog::enabled(int cLevel)
+{
+	return cLevel >= __atomic_load_n(&level, __ATOMIC_RELAXED);
+}
+
+/*!
+ * @brief log one line
+ * @details disabled levels return before any formatting; a full ring drops the line rather than
+ * block, and the writer reports how many were dropped
+ * @param cLevel the level
+ * @param format printf style, the trailing newline is optional
+ */
+void AsyncLog::write(int cLevel, const char* format, ...)
+{
+	if (!enabled(cLevel))
+		return;
+
+	va_list args;
+	va_start(args, format);
+	if (!__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+	{
+		vprintf(format, args);
+		va_end(args);
+		if ((format[0] == '\0') || (format[strlen(format) - 1] != '\n'))
+			printf("\n");
+		return;
+	}
+
+	Ring* cRing = local();
+	unsigned int head = cRing->head;
+	if (head - __atomic_load_n(&cRing->tail, __ATOMIC_ACQUIRE) >= RING_RECORDS)
+	{
+		__atomic_fetch_add(&cRing->dropped, 1, __ATOMIC_RELAXED);
+		va_end(args);
+		return;
+	}
+
+	Record& cRecord = cRing->records[head % RING_RECORDS];
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	cRecord.level = cLevel;
+	cRecord.wallUs = (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+	vsnprintf(cRecord.text, TEXT_BYTES, format, args);
+	va_end(args);
+
+	__atomic_store_n(&cRing->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void* AsyncLog::writerLoop(void*)
+{
+	while (__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+	{
+		if (drain() == 0)
+			usleep(FLUSH_US);
+	}
+
+	return NULL;
+}
+
+/*!
+ * @brief write out every pending record
+ * @details rings of exited threads are freed once empty
+ * @return the number of records written
+ */
+unsigned int AsyncLog::drain()
+{
+	unsigned int written = 0;
+
+	pthread_mutex_lock(&registryMutex);
+	for (unsigned int r = 0; r < rings.size();)
+	{
+		Ring* cRing = rings[r];
+		bool closed = __atomic_load_n(&cRing->closed, __ATOMIC_ACQUIRE);
+		unsigned int tail = cRing->tail;
+		unsigned int head = __atomic_load_n(&cRing->head, __ATOMIC_ACQUIRE);
+		for (; tail != head; ++tail, ++written)
+		{
+			const Record& cRecord = cRing->records[tail % RING_RECORDS];
+			time_t seconds = (time_t)(cRecord.wallUs / 1000000);
+			struct tm local;
+			localtime_r(&seconds, &local);
+			char stamp[32];
+			strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+
+			// one newline per line whether or not the caller wrote one
+			const char* text = cRecord.text;
+			int length = (int)strnlen(text, TEXT_BYTES);
+			if ((length > 0) && (text[length - 1] == '\n'))
+				--length;
+
+			fprintf(fd, "%s.%03d %c %.*s\n", stamp, (int)((cRecord.wallUs / 1000) % 1000),
+					LEVEL_SYMBOLS[(cRecord.level >= 1 && cRecord.level <= 4) ? cRecord.level : 0],
+					length, text);
+			if (echo)
+				printf("%.*s\n", length, text);
+		}
+		__atomic_store_n(&cRing->tail, tail, __ATOMIC_RELEASE);
+
+		uint64_t dropped = __atomic_exchange_n(&cRing->dropped, 0, __ATOMIC_RELAXED);
+		if (dropped > 0)
+			fprintf(fd, "[LOG] Dropped %llu lines\n", (unsigned long long)dropped);
+
+		if ((closed) && (tail == __atomic_load_n(&cRing->head, __ATOMIC_ACQUIRE)))
+		{
+			delete cRing;
+			rings.erase(rings.begin() + r);
+		}
+		else
+			++r;
+	}
+	pthread_mutex_unlock(&registryMutex);
+
+	if (written > 0)
+	{
+		fflush(fd);
+		if (echo)
+			fflush(stdout);
+	}
+
+	return written;
+}
@@ -0,0 +1,98 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _ASYNCLOG
+#define _ASYNCLOG
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Console and file logging off the hot paths. Each thread formats its line
+// into a fixed record of its own ring buffer, so logging takes no lock and
+// never waits on the terminal or the disk; a writer thread stamps, writes
+// and flushes the records. Before start() and after stop() lines go straight
+// to stdout.
+class AsyncLog
+{
+private:
+	static const unsigned int TEXT_BYTES = 240;
+	static const unsigned int RING_RECORDS = 256;
+
+	struct Record
+	{
+		int level;
+		int64_t wallUs;
+		char text[TEXT_BYTES];
+	};
+
+	struct Ring
+	{
+		Record records[RING_RECORDS];
+		// head is written by the owner thread, tail by the writer
+		unsigned int head;
+		unsigned int tail;
+		uint64_t dropped;
+		// set when the owner thread exits so the writer can free the ring
+		int closed;
+	};
+
+	static int level;
+	static int running;
+	static bool echo;
+	static FILE* fd;
+	static pthread_t writer;
+	static pthread_mutex_t registryMutex;
+	static pthread_key_t threadKey;
+	static pthread_once_t threadOnce;
+	static std::vector<Ring*> rings;
+
+	static void makeKey();
+	static void closeRing(void*);
+	static Ring* local();
+	static void* writerLoop(void*);
+	static unsigned int drain();
+
+public:
+	// same numbering as shmea::GLogger
+	static const int LOG_DEBUG = 1;
+	static const int LOG_INFO = 2;
+	static const int LOG_WARNING = 3;
+	static const int LOG_ERROR = 4;
+
+	static bool start(const std::string&, bool = true);
+	static void stop();
+
+	static void setLevel(int);
+	static int getLevel();
+	static bool enabled(int);
+
+	static void write(int, const char*, ...) __attribute__((format(printf, 2, 3)));
+};
+
+#endif
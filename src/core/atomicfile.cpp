@@ -0,0 +1,185 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "atomicfile.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+// makes the temp names of this process unique across threads
+static unsigned int tmpCount = 0;
+
+AtomicFile::AtomicFile()
+{
+	fd = NULL;
+	ok = false;
+}
+
+AtomicFile::~AtomicFile()
+{
+	abort();
+}
+
+/*!
+ * @brief start writing a replacement
+ * @details the temp file is "<path>.tmp.<pid>.<n>", created exclusively, so writers of the same
+ * target never share one; whichever commits last wins with a whole file
+ * @param newPath the file to replace once committed
+ * @return whether the temp file could be created
+ */
+bool AtomicFile::open(const std::string& newPath)
+{
+	abort();
+
+	char suffix[48];
+	snprintf(suffix, sizeof(suffix), ".tmp.%ld.%u", (long)getpid(),
+			 __sync_fetch_and_add(&tmpCount, 1));
+	path = newPath;
+	tmpPath = path + suffix;
+
+	int tmpFd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+	if (tmpFd >= 0)
+	{
+		fd = fdopen(tmpFd, "wb");
+		if (!fd)
+			close(tmpFd);
+	}
+
+	if (!fd)
+		tmpPath = "";
+	ok = (fd != NULL);
+	return ok;
+}
+
+bool AtomicFile::write(const void* data, size_t len)
+{
+	if ((!fd) || (!ok))
+		return false;
+
+	if ((len > 0) && (fwrite(data, 1, len, fd) != len))
+		ok = false;
+
+	return ok;
+}
+
+// close the temp file, optionally making sure the data reached the disk first
+bool AtomicFile::flush(bool sync)
+{
+	if (!fd)
+		return false;
+
+	if (fflush(fd) != 0)
+		ok = false;
+	if ((ok) && (sync) && (fsync(fileno(fd)) != 0))
+		ok = false;
+	if (fclose(fd) != 0)
+		ok = false;
+	fd = NULL;
+
+	return ok;
+}
+
+bool AtomicFile::publish()
+{
+	if ((!ok) || (rename(tmpPath.c_str(), path.c_str()) != 0))
+	{
+		unlink(tmpPath.c_str());
+		ok = false;
+		return false;
+	}
+
+	tmpPath = "";
+	return true;
+}
+
+/*!
+ * @brief replace the target with what was written
+ * @param sync whether to fsync the data and the directory entry; without it the rename is
+ * still atomic but may not survive a power loss
+ * @return whether the target was replaced
+ */
+bool AtomicFile::commit(bool sync)
+{
+	if ((!flush(sync)) || (!publish()))
+	{
+		abort();
+		return false;
+	}
+
+	if (sync)
+		syncDirectory(path);
+	return true;
+}
+
+// Drop the temp file, leaving the target untouched
+void AtomicFile::abort()
+{
+	if (fd)
+	{
+		fclose(fd);
+		fd = NULL;
+	}
+
+	if (!tmpPath.empty())
+		unlink(tmpPath.c_str());
+	tmpPath = "";
+	ok = false;
+}
+
+bool AtomicFile::isOpen() const
+{
+	return fd != NULL;
+}
+
+bool AtomicFile::writeFile(const std::string& fname, const void* data, size_t len, bool sync)
+{
+	AtomicFile file;
+	if (!file.open(fname))
+		return false;
+
+	if (!file.write(data, len))
+		return false;
+
+	return file.commit(sync);
+}
+
+/*!
+ * @brief persist a rename
+ * @param fname a file in the directory, or the directory itself with a trailing '/'
+ */
+void AtomicFile::syncDirectory(const std::string& fname)
+{
+	size_t slash = fname.rfind('/');
+	std::string dir = (slash == std::string::npos) ? "." : fname.substr(0, slash);
+	if (dir.empty())
+		dir = "/";
+
+	int dirFd = ::open(dir.c_str(), O_RDONLY);
+	if (dirFd < 0)
+		return;
+
+	fsync(dirFd);
+	close(dirFd);
+}
@@ -0,0 +1,67 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _ATOMICFILE
+#define _ATOMICFILE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+// Crash safe file replacement. Data goes to a temp file of its own next to the
+// target and is renamed over it only once it is complete and on disk, so a
+// reader (or a reboot) sees either the old file or the new one, never half of
+// either.
+class AtomicFile
+{
+private:
+	std::string path;
+	std::string tmpPath;
+	FILE* fd;
+	bool ok;
+
+	bool flush(bool);
+	bool publish();
+
+	// owns a FILE*
+	AtomicFile(const AtomicFile&);
+	void operator=(const AtomicFile&);
+
+public:
+	AtomicFile();
+	virtual ~AtomicFile();
+
+	bool open(const std::string&);
+	bool write(const void*, size_t);
+	bool commit(bool = true);
+	void abort();
+	bool isOpen() const;
+
+	static bool writeFile(const std::string&, const void*, size_t, bool = true);
+	static void syncDirectory(const std::string&);
+};
+
+#endif
@@ -0,0 +1,304 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "confusion.h"
+
+ConfusionMatrix::ConfusionMatrix()
+{
+	build(0);
+}
+
+ConfusionMatrix::ConfusionMatrix(unsigned int newClassCount)
+{
+	build(newClassCount);
+}
+
+void ConfusionMatrix::build(unsigned int newClassCount)
+{
+	classCount = newClassCount;
+	counts.assign(classCount * classCount, 0);
+	reset();
+}
+
+void ConfusionMatrix::reset()
+{
+	counts.assign(classCount * classCount, 0);
+	total = 0;
+	correct = 0;
+	dirty = true;
+}
+
+void ConfusionMatrix::add(int predicted, int actual)
+{
+	if ((predicted < 0) || (actual < 0) || ((unsigned int)predicted >= classCount) ||
+		((unsigned int)actual >= classCount))
+		return;
+
+	++counts[actual * classCount + predicted];
+	++total;
+	if (predicted == actual)
+		++correct;
+	dirty = true;
+}
+
+/*!
+ * @brief add a batch of results
+ * @details one pass of integer increments; labels outside [0, classCount) are skipped
+ * @param predicted the predicted class of each sample
+ * @param actual the true class of each sample
+ * @param n the number of samples
+ */
+void ConfusionMatrix::addBatch(const int* predicted, const int* actual, unsigned int n)
+{
+	if ((!predicted) || (!actual))
+		return;
+
+	int64_t* cell = counts.empty() ? NULL : &counts[0];
+	for (unsigned int i = 0; i < n; ++i)
+	{
+		unsigned int p = (unsigned int)predicted[i];
+		unsigned int a = (unsigned int)actual[i];
+		if ((p >= classCount) || (a >= classCount))
+			continue;
+
+		++cell[a * classCount + p];
+		++total;
+		correct += (p == a);
+	}
+	dirty = true;
+}
+
+/*!
+ * @brief add another matrix's counts
+ * @details for per thread or per fold matrices; both must have the same class count
+ * @param other the matrix to add
+ */
+void ConfusionMatrix::merge(const ConfusionMatrix& other)
+{
+	if (other.classCount != classCount)
+		return;
+
+	for (unsigned int i = 0; i < counts.size(); ++i)
+		counts[i] += other.counts[i];
+	total += other.total;
+	correct += other.correct;
+	dirty = true;
+}
+
+/*!
+ * @brief recompute the derived stats
+ * @details O(classCount^2) from the column and row sums, only when results changed since the
+ * last read
+ */
+void ConfusionMatrix::updateStats() const
+{
+	if (!dirty)
+		return;
+
+	precision.assign(classCount, 0.0f);
+	recall.assign(classCount, 0.0f);
+	specificity.assign(classCount, 0.0f);
+	falseAlarm.assign(classCount, 0.0f);
+	f1.assign(classCount, 0.0f);
+
+	std::vector<int64_t> actualSum(classCount, 0);
+	std::vector<int64_t> predictedSum(classCount, 0);
+	for (unsigned int a = 0; a < classCount; ++a)
+	{
+		for (unsigned int p = 0; p < classCount; ++p)
+		{
+			int64_t cell = counts[a * classCount + p];
+			actualSum[a] += cell;
+			predictedSum[p] += cell;
+		}
+	}
+
+	for (unsigned int c = 0; c < classCount; ++c)
+	{
+		int64_t tp = counts[c * classCount + c];
+		int64_t fp = predictedSum[c] - tp;
+		int64_t fn = actualSum[c] - tp;
+		int64_t tn = total - tp - fp - fn;
+
+		if (tp + fp > 0)
+			precision[c] = (float)tp / (float)(tp + fp);
+		if (tp + fn > 0)
+			recall[c] = (float)tp / (float)(tp + fn);
+		if (tn + fp > 0)
+		{
+			specificity[c] = (float)tn / (float)(tn + fp);
+			falseAlarm[c] = (float)fp / (float)(tn + fp);
+		}
+		if (precision[c] + recall[c] > 0.0f)
+			f1[c] = 2.0f * precision[c] * recall[c] / (precision[c] + recall[c]);
+	}
+
+	dirty = false;
+}
+
+unsigned int ConfusionMatrix::getClassCount() const
+{
+	return classCount;
+}
+
+int64_t ConfusionMatrix::getCount(unsigned int actual, unsigned int predicted) const
+{
+	if ((actual >= classCount) || (predicted >= classCount))
+		return 0;
+
+	return counts[actual * classCount + predicted];
+}
+
+int64_t ConfusionMatrix::getTotal() const
+{
+	return total;
+}
+
+float ConfusionMatrix::getOverallAccuracy() const
+{
+	if (total == 0)
+		return 0.0f;
+
+	return (float)correct / (float)total;
+}
+
+float ConfusionMatrix::getClassPrecision(unsigned int c) const
+{
+	if (c >= classCount)
+		return 0.0f;
+
+	updateStats();
+	return precision[c];
+}
+
+float ConfusionMatrix::getClassRecall(unsigned int c) const
+{
+	if (c >= classCount)
+		return 0.0f;
+
+	updateStats();
+	return recall[c];
+}
+
+float ConfusionMatrix::getClassSpecificity(unsigned int c) const
+{
+	if (c >= classCount)
+		return 0.0f;
+
+	updateStats();
+	return specificity[c];
+}
+
+float ConfusionMatrix::getClassFalseAlarm(unsigned int c) const
+{
+	if (c >= classCount)
+		return 0.0f;
+
+	updateStats();
+	return falseAlarm[c];
+}
+
+float ConfusionMatrix::getClassF1Score(unsigned int c) const
+{
+	if (c >= classCount)
+		return 0.0f;
+
+	updateStats();
+	return f1[c];
+}
+
+// Overall values are macro averages over the classes
+static float average(const std::vector<float>& values)
+{
+	if (values.empty())
+		return 0.0f;
+
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < values.size(); ++i)
+		sum += values[i];
+	return sum / values.size();
+}
+
+float ConfusionMatrix::getOverallPrecision() const
+{
+	updateStats();
+	return average(precision);
+}
+
+float ConfusionMatrix::getOverallRecall() const
+{
+	updateStats();
+	return average(recall);
+}
+
+float ConfusionMatrix::getOverallSpecificity() const
+{
+	updateStats();
+	return average(specificity);
+}
+
+float ConfusionMatrix::getOverallFalseAlarm() const
+{
+	updateStats();
+	return average(falseAlarm);
+}
+
+float ConfusionMatrix::getOverallF1Score() const
+{
+	updateStats();
+	return average(f1);
+}
+
+void ConfusionMatrix::print() const
+{
+	for (unsigned int a = 0; a < classCount; ++a)
+	{
+		for (unsigned int p = 0; p < classCount; ++p)
+			printf("%lld ", (long long)counts[a * classCount + p]);
+		printf("\n");
+	}
+	printf("Accuracy: %f F1: %f\n", getOverallAccuracy(), getOverallF1Score());
+}
+
+/*!
+ * @brief class of an output row
+ * @param values the output or expected row
+ * @param n the number of values
+ * @return the index of the largest value, -1 for an empty row
+ */
+int ConfusionMatrix::argmax(const float* values, unsigned int n)
+{
+	if ((!values) || (n == 0))
+		return -1;
+
+	unsigned int best = 0;
+	for (unsigned int i = 1; i < n; ++i)
+	{
+		if (values[i] > values[best])
+			best = i;
+	}
+	return best;
+}
@@ -0,0 +1,86 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _CONFUSION
+#define _CONFUSION
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+// Integer backed confusion matrix, rows are the actual class and columns the
+// predicted class. Results are added a batch of class indices at a time and the
+// per class precision, recall and F1 are only recomputed when asked for after
+// new results came in.
+class ConfusionMatrix
+{
+private:
+	unsigned int classCount;
+	std::vector<int64_t> counts;
+	int64_t total;
+	int64_t correct;
+
+	mutable bool dirty;
+	mutable std::vector<float> precision;
+	mutable std::vector<float> recall;
+	mutable std::vector<float> specificity;
+	mutable std::vector<float> falseAlarm;
+	mutable std::vector<float> f1;
+
+	void updateStats() const;
+
+public:
+	ConfusionMatrix();
+	ConfusionMatrix(unsigned int);
+
+	// sets
+	void build(unsigned int);
+	void reset();
+	void add(int, int);
+	void addBatch(const int*, const int*, unsigned int);
+	void merge(const ConfusionMatrix&);
+
+	// gets
+	unsigned int getClassCount() const;
+	int64_t getCount(unsigned int, unsigned int) const;
+	int64_t getTotal() const;
+	float getOverallAccuracy() const;
+	float getClassPrecision(unsigned int) const;
+	float getOverallPrecision() const;
+	float getClassRecall(unsigned int) const;
+	float getOverallRecall() const;
+	float getClassSpecificity(unsigned int) const;
+	float getOverallSpecificity() const;
+	float getClassFalseAlarm(unsigned int) const;
+	float getOverallFalseAlarm() const;
+	float getClassF1Score(unsigned int) const;
+	float getOverallF1Score() const;
+	void print() const;
+
+	static int argmax(const float*, unsigned int);
+};
+
+#endif
@@ -0,0 +1,91 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "cpufeatures.h"
+#if defined(__aarch64__) && defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+bool CPUFeatures::detected = false;
+unsigned int CPUFeatures::features = 0;
+
+/*!
+ * @brief read the CPU features
+ * @details cpuid on x86, the auxiliary vector on ARM; call once from the main thread before any
+ * worker starts, later calls do nothing
+ */
+void CPUFeatures::detect()
+{
+	if (detected)
+		return;
+
+	features = 0;
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+		features |= SSE2;
+	if (__builtin_cpu_supports("avx2"))
+		features |= AVX2;
+	if (__builtin_cpu_supports("avx512bw"))
+		features |= AVX512BW;
+#elif defined(__aarch64__) && defined(__linux__)
+	if (getauxval(AT_HWCAP) & HWCAP_ASIMD)
+		features |= NEON;
+#endif
+
+	detected = true;
+}
+
+bool CPUFeatures::has(unsigned int feature)
+{
+	if (!detected)
+		detect();
+
+	return (features & feature) == feature;
+}
+
+/*!
+ * @brief name the detected features
+ * @return e.g. "sse2 avx2", or "none"
+ */
+std::string CPUFeatures::describe()
+{
+	static const char* names[] = {"sse2", "avx2", "avx512bw", "neon"};
+
+	std::string text;
+	for (unsigned int i = 0; i < 4; ++i)
+	{
+		if (!has(1 << i))
+			continue;
+
+		if (!text.empty())
+			text += " ";
+		text += names[i];
+	}
+
+	return (text.empty()) ? "none" : text;
+}
@@ -0,0 +1,51 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _CPUFEATURES
+#define _CPUFEATURES
+
+#include <string>
+
+// The vector extensions of the CPU we are running on, read once at startup
+// so one binary can pick its kernels per node instead of per build.
+class CPUFeatures
+{
+private:
+	static bool detected;
+	static unsigned int features;
+
+public:
+	static const unsigned int SSE2 = 1 << 0;
+	static const unsigned int AVX2 = 1 << 1;
+	static const unsigned int AVX512BW = 1 << 2;
+	static const unsigned int NEON = 1 << 3;
+
+	static void detect();
+	static bool has(unsigned int);
+	static std::string describe();
+};
+
+#endif
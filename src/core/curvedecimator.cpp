@@ -0,0 +1,183 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "curvedecimator.h"
+
+CurveDecimator::CurveDecimator()
+{
+	maxBuckets = DEFAULT_BUCKETS;
+	clear();
+}
+
+/*!
+ * @brief CurveDecimator constructor
+ * @param newBuckets the most buckets kept, usually the graph width in pixels
+ */
+CurveDecimator::CurveDecimator(unsigned int newBuckets)
+{
+	maxBuckets = (newBuckets > 0) ? newBuckets : 1;
+	clear();
+}
+
+void CurveDecimator::clear()
+{
+	buckets.clear();
+	pointsPerBucket = 1;
+	pointCount = 0;
+}
+
+/*!
+ * @brief append a point to the series
+ * @details O(1) amortized; a fold touches every bucket but halves their count
+ * @param x the x value, expected to be non-decreasing
+ * @param y the y value
+ */
+void CurveDecimator::append(float x, float y)
+{
+	++pointCount;
+
+	// out of buckets, so halve them before starting another
+	if ((buckets.size() >= maxBuckets) && (buckets.back().count >= pointsPerBucket))
+		fold();
+
+	if ((!buckets.empty()) && (buckets.back().count < pointsPerBucket))
+	{
+		Bucket& cBucket = buckets.back();
+		if (y < cBucket.minY)
+		{
+			cBucket.minX = x;
+			cBucket.minY = y;
+		}
+		if (y > cBucket.maxY)
+		{
+			cBucket.maxX = x;
+			cBucket.maxY = y;
+		}
+		++cBucket.count;
+		return;
+	}
+
+	Bucket newBucket;
+	newBucket.minX = x;
+	newBucket.minY = y;
+	newBucket.maxX = x;
+	newBucket.maxY = y;
+	newBucket.count = 1;
+	buckets.push_back(newBucket);
+}
+
+/*!
+ * @brief merge neighbouring buckets pairwise and double the points per bucket
+ */
+void CurveDecimator::fold()
+{
+	unsigned int folded = 0;
+	for (unsigned int i = 0; i < buckets.size(); i += 2)
+	{
+		Bucket merged = buckets[i];
+		if (i + 1 < buckets.size())
+		{
+			const Bucket& next = buckets[i + 1];
+			if (next.minY < merged.minY)
+			{
+				merged.minX = next.minX;
+				merged.minY = next.minY;
+			}
+			if (next.maxY > merged.maxY)
+			{
+				merged.maxX = next.maxX;
+				merged.maxY = next.maxY;
+			}
+			merged.count += next.count;
+		}
+
+		buckets[folded] = merged;
+		++folded;
+	}
+
+	buckets.resize(folded);
+	pointsPerBucket *= 2;
+}
+
+/*!
+ * @brief the decimated series
+ * @details each bucket gives its min and max in x order, or a single point when they are
+ * the same sample, so the envelope of the full curve is kept
+ * @param xs the x values, replaced
+ * @param ys the y values, replaced
+ */
+void CurveDecimator::points(std::vector<float>& xs, std::vector<float>& ys) const
+{
+	xs.clear();
+	ys.clear();
+	xs.reserve(buckets.size() * 2);
+	ys.reserve(buckets.size() * 2);
+
+	for (unsigned int i = 0; i < buckets.size(); ++i)
+	{
+		const Bucket& cBucket = buckets[i];
+		bool minFirst = (cBucket.minX <= cBucket.maxX);
+		float firstX = minFirst ? cBucket.minX : cBucket.maxX;
+		float firstY = minFirst ? cBucket.minY : cBucket.maxY;
+		float secondX = minFirst ? cBucket.maxX : cBucket.minX;
+		float secondY = minFirst ? cBucket.maxY : cBucket.minY;
+
+		xs.push_back(firstX);
+		ys.push_back(firstY);
+		if ((secondX != firstX) || (secondY != firstY))
+		{
+			xs.push_back(secondX);
+			ys.push_back(secondY);
+		}
+	}
+}
+
+unsigned int CurveDecimator::getBuckets() const
+{
+	return maxBuckets;
+}
+
+unsigned int CurveDecimator::getPointsPerBucket() const
+{
+	return pointsPerBucket;
+}
+
+int64_t CurveDecimator::size() const
+{
+	return pointCount;
+}
+
+/*!
+ * @brief set the most buckets kept
+ * @details folds right away when the series already has more
+ * @param newBuckets the bucket limit, usually the graph width in pixels
+ */
+void CurveDecimator::setBuckets(unsigned int newBuckets)
+{
+	maxBuckets = (newBuckets > 0) ? newBuckets : 1;
+	while (buckets.size() > maxBuckets)
+		fold();
+}
@@ -0,0 +1,75 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _CURVEDECIMATOR
+#define _CURVEDECIMATOR
+
+#include <stdint.h>
+#include <vector>
+
+// Append-only series reduced to min/max buckets, one bucket per pixel column.
+// Once the buckets fill up, neighbours are folded together and each bucket covers
+// twice as many points, so memory and the points handed to the graph stay
+// O(columns) however long the learning curve gets.
+class CurveDecimator
+{
+private:
+	struct Bucket
+	{
+		float minX;
+		float minY;
+		float maxX;
+		float maxY;
+		unsigned int count;
+	};
+
+	std::vector<Bucket> buckets;
+	unsigned int maxBuckets;
+	unsigned int pointsPerBucket;
+	int64_t pointCount;
+
+	void fold();
+
+public:
+	static const unsigned int DEFAULT_BUCKETS = 256;
+
+	CurveDecimator();
+	CurveDecimator(unsigned int);
+
+	void append(float, float);
+	void clear();
+	void points(std::vector<float>&, std::vector<float>&) const;
+
+	// gets
+	unsigned int getBuckets() const;
+	unsigned int getPointsPerBucket() const;
+	int64_t size() const;
+
+	// sets
+	void setBuckets(unsigned int);
+};
+
+#endif
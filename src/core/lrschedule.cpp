@@ -0,0 +1,216 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "lrschedule.h"
+#include <math.h>
+#include <stdlib.h>
+
+// a one cycle run starts and ends this far below the peak
+static const float ONE_CYCLE_DIV = 25.0f;
+static const float ONE_CYCLE_FINAL_DIV = 1e4f;
+
+// share of a one cycle run spent ramping up
+static const double ONE_CYCLE_RAMP = 0.3;
+
+static const double PI = 3.14159265358979323846;
+
+LRSchedule::LRSchedule()
+{
+	type = CONSTANT;
+	warmupEpochs = 0;
+	stepEpochs = 30;
+	stepGamma = 0.1f;
+	minFactor = 0.0f;
+}
+
+/*!
+ * @brief LRSchedule constructor
+ * @param newType CONSTANT, STEP, COSINE or ONE_CYCLE
+ * @param newWarmupEpochs epochs to ramp up from zero
+ */
+LRSchedule::LRSchedule(int newType, int64_t newWarmupEpochs)
+{
+	type = newType;
+	warmupEpochs = newWarmupEpochs;
+	stepEpochs = 30;
+	stepGamma = 0.1f;
+	minFactor = 0.0f;
+}
+
+/*!
+ * @brief read a schedule from an option
+ * @details "type" or "type,warmup" with type one of constant, step, cosine or onecycle
+ * @param spec the option text
+ * @return whether it named a schedule
+ */
+bool LRSchedule::parse(const std::string& spec)
+{
+	std::string name = spec;
+	int64_t warmup = 0;
+	size_t comma = spec.find(',');
+	if (comma != std::string::npos)
+	{
+		name = spec.substr(0, comma);
+		warmup = atoll(spec.c_str() + comma + 1);
+	}
+
+	if (name == "constant")
+		type = CONSTANT;
+	else if (name == "step")
+		type = STEP;
+	else if (name == "cosine")
+		type = COSINE;
+	else if (name == "onecycle")
+		type = ONE_CYCLE;
+	else
+		return false;
+
+	warmupEpochs = (warmup > 0) ? warmup : 0;
+	return true;
+}
+
+/*!
+ * @brief the multiplier for one epoch
+ * @param epoch the epoch since the run started
+ * @param epochs the length of the run, 0 when it has no epoch limit
+ * @return the learning rate multiplier
+ */
+float LRSchedule::compute(int64_t epoch, int64_t epochs) const
+{
+	// without a horizon only the warmup and step decay are defined
+	double progress = (epochs > 0) ? (double)epoch / (double)epochs : 0.0;
+	if (progress > 1.0)
+		progress = 1.0;
+
+	double value = 1.0;
+	if (type == STEP)
+	{
+		if (stepEpochs > 0)
+			value = pow((double)stepGamma, (double)(epoch / stepEpochs));
+	}
+	else if ((type == COSINE) && (epochs > 0))
+		value = minFactor + (1.0 - minFactor) * 0.5 * (1.0 + cos(PI * progress));
+	else if ((type == ONE_CYCLE) && (epochs > 0))
+	{
+		double low = 1.0 / ONE_CYCLE_DIV;
+		if (progress < ONE_CYCLE_RAMP)
+			return (float)(low + (1.0 - low) * progress / ONE_CYCLE_RAMP);
+
+		double down = (progress - ONE_CYCLE_RAMP) / (1.0 - ONE_CYCLE_RAMP);
+		double end = low / ONE_CYCLE_FINAL_DIV;
+		return (float)(end + (1.0 - end) * 0.5 * (1.0 + cos(PI * down)));
+	}
+
+	if ((type != ONE_CYCLE) && (epoch < warmupEpochs))
+		value *= (double)(epoch + 1) / (double)warmupEpochs;
+
+	return (float)value;
+}
+
+/*!
+ * @brief precompute the multipliers of a run
+ * @param epochs the length of the run, 0 when it has no epoch limit
+ */
+void LRSchedule::build(int64_t epochs)
+{
+	factors.clear();
+	if ((type == CONSTANT) && (warmupEpochs == 0))
+		return;
+
+	// an open ended run keeps the last factor once the warmup and step decay run out
+	unsigned int length = (unsigned int)((epochs > 0) ? epochs : warmupEpochs + 1);
+	if ((epochs <= 0) && (type == STEP))
+		length = (unsigned int)MAX_EPOCHS;
+	if (length > MAX_EPOCHS)
+		length = (unsigned int)MAX_EPOCHS;
+
+	factors.resize(length);
+	for (unsigned int i = 0; i < length; ++i)
+		factors[i] = compute(i, epochs);
+}
+
+/*!
+ * @brief the multiplier for an epoch
+ * @param epoch the epoch since the run started
+ * @return the precomputed multiplier, 1 when there is no schedule
+ */
+float LRSchedule::factor(int64_t epoch) const
+{
+	if (factors.empty())
+		return 1.0f;
+
+	if (epoch < 0)
+		epoch = 0;
+	if (epoch >= (int64_t)factors.size())
+		return factors[factors.size() - 1];
+
+	return factors[epoch];
+}
+
+bool LRSchedule::isActive() const
+{
+	return !factors.empty();
+}
+
+int LRSchedule::getType() const
+{
+	return type;
+}
+
+int64_t LRSchedule::getWarmupEpochs() const
+{
+	return warmupEpochs;
+}
+
+void LRSchedule::setType(int newType)
+{
+	type = newType;
+}
+
+void LRSchedule::setWarmupEpochs(int64_t newWarmupEpochs)
+{
+	warmupEpochs = newWarmupEpochs;
+}
+
+/*!
+ * @brief set the step decay
+ * @param newStepEpochs epochs between decays
+ * @param newStepGamma the multiplier applied at each decay
+ */
+void LRSchedule::setStep(int64_t newStepEpochs, float newStepGamma)
+{
+	stepEpochs = newStepEpochs;
+	stepGamma = newStepGamma;
+}
+
+/*!
+ * @brief set the floor of the cosine schedule
+ * @param newMinFactor the multiplier reached at the end of the run
+ */
+void LRSchedule::setMinFactor(float newMinFactor)
+{
+	minFactor = newMinFactor;
+}
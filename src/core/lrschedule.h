@@ -0,0 +1,84 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _LRSCHEDULE
+#define _LRSCHEDULE
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Learning rate multipliers over a training run. The multiplier for every
+// epoch is computed once by build(), so looking one up while training is a
+// single table read. The layers' own learning rates are the peak, and each
+// epoch trains at rate * factor(epoch). A linear warmup ramps the first
+// epochs up from zero on top of any schedule except ONE_CYCLE, which has its
+// own ramp.
+class LRSchedule
+{
+private:
+	int type;
+	int64_t warmupEpochs;
+	int64_t stepEpochs;
+	float stepGamma;
+	float minFactor;
+
+	std::vector<float> factors;
+
+	float compute(int64_t, int64_t) const;
+
+public:
+	static const int CONSTANT = 0;
+	static const int STEP = 1;
+	static const int COSINE = 2;
+	static const int ONE_CYCLE = 3;
+
+	// epochs trained between learning rate updates
+	static const int64_t UPDATE_EPOCHS = 5;
+
+	// tables longer than this are not built; later epochs keep the last factor
+	static const int64_t MAX_EPOCHS = 1 << 20;
+
+	LRSchedule();
+	LRSchedule(int, int64_t = 0);
+
+	bool parse(const std::string&);
+	void build(int64_t);
+	float factor(int64_t) const;
+	bool isActive() const;
+
+	// gets
+	int getType() const;
+	int64_t getWarmupEpochs() const;
+
+	// sets
+	void setType(int);
+	void setWarmupEpochs(int64_t);
+	void setStep(int64_t, float);
+	void setMinFactor(float);
+};
+
+#endif
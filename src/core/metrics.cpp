@@ -0,0 +1,183 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "metrics.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+pthread_mutex_t Metrics::registryMutex = PTHREAD_MUTEX_INITIALIZER;
+const char* Metrics::names[Metrics::MAX_METRICS];
+const char* Metrics::helps[Metrics::MAX_METRICS];
+int Metrics::types[Metrics::MAX_METRICS];
+uint64_t Metrics::values[Metrics::MAX_METRICS];
+int Metrics::metricCount = 0;
+
+static inline uint64_t toBits(double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static inline double fromBits(uint64_t bits)
+{
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+int Metrics::find(const char* name, const char* help, int type)
+{
+	pthread_mutex_lock(&registryMutex);
+	int found = -1;
+	for (int i = 0; i < metricCount; ++i)
+	{
+		if (strcmp(names[i], name) == 0)
+			found = i;
+	}
+
+	if ((found < 0) && (metricCount < MAX_METRICS))
+	{
+		names[metricCount] = name;
+		helps[metricCount] = help;
+		types[metricCount] = type;
+		__atomic_store_n(&values[metricCount], toBits(0.0), __ATOMIC_RELAXED);
+		found = metricCount;
+		__atomic_store_n(&metricCount, metricCount + 1, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&registryMutex);
+
+	return found;
+}
+
+/*!
+ * @brief register a counter
+ * @details registering an existing name returns its slot, so call sites can look it up once into
+ * a static
+ * @param name a string literal, without the "_total" suffix
+ * @param help a string literal describing it
+ * @return the slot, or -1 once every slot is taken
+ */
+int Metrics::counter(const char* name, const char* help)
+{
+	return find(name, help, COUNTER);
+}
+
+/*!
+ * @brief register a gauge
+ * @param name a string literal
+ * @param help a string literal describing it
+ * @return the slot, or -1 once every slot is taken
+ */
+int Metrics::gauge(const char* name, const char* help)
+{
+	return find(name, help, GAUGE);
+}
+
+void Metrics::add(int slot, double amount)
+{
+	if ((slot < 0) || (slot >= MAX_METRICS))
+		return;
+
+	uint64_t expected = __atomic_load_n(&values[slot], __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&values[slot], &expected,
+										toBits(fromBits(expected) + amount), true,
+										__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+	{
+	}
+}
+
+void Metrics::set(int slot, double value)
+{
+	if ((slot < 0) || (slot >= MAX_METRICS))
+		return;
+
+	__atomic_store_n(&values[slot], toBits(value), __ATOMIC_RELAXED);
+}
+
+double Metrics::get(int slot)
+{
+	if ((slot < 0) || (slot >= MAX_METRICS))
+		return 0.0;
+
+	return fromBits(__atomic_load_n(&values[slot], __ATOMIC_RELAXED));
+}
+
+/*!
+ * @brief read every metric
+ * @return one entry per registered metric, in registration order
+ */
+std::vector<MetricValue> Metrics::snapshot()
+{
+	std::vector<MetricValue> snap;
+	int count = __atomic_load_n(&metricCount, __ATOMIC_ACQUIRE);
+	for (int i = 0; i < count; ++i)
+	{
+		MetricValue cValue;
+		cValue.name = names[i];
+		cValue.help = helps[i];
+		cValue.type = types[i];
+		cValue.value = get(i);
+		snap.push_back(cValue);
+	}
+
+	return snap;
+}
+
+/*!
+ * @brief format every metric in the OpenMetrics text format
+ * @return the exposition, ending in "# EOF"
+ */
+std::string Metrics::openMetrics()
+{
+	std::string text;
+	char line[256];
+
+	std::vector<MetricValue> snap = snapshot();
+	for (unsigned int i = 0; i < snap.size(); ++i)
+	{
+		const MetricValue& cValue = snap[i];
+		bool isCounter = (cValue.type == COUNTER);
+		snprintf(line, sizeof(line), "# TYPE %s %s\n# HELP %s %s\n", cValue.name,
+				 (isCounter) ? "counter" : "gauge", cValue.name, cValue.help);
+		text += line;
+
+		// the format spells the special values its own way
+		if (isnan(cValue.value))
+			snprintf(line, sizeof(line), "%s%s NaN\n", cValue.name, (isCounter) ? "_total" : "");
+		else if (isinf(cValue.value))
+			snprintf(line, sizeof(line), "%s%s %sInf\n", cValue.name, (isCounter) ? "_total" : "",
+					 (cValue.value > 0) ? "+" : "-");
+		else
+			snprintf(line, sizeof(line), "%s%s %.17g\n", cValue.name, (isCounter) ? "_total" : "",
+					 cValue.value);
+		text += line;
+	}
+	text += "# EOF\n";
+
+	return text;
+}
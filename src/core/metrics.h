@@ -0,0 +1,76 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _METRICS
+#define _METRICS
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// One exported metric at the time of a snapshot
+struct MetricValue
+{
+	const char* name;
+	const char* help;
+	int type;
+	double value;
+};
+
+// Process wide counters and gauges for scraping. Values are atomics, so the
+// training and serving paths update them without a lock; only registering a
+// new name locks. Names follow the Prometheus conventions, and counters get
+// the "_total" suffix on export.
+class Metrics
+{
+private:
+	static pthread_mutex_t registryMutex;
+	static const char* names[64];
+	static const char* helps[64];
+	static int types[64];
+	// doubles stored by bit pattern for the atomic builtins
+	static uint64_t values[64];
+	static int metricCount;
+
+	static int find(const char*, const char*, int);
+
+public:
+	static const int MAX_METRICS = 64;
+	static const int COUNTER = 0;
+	static const int GAUGE = 1;
+
+	static int counter(const char*, const char*);
+	static int gauge(const char*, const char*);
+	static void add(int, double = 1.0);
+	static void set(int, double);
+	static double get(int);
+
+	static std::vector<MetricValue> snapshot();
+	static std::string openMetrics();
+};
+
+#endif
@@ -0,0 +1,290 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "metricslog.h"
+#include <algorithm>
+#include <dirent.h>
+#include <math.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char METRICS_MAGIC[8] = {'N', 'N', 'C', 'M', 'E', 'T', 'R', 0};
+static const char METRICS_EXT[] = ".nnmetrics";
+
+MetricsLog::MetricsLog()
+{
+	fd = NULL;
+}
+
+MetricsLog::~MetricsLog()
+{
+	close();
+}
+
+// Checks the header of an open log
+static bool readHeader(FILE* fd)
+{
+	char header[MetricsLog::HEADER_BYTES];
+	if (fseek(fd, 0, SEEK_SET) != 0)
+		return false;
+	if (fread(header, 1, sizeof(header), fd) != sizeof(header))
+		return false;
+
+	uint32_t version = 0;
+	uint32_t recordSize = 0;
+	memcpy(&version, header + 8, sizeof(version));
+	memcpy(&recordSize, header + 12, sizeof(recordSize));
+	return (memcmp(header, METRICS_MAGIC, sizeof(METRICS_MAGIC)) == 0) &&
+		   (version == MetricsLog::VERSION) && (recordSize == sizeof(MetricsRecord));
+}
+
+/*!
+ * @brief open a log for appending
+ * @details creates the file with its header if it does not exist; an existing file with another
+ * layout is left alone and not opened
+ * @param fname the path of the log
+ * @return whether the log is ready to append to
+ */
+bool MetricsLog::open(const std::string& fname)
+{
+	close();
+
+	path = fname;
+	fd = fopen(path.c_str(), "r+b");
+	if (fd)
+	{
+		if (!readHeader(fd))
+		{
+			printf("[METRICS] \"%s\" is not a metrics log\n", path.c_str());
+			close();
+			return false;
+		}
+	}
+	else
+	{
+		fd = fopen(path.c_str(), "w+b");
+		if (!fd)
+			return false;
+
+		char header[HEADER_BYTES];
+		uint32_t version = VERSION;
+		uint32_t recordSize = sizeof(MetricsRecord);
+		memcpy(header, METRICS_MAGIC, sizeof(METRICS_MAGIC));
+		memcpy(header + 8, &version, sizeof(version));
+		memcpy(header + 12, &recordSize, sizeof(recordSize));
+		if (fwrite(header, 1, sizeof(header), fd) != sizeof(header))
+		{
+			close();
+			return false;
+		}
+	}
+
+	// drop a torn last record left by a crash
+	fseek(fd, 0, SEEK_END);
+	long size = ftell(fd);
+	long whole = HEADER_BYTES + ((size - HEADER_BYTES) / (long)sizeof(MetricsRecord)) *
+									(long)sizeof(MetricsRecord);
+	if (size != whole)
+	{
+		fflush(fd);
+		if (truncate(path.c_str(), whole) != 0)
+		{
+			close();
+			return false;
+		}
+		fseek(fd, 0, SEEK_END);
+	}
+
+	return true;
+}
+
+void MetricsLog::close()
+{
+	if (fd)
+		fclose(fd);
+	fd = NULL;
+}
+
+bool MetricsLog::isOpen() const
+{
+	return fd != NULL;
+}
+
+/*!
+ * @brief add a row
+ * @details flushed right away so readers and crashes see every finished row
+ * @param record the row to add
+ * @return whether it was written
+ */
+bool MetricsLog::append(const MetricsRecord& record)
+{
+	if (!fd)
+		return false;
+
+	if (fseek(fd, 0, SEEK_END) != 0)
+		return false;
+	if (fwrite(&record, sizeof(record), 1, fd) != 1)
+		return false;
+
+	return fflush(fd) == 0;
+}
+
+MetricsRecord MetricsLog::emptyRecord()
+{
+	MetricsRecord record;
+	record.epoch = 0;
+	record.timestamp = 0;
+	record.loss = NAN;
+	record.accuracy = NAN;
+	record.precision = NAN;
+	record.recall = NAN;
+	record.f1 = NAN;
+	record.reserved = 0.0f;
+	return record;
+}
+
+/*!
+ * @brief the log of one run
+ * @param dir the metrics directory
+ * @param netName the network
+ * @param started when the run started, in seconds since the epoch
+ * @param runID the Scheduler job of the run, which keeps runs started in the same second apart
+ * @return "<dir>/<net>.<started>.<runID>.nnmetrics"
+ */
+std::string MetricsLog::runPath(const std::string& dir, const std::string& netName,
+								int64_t started, int64_t runID)
+{
+	char stamp[48];
+	snprintf(stamp, sizeof(stamp), ".%lld.%lld", (long long)started, (long long)runID);
+	return dir + "/" + netName + stamp + METRICS_EXT;
+}
+
+/*!
+ * @brief the run logs of a network
+ * @param dir the metrics directory
+ * @param netName the network
+ * @return the paths from runPath, oldest first
+ */
+std::vector<std::string> MetricsLog::runs(const std::string& dir, const std::string& netName)
+{
+	std::vector<std::string> paths;
+	DIR* dirFd = opendir(dir.c_str());
+	if (!dirFd)
+		return paths;
+
+	std::string prefix = netName + ".";
+	std::string ext = METRICS_EXT;
+	std::vector<std::pair<std::pair<int64_t, int64_t>, std::string> > found;
+	struct dirent* entry = NULL;
+	while ((entry = readdir(dirFd)) != NULL)
+	{
+		std::string fname = entry->d_name;
+		if ((fname.length() <= prefix.length() + ext.length()) ||
+			(fname.compare(0, prefix.length(), prefix) != 0) ||
+			(fname.compare(fname.length() - ext.length(), ext.length(), ext) != 0))
+			continue;
+
+		// only "<started>.<runID>" between the name and the extension, so "net.b" is not "net"
+		std::string stamp =
+			fname.substr(prefix.length(), fname.length() - prefix.length() - ext.length());
+		long long started = 0;
+		long long runID = 0;
+		int used = 0;
+		if ((sscanf(stamp.c_str(), "%lld.%lld%n", &started, &runID, &used) != 2) ||
+			(used != (int)stamp.length()))
+			continue;
+
+		found.push_back(std::make_pair(std::make_pair((int64_t)started, (int64_t)runID),
+									   dir + "/" + fname));
+	}
+	closedir(dirFd);
+
+	std::sort(found.begin(), found.end());
+	for (unsigned int i = 0; i < found.size(); ++i)
+		paths.push_back(found[i].second);
+
+	return paths;
+}
+
+/*!
+ * @brief the number of rows in a log
+ * @param fname the path of the log
+ * @return the row count, -1 if there is no log
+ */
+int64_t MetricsLog::count(const std::string& fname)
+{
+	struct stat st;
+	if ((stat(fname.c_str(), &st) != 0) || (st.st_size < (int64_t)HEADER_BYTES))
+		return -1;
+
+	return (st.st_size - HEADER_BYTES) / sizeof(MetricsRecord);
+}
+
+/*!
+ * @brief read a range of rows
+ * @param fname the path of the log
+ * @param start the first row; negative counts back from the end
+ * @param maxRows the most rows to read
+ * @param records the rows out
+ * @return the number of rows read, -1 if the log could not be read
+ */
+int64_t MetricsLog::read(const std::string& fname, int64_t start, int64_t maxRows,
+						 std::vector<MetricsRecord>& records)
+{
+	records.clear();
+
+	FILE* readFd = fopen(fname.c_str(), "rb");
+	if (!readFd)
+		return -1;
+
+	if (!readHeader(readFd))
+	{
+		fclose(readFd);
+		return -1;
+	}
+
+	int64_t rows = count(fname);
+	if (start < 0)
+		start += rows;
+	if (start < 0)
+		start = 0;
+	if (maxRows > rows - start)
+		maxRows = rows - start;
+
+	if (maxRows > 0)
+	{
+		records.resize(maxRows);
+		long offset = HEADER_BYTES + (long)(start * sizeof(MetricsRecord));
+		size_t got = 0;
+		if (fseek(readFd, offset, SEEK_SET) == 0)
+			got = fread(&records[0], sizeof(MetricsRecord), maxRows, readFd);
+		records.resize(got);
+	}
+
+	fclose(readFd);
+	return records.size();
+}
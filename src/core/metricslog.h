@@ -0,0 +1,83 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _METRICSLOG
+#define _METRICSLOG
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// One fixed width row of a run's history. Values that were not measured are
+// stored as NaN.
+struct MetricsRecord
+{
+	int64_t epoch;
+	int64_t timestamp;
+	float loss;
+	float accuracy;
+	float precision;
+	float recall;
+	float f1;
+	float reserved;
+};
+
+// Append only, fixed width metrics history of one training run. A short
+// header is followed by MetricsRecords, so the newest rows, a range of rows or
+// the count can be read with a single seek and never the whole file. Every run
+// writes its own "<net>.<start>.<job>.nnmetrics" (see runPath), so runs of one
+// network are compared by listing them with runs and reading what is needed.
+class MetricsLog
+{
+private:
+	FILE* fd;
+	std::string path;
+
+	// owns a FILE*
+	MetricsLog(const MetricsLog&);
+	void operator=(const MetricsLog&);
+
+public:
+	static const uint32_t VERSION = 1;
+	static const unsigned int HEADER_BYTES = 16;
+
+	MetricsLog();
+	virtual ~MetricsLog();
+
+	bool open(const std::string&);
+	void close();
+	bool isOpen() const;
+	bool append(const MetricsRecord&);
+
+	static MetricsRecord emptyRecord();
+	static std::string runPath(const std::string&, const std::string&, int64_t, int64_t);
+	static std::vector<std::string> runs(const std::string&, const std::string&);
+	static int64_t count(const std::string&);
+	static int64_t read(const std::string&, int64_t, int64_t, std::vector<MetricsRecord>&);
+};
+
+#endif
@@ -0,0 +1,214 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "plateau.h"
+#include <stdlib.h>
+
+Plateau::Plateau()
+{
+	patience = 0;
+	minDelta = 0.0f;
+	factor = 0.5f;
+	maxReductions = 0;
+	cooldown = 0;
+	reset();
+}
+
+/*!
+ * @brief Plateau constructor
+ * @param newPatience updates without improvement before acting; 0 disables the detector
+ * @param newMinDelta the smallest drop in loss that counts as an improvement
+ * @param newFactor the learning rate multiplier handed out with REDUCE
+ * @param newMaxReductions how many REDUCE actions are allowed before STOP
+ * @param newCooldown updates to wait after a REDUCE before counting again
+ */
+Plateau::Plateau(int newPatience, float newMinDelta, float newFactor, int newMaxReductions,
+				 int newCooldown)
+{
+	patience = newPatience;
+	minDelta = newMinDelta;
+	factor = newFactor;
+	maxReductions = newMaxReductions;
+	cooldown = newCooldown;
+	reset();
+}
+
+void Plateau::reset()
+{
+	best = 0.0f;
+	hasBest = false;
+	updates = 0;
+	bestUpdate = 0;
+	stale = 0;
+	reductions = 0;
+	cooldownLeft = 0;
+}
+
+/*!
+ * @brief set the detector from a "PATIENCE[,MIN_DELTA[,REDUCTIONS]]" spec
+ * @details REDUCTIONS is how many times the learning rate is scaled by the factor before a
+ * further plateau stops the run
+ * @param spec the spec
+ * @return whether the spec named a patience of at least 1
+ */
+bool Plateau::parse(const std::string& spec)
+{
+	const char* cursor = spec.c_str();
+	char* end = NULL;
+	long newPatience = strtol(cursor, &end, 10);
+	if ((end == cursor) || (newPatience < 1))
+		return false;
+
+	float newMinDelta = 0.0f;
+	long newReductions = 0;
+	if (*end == ',')
+	{
+		cursor = end + 1;
+		newMinDelta = (float)strtod(cursor, &end);
+		if (*end == ',')
+			newReductions = strtol(end + 1, NULL, 10);
+	}
+
+	patience = (int)newPatience;
+	minDelta = (newMinDelta > 0.0f) ? newMinDelta : 0.0f;
+	maxReductions = (newReductions > 0) ? (int)newReductions : 0;
+	reset();
+	return true;
+}
+
+/*!
+ * @brief feed a loss value
+ * @details compares against the running best only; the caller is expected to apply the
+ * returned action (scale the learning rate by getFactor() or stop training)
+ * @param loss the newest loss value
+ * @return NONE, REDUCE or STOP
+ */
+int Plateau::update(float loss)
+{
+	++updates;
+
+	if ((!hasBest) || (loss < best - minDelta))
+	{
+		best = loss;
+		hasBest = true;
+		bestUpdate = updates;
+		stale = 0;
+		return NONE;
+	}
+
+	if (patience <= 0)
+		return NONE;
+
+	if (cooldownLeft > 0)
+	{
+		--cooldownLeft;
+		return NONE;
+	}
+
+	++stale;
+	if (stale < patience)
+		return NONE;
+
+	stale = 0;
+	if (reductions < maxReductions)
+	{
+		++reductions;
+		cooldownLeft = cooldown;
+		return REDUCE;
+	}
+
+	return STOP;
+}
+
+bool Plateau::isActive() const
+{
+	return patience > 0;
+}
+
+int Plateau::getPatience() const
+{
+	return patience;
+}
+
+float Plateau::getMinDelta() const
+{
+	return minDelta;
+}
+
+float Plateau::getFactor() const
+{
+	return factor;
+}
+
+float Plateau::getBest() const
+{
+	return best;
+}
+
+int64_t Plateau::getBestUpdate() const
+{
+	return bestUpdate;
+}
+
+int64_t Plateau::getUpdates() const
+{
+	return updates;
+}
+
+int Plateau::getStale() const
+{
+	return stale;
+}
+
+int Plateau::getReductions() const
+{
+	return reductions;
+}
+
+void Plateau::setPatience(int newPatience)
+{
+	patience = newPatience;
+}
+
+void Plateau::setMinDelta(float newMinDelta)
+{
+	minDelta = newMinDelta;
+}
+
+void Plateau::setFactor(float newFactor)
+{
+	factor = newFactor;
+}
+
+void Plateau::setMaxReductions(int newMaxReductions)
+{
+	maxReductions = newMaxReductions;
+}
+
+void Plateau::setCooldown(int newCooldown)
+{
+	cooldown = newCooldown;
+}
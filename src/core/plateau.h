@@ -0,0 +1,85 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _PLATEAU
+#define _PLATEAU
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+// Patience based plateau detection over a stream of loss values.
+// Keeps only the running best and a counter, so each update is O(1) no
+// matter how long the learning curve gets.
+class Plateau
+{
+private:
+	int patience;
+	float minDelta;
+	float factor;
+	int maxReductions;
+	int cooldown;
+
+	float best;
+	bool hasBest;
+	int64_t updates;
+	int64_t bestUpdate;
+	int stale;
+	int reductions;
+	int cooldownLeft;
+
+public:
+	static const int NONE = 0;
+	static const int REDUCE = 1;
+	static const int STOP = 2;
+
+	Plateau();
+	Plateau(int, float, float = 0.5f, int = 0, int = 0);
+
+	void reset();
+	bool parse(const std::string&);
+	int update(float);
+	bool isActive() const;
+
+	// gets
+	int getPatience() const;
+	float getMinDelta() const;
+	float getFactor() const;
+	float getBest() const;
+	int64_t getBestUpdate() const;
+	int64_t getUpdates() const;
+	int getStale() const;
+	int getReductions() const;
+
+	// sets
+	void setPatience(int);
+	void setMinDelta(float);
+	void setFactor(float);
+	void setMaxReductions(int);
+	void setCooldown(int);
+};
+
+#endif
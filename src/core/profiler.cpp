@@ -0,0 +1,259 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "profiler.h"
+#include "stopwatch.h"
+#include <stdio.h>
+#include <string.h>
+
+pthread_mutex_t Profiler::registryMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_key_t Profiler::threadKey;
+pthread_once_t Profiler::threadOnce = PTHREAD_ONCE_INIT;
+std::vector<Profiler::ThreadData*> Profiler::threads;
+const char* Profiler::slotNames[Profiler::MAX_SLOTS];
+int Profiler::slotCount = 0;
+
+// owner-thread writes and cross-thread reads of the counters
+static inline void relaxedAdd(uint64_t* dest, uint64_t value)
+{
+	__atomic_store_n(dest, __atomic_load_n(dest, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t relaxedLoad(const uint64_t* src)
+{
+	return __atomic_load_n(src, __ATOMIC_RELAXED);
+}
+
+static unsigned int bucketOf(uint64_t ns)
+{
+	unsigned int bucket = 0;
+	while ((ns > 1) && (bucket < 31))
+	{
+		ns >>= 1;
+		++bucket;
+	}
+	return bucket;
+}
+
+bool Profiler::enabled()
+{
+#ifdef NNC_PROFILE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void Profiler::makeKey()
+{
+	// thread data outlives its thread so a dump still sees finished workers
+	pthread_key_create(&threadKey, NULL);
+}
+
+Profiler::ThreadData* Profiler::local()
+{
+	pthread_once(&threadOnce, makeKey);
+	ThreadData* cThread = (ThreadData*)pthread_getspecific(threadKey);
+	if (cThread)
+		return cThread;
+
+	cThread = new ThreadData();
+	memset(cThread->counts, 0, sizeof(cThread->counts));
+	memset(cThread->totalNs, 0, sizeof(cThread->totalNs));
+	memset(cThread->maxNs, 0, sizeof(cThread->maxNs));
+	memset(cThread->histogram, 0, sizeof(cThread->histogram));
+	cThread->events.resize(TRACE_EVENTS);
+	cThread->nextEvent = 0;
+
+	pthread_mutex_lock(&registryMutex);
+	cThread->tid = threads.size() + 1;
+	threads.push_back(cThread);
+	pthread_mutex_unlock(&registryMutex);
+
+	pthread_setspecific(threadKey, cThread);
+	return cThread;
+}
+
+/*!
+ * @brief get the slot of a scope name
+ * @details called once per call site through the macros
+ * @param name a string literal
+ * @return the slot, or -1 once every slot is taken
+ */
+int Profiler::slot(const char* name)
+{
+	pthread_mutex_lock(&registryMutex);
+	int found = -1;
+	for (int i = 0; i < slotCount; ++i)
+	{
+		if (strcmp(slotNames[i], name) == 0)
+			found = i;
+	}
+
+	if ((found < 0) && (slotCount < MAX_SLOTS))
+	{
+		slotNames[slotCount] = name;
+		found = slotCount++;
+	}
+	pthread_mutex_unlock(&registryMutex);
+
+	return found;
+}
+
+/*!
+ * @brief record one timed call
+ * @param cSlot the slot
+ * @param startNs when the call started, from Stopwatch::nowNs
+ * @param durationNs how long it took
+ */
+void Profiler::record(int cSlot, int64_t startNs, int64_t durationNs)
+{
+	if (cSlot < 0)
+		return;
+
+	ThreadData* cThread = local();
+	uint64_t duration = (durationNs > 0) ? durationNs : 0;
+	relaxedAdd(&cThread->counts[cSlot], 1);
+	relaxedAdd(&cThread->totalNs[cSlot], duration);
+	relaxedAdd(&cThread->histogram[cSlot][bucketOf(duration)], 1);
+	if (duration > relaxedLoad(&cThread->maxNs[cSlot]))
+		__atomic_store_n(&cThread->maxNs[cSlot], duration, __ATOMIC_RELAXED);
+
+	Event& cEvent = cThread->events[cThread->nextEvent];
+	cEvent.slot = cSlot;
+	cEvent.startNs = startNs;
+	cEvent.durationNs = durationNs;
+	cThread->nextEvent = (cThread->nextEvent + 1) % TRACE_EVENTS;
+}
+
+/*!
+ * @brief add to a counter
+ * @param cSlot the slot
+ * @param value the amount
+ */
+void Profiler::count(int cSlot, uint64_t value)
+{
+	if (cSlot < 0)
+		return;
+
+	relaxedAdd(&local()->counts[cSlot], value);
+}
+
+/*!
+ * @brief merge every thread's totals
+ * @return one entry per used slot
+ */
+std::vector<ProfileStat> Profiler::snapshot()
+{
+	std::vector<ProfileStat> stats;
+
+	pthread_mutex_lock(&registryMutex);
+	for (int i = 0; i < slotCount; ++i)
+	{
+		ProfileStat cStat;
+		memset(&cStat, 0, sizeof(cStat));
+		cStat.name = slotNames[i];
+		for (unsigned int t = 0; t < threads.size(); ++t)
+		{
+			const ThreadData* cThread = threads[t];
+			cStat.count += relaxedLoad(&cThread->counts[i]);
+			cStat.totalNs += relaxedLoad(&cThread->totalNs[i]);
+			uint64_t threadMax = relaxedLoad(&cThread->maxNs[i]);
+			if (threadMax > cStat.maxNs)
+				cStat.maxNs = threadMax;
+			for (unsigned int b = 0; b < 32; ++b)
+				cStat.histogram[b] += relaxedLoad(&cThread->histogram[i][b]);
+		}
+		stats.push_back(cStat);
+	}
+	pthread_mutex_unlock(&registryMutex);
+
+	return stats;
+}
+
+/*!
+ * @brief write the profile as a Chrome trace
+ * @details the recent events of each thread go in traceEvents and the merged totals in a
+ * summary object that the trace viewer ignores; event reads race with threads still recording,
+ * so dump once the profiled work has stopped for an exact trace
+ * @param fname the output path
+ * @return whether the file was written
+ */
+bool Profiler::dump(const std::string& fname)
+{
+	FILE* fd = fopen(fname.c_str(), "w");
+	if (!fd)
+		return false;
+
+	fprintf(fd, "{\"traceEvents\": [\n");
+	bool first = true;
+	pthread_mutex_lock(&registryMutex);
+	for (unsigned int t = 0; t < threads.size(); ++t)
+	{
+		const ThreadData* cThread = threads[t];
+		for (unsigned int i = 0; i < TRACE_EVENTS; ++i)
+		{
+			const Event& cEvent = cThread->events[i];
+			if ((cEvent.durationNs <= 0) || (cEvent.slot < 0) || (cEvent.slot >= slotCount))
+				continue;
+
+			fprintf(fd, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %llu, ",
+					(first) ? "" : ",\n", slotNames[cEvent.slot], (unsigned long long)cThread->tid);
+			fprintf(fd, "\"ts\": %.3f, \"dur\": %.3f}", cEvent.startNs / 1e3,
+					cEvent.durationNs / 1e3);
+			first = false;
+		}
+	}
+	pthread_mutex_unlock(&registryMutex);
+	fprintf(fd, "\n],\n\"summary\": [\n");
+
+	std::vector<ProfileStat> stats = snapshot();
+	for (unsigned int i = 0; i < stats.size(); ++i)
+	{
+		const ProfileStat& cStat = stats[i];
+		fprintf(fd, "{\"name\": \"%s\", \"count\": %llu, \"total_ms\": %.3f, \"max_ms\": %.3f, ",
+				cStat.name, (unsigned long long)cStat.count, cStat.totalNs / 1e6,
+				cStat.maxNs / 1e6);
+		fprintf(fd, "\"log2_ns_histogram\": [");
+		for (unsigned int b = 0; b < 32; ++b)
+			fprintf(fd, "%s%llu", (b == 0) ? "" : ",", (unsigned long long)cStat.histogram[b]);
+		fprintf(fd, "]}%s\n", (i + 1 < stats.size()) ? "," : "");
+	}
+	fprintf(fd, "]}\n");
+
+	return fclose(fd) == 0;
+}
+
+ProfileScope::ProfileScope(int newSlot)
+{
+	slot = newSlot;
+	startNs = Stopwatch::nowNs();
+}
+
+ProfileScope::~ProfileScope()
+{
+	Profiler::record(slot, startNs, Stopwatch::nowNs() - startNs);
+}
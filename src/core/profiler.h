@@ -0,0 +1,123 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _PROFILER
+#define _PROFILER
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Aggregated totals of one profiled scope across every thread
+struct ProfileStat
+{
+	const char* name;
+	uint64_t count;
+	uint64_t totalNs;
+	uint64_t maxNs;
+	// calls per power of two of nanoseconds
+	uint64_t histogram[32];
+};
+
+// Scoped timers and counters for the hot paths. Each thread writes only its
+// own slots, so recording takes no lock; snapshot() and dump() merge the
+// threads. Everything compiles away unless the build sets NNC_PROFILE.
+class Profiler
+{
+private:
+	struct Event
+	{
+		int slot;
+		int64_t startNs;
+		int64_t durationNs;
+	};
+
+	struct ThreadData
+	{
+		uint64_t tid;
+		uint64_t counts[64];
+		uint64_t totalNs[64];
+		uint64_t maxNs[64];
+		uint64_t histogram[64][32];
+		std::vector<Event> events;
+		unsigned int nextEvent;
+	};
+
+	static pthread_mutex_t registryMutex;
+	static pthread_key_t threadKey;
+	static pthread_once_t threadOnce;
+	static std::vector<ThreadData*> threads;
+	static const char* slotNames[64];
+	static int slotCount;
+
+	static void makeKey();
+	static ThreadData* local();
+
+public:
+	static const int MAX_SLOTS = 64;
+	// trace events kept per thread, newest win
+	static const unsigned int TRACE_EVENTS = 16384;
+
+	static int slot(const char*);
+	static void record(int, int64_t, int64_t);
+	static void count(int, uint64_t);
+
+	static std::vector<ProfileStat> snapshot();
+	static bool dump(const std::string&);
+	static bool enabled();
+};
+
+// Times the enclosing scope under a slot
+class ProfileScope
+{
+private:
+	int slot;
+	int64_t startNs;
+
+public:
+	ProfileScope(int);
+	~ProfileScope();
+};
+
+#ifdef NNC_PROFILE
+#define NNC_PROFILE_CAT2(a, b) a##b
+#define NNC_PROFILE_CAT(a, b) NNC_PROFILE_CAT2(a, b)
+#define NNC_PROFILE_SCOPE(name)                                                                    \
+	static const int NNC_PROFILE_CAT(profileSlot, __LINE__) = Profiler::slot(name);               \
+	ProfileScope NNC_PROFILE_CAT(profileScope, __LINE__)(NNC_PROFILE_CAT(profileSlot, __LINE__))
+#define NNC_PROFILE_COUNT(name, n)                                                                 \
+	do                                                                                             \
+	{                                                                                              \
+		static const int profileSlot = Profiler::slot(name);                                       \
+		Profiler::count(profileSlot, (n));                                                         \
+	} while (0)
+#else
+#define NNC_PROFILE_SCOPE(name)
+#define NNC_PROFILE_COUNT(name, n)
+#endif
+
+#endif
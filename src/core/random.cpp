@@ -0,0 +1,246 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "random.h"
+
+uint64_t Random::seedValue = 0;
+bool Random::deterministic = false;
+Random* Random::master = NULL;
+pthread_mutex_t Random::masterMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_key_t Random::localKey;
+pthread_once_t Random::localOnce = PTHREAD_ONCE_INIT;
+
+Random::Random()
+{
+	seed(0);
+}
+
+Random::Random(uint64_t newSeed)
+{
+	seed(newSeed);
+}
+
+uint64_t Random::rotl(uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+uint64_t Random::splitmix64(uint64_t& x)
+{
+	uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/*!
+ * @brief seed the generator
+ * @details expands a single 64 bit seed into the 256 bit state with splitmix64, as recommended
+ * by the xoshiro authors, so that similar seeds still give unrelated sequences
+ * @param newSeed the seed
+ */
+void Random::seed(uint64_t newSeed)
+{
+	uint64_t x = newSeed;
+	for (unsigned int i = 0; i < 4; ++i)
+		state[i] = splitmix64(x);
+}
+
+uint64_t Random::next()
+{
+	const uint64_t result = rotl(state[1] * 5, 7) * 9;
+	const uint64_t t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+
+	state[2] ^= t;
+	state[3] = rotl(state[3], 45);
+
+	return result;
+}
+
+/*!
+ * @brief jump ahead
+ * @details equivalent to 2^128 calls to next(); used to hand out non-overlapping streams
+ */
+void Random::jump()
+{
+	static const uint64_t JUMP[] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+									0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+
+	uint64_t s0 = 0;
+	uint64_t s1 = 0;
+	uint64_t s2 = 0;
+	uint64_t s3 = 0;
+	for (unsigned int i = 0; i < sizeof(JUMP) / sizeof(*JUMP); ++i)
+	{
+		for (int b = 0; b < 64; ++b)
+		{
+			if (JUMP[i] & (1ULL << b))
+			{
+				s0 ^= state[0];
+				s1 ^= state[1];
+				s2 ^= state[2];
+				s3 ^= state[3];
+			}
+			next();
+		}
+	}
+
+	state[0] = s0;
+	state[1] = s1;
+	state[2] = s2;
+	state[3] = s3;
+}
+
+/*!
+ * @brief bounded integer
+ * @details Lemire's multiply-shift reduction; avoids the modulo bias of rand() % n
+ * @param n the exclusive upper bound
+ * @return a value in [0, n)
+ */
+unsigned int Random::nextUInt(unsigned int n)
+{
+	if (n == 0)
+		return 0;
+
+	return (unsigned int)(((next() >> 32) * (uint64_t)n) >> 32);
+}
+
+float Random::nextFloat()
+{
+	// top 24 bits fill the float mantissa exactly
+	return (next() >> 40) * (1.0f / 16777216.0f);
+}
+
+double Random::nextDouble()
+{
+	return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*!
+ * @brief set the process seed
+ * @details reseeds the master stream; threads that already own a stream keep it, so call this
+ * before any worker threads are started
+ * @param newSeed the seed
+ */
+void Random::setSeed(uint64_t newSeed)
+{
+	pthread_mutex_lock(&masterMutex);
+
+	seedValue = newSeed;
+	if (!master)
+		master = new Random(newSeed);
+	else
+		master->seed(newSeed);
+
+	pthread_mutex_unlock(&masterMutex);
+}
+
+uint64_t Random::getSeed()
+{
+	return seedValue;
+}
+
+/*!
+ * @brief make runs with the same seed repeat exactly
+ * @details the streams of streamSeed() then depend only on the seed and their key, not on which
+ * thread asked first, and the parallel services run their work items one at a time; set it
+ * before any worker threads are started
+ * @param newDeterministic whether to enable it
+ */
+void Random::setDeterministic(bool newDeterministic)
+{
+	deterministic = newDeterministic;
+}
+
+bool Random::isDeterministic()
+{
+	return deterministic;
+}
+
+/*!
+ * @brief seed for a named generator such as a shuffle
+ * @param key names what the generator is for
+ * @return a seed derived from the process seed and key in deterministic mode, otherwise the next
+ * number of the calling thread's stream
+ */
+uint64_t Random::streamSeed(const char* key)
+{
+	if (!deterministic)
+		return local()->next();
+
+	// FNV-1a of the key, folded into the seed
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (const char* c = key; *c; ++c)
+		hash = (hash ^ (unsigned char)*c) * 0x100000001B3ULL;
+
+	uint64_t x = seedValue ^ hash;
+	return splitmix64(x);
+}
+
+void Random::makeKey()
+{
+	pthread_key_create(&localKey, freeLocal);
+}
+
+void Random::freeLocal(void* y)
+{
+	Random* cRandom = (Random*)y;
+	if (cRandom)
+		delete cRandom;
+}
+
+/*!
+ * @brief thread local stream
+ * @details the first call on a thread copies the master state and advances the master by one
+ * jump, so no locking is needed after that
+ * @return the calling thread's generator
+ */
+Random* Random::local()
+{
+	pthread_once(&localOnce, makeKey);
+
+	Random* cRandom = (Random*)pthread_getspecific(localKey);
+	if (cRandom)
+		return cRandom;
+
+	pthread_mutex_lock(&masterMutex);
+
+	if (!master)
+		master = new Random(seedValue);
+
+	cRandom = new Random(*master);
+	master->jump();
+
+	pthread_mutex_unlock(&masterMutex);
+
+	pthread_setspecific(localKey, cRandom);
+	return cRandom;
+}
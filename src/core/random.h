@@ -0,0 +1,79 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _RANDOM
+#define _RANDOM
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// xoshiro256** generator with one independent stream per thread.
+// Streams are carved out of a single seeded master with jump(), so each
+// thread gets 2^128 numbers before it could overlap another one.
+class Random
+{
+private:
+	uint64_t state[4];
+
+	static uint64_t seedValue;
+	static bool deterministic;
+	static Random* master;
+	static pthread_mutex_t masterMutex;
+	static pthread_key_t localKey;
+	static pthread_once_t localOnce;
+
+	static uint64_t rotl(uint64_t, int);
+	static uint64_t splitmix64(uint64_t&);
+	static void makeKey();
+	static void freeLocal(void*);
+
+public:
+	Random();
+	Random(uint64_t);
+
+	void seed(uint64_t);
+	void jump();
+
+	// gets
+	uint64_t next();
+	unsigned int nextUInt(unsigned int);
+	float nextFloat();
+	double nextDouble();
+
+	// process-wide streams
+	static void setSeed(uint64_t);
+	static uint64_t getSeed();
+	static Random* local();
+
+	// reproducible runs
+	static void setDeterministic(bool);
+	static bool isDeterministic();
+	static uint64_t streamSeed(const char*);
+};
+
+#endif
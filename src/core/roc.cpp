@@ -0,0 +1,292 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "roc.h"
+#include <algorithm>
+#include <float.h>
+
+// Sorts descending by score
+struct ScoreGreater
+{
+	const float* scores;
+
+	bool operator()(unsigned int a, unsigned int b) const
+	{
+		return scores[a] > scores[b];
+	}
+};
+
+ROC::ROC()
+{
+	clear();
+}
+
+void ROC::clear()
+{
+	falseAlarm.clear();
+	recall.clear();
+	thresholds.clear();
+	positives = 0;
+	negatives = 0;
+	auc = 0.0f;
+}
+
+void ROC::addPoint(int64_t tp, int64_t fp, float threshold)
+{
+	falseAlarm.push_back((negatives > 0) ? (float)fp / (float)negatives : 0.0f);
+	recall.push_back((positives > 0) ? (float)tp / (float)positives : 0.0f);
+	thresholds.push_back(threshold);
+}
+
+// Trapezoid area under the finished curve
+void ROC::finish()
+{
+	double area = 0.0;
+	for (unsigned int i = 1; i < falseAlarm.size(); ++i)
+		area += (falseAlarm[i] - falseAlarm[i - 1]) * (recall[i] + recall[i - 1]) * 0.5;
+	auc = (float)area;
+}
+
+/*!
+ * @brief exact ROC curve
+ * @details sorts the sample indices by score once, O(n log n), then sweeps the thresholds
+ * from high to low; tied scores become a single point so the AUC counts ties as half
+ * @param scores the classifier score of each sample, higher meaning more positive
+ * @param labels nonzero for the positive samples
+ * @param n the number of samples
+ * @return whether both classes were present
+ */
+bool ROC::build(const float* scores, const int* labels, unsigned int n)
+{
+	clear();
+	if ((!scores) || (!labels) || (n == 0))
+		return false;
+
+	std::vector<unsigned int> order(n);
+	for (unsigned int i = 0; i < n; ++i)
+	{
+		order[i] = i;
+		if (labels[i])
+			++positives;
+	}
+	negatives = n - positives;
+
+	ScoreGreater cmp;
+	cmp.scores = scores;
+	std::sort(order.begin(), order.end(), cmp);
+
+	int64_t tp = 0;
+	int64_t fp = 0;
+	addPoint(0, 0, FLT_MAX);
+	for (unsigned int i = 0; i < n; ++i)
+	{
+		if (labels[order[i]])
+			++tp;
+		else
+			++fp;
+
+		if ((i + 1 == n) || (scores[order[i + 1]] != scores[order[i]]))
+			addPoint(tp, fp, scores[order[i]]);
+	}
+
+	finish();
+	return (positives > 0) && (negatives > 0);
+}
+
+/*!
+ * @brief binned ROC curve
+ * @details one O(n) pass into score bins and a sweep over the bins, for per epoch curves on
+ * large sets where an approximate AUC is enough; scores outside [minScore, maxScore] go into
+ * the end bins
+ * @param scores the classifier score of each sample
+ * @param labels nonzero for the positive samples
+ * @param n the number of samples
+ * @param bins the number of thresholds
+ * @param minScore the lowest expected score
+ * @param maxScore the highest expected score
+ * @return whether both classes were present
+ */
+bool ROC::buildHistogram(const float* scores, const int* labels, unsigned int n,
+						 unsigned int bins, float minScore, float maxScore)
+{
+	clear();
+	if ((!scores) || (!labels) || (n == 0) || (bins == 0) || (maxScore <= minScore))
+		return false;
+
+	std::vector<int64_t> posBins(bins, 0);
+	std::vector<int64_t> negBins(bins, 0);
+	float binScale = bins / (maxScore - minScore);
+	for (unsigned int i = 0; i < n; ++i)
+	{
+		float pos = (scores[i] - minScore) * binScale;
+		unsigned int bin = 0;
+		if (pos >= bins)
+			bin = bins - 1;
+		else if (pos > 0.0f)
+			bin = (unsigned int)pos;
+
+		if (labels[i])
+		{
+			++posBins[bin];
+			++positives;
+		}
+		else
+			++negBins[bin];
+	}
+	negatives = n - positives;
+
+	int64_t tp = 0;
+	int64_t fp = 0;
+	addPoint(0, 0, FLT_MAX);
+	for (unsigned int b = bins; b > 0; --b)
+	{
+		if ((posBins[b - 1] == 0) && (negBins[b - 1] == 0))
+			continue;
+
+		tp += posBins[b - 1];
+		fp += negBins[b - 1];
+		addPoint(tp, fp, minScore + (b - 1) / binScale);
+	}
+
+	finish();
+	return (positives > 0) && (negatives > 0);
+}
+
+/*!
+ * @brief ROC curve from network outputs and one-hot targets
+ * @details a single output is scored as is; of two, the second is the positive class; with more,
+ * every (sample, class) pair is one score, the micro-averaged one vs rest curve
+ * @param outputs the network outputs, width per sample
+ * @param expected the targets in the same layout, above 0.5 for the positive class
+ * @param n the number of samples
+ * @param width the outputs per sample
+ * @return whether both classes were present
+ */
+bool ROC::buildOneVsRest(const float* outputs, const float* expected, unsigned int n,
+						 unsigned int width)
+{
+	clear();
+	if ((!outputs) || (!expected) || (n == 0) || (width == 0))
+		return false;
+
+	std::vector<float> scores;
+	std::vector<int> labels;
+	if (width <= 2)
+	{
+		unsigned int column = width - 1;
+		scores.resize(n);
+		labels.resize(n);
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			scores[i] = outputs[(size_t)i * width + column];
+			labels[i] = (expected[(size_t)i * width + column] > 0.5f) ? 1 : 0;
+		}
+	}
+	else
+	{
+		size_t pairs = (size_t)n * width;
+		scores.assign(outputs, outputs + pairs);
+		labels.resize(pairs);
+		for (size_t i = 0; i < pairs; ++i)
+			labels[i] = (expected[i] > 0.5f) ? 1 : 0;
+	}
+
+	return build(&scores[0], &labels[0], scores.size());
+}
+
+/*!
+ * @brief thin the curve for plotting
+ * @details keeps the end points and evenly spaced points between them
+ * @param maxPoints the most points to return, at least 2
+ * @param x the false alarm rates out
+ * @param y the recall rates out
+ */
+void ROC::downsample(unsigned int maxPoints, std::vector<float>& x, std::vector<float>& y) const
+{
+	x.clear();
+	y.clear();
+	if (falseAlarm.empty())
+		return;
+
+	if ((maxPoints < 2) || (falseAlarm.size() <= maxPoints))
+	{
+		x = falseAlarm;
+		y = recall;
+		return;
+	}
+
+	unsigned int last = falseAlarm.size() - 1;
+	for (unsigned int i = 0; i < maxPoints; ++i)
+	{
+		unsigned int index = (unsigned int)(((uint64_t)i * last) / (maxPoints - 1));
+		x.push_back(falseAlarm[index]);
+		y.push_back(recall[index]);
+	}
+}
+
+unsigned int ROC::size() const
+{
+	return falseAlarm.size();
+}
+
+float ROC::getFalseAlarm(unsigned int index) const
+{
+	if (index >= falseAlarm.size())
+		return 0.0f;
+
+	return falseAlarm[index];
+}
+
+float ROC::getRecall(unsigned int index) const
+{
+	if (index >= recall.size())
+		return 0.0f;
+
+	return recall[index];
+}
+
+float ROC::getThreshold(unsigned int index) const
+{
+	if (index >= thresholds.size())
+		return 0.0f;
+
+	return thresholds[index];
+}
+
+int64_t ROC::getPositives() const
+{
+	return positives;
+}
+
+int64_t ROC::getNegatives() const
+{
+	return negatives;
+}
+
+float ROC::getAUC() const
+{
+	return auc;
+}
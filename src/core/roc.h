@@ -0,0 +1,69 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _ROC
+#define _ROC
+
+#include <stdint.h>
+#include <vector>
+
+// Full ROC curve and AUC from per sample scores of a binary (or one vs rest)
+// classifier. The curve is stored as contiguous false alarm / recall arrays,
+// one point per distinct threshold, and can be thinned out for plotting.
+class ROC
+{
+private:
+	std::vector<float> falseAlarm;
+	std::vector<float> recall;
+	std::vector<float> thresholds;
+	int64_t positives;
+	int64_t negatives;
+	float auc;
+
+	void addPoint(int64_t, int64_t, float);
+	void finish();
+
+public:
+	ROC();
+
+	void clear();
+	bool build(const float*, const int*, unsigned int);
+	bool buildHistogram(const float*, const int*, unsigned int, unsigned int, float = 0.0f,
+						float = 1.0f);
+	bool buildOneVsRest(const float*, const float*, unsigned int, unsigned int);
+	void downsample(unsigned int, std::vector<float>&, std::vector<float>&) const;
+
+	// gets
+	unsigned int size() const;
+	float getFalseAlarm(unsigned int) const;
+	float getRecall(unsigned int) const;
+	float getThreshold(unsigned int) const;
+	int64_t getPositives() const;
+	int64_t getNegatives() const;
+	float getAUC() const;
+};
+
+#endif
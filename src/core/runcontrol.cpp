@@ -0,0 +1,133 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "runcontrol.h"
+
+RunControl::RunControl()
+{
+	pthread_mutex_init(&controlMutex, NULL);
+	pthread_cond_init(&resumeCond, NULL);
+	cancelled = false;
+	paused = false;
+	pauseSeen = false;
+}
+
+RunControl::~RunControl()
+{
+	pthread_cond_destroy(&resumeCond);
+	pthread_mutex_destroy(&controlMutex);
+}
+
+/*!
+ * @brief clear the state for a new run
+ */
+void RunControl::reset()
+{
+	pthread_mutex_lock(&controlMutex);
+	cancelled = false;
+	paused = false;
+	pauseSeen = false;
+	pthread_mutex_unlock(&controlMutex);
+}
+
+/*!
+ * @brief end the run
+ * @details also releases a paused run so it can clean up
+ */
+void RunControl::cancel()
+{
+	pthread_mutex_lock(&controlMutex);
+	cancelled = true;
+	pthread_cond_broadcast(&resumeCond);
+	pthread_mutex_unlock(&controlMutex);
+}
+
+/*!
+ * @brief park the run at its next check
+ */
+void RunControl::pause()
+{
+	pthread_mutex_lock(&controlMutex);
+	paused = true;
+	pauseSeen = true;
+	pthread_mutex_unlock(&controlMutex);
+}
+
+/*!
+ * @brief let a paused run continue
+ */
+void RunControl::resume()
+{
+	pthread_mutex_lock(&controlMutex);
+	paused = false;
+	pthread_cond_broadcast(&resumeCond);
+	pthread_mutex_unlock(&controlMutex);
+}
+
+bool RunControl::isCancelled() const
+{
+	pthread_mutex_lock(const_cast<pthread_mutex_t*>(&controlMutex));
+	bool value = cancelled;
+	pthread_mutex_unlock(const_cast<pthread_mutex_t*>(&controlMutex));
+	return value;
+}
+
+bool RunControl::isPaused() const
+{
+	pthread_mutex_lock(const_cast<pthread_mutex_t*>(&controlMutex));
+	bool value = paused;
+	pthread_mutex_unlock(const_cast<pthread_mutex_t*>(&controlMutex));
+	return value;
+}
+
+/*!
+ * @brief whether a pause was asked for since the last call
+ * @details true even when the run was resumed again before it looked, so a step cut short by
+ * a pause is not mistaken for the end of the run
+ * @return whether a pause was asked for
+ */
+bool RunControl::takePause()
+{
+	pthread_mutex_lock(&controlMutex);
+	bool value = pauseSeen;
+	pauseSeen = false;
+	pthread_mutex_unlock(&controlMutex);
+	return value;
+}
+
+/*!
+ * @brief block while the run is paused
+ * @return false when the run was cancelled
+ */
+bool RunControl::waitWhilePaused()
+{
+	pthread_mutex_lock(&controlMutex);
+	while ((paused) && (!cancelled))
+		pthread_cond_wait(&resumeCond, &controlMutex);
+	bool running = !cancelled;
+	pthread_mutex_unlock(&controlMutex);
+	return running;
+}
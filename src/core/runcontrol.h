@@ -0,0 +1,64 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _RUNCONTROL
+#define _RUNCONTROL
+
+#include <pthread.h>
+
+// Cooperative cancel and pause for one training run. The trainer checks it
+// between the steps it hands to the network and parks in waitWhilePaused()
+// with its network, data and reserved cores intact; any thread may cancel,
+// pause or resume it.
+class RunControl
+{
+private:
+	pthread_mutex_t controlMutex;
+	pthread_cond_t resumeCond;
+	bool cancelled;
+	bool paused;
+	bool pauseSeen;
+
+	// waited on by other threads
+	RunControl(const RunControl&);
+	void operator=(const RunControl&);
+
+public:
+	RunControl();
+	~RunControl();
+
+	void reset();
+	void cancel();
+	void pause();
+	void resume();
+
+	bool isCancelled() const;
+	bool isPaused() const;
+	bool takePause();
+	bool waitWhilePaused();
+};
+
+#endif
@@ -0,0 +1,282 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "scheduler.h"
+#include "threadpool.h"
+#include <stdio.h>
+
+pthread_mutex_t Scheduler::jobMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t Scheduler::jobCond = PTHREAD_COND_INITIALIZER;
+std::vector<Scheduler::Job*> Scheduler::jobs;
+int64_t Scheduler::nextID = 1;
+unsigned int Scheduler::capacity = 0;
+unsigned int Scheduler::busy = 0;
+
+/*!
+ * @brief queue a job
+ * @param name shown in status reports
+ * @param priority higher runs first
+ * @param threads the cores the job will use, at least 1
+ * @param cancelFn called once to stop the job if it is cancelled while running; it runs under the
+ * scheduler lock and must not call back into the Scheduler
+ * @param cancelArg its argument
+ * @return the job id for waitTurn, finish and cancel
+ */
+int64_t Scheduler::submit(const std::string& name, int priority, unsigned int threads,
+						  void (*cancelFn)(void*), void* cancelArg)
+{
+	Job* cJob = new Job();
+	cJob->info.name = name;
+	cJob->info.priority = priority;
+	cJob->info.threads = (threads > 0) ? threads : 1;
+	cJob->info.state = STATE_QUEUED;
+	cJob->info.submitted = time(NULL);
+	cJob->info.started = 0;
+	cJob->info.finished = 0;
+	cJob->cancelFn = cancelFn;
+	cJob->cancelArg = cancelArg;
+	cJob->cancelled = false;
+
+	pthread_mutex_lock(&jobMutex);
+	cJob->info.id = nextID++;
+	jobs.push_back(cJob);
+	dispatch();
+	pthread_mutex_unlock(&jobMutex);
+
+	printf("[JOB] Queued %lld \"%s\" (priority %d, %u threads)\n", (long long)cJob->info.id,
+		   name.c_str(), priority, cJob->info.threads);
+	return cJob->info.id;
+}
+
+/*!
+ * @brief block until the job may run
+ * @param id the job id
+ * @return whether the job should run; false if it was cancelled while queued
+ */
+bool Scheduler::waitTurn(int64_t id)
+{
+	pthread_mutex_lock(&jobMutex);
+	Job* cJob = find(id);
+	while ((cJob) && (cJob->info.state == STATE_QUEUED))
+	{
+		pthread_cond_wait(&jobCond, &jobMutex);
+		cJob = find(id);
+	}
+	bool run = ((cJob) && (cJob->info.state == STATE_RUNNING));
+	pthread_mutex_unlock(&jobMutex);
+
+	return run;
+}
+
+/*!
+ * @brief mark a running job as finished and free its cores
+ * @param id the job id
+ */
+void Scheduler::finish(int64_t id)
+{
+	pthread_mutex_lock(&jobMutex);
+	Job* cJob = find(id);
+	if ((cJob) && (cJob->info.state == STATE_RUNNING))
+	{
+		busy -= cJob->info.threads;
+		cJob->info.state = (cJob->cancelled) ? STATE_CANCELLED : STATE_DONE;
+		cJob->info.finished = time(NULL);
+		dispatch();
+		trimHistory();
+	}
+	pthread_mutex_unlock(&jobMutex);
+}
+
+/*!
+ * @brief cancel a job
+ * @details a queued job is dropped from the queue; a running job has its cancel function called
+ * and keeps its cores until it calls finish
+ * @param id the job id
+ * @return whether the job was queued or running
+ */
+bool Scheduler::cancel(int64_t id)
+{
+	pthread_mutex_lock(&jobMutex);
+	Job* cJob = find(id);
+	bool found = ((cJob) && (!cJob->cancelled) &&
+				  ((cJob->info.state == STATE_QUEUED) || (cJob->info.state == STATE_RUNNING)));
+	if (found)
+	{
+		cJob->cancelled = true;
+		if (cJob->info.state == STATE_QUEUED)
+		{
+			cJob->info.state = STATE_CANCELLED;
+			cJob->info.finished = time(NULL);
+
+			// wake its waitTurn
+			pthread_cond_broadcast(&jobCond);
+			dispatch();
+			trimHistory();
+		}
+		else if (cJob->cancelFn)
+		{
+			// under the lock so the job cannot finish and go away mid call
+			(*cJob->cancelFn)(cJob->cancelArg);
+		}
+	}
+	pthread_mutex_unlock(&jobMutex);
+
+	if (found)
+		printf("[JOB] Cancelled %lld\n", (long long)id);
+
+	return found;
+}
+
+/*!
+ * @brief snapshot every queued, running and recently finished job
+ * @return the jobs in submission order
+ */
+std::vector<JobInfo> Scheduler::list()
+{
+	std::vector<JobInfo> infos;
+
+	pthread_mutex_lock(&jobMutex);
+	for (unsigned int i = 0; i < jobs.size(); ++i)
+		infos.push_back(jobs[i]->info);
+	pthread_mutex_unlock(&jobMutex);
+
+	return infos;
+}
+
+/*!
+ * @brief set the number of cores shared by all jobs
+ * @param newCapacity the cores; 0 uses every online core
+ */
+void Scheduler::setCapacity(unsigned int newCapacity)
+{
+	pthread_mutex_lock(&jobMutex);
+	capacity = newCapacity;
+	dispatch();
+	pthread_mutex_unlock(&jobMutex);
+}
+
+unsigned int Scheduler::getCapacity()
+{
+	return (capacity > 0) ? capacity : ThreadPool::cores();
+}
+
+const char* Scheduler::stateName(int state)
+{
+	if (state == STATE_QUEUED)
+		return "queued";
+	if (state == STATE_RUNNING)
+		return "running";
+	if (state == STATE_DONE)
+		return "done";
+	if (state == STATE_CANCELLED)
+		return "cancelled";
+	return "unknown";
+}
+
+/*!
+ * @brief look up a job
+ * @details expects jobMutex to be held
+ * @param id the job id
+ * @return the job, or NULL once it has left the history
+ */
+Scheduler::Job* Scheduler::find(int64_t id)
+{
+	for (unsigned int i = 0; i < jobs.size(); ++i)
+	{
+		if (jobs[i]->info.id == id)
+			return jobs[i];
+	}
+
+	return NULL;
+}
+
+/*!
+ * @brief start queued jobs while their cores are free
+ * @details strictly by priority: when the best queued job does not fit, nothing behind it
+ * starts either, so a wide job cannot be starved by a stream of narrow ones; expects jobMutex to
+ * be held
+ */
+void Scheduler::dispatch()
+{
+	unsigned int cores = getCapacity();
+	bool started = false;
+	while (true)
+	{
+		Job* best = NULL;
+		for (unsigned int i = 0; i < jobs.size(); ++i)
+		{
+			Job* cJob = jobs[i];
+			if (cJob->info.state != STATE_QUEUED)
+				continue;
+
+			// jobs are in submission order, so ties keep the earliest
+			if ((!best) || (cJob->info.priority > best->info.priority))
+				best = cJob;
+		}
+
+		if (!best)
+			break;
+
+		// an oversized job gets the machine to itself
+		if ((busy > 0) && (busy + best->info.threads > cores))
+			break;
+
+		best->info.state = STATE_RUNNING;
+		best->info.started = time(NULL);
+		busy += best->info.threads;
+		started = true;
+	}
+
+	if (started)
+		pthread_cond_broadcast(&jobCond);
+}
+
+/*!
+ * @brief forget the oldest finished jobs beyond HISTORY
+ * @details expects jobMutex to be held
+ */
+void Scheduler::trimHistory()
+{
+	unsigned int finished = 0;
+	for (unsigned int i = 0; i < jobs.size(); ++i)
+	{
+		if ((jobs[i]->info.state == STATE_DONE) || (jobs[i]->info.state == STATE_CANCELLED))
+			++finished;
+	}
+
+	for (unsigned int i = 0; (i < jobs.size()) && (finished > HISTORY);)
+	{
+		Job* cJob = jobs[i];
+		if ((cJob->info.state == STATE_DONE) || (cJob->info.state == STATE_CANCELLED))
+		{
+			jobs.erase(jobs.begin() + i);
+			delete cJob;
+			--finished;
+			continue;
+		}
+		++i;
+	}
+}
@@ -0,0 +1,96 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _SCHEDULER
+#define _SCHEDULER
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+// Snapshot of one job for status reports
+struct JobInfo
+{
+	int64_t id;
+	std::string name;
+	int priority;
+	unsigned int threads;
+	int state;
+	time_t submitted;
+	time_t started;
+	time_t finished;
+};
+
+// Admission control for long running jobs. A job declares how many cores it
+// uses and waits in waitTurn until they are free; higher priorities go first
+// and equal priorities run in submission order. A job that needs more cores
+// than the machine has runs once everything else has drained.
+class Scheduler
+{
+private:
+	struct Job
+	{
+		JobInfo info;
+		void (*cancelFn)(void*);
+		void* cancelArg;
+		bool cancelled;
+	};
+
+	static pthread_mutex_t jobMutex;
+	static pthread_cond_t jobCond;
+	static std::vector<Job*> jobs;
+	static int64_t nextID;
+	static unsigned int capacity;
+	static unsigned int busy;
+
+	static Job* find(int64_t);
+	static void dispatch();
+	static void trimHistory();
+
+public:
+	static const int STATE_QUEUED = 0;
+	static const int STATE_RUNNING = 1;
+	static const int STATE_DONE = 2;
+	static const int STATE_CANCELLED = 3;
+
+	// finished jobs kept for status reports
+	static const unsigned int HISTORY = 32;
+
+	static int64_t submit(const std::string&, int, unsigned int, void (*)(void*) = NULL,
+						  void* = NULL);
+	static bool waitTurn(int64_t);
+	static void finish(int64_t);
+	static bool cancel(int64_t);
+	static std::vector<JobInfo> list();
+
+	static void setCapacity(unsigned int);
+	static unsigned int getCapacity();
+	static const char* stateName(int);
+};
+
+#endif
@@ -0,0 +1,73 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "stopwatch.h"
+#include <time.h>
+
+Stopwatch::Stopwatch()
+{
+	reset();
+}
+
+void Stopwatch::reset()
+{
+	startNs = nowNs();
+	lapNs = startNs;
+}
+
+double Stopwatch::elapsedMs() const
+{
+	return (nowNs() - startNs) / 1e6;
+}
+
+/*!
+ * @brief end the current lap
+ * @return the milliseconds since the previous lap, or since the start
+ */
+double Stopwatch::lap()
+{
+	int64_t now = nowNs();
+	double lapMs = (now - lapNs) / 1e6;
+	lapNs = now;
+	return lapMs;
+}
+
+/*!
+ * @brief end the current lap and print it
+ * @param phase the name of the phase that just finished
+ */
+void Stopwatch::lap(const char* phase)
+{
+	double lapMs = lap();
+	printf("[TIME] %s: %.1f ms (%.1f ms total)\n", phase, lapMs, elapsedMs());
+}
+
+int64_t Stopwatch::nowNs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
@@ -0,0 +1,259 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "threadpool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+bool ThreadPool::pinning = false;
+unsigned int ThreadPool::nextCPU = 0;
+pthread_mutex_t ThreadPool::cpuMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*!
+ * @brief ThreadPool constructor
+ * @param threadCount the number of workers; 0 uses one per online core
+ */
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+	pthread_mutex_init(&queueMutex, NULL);
+	pthread_cond_init(&workCond, NULL);
+	pthread_cond_init(&doneCond, NULL);
+	active = 0;
+	stopping = false;
+
+	if (threadCount == 0)
+		threadCount = cores();
+
+	for (unsigned int i = 0; i < threadCount; ++i)
+	{
+		pthread_t thread;
+		if (pthread_create(&thread, NULL, workerLoop, (void*)this) != 0)
+			break;
+		threads.push_back(thread);
+
+		if (pinning)
+			pin(thread);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	pthread_mutex_lock(&queueMutex);
+	stopping = true;
+	pthread_cond_broadcast(&workCond);
+	pthread_mutex_unlock(&queueMutex);
+
+	for (unsigned int i = 0; i < threads.size(); ++i)
+		pthread_join(threads[i], NULL);
+
+	pthread_cond_destroy(&doneCond);
+	pthread_cond_destroy(&workCond);
+	pthread_mutex_destroy(&queueMutex);
+}
+
+/*!
+ * @brief queue a task
+ * @details runs the task on the calling thread if the pool could not start any workers
+ * @param fnptr the function to run
+ * @param arg its argument
+ * @return whether the task was accepted
+ */
+bool ThreadPool::submit(void* (*fnptr)(void*), void* arg)
+{
+	if (!fnptr)
+		return false;
+
+	if (threads.empty())
+	{
+		fnptr(arg);
+		return true;
+	}
+
+	Task task;
+	task.fnptr = fnptr;
+	task.arg = arg;
+
+	pthread_mutex_lock(&queueMutex);
+	if (stopping)
+	{
+		pthread_mutex_unlock(&queueMutex);
+		return false;
+	}
+	tasks.push(task);
+	pthread_cond_signal(&workCond);
+	pthread_mutex_unlock(&queueMutex);
+
+	return true;
+}
+
+void ThreadPool::wait()
+{
+	pthread_mutex_lock(&queueMutex);
+	while ((!tasks.empty()) || (active > 0))
+		pthread_cond_wait(&doneCond, &queueMutex);
+	pthread_mutex_unlock(&queueMutex);
+}
+
+unsigned int ThreadPool::size() const
+{
+	return threads.size();
+}
+
+unsigned int ThreadPool::cores()
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (count <= 0)
+		return 1;
+
+	return (unsigned int)count;
+}
+
+/*!
+ * @brief list the online cpus grouped by NUMA node
+ * @details read from sysfs; machines without NUMA information get every cpu in order
+ * @return the cpu ids, node 0 first
+ */
+std::vector<int> ThreadPool::cpuOrder()
+{
+	std::vector<int> order;
+
+	for (int node = 0;; ++node)
+	{
+		char path[64];
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+		FILE* fd = fopen(path, "r");
+		if (!fd)
+			break;
+
+		// ranges like "0-7,16-23"
+		char line[1024];
+		if (fgets(line, sizeof(line), fd))
+		{
+			char* cursor = line;
+			while ((*cursor >= '0') && (*cursor <= '9'))
+			{
+				int first = (int)strtol(cursor, &cursor, 10);
+				int last = first;
+				if (*cursor == '-')
+					last = (int)strtol(cursor + 1, &cursor, 10);
+				for (int cpu = first; cpu <= last; ++cpu)
+					order.push_back(cpu);
+				if (*cursor == ',')
+					++cursor;
+			}
+		}
+		fclose(fd);
+	}
+
+	if (order.empty())
+	{
+		unsigned int count = cores();
+		for (unsigned int cpu = 0; cpu < count; ++cpu)
+			order.push_back((int)cpu);
+	}
+
+	return order;
+}
+
+/*!
+ * @brief set whether pools created from now on pin their workers
+ * @param newPinning whether to pin
+ */
+void ThreadPool::setPinning(bool newPinning)
+{
+	pinning = newPinning;
+}
+
+bool ThreadPool::getPinning()
+{
+	return pinning;
+}
+
+/*!
+ * @brief bind a worker to the next cpu
+ * @details cpus are handed out round robin across every pool, so two pools running side by side
+ * land on different cores; does nothing where thread affinity is not supported
+ * @param thread the worker
+ */
+void ThreadPool::pin(pthread_t thread)
+{
+#if defined(__linux__)
+	static std::vector<int> order;
+
+	pthread_mutex_lock(&cpuMutex);
+	if (order.empty())
+		order = cpuOrder();
+	int cpu = order[nextCPU % order.size()];
+	++nextCPU;
+	pthread_mutex_unlock(&cpuMutex);
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	CPU_SET(cpu, &cpus);
+	if (pthread_setaffinity_np(thread, sizeof(cpus), &cpus) != 0)
+		printf("[POOL] Unable to pin a worker to cpu %d\n", cpu);
+#else
+	(void)thread;
+#endif
+}
+
+void* ThreadPool::workerLoop(void* y)
+{
+	ThreadPool* cPool = (ThreadPool*)y;
+
+	pthread_mutex_lock(&cPool->queueMutex);
+	while (true)
+	{
+		if (cPool->tasks.empty())
+		{
+			if (cPool->stopping)
+				break;
+
+			pthread_cond_wait(&cPool->workCond, &cPool->queueMutex);
+			continue;
+		}
+
+		Task task = cPool->tasks.front();
+		cPool->tasks.pop();
+		++cPool->active;
+
+		pthread_mutex_unlock(&cPool->queueMutex);
+		task.fnptr(task.arg);
+		pthread_mutex_lock(&cPool->queueMutex);
+
+		--cPool->active;
+		if ((cPool->tasks.empty()) && (cPool->active == 0))
+			pthread_cond_broadcast(&cPool->doneCond);
+	}
+	pthread_mutex_unlock(&cPool->queueMutex);
+
+	return NULL;
+}
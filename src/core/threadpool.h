@@ -0,0 +1,81 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _THREADPOOL
+#define _THREADPOOL
+
+#include <pthread.h>
+#include <queue>
+#include <vector>
+
+// Fixed set of worker threads pulling tasks off a shared queue. Tasks are
+// plain pthread style functions; wait() blocks until everything submitted so
+// far has finished, so a pool can be reused for several rounds of work.
+// With pinning on, each worker is bound to one cpu, filling a NUMA node before
+// moving to the next, so the buffers a task writes first stay node local.
+class ThreadPool
+{
+private:
+	struct Task
+	{
+		void* (*fnptr)(void*);
+		void* arg;
+	};
+
+	std::vector<pthread_t> threads;
+	std::queue<Task> tasks;
+	pthread_mutex_t queueMutex;
+	pthread_cond_t workCond;
+	pthread_cond_t doneCond;
+	unsigned int active;
+	bool stopping;
+
+	static bool pinning;
+	static unsigned int nextCPU;
+	static pthread_mutex_t cpuMutex;
+
+	static void* workerLoop(void*);
+	static void pin(pthread_t);
+
+	// owns its threads
+	ThreadPool(const ThreadPool&);
+	void operator=(const ThreadPool&);
+
+public:
+	ThreadPool(unsigned int = 0);
+	~ThreadPool();
+
+	bool submit(void* (*)(void*), void*);
+	void wait();
+	unsigned int size() const;
+
+	static unsigned int cores();
+	static std::vector<int> cpuOrder();
+	static void setPinning(bool);
+	static bool getPinning();
+};
+
+#endif
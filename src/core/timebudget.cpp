@@ -0,0 +1,128 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "timebudget.h"
+#include <math.h>
+#include <sys/time.h>
+
+// Pad the slowest save seen, plus slack for the clock and the reply
+static const double SAVE_MARGIN = 1.5;
+static const double SLACK_SECONDS = 1.0;
+
+TimeBudget::TimeBudget()
+{
+	deadline = 0;
+	epochSeconds = 0.0;
+	saveSeconds = 0.0;
+}
+
+/*!
+ * @brief set the deadline and forget the old timings
+ * @param newDeadline the unix time training and the final save must end by, or 0 for none
+ */
+void TimeBudget::setDeadline(int64_t newDeadline)
+{
+	deadline = (newDeadline > 0) ? newDeadline : 0;
+	epochSeconds = 0.0;
+	saveSeconds = 0.0;
+}
+
+bool TimeBudget::isActive() const
+{
+	return (deadline > 0);
+}
+
+/*!
+ * @brief report a finished step
+ * @details leans towards the slower of the last step and the running average, so a run that
+ * slows down is not caught out at the end
+ * @param epochs the epochs the step trained
+ * @param seconds how long it took
+ */
+void TimeBudget::noteEpochs(int64_t epochs, double seconds)
+{
+	if ((epochs <= 0) || (seconds <= 0.0))
+		return;
+
+	double perEpoch = seconds / epochs;
+	if (epochSeconds <= 0.0)
+		epochSeconds = perEpoch;
+	else
+	{
+		double average = (epochSeconds + perEpoch) / 2.0;
+		epochSeconds = (perEpoch > average) ? perEpoch : average;
+	}
+}
+
+/*!
+ * @brief report a checkpoint save
+ * @param seconds how long it took
+ */
+void TimeBudget::noteSave(double seconds)
+{
+	if (seconds > saveSeconds)
+		saveSeconds = seconds;
+}
+
+double TimeBudget::reserve() const
+{
+	return saveSeconds * SAVE_MARGIN + SLACK_SECONDS;
+}
+
+/*!
+ * @brief how many epochs still fit before the deadline
+ * @return the epochs, 1 while no epoch has been timed, or 0 when it is time to stop
+ */
+int64_t TimeBudget::epochsLeft() const
+{
+	if (!isActive())
+		return 0;
+
+	double left = deadline - reserve() - now();
+	if (left <= 0.0)
+		return 0;
+	if (epochSeconds <= 0.0)
+		return 1;
+
+	return (int64_t)floor(left / epochSeconds);
+}
+
+/*!
+ * @brief the unix time training itself has to stop by
+ * @details for the Terminator, which stops the network between epochs
+ * @return the deadline less the save reserve
+ */
+int64_t TimeBudget::stopAt() const
+{
+	return (int64_t)floor(deadline - reserve());
+}
+
+double TimeBudget::now()
+{
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
@@ -0,0 +1,60 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _TIMEBUDGET
+#define _TIMEBUDGET
+
+#include <stdint.h>
+
+// Trains up to a wall clock deadline and leaves time for the final save.
+// The trainer reports how long its epochs and saves take; epochsLeft() then
+// sizes the next step so it ends, and its checkpoint is written, before the
+// deadline. Until the first report it asks for a single probe epoch.
+class TimeBudget
+{
+private:
+	int64_t deadline;
+	double epochSeconds;
+	double saveSeconds;
+
+	double reserve() const;
+
+public:
+	TimeBudget();
+
+	void setDeadline(int64_t);
+	bool isActive() const;
+
+	void noteEpochs(int64_t, double);
+	void noteSave(double);
+
+	int64_t epochsLeft() const;
+	int64_t stopAt() const;
+
+	static double now();
+};
+
+#endif
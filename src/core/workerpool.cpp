@@ -0,0 +1,191 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "workerpool.h"
+#include <stdio.h>
+
+pthread_mutex_t WorkerPool::poolMutex = PTHREAD_MUTEX_INITIALIZER;
+std::vector<WorkerInfo> WorkerPool::workers;
+std::string WorkerPool::coordinatorHost;
+std::string WorkerPool::coordinatorPort;
+std::vector<std::string> WorkerPool::saved;
+
+/*!
+ * @brief register a worker or record its heartbeat
+ * @param host the worker's address
+ * @param port the port its server listens on
+ * @param cores its core count
+ * @param running the jobs it holds, queued or running
+ */
+void WorkerPool::update(const std::string& host, const std::string& port, unsigned int cores,
+						unsigned int running)
+{
+	pthread_mutex_lock(&poolMutex);
+	WorkerInfo* cWorker = NULL;
+	for (unsigned int i = 0; i < workers.size(); ++i)
+	{
+		if ((workers[i].host == host) && (workers[i].port == port))
+			cWorker = &workers[i];
+	}
+
+	if (!cWorker)
+	{
+		WorkerInfo newWorker;
+		newWorker.host = host;
+		newWorker.port = port;
+		workers.push_back(newWorker);
+		cWorker = &workers[workers.size() - 1];
+		printf("[WORKER] %s:%s joined with %u cores\n", host.c_str(), port.c_str(), cores);
+	}
+
+	cWorker->cores = (cores > 0) ? cores : 1;
+	cWorker->running = running;
+	cWorker->assigned = 0;
+	cWorker->lastSeen = time(NULL);
+	pthread_mutex_unlock(&poolMutex);
+}
+
+/*!
+ * @brief choose the worker for a new job
+ * @param host set to the worker's address
+ * @param port set to its port
+ * @return whether a live worker was found; the job counts against it until its next beat
+ */
+bool WorkerPool::pick(std::string& host, std::string& port)
+{
+	time_t now = time(NULL);
+	pthread_mutex_lock(&poolMutex);
+	WorkerInfo* best = NULL;
+	double bestLoad = 0.0;
+	for (unsigned int i = 0; i < workers.size(); ++i)
+	{
+		WorkerInfo& cWorker = workers[i];
+		if (now - cWorker.lastSeen > TIMEOUT_SECONDS)
+			continue;
+
+		double load = (double)(cWorker.running + cWorker.assigned) / cWorker.cores;
+		if ((!best) || (load < bestLoad))
+		{
+			best = &cWorker;
+			bestLoad = load;
+		}
+	}
+
+	if (best)
+	{
+		++best->assigned;
+		host = best->host;
+		port = best->port;
+	}
+	pthread_mutex_unlock(&poolMutex);
+
+	return best != NULL;
+}
+
+/*!
+ * @brief the live workers
+ * @return a snapshot of every worker heard from within TIMEOUT_SECONDS
+ */
+std::vector<WorkerInfo> WorkerPool::list()
+{
+	time_t now = time(NULL);
+	std::vector<WorkerInfo> live;
+	pthread_mutex_lock(&poolMutex);
+	for (unsigned int i = 0; i < workers.size(); ++i)
+	{
+		if (now - workers[i].lastSeen <= TIMEOUT_SECONDS)
+			live.push_back(workers[i]);
+	}
+	pthread_mutex_unlock(&poolMutex);
+
+	return live;
+}
+
+/*!
+ * @brief run as a worker of a coordinator
+ * @param host the coordinator's address
+ * @param port its server port, empty for the GNet default
+ */
+void WorkerPool::setCoordinator(const std::string& host, const std::string& port)
+{
+	pthread_mutex_lock(&poolMutex);
+	coordinatorHost = host;
+	coordinatorPort = port;
+	pthread_mutex_unlock(&poolMutex);
+}
+
+bool WorkerPool::isWorker()
+{
+	pthread_mutex_lock(&poolMutex);
+	bool worker = !coordinatorHost.empty();
+	pthread_mutex_unlock(&poolMutex);
+
+	return worker;
+}
+
+std::string WorkerPool::getCoordinatorHost()
+{
+	pthread_mutex_lock(&poolMutex);
+	std::string host = coordinatorHost;
+	pthread_mutex_unlock(&poolMutex);
+
+	return host;
+}
+
+std::string WorkerPool::getCoordinatorPort()
+{
+	pthread_mutex_lock(&poolMutex);
+	std::string port = coordinatorPort;
+	pthread_mutex_unlock(&poolMutex);
+
+	return port;
+}
+
+/*!
+ * @brief remember a network this worker saved
+ * @details sent with the next heartbeat so the coordinator reloads it from the shared store
+ * @param name the network
+ */
+void WorkerPool::noteSaved(const std::string& name)
+{
+	pthread_mutex_lock(&poolMutex);
+	bool known = false;
+	for (unsigned int i = 0; i < saved.size(); ++i)
+		known = (known) || (saved[i] == name);
+	if (!known)
+		saved.push_back(name);
+	pthread_mutex_unlock(&poolMutex);
+}
+
+std::vector<std::string> WorkerPool::takeSaved()
+{
+	pthread_mutex_lock(&poolMutex);
+	std::vector<std::string> names;
+	names.swap(saved);
+	pthread_mutex_unlock(&poolMutex);
+
+	return names;
+}
@@ -0,0 +1,79 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _WORKERPOOL
+#define _WORKERPOOL
+
+#include <pthread.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+// Snapshot of one training worker
+struct WorkerInfo
+{
+	std::string host;
+	std::string port;
+	unsigned int cores;
+	unsigned int running;
+	unsigned int assigned;
+	time_t lastSeen;
+};
+
+// The training workers a coordinator knows about, and on a worker, the
+// coordinator it reports to. Workers heartbeat every HEARTBEAT_SECONDS with
+// their core count, how many jobs they hold and the networks they saved since
+// the last beat; one not heard from for TIMEOUT_SECONDS gets no new jobs.
+// Jobs go to the worker with the fewest jobs per core, counting the ones
+// handed to it since its last beat.
+class WorkerPool
+{
+private:
+	static pthread_mutex_t poolMutex;
+	static std::vector<WorkerInfo> workers;
+	static std::string coordinatorHost;
+	static std::string coordinatorPort;
+	static std::vector<std::string> saved;
+
+public:
+	static const int HEARTBEAT_SECONDS = 5;
+	static const int TIMEOUT_SECONDS = 20;
+
+	// coordinator side
+	static void update(const std::string&, const std::string&, unsigned int, unsigned int);
+	static bool pick(std::string&, std::string&);
+	static std::vector<WorkerInfo> list();
+
+	// worker side
+	static void setCoordinator(const std::string&, const std::string&);
+	static bool isWorker();
+	static std::string getCoordinatorHost();
+	static std::string getCoordinatorPort();
+	static void noteSaved(const std::string&);
+	static std::vector<std::string> takeSaved();
+};
+
+#endif
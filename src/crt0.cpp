@@ -25,17 +25,33 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 #include "crt0.h"
+#include "cli.h"
 #include "Backend/Database/GList.h"
 #include "Backend/Machine Learning/main.h"
 #include "Backend/Networking/main.h"
 #include "Backend/Networking/service.h"
 #include "Backend/Networking/socket.h"
+#include "core/asynclog.h"
+#include "core/cpufeatures.h"
 #include "core/error.h"
 #include "core/md5.h"
+#include "core/random.h"
+#include "core/stopwatch.h"
+#include "core/threadpool.h"
 #include "core/version.h"
+#include "core/workerpool.h"
+#include "data/csvscan.h"
+#include "data/memoryusage.h"
 #include "main.h"
 #include "services/bayes_train.h"
+#include "services/cv_test.h"
+#include "services/job_status.h"
+#include "services/metrics_export.h"
+#include "services/ml_predict.h"
+#include "services/ml_sweep.h"
 #include "services/ml_train.h"
+#include "services/reply_router.h"
+#include "services/worker_register.h"
 
 bool NNCreator::running = true;
 Version* NNCreator::version = new Version("0.58");
@@ -66,14 +82,45 @@ void NNCreator::stop()
 
 int main(int argc, char* argv[])
 {
+	Stopwatch startup;
+
 	// version & header
 	printf("%s\n", NNCreator::getVersion().header().c_str());
 
-	// For random numbers
-	srand(time(NULL));
+	// For random numbers; "seed=N" makes runs repeatable
+	uint64_t seed = ((uint64_t)time(NULL) << 16) ^ (uint64_t)getpid();
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strncmp(argv[i], "seed=", 5) == 0)
+		{
+			seed = strtoull(argv[i] + 5, NULL, 10);
+			Random::setDeterministic(true);
+		}
+	}
+	Random::setSeed(seed);
+	srand((unsigned int)Random::local()->next());
+	printf("[MAIN] Random seed: %llu\n", (unsigned long long)Random::getSeed());
 
 	// for machine learning initialization
 	glades::init();
+	startup.lap("glades init");
+
+	// Pick the kernels for this CPU before any loader thread runs
+	CPUFeatures::detect();
+	CSVScan::select();
+	printf("[MAIN] CPU features: %s; CSV scan: %s\n", CPUFeatures::describe().c_str(),
+		   CSVScan::getName());
+
+	// Headless subcommands never start the server or the gui
+	if ((argc > 1) && (CLI::isCommand(argv[1])))
+		return CLI::run(argc, argv);
+
+	// Service threads log through the writer thread from here on
+	char logFName[64];
+	time_t now = time(NULL);
+	strftime(logFName, sizeof(logFName), "logs/%Y-%m-%d_%H-%M-%S.log", localtime(&now));
+	if (!AsyncLog::start(logFName))
+		printf("[MAIN] Unable to open \"%s\", logging to the console\n", logFName);
 
 	GNet::GServer* serverInstance = new GNet::GServer();
 
@@ -84,29 +131,87 @@ int main(int argc, char* argv[])
 	Bayes_Train* bayes_train_srvc = new Bayes_Train(serverInstance);
 	serverInstance->addService(bayes_train_srvc);
 
+	CV_Test* cv_test_srvc = new CV_Test(serverInstance);
+	serverInstance->addService(cv_test_srvc);
+
+	ML_Sweep* ml_sweep_srvc = new ML_Sweep(serverInstance);
+	serverInstance->addService(ml_sweep_srvc);
+
+	ML_Predict* ml_predict_srvc = new ML_Predict(serverInstance);
+	serverInstance->addService(ml_predict_srvc);
+
+	JOB_Status* job_status_srvc = new JOB_Status(serverInstance);
+	serverInstance->addService(job_status_srvc);
+
+	Metrics_Export* metrics_export_srvc = new Metrics_Export(serverInstance);
+	serverInstance->addService(metrics_export_srvc);
+
+	Worker_Register* worker_register_srvc = new Worker_Register(serverInstance);
+	serverInstance->addService(worker_register_srvc);
+
+	Reply_Router* reply_router_srvc = new Reply_Router(serverInstance);
+	serverInstance->addService(reply_router_srvc);
+	startup.lap("services");
+
 	// command line args
 	bool noguiMode = false;
 	bool fullScreenMode = false;
 	bool compatMode = false;
 	bool localOnly = false;
+	shmea::GString port = "45024";
 	for (int i = 1; i < argc; ++i)
 	{
 		printf("Ingesting program paramter [%d]: %s\n", i, argv[i]);
-		noguiMode = (strcmp(argv[i], "nogui") == 0);
-		fullScreenMode = (strcmp(argv[i], "fullscreen") == 0);
-		compatMode = (strcmp(argv[i], "fullscreen") == 0);
-		localOnly = (strcmp(argv[i], "local") == 0);
+		if (strcmp(argv[i], "nogui") == 0)
+			noguiMode = true;
+		else if (strcmp(argv[i], "fullscreen") == 0)
+			fullScreenMode = true;
+		else if (strcmp(argv[i], "compat") == 0)
+			compatMode = true;
+		else if (strcmp(argv[i], "local") == 0)
+			localOnly = true;
+		else if (strcmp(argv[i], "pin") == 0)
+			ThreadPool::setPinning(true);
+		else if (strncmp(argv[i], "memory=", 7) == 0)
+			MemoryUsage::setBudget((size_t)atoi(argv[i] + 7) * 1024 * 1024);
+		else if (strncmp(argv[i], "port=", 5) == 0)
+			port = argv[i] + 5;
+		else if (strncmp(argv[i], "worker=", 7) == 0)
+		{
+			// worker=HOST or worker=HOST:PORT of the coordinator
+			std::string coordinator = argv[i] + 7;
+			size_t colon = coordinator.find(':');
+			std::string coordinatorPort;
+			if (colon != std::string::npos)
+			{
+				coordinatorPort = coordinator.substr(colon + 1);
+				coordinator = coordinator.substr(0, colon);
+			}
+			WorkerPool::setCoordinator(coordinator, coordinatorPort);
+		}
 	}
 
 	// Launch the server server
-	serverInstance->run("45024", localOnly);
+	serverInstance->run(port, localOnly);
+	startup.lap("server");
 
-	// Launch the gui
-	if (!noguiMode)
+	// A worker has no gui and reports to its coordinator until stopped
+	if (WorkerPool::isWorker())
+	{
+		printf("[MAIN] Training for %s\n", WorkerPool::getCoordinatorHost().c_str());
+		while ((NNCreator::getRunning()) && (serverInstance->getRunning()))
+		{
+			if (!Worker_Register::heartbeat(serverInstance))
+				printf("[MAIN] Unable to reach %s\n", WorkerPool::getCoordinatorHost().c_str());
+			sleep(WorkerPool::HEARTBEAT_SECONDS);
+		}
+	}
+	else if (!noguiMode)
 		Frontend::run(serverInstance, fullScreenMode, compatMode);
 
 	// Cleanup GNet
 	serverInstance->stop();
+	AsyncLog::stop();
 
 	return EXIT_SUCCESS;
 }
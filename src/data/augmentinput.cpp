@@ -0,0 +1,547 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "augmentinput.h"
+#include "../core/profiler.h"
+#include "../core/random.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Machine Learning/DataObjects/ImageInput.h"
+#include "denseinput.h"
+#include "indexedinput.h"
+#include "shardinput.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// spreads the epoch and row over the generator seed
+static const uint64_t EPOCH_MIX = 0x9E3779B97F4A7C15ULL;
+static const uint64_t ROW_MIX = 0xBF58476D1CE4E5B9ULL;
+
+AugmentInput::AugmentInput(const glades::DataInput* newSource)
+{
+	source = newSource;
+	width = 0;
+	height = 0;
+	channels = 0;
+	flip = false;
+	cropPad = 0;
+	brightness = 0.0f;
+	contrast = 0.0f;
+	noise = 0.0f;
+	seedBase = Random::streamSeed("augmentinput");
+
+	pthread_mutex_init(&blockMutex, NULL);
+	pthread_cond_init(&prefetchCond, NULL);
+	pthread_cond_init(&readyCond, NULL);
+	prefetchStarted = false;
+	prefetchStopping = false;
+	blockStart = 0;
+	blockRows = 0;
+	blockEpoch = -1;
+	nextStart = 0;
+	nextRows = 0;
+	nextEpoch = -1;
+	nextReady = false;
+	nextBusy = false;
+	nextPending = false;
+	epoch = 0;
+	lastTrainRow = 0;
+
+	if (source)
+	{
+		OHEMaps = source->OHEMaps;
+		featureIsCategorical = source->featureIsCategorical;
+	}
+}
+
+AugmentInput::~AugmentInput()
+{
+	stopPrefetch();
+	pthread_cond_destroy(&readyCond);
+	pthread_cond_destroy(&prefetchCond);
+	pthread_mutex_destroy(&blockMutex);
+	source = NULL; // Not ours to delete
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+}
+
+/*!
+ * @brief set the augmentations
+ * @details a comma separated list of flip, crop=PIXELS, brightness=DELTA, contrast=FRACTION and
+ * noise=AMOUNT, where noise is the standard deviation of the added noise
+ * @param spec the list
+ * @return false on an unknown or out of range entry
+ */
+bool AugmentInput::parse(const char* spec)
+{
+	if (!spec)
+		return false;
+
+	std::string list = spec;
+	size_t begin = 0;
+	while (begin <= list.length())
+	{
+		size_t end = list.find(',', begin);
+		if (end == std::string::npos)
+			end = list.length();
+
+		std::string entry = list.substr(begin, end - begin);
+		std::string key = entry.substr(0, entry.find('='));
+		float value = 0.0f;
+		if (entry.find('=') != std::string::npos)
+			value = (float)atof(entry.c_str() + entry.find('=') + 1);
+
+		if (entry == "flip")
+			flip = true;
+		else if ((key == "crop") && (value >= 0.0f))
+			cropPad = (unsigned int)value;
+		else if ((key == "brightness") && (value >= 0.0f))
+			brightness = value;
+		else if ((key == "contrast") && (value >= 0.0f) && (value < 1.0f))
+			contrast = value;
+		else if ((key == "noise") && (value >= 0.0f))
+			noise = value;
+		else if (!entry.empty())
+			return false;
+
+		begin = end + 1;
+	}
+
+	return true;
+}
+
+/*!
+ * @brief set the image size of the rows
+ * @param newWidth the image width
+ * @param newHeight the image height
+ * @return false when the rows are not a whole number of channels of that size
+ */
+bool AugmentInput::setGeometry(unsigned int newWidth, unsigned int newHeight)
+{
+	width = 0;
+	height = 0;
+	channels = 0;
+	if ((!source) || (newWidth == 0) || (newHeight == 0) || (source->getTrainSize() == 0))
+		return false;
+
+	unsigned int features = source->getTrainRow(0).size();
+	unsigned int pixels = newWidth * newHeight;
+	if ((features == 0) || (features % pixels != 0))
+		return false;
+
+	width = newWidth;
+	height = newHeight;
+	channels = features / pixels;
+	return true;
+}
+
+bool AugmentInput::isActive() const
+{
+	return (channels > 0) &&
+		   ((flip) || (cropPad > 0) || (brightness > 0.0f) || (contrast > 0.0f) || (noise > 0.0f));
+}
+
+const glades::DataInput* AugmentInput::getSource() const
+{
+	return source;
+}
+
+size_t AugmentInput::getBytes() const
+{
+	return (block.capacity() + nextBlock.capacity()) * sizeof(float);
+}
+
+/*!
+ * @brief the size of the images behind an input
+ * @details looks through IndexedInput to a pack, a flattened image set or ImageInput's first
+ * image
+ * @param di the input
+ * @param imageWidth set to the width
+ * @param imageHeight set to the height
+ * @return false when the input has no images or their size is unknown
+ */
+bool AugmentInput::imageSize(const glades::DataInput* di, unsigned int& imageWidth,
+							 unsigned int& imageHeight)
+{
+	const IndexedInput* indexed = dynamic_cast<const IndexedInput*>(di);
+	if (indexed)
+		return imageSize(indexed->getSource(), imageWidth, imageHeight);
+
+	imageWidth = 0;
+	imageHeight = 0;
+	const ShardInput* shards = dynamic_cast<const ShardInput*>(di);
+	if (shards)
+	{
+		imageWidth = shards->getWidth();
+		imageHeight = shards->getHeight();
+	}
+
+	const DenseInput* dense = dynamic_cast<const DenseInput*>(di);
+	if (dense)
+	{
+		imageWidth = dense->imageWidth;
+		imageHeight = dense->imageHeight;
+	}
+
+	const glades::ImageInput* images = dynamic_cast<const glades::ImageInput*>(di);
+	if ((images) && (images->getTrainSize() > 0))
+	{
+		const shmea::GPointer<shmea::Image> firstImage = images->getTrainImage(0);
+		if (firstImage)
+		{
+			imageWidth = firstImage->getWidth();
+			imageHeight = firstImage->getHeight();
+		}
+	}
+
+	return (imageWidth > 0) && (imageHeight > 0);
+}
+
+/*!
+ * @brief augment an image input
+ * @param di the input, usually the shuffled one
+ * @param spec the augmentations, as for parse
+ * @return the augmented input, or NULL for a bad spec or rows of unknown size; delete it
+ * through InputLoader::release
+ */
+AugmentInput* AugmentInput::create(const glades::DataInput* di, const char* spec)
+{
+	unsigned int imageWidth = 0;
+	unsigned int imageHeight = 0;
+	if (!imageSize(di, imageWidth, imageHeight))
+	{
+		printf("[DATA] Augmentation needs an image set\n");
+		return NULL;
+	}
+
+	AugmentInput* augmented = new AugmentInput(di);
+	if (!augmented->parse(spec))
+	{
+		printf("[DATA] Unknown augmentation \"%s\"\n", spec);
+		delete augmented;
+		return NULL;
+	}
+	if (!augmented->setGeometry(imageWidth, imageHeight))
+	{
+		printf("[DATA] Rows do not match %ux%u images\n", imageWidth, imageHeight);
+		delete augmented;
+		return NULL;
+	}
+
+	return augmented;
+}
+
+/*!
+ * @brief augment one row
+ * @details the crop and flip are one gather from the source pixels, then the photometric
+ * changes are single passes over the floats that the compiler can vectorize
+ * @param cRow the source row
+ * @param row the row index, part of the seed
+ * @param rowEpoch the epoch, part of the seed
+ * @param dst the augmented row, getFeatureCount() floats
+ */
+void AugmentInput::augmentRow(const shmea::GList& cRow, unsigned int row, int64_t rowEpoch,
+							  float* dst) const
+{
+	unsigned int features = width * height * channels;
+	if ((!isActive()) || (cRow.size() != features))
+	{
+		for (unsigned int i = 0; i < features; ++i)
+			dst[i] = (i < cRow.size()) ? cRow.getFloat(i) : 0.0f;
+		return;
+	}
+
+	Random rng(seedBase ^ ((uint64_t)rowEpoch * EPOCH_MIX) ^ ((uint64_t)row * ROW_MIX));
+	int dx = 0;
+	int dy = 0;
+	if (cropPad > 0)
+	{
+		dx = (int)rng.nextUInt(2 * cropPad + 1) - (int)cropPad;
+		dy = (int)rng.nextUInt(2 * cropPad + 1) - (int)cropPad;
+	}
+	bool mirror = (flip) && ((rng.next() & 1) != 0);
+
+	// the padding is zeros
+	for (unsigned int y = 0; y < height; ++y)
+	{
+		int sy = (int)y + dy;
+		for (unsigned int x = 0; x < width; ++x)
+		{
+			int sx = (int)((mirror) ? width - 1 - x : x) + dx;
+			float* out = dst + ((size_t)y * width + x) * channels;
+			if ((sx < 0) || (sy < 0) || (sx >= (int)width) || (sy >= (int)height))
+			{
+				for (unsigned int c = 0; c < channels; ++c)
+					out[c] = 0.0f;
+				continue;
+			}
+
+			unsigned int in = ((unsigned int)sy * width + (unsigned int)sx) * channels;
+			for (unsigned int c = 0; c < channels; ++c)
+				out[c] = cRow.getFloat(in + c);
+		}
+	}
+
+	if ((brightness > 0.0f) || (contrast > 0.0f))
+	{
+		float shift = (brightness > 0.0f) ? (rng.nextFloat() * 2.0f - 1.0f) * brightness : 0.0f;
+		float scale = (contrast > 0.0f) ? 1.0f + (rng.nextFloat() * 2.0f - 1.0f) * contrast : 1.0f;
+
+		float sum = 0.0f;
+		for (unsigned int i = 0; i < features; ++i)
+			sum += dst[i];
+		float mean = sum / features;
+		float offset = mean - mean * scale + shift;
+		for (unsigned int i = 0; i < features; ++i)
+			dst[i] = dst[i] * scale + offset;
+	}
+
+	// uniform noise on [-a, a] has a standard deviation of a / sqrt(3)
+	if (noise > 0.0f)
+	{
+		float amplitude = noise * sqrtf(3.0f);
+		for (unsigned int i = 0; i < features; ++i)
+			dst[i] += (rng.nextFloat() * 2.0f - 1.0f) * amplitude;
+	}
+}
+
+unsigned int AugmentInput::makeBlock(unsigned int start, int64_t blockOf,
+									 std::vector<float>& values) const
+{
+	NNC_PROFILE_SCOPE("data.augment_block");
+	unsigned int size = source->getTrainSize();
+	if (start >= size)
+		return 0;
+
+	unsigned int rows = (start + BLOCK_ROWS <= size) ? BLOCK_ROWS : size - start;
+	unsigned int features = width * height * channels;
+	values.resize((size_t)rows * features);
+	for (unsigned int r = 0; r < rows; ++r)
+		augmentRow(source->getTrainRow(start + r), start + r, blockOf,
+				   &values[(size_t)r * features]);
+	return rows;
+}
+
+// called with blockMutex held
+void AugmentInput::requestPrefetch(unsigned int start) const
+{
+	if (!prefetchStarted)
+	{
+		prefetchStopping = false;
+		if (pthread_create(&prefetchThread, NULL, prefetchLoop, (void*)this) != 0)
+			return;
+		prefetchStarted = true;
+	}
+
+	nextReady = false;
+	nextPending = true;
+	nextStart = start;
+	nextEpoch = epoch;
+	pthread_cond_signal(&prefetchCond);
+}
+
+// called with blockMutex held; returns once the loader thread is not reading the source, which
+// it cannot start again until the lock is released, so the source is read by one thread at a time
+void AugmentInput::waitForSource() const
+{
+	while ((nextPending) || (nextBusy))
+		pthread_cond_wait(&readyCond, &blockMutex);
+}
+
+void AugmentInput::stopPrefetch()
+{
+	pthread_mutex_lock(&blockMutex);
+	if (!prefetchStarted)
+	{
+		pthread_mutex_unlock(&blockMutex);
+		return;
+	}
+
+	prefetchStopping = true;
+	pthread_cond_signal(&prefetchCond);
+	pthread_mutex_unlock(&blockMutex);
+
+	pthread_join(prefetchThread, NULL);
+	prefetchStarted = false;
+}
+
+void* AugmentInput::prefetchLoop(void* y)
+{
+	const AugmentInput* cInput = (const AugmentInput*)y;
+	std::vector<float> values;
+
+	pthread_mutex_lock(&cInput->blockMutex);
+	while (!cInput->prefetchStopping)
+	{
+		if (!cInput->nextPending)
+		{
+			pthread_cond_wait(&cInput->prefetchCond, &cInput->blockMutex);
+			continue;
+		}
+
+		unsigned int start = cInput->nextStart;
+		int64_t blockOf = cInput->nextEpoch;
+		cInput->nextPending = false;
+		cInput->nextBusy = true;
+
+		// augment without the lock; the trainer waits for nextBusy before touching the source
+		pthread_mutex_unlock(&cInput->blockMutex);
+		unsigned int rows = cInput->makeBlock(start, blockOf, values);
+		pthread_mutex_lock(&cInput->blockMutex);
+
+		cInput->nextBlock.swap(values);
+		cInput->nextRows = rows;
+		cInput->nextReady = (rows > 0);
+		cInput->nextBusy = false;
+		pthread_cond_broadcast(&cInput->readyCond);
+	}
+	pthread_mutex_unlock(&cInput->blockMutex);
+
+	return NULL;
+}
+
+void AugmentInput::import(shmea::GString fname)
+{
+	printf("[DATA] AugmentInput augments an imported source, \"%s\" not loaded\n",
+		   fname.c_str());
+}
+
+shmea::GList AugmentInput::getTrainRow(unsigned int index) const
+{
+	NNC_PROFILE_SCOPE("data.train_row");
+	if ((!source) || (index >= source->getTrainSize()))
+		return shmea::GList();
+
+	if (!isActive())
+		return source->getTrainRow(index);
+
+	pthread_mutex_lock(&blockMutex);
+
+	// a new epoch
+	if ((index == 0) && (lastTrainRow > 0))
+		++epoch;
+	lastTrainRow = index;
+
+	bool inBlock = (blockEpoch == epoch) && (index >= blockStart) &&
+				   (index < blockStart + blockRows);
+	if (!inBlock)
+	{
+		waitForSource();
+
+		unsigned int start = index - index % BLOCK_ROWS;
+		if ((nextReady) && (nextStart == start) && (nextEpoch == epoch))
+		{
+			block.swap(nextBlock);
+			blockRows = nextRows;
+			nextReady = false;
+		}
+		else
+			blockRows = makeBlock(start, epoch, block);
+		blockStart = start;
+		blockEpoch = epoch;
+	}
+
+	unsigned int features = width * height * channels;
+	shmea::GList cRow;
+	const float* values = &block[(size_t)(index - blockStart) * features];
+	for (unsigned int c = 0; c < features; ++c)
+		cRow.addFloat(values[c]);
+
+	// augment the following block while this one is read
+	unsigned int following = blockStart + blockRows;
+	bool queued = (nextReady) && (nextStart == following) && (nextEpoch == epoch);
+	if ((following < source->getTrainSize()) && (!nextPending) && (!nextBusy) && (!queued))
+		requestPrefetch(following);
+
+	pthread_mutex_unlock(&blockMutex);
+	return cRow;
+}
+
+shmea::GList AugmentInput::getTrainExpectedRow(unsigned int index) const
+{
+	if (!source)
+		return shmea::GList();
+
+	pthread_mutex_lock(&blockMutex);
+	waitForSource();
+	shmea::GList cRow = source->getTrainExpectedRow(index);
+	pthread_mutex_unlock(&blockMutex);
+	return cRow;
+}
+
+shmea::GList AugmentInput::getTestRow(unsigned int index) const
+{
+	if (!source)
+		return shmea::GList();
+
+	pthread_mutex_lock(&blockMutex);
+	waitForSource();
+	shmea::GList cRow = source->getTestRow(index);
+	pthread_mutex_unlock(&blockMutex);
+	return cRow;
+}
+
+shmea::GList AugmentInput::getTestExpectedRow(unsigned int index) const
+{
+	if (!source)
+		return shmea::GList();
+
+	pthread_mutex_lock(&blockMutex);
+	waitForSource();
+	shmea::GList cRow = source->getTestExpectedRow(index);
+	pthread_mutex_unlock(&blockMutex);
+	return cRow;
+}
+
+unsigned int AugmentInput::getTrainSize() const
+{
+	if (!source)
+		return 0;
+	return source->getTrainSize();
+}
+
+unsigned int AugmentInput::getTestSize() const
+{
+	if (!source)
+		return 0;
+	return source->getTestSize();
+}
+
+unsigned int AugmentInput::getFeatureCount() const
+{
+	if (!source)
+		return 0;
+	return source->getFeatureCount();
+}
+
+int AugmentInput::getType() const
+{
+	if (!source)
+		return glades::DataInput::IMAGE;
+	return source->getType();
+}
@@ -0,0 +1,121 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _AUGMENTINPUT
+#define _AUGMENTINPUT
+
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <vector>
+
+// Random image augmentation of another input's training rows, made fresh
+// every epoch so nothing augmented is ever written to disk. A row is taken as
+// width x height pixels, top row first, with the channels of each pixel next
+// to each other. Each row gets a random crop of the image padded by cropPad
+// pixels, an optional horizontal flip, a brightness shift, a contrast scale
+// around its mean and uniform noise, drawn from a generator seeded by the
+// epoch and row, so a run is repeatable. Rows are augmented BLOCK_ROWS at a
+// time and the next block is made on a loader thread while the trainer reads
+// the current one. Expected rows and the test split pass through unchanged.
+class AugmentInput : public glades::DataInput
+{
+private:
+	const glades::DataInput* source;
+	unsigned int width;
+	unsigned int height;
+	unsigned int channels;
+	bool flip;
+	unsigned int cropPad;
+	float brightness;
+	float contrast;
+	float noise;
+	uint64_t seedBase;
+
+	// the block being read, and the next one
+	mutable pthread_mutex_t blockMutex;
+	mutable pthread_cond_t prefetchCond;
+	mutable pthread_cond_t readyCond;
+	mutable pthread_t prefetchThread;
+	mutable bool prefetchStarted;
+	mutable bool prefetchStopping;
+	mutable std::vector<float> block;
+	mutable unsigned int blockStart;
+	mutable unsigned int blockRows;
+	mutable int64_t blockEpoch;
+	mutable std::vector<float> nextBlock;
+	mutable unsigned int nextStart;
+	mutable unsigned int nextRows;
+	mutable int64_t nextEpoch;
+	mutable bool nextReady;
+	mutable bool nextBusy;
+	mutable bool nextPending;
+	mutable int64_t epoch;
+	mutable unsigned int lastTrainRow;
+
+	// owns the loader thread
+	AugmentInput(const AugmentInput&);
+	void operator=(const AugmentInput&);
+
+	unsigned int makeBlock(unsigned int, int64_t, std::vector<float>&) const;
+	void augmentRow(const shmea::GList&, unsigned int, int64_t, float*) const;
+	void requestPrefetch(unsigned int) const;
+	void waitForSource() const;
+	void stopPrefetch();
+
+	static void* prefetchLoop(void*);
+
+public:
+	static const unsigned int BLOCK_ROWS = 256;
+
+	AugmentInput(const glades::DataInput*);
+	virtual ~AugmentInput();
+
+	bool parse(const char*);
+	bool setGeometry(unsigned int, unsigned int);
+	bool isActive() const;
+	const glades::DataInput* getSource() const;
+	size_t getBytes() const;
+
+	static bool imageSize(const glades::DataInput*, unsigned int&, unsigned int&);
+	static AugmentInput* create(const glades::DataInput*, const char*);
+
+	virtual void import(shmea::GString);
+
+	virtual shmea::GList getTrainRow(unsigned int) const;
+	virtual shmea::GList getTrainExpectedRow(unsigned int) const;
+
+	virtual shmea::GList getTestRow(unsigned int) const;
+	virtual shmea::GList getTestExpectedRow(unsigned int) const;
+
+	virtual unsigned int getTrainSize() const;
+	virtual unsigned int getTestSize() const;
+	virtual unsigned int getFeatureCount() const;
+
+	virtual int getType() const;
+};
+
+#endif
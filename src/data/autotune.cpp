@@ -0,0 +1,311 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "autotune.h"
+#include "../core/atomicfile.h"
+#include "../core/cpufeatures.h"
+#include "../core/md5.h"
+#include "../core/stopwatch.h"
+#include "../core/threadpool.h"
+#include "Backend/Machine Learning/Networks/network.h"
+#include "Backend/Machine Learning/State/Terminator.h"
+#include "Backend/Machine Learning/Structure/nninfo.h"
+#include "Backend/Machine Learning/main.h"
+#include "csvreader.h"
+#include "denseinput.h"
+#include "indexedinput.h"
+#include "inputloader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Next to the metrics history
+static const char TUNE_DIR[] = "metrics";
+static const char TUNE_FILE[] = "autotune.nntune";
+
+// batch sizes tried, 0 being the full batch
+static const int BATCH_CANDIDATES[] = {1, 8, 32, 128, glades::NNInfo::BATCH_FULL};
+static const unsigned int BATCH_CANDIDATE_COUNT = 5;
+
+/*!
+ * @brief what identifies this machine
+ * @return the md5 of the host name, core count and vector extensions
+ */
+std::string Autotune::hostKey()
+{
+	char host[256];
+	if (gethostname(host, sizeof(host)) != 0)
+		host[0] = '\0';
+	host[sizeof(host) - 1] = '\0';
+
+	char cores[32];
+	sprintf(cores, ":%u:", ThreadPool::cores());
+	return MD5(std::string(host) + cores + CPUFeatures::describe()).hexdigest();
+}
+
+/*!
+ * @brief what identifies a network's shapes on this machine
+ * @param cInfo the network structure
+ * @return the md5 of the host key and the layer sizes and activations
+ */
+std::string Autotune::modelKey(const glades::NNInfo* cInfo)
+{
+	if (!cInfo)
+		return "";
+
+	std::string shape = hostKey();
+	char layer[64];
+	sprintf(layer, ":%d:%d", cInfo->getInputLayerSize(), cInfo->getInputType());
+	shape += layer;
+	for (int i = 0; i < cInfo->numHiddenLayers(); ++i)
+	{
+		sprintf(layer, ":%d/%d", cInfo->getHiddenLayerSize(i), cInfo->getActivationType(i));
+		shape += layer;
+	}
+	sprintf(layer, ":%u:%d", cInfo->getOutputLayerSize(), cInfo->getOutputType());
+	shape += layer;
+
+	return MD5(shape).hexdigest();
+}
+
+std::string Autotune::path()
+{
+	return std::string(TUNE_DIR) + "/" + TUNE_FILE;
+}
+
+bool Autotune::read(std::vector<std::pair<std::string, int> >& entries)
+{
+	entries.clear();
+	FILE* fd = fopen(path().c_str(), "r");
+	if (!fd)
+		return false;
+
+	char key[64];
+	int value = 0;
+	while (fscanf(fd, "%63s %d", key, &value) == 2)
+		entries.push_back(std::pair<std::string, int>(key, value));
+
+	fclose(fd);
+	return true;
+}
+
+bool Autotune::lookup(const std::string& key, int& value)
+{
+	std::vector<std::pair<std::string, int> > entries;
+	read(entries);
+	for (unsigned int i = 0; i < entries.size(); ++i)
+	{
+		if (entries[i].first == key)
+		{
+			value = entries[i].second;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*!
+ * @brief add or replace an entry
+ * @details the whole file is rewritten through AtomicFile, so concurrent readers see either
+ * the old entries or the new ones
+ * @param key the host or model key
+ * @param value the setting
+ * @return whether the file was written
+ */
+bool Autotune::store(const std::string& key, int value)
+{
+	std::vector<std::pair<std::string, int> > entries;
+	read(entries);
+
+	bool replaced = false;
+	for (unsigned int i = 0; i < entries.size(); ++i)
+	{
+		if (entries[i].first == key)
+		{
+			entries[i].second = value;
+			replaced = true;
+		}
+	}
+	if (!replaced)
+		entries.push_back(std::pair<std::string, int>(key, value));
+
+	std::string text;
+	char line[128];
+	for (unsigned int i = 0; i < entries.size(); ++i)
+	{
+		sprintf(line, "%s %d\n", entries[i].first.c_str(), entries[i].second);
+		text += line;
+	}
+
+	mkdir(TUNE_DIR, 0755);
+	return AtomicFile::writeFile(path(), text.data(), text.size());
+}
+
+/*!
+ * @brief training throughput of one batch size
+ * @details a fresh scratch copy of the network is loaded for every candidate and never
+ * saved, so the real network is untouched
+ * @param netName the network
+ * @param sample the rows to train on
+ * @param batchSize the candidate
+ * @return rows per second over one epoch, 0 when the network would not load
+ */
+double Autotune::trainRate(const shmea::GString& netName, glades::DataInput* sample,
+						   int batchSize)
+{
+	glades::NNetwork scratch;
+	if ((!scratch.load(netName)) || (!scratch.getNNInfo()))
+		return 0.0;
+
+	scratch.getNNInfo()->setBatchSize(batchSize);
+	scratch.terminator.setEpoch(scratch.getEpochs() + 1);
+
+	Stopwatch timer;
+	glades::train(&scratch, sample);
+	double seconds = timer.elapsedMs() / 1000.0;
+	if (seconds <= 0.0)
+		return 0.0;
+
+	return (double)sample->getTrainSize() / seconds;
+}
+
+/*!
+ * @brief pick the fastest batch size for a network
+ * @details each candidate trains one epoch over the last SAMPLE_ROWS rows of the input;
+ * the winner is cached under the network's model key
+ * @param netName the network
+ * @param di the training input
+ * @return the batch size, or -1 when nothing could be timed
+ */
+int Autotune::tuneBatchSize(const shmea::GString& netName, const glades::DataInput* di)
+{
+	glades::NNetwork cNetwork;
+	if ((!di) || (!cNetwork.load(netName)))
+		return -1;
+
+	IndexedInput sample(di);
+	unsigned int total = di->getTrainSize();
+	sample.incremental((total > SAMPLE_ROWS) ? total - SAMPLE_ROWS : 0, 0.0);
+
+	int best = -1;
+	double bestRate = 0.0;
+	for (unsigned int i = 0; i < BATCH_CANDIDATE_COUNT; ++i)
+	{
+		double rate = trainRate(netName, &sample, BATCH_CANDIDATES[i]);
+		printf("[DATA] batch size %d: %.0f rows/s\n", BATCH_CANDIDATES[i], rate);
+		if (rate > bestRate)
+		{
+			best = BATCH_CANDIDATES[i];
+			bestRate = rate;
+		}
+	}
+
+	if ((best >= 0) && (!store(modelKey(cNetwork.getNNInfo()), best)))
+		printf("[DATA] Unable to write \"%s\"\n", path().c_str());
+
+	return best;
+}
+
+double Autotune::importSeconds(const shmea::GString& fname, unsigned int threads)
+{
+	DenseInput dense;
+	Stopwatch timer;
+	if (!dense.importParallel(fname, threads))
+		return -1.0;
+
+	return timer.elapsedMs() / 1000.0;
+}
+
+/*!
+ * @brief pick the fastest csv loader thread count for this machine
+ * @details powers of two up to the core count, each timing a full parallel import; csv files
+ * under InputLoader::PARALLEL_THRESHOLD are read on one thread and are not timed
+ * @param fname the csv path, as InputLoader resolved it
+ * @return the thread count, or 0 when nothing could be timed
+ */
+unsigned int Autotune::tuneThreads(const shmea::GString& fname)
+{
+	if (CSVReader::fileSize(fname) <= InputLoader::PARALLEL_THRESHOLD)
+		return 0;
+
+	unsigned int best = 0;
+	double bestSeconds = 0.0;
+	for (unsigned int threads = 1; threads <= ThreadPool::cores(); threads *= 2)
+	{
+		double seconds = importSeconds(fname, threads);
+		printf("[DATA] %u loader threads: %.3fs\n", threads, seconds);
+		if ((seconds >= 0.0) && ((best == 0) || (seconds < bestSeconds)))
+		{
+			best = threads;
+			bestSeconds = seconds;
+		}
+	}
+
+	if ((best > 0) && (!store(hostKey(), best)))
+		printf("[DATA] Unable to write \"%s\"\n", path().c_str());
+
+	return best;
+}
+
+/*!
+ * @brief use the tuned batch size for a network
+ * @param cNetwork the loaded network
+ * @return whether a tuned batch size was found and set
+ */
+bool Autotune::applyBatchSize(glades::NNetwork& cNetwork)
+{
+	glades::NNInfo* cInfo = cNetwork.getNNInfo();
+	int batchSize = 0;
+	if ((!cInfo) || (!lookup(modelKey(cInfo), batchSize)))
+		return false;
+
+	if (cInfo->getBatchSize() != batchSize)
+	{
+		printf("[DATA] Using the tuned batch size %d for \"%s\"\n", batchSize,
+			   cInfo->getName().c_str());
+		cInfo->setBatchSize(batchSize);
+	}
+	return true;
+}
+
+/*!
+ * @brief the csv loader thread count to use
+ * @param requested the count asked for, 0 for automatic
+ * @return requested when set, otherwise the tuned count or 0
+ */
+unsigned int Autotune::loaderThreads(unsigned int requested)
+{
+	if (requested > 0)
+		return requested;
+
+	int threads = 0;
+	if ((!lookup(hostKey(), threads)) || (threads < 0))
+		return 0;
+
+	return (unsigned int)threads;
+}
@@ -0,0 +1,70 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _AUTOTUNE
+#define _AUTOTUNE
+
+#include "Backend/Database/GString.h"
+#include <string>
+#include <vector>
+
+namespace glades {
+class DataInput;
+class NNetwork;
+class NNInfo;
+};
+
+// Measured settings for this machine, written by "nncreator tune" and read
+// by every later run. The csv loader thread count is keyed on the host alone;
+// the batch size is keyed on the host and the network's layer shapes, and is
+// chosen by timing a short run of each candidate on a scratch copy of the
+// network. Entries live in one text file, one "key value" line each.
+class Autotune
+{
+private:
+	static bool read(std::vector<std::pair<std::string, int> >&);
+	static bool lookup(const std::string&, int&);
+	static bool store(const std::string&, int);
+
+	static double trainRate(const shmea::GString&, glades::DataInput*, int);
+	static double importSeconds(const shmea::GString&, unsigned int);
+
+public:
+	// training rows timed per batch size candidate
+	static const unsigned int SAMPLE_ROWS = 2048;
+
+	static std::string hostKey();
+	static std::string modelKey(const glades::NNInfo*);
+	static std::string path();
+
+	static int tuneBatchSize(const shmea::GString&, const glades::DataInput*);
+	static unsigned int tuneThreads(const shmea::GString&);
+
+	static bool applyBatchSize(glades::NNetwork&);
+	static unsigned int loaderThreads(unsigned int);
+};
+
+#endif
@@ -0,0 +1,344 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "bincache.h"
+#include "../core/atomicfile.h"
+#include "../core/md5.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Machine Learning/GMath/OHE.h"
+#include "denseinput.h"
+#include <fcntl.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+static const char BIN_MAGIC[8] = {'N', 'N', 'B', 'I', 'N', '\0', '\0', '\0'};
+static const size_t SAMPLE_BYTES = 1024 * 1024;
+
+// fixed part of the file
+struct BinHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t floatSize;
+	char key[32];
+	uint64_t metaOffset;
+	uint64_t metaBytes;
+	uint32_t rows[4];
+	uint32_t cols[4];
+	uint32_t stride[4];
+	uint64_t dataOffset[4];
+};
+
+static uint64_t alignUp(uint64_t value)
+{
+	return (value + FloatMatrix::ALIGNMENT - 1) & ~((uint64_t)FloatMatrix::ALIGNMENT - 1);
+}
+
+static void putU32(std::string& dst, uint32_t value)
+{
+	dst.append((const char*)&value, sizeof(value));
+}
+
+template <class T>
+static void putValue(std::string& dst, T value)
+{
+	dst.append((const char*)&value, sizeof(value));
+}
+
+template <class T>
+static bool getValue(const char*& src, const char* stop, T& value)
+{
+	if (stop - src < (ptrdiff_t)sizeof(value))
+		return false;
+
+	memcpy(&value, src, sizeof(value));
+	src += sizeof(value);
+	return true;
+}
+
+static bool getU32(const char*& src, const char* stop, uint32_t& value)
+{
+	return getValue(src, stop, value);
+}
+
+shmea::GString BinCache::cachePath(const shmea::GString& fname)
+{
+	return shmea::GString((std::string(fname.c_str()) + ".nnbin").c_str());
+}
+
+/*!
+ * @brief cache key for a source file
+ * @details md5 over the size, the mtime and the first and last MB of the file; cheap enough for
+ * multi GB sources while still catching in place edits
+ * @param fname the source csv
+ * @return the hex digest, or an empty string when the file is missing
+ */
+std::string BinCache::sourceKey(const shmea::GString& fname)
+{
+	struct stat st;
+	if (stat(fname.c_str(), &st) != 0)
+		return "";
+
+	FILE* fd = fopen(fname.c_str(), "rb");
+	if (!fd)
+		return "";
+
+	MD5 digest;
+	char stamp[64];
+	sprintf(stamp, "%lld:%lld", (long long)st.st_size, (long long)st.st_mtime);
+	digest.update(stamp, strlen(stamp));
+
+	std::vector<char> sample(SAMPLE_BYTES);
+	size_t bytesRead = fread(&sample[0], 1, SAMPLE_BYTES, fd);
+	digest.update(&sample[0], bytesRead);
+
+	if ((int64_t)st.st_size > (int64_t)(2 * SAMPLE_BYTES))
+	{
+		fseeko(fd, (off_t)(st.st_size - SAMPLE_BYTES), SEEK_SET);
+		bytesRead = fread(&sample[0], 1, SAMPLE_BYTES, fd);
+		digest.update(&sample[0], bytesRead);
+	}
+
+	fclose(fd);
+	return digest.finalize().hexdigest();
+}
+
+/*!
+ * @brief write the cache for a dataset
+ * @details written to a temp file first and renamed into place, so readers never see a partial
+ * cache
+ * @param di the decoded dataset
+ * @param fname the source csv
+ * @return whether the cache was written
+ */
+bool BinCache::save(const DenseInput& di, const shmea::GString& fname)
+{
+	std::string key = sourceKey(fname);
+	if (key.length() != KEY_LEN)
+		return false;
+
+	// categorical flags and dictionaries
+	std::string meta;
+	putU32(meta, di.featureIsCategorical.size());
+	for (unsigned int c = 0; c < di.featureIsCategorical.size(); ++c)
+	{
+		std::vector<std::string> classes;
+		if ((c < di.OHEMaps.size()) && (di.OHEMaps[c]) && (di.featureIsCategorical[c]))
+			classes = di.OHEMaps[c]->getStrings();
+
+		ColumnStats cStats;
+		if (c < di.columnStats.size())
+			cStats = di.columnStats[c];
+
+		putU32(meta, di.featureIsCategorical[c] ? 1 : 0);
+		putValue<int64_t>(meta, cStats.count);
+		putValue<double>(meta, cStats.mean);
+		putValue<double>(meta, cStats.m2);
+		putValue<float>(meta, cStats.min);
+		putValue<float>(meta, cStats.max);
+		putU32(meta, classes.size());
+		for (unsigned int i = 0; i < classes.size(); ++i)
+		{
+			putU32(meta, classes[i].length());
+			meta += classes[i];
+		}
+	}
+
+	const FloatMatrix* matrices[MATRIX_COUNT] = {&di.trainMatrix, &di.trainExpectedMatrix,
+												 &di.testMatrix, &di.testExpectedMatrix};
+
+	BinHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BIN_MAGIC, sizeof(BIN_MAGIC));
+	header.version = VERSION;
+	header.floatSize = sizeof(float);
+	memcpy(header.key, key.c_str(), KEY_LEN);
+	header.metaOffset = sizeof(header);
+	header.metaBytes = meta.size();
+
+	uint64_t offset = alignUp(header.metaOffset + header.metaBytes);
+	for (unsigned int m = 0; m < MATRIX_COUNT; ++m)
+	{
+		header.rows[m] = matrices[m]->numberOfRows();
+		header.cols[m] = matrices[m]->numberOfCols();
+		header.stride[m] = matrices[m]->getStride();
+		header.dataOffset[m] = offset;
+		offset = alignUp(offset + (uint64_t)header.rows[m] * header.stride[m] * sizeof(float));
+	}
+
+	shmea::GString path = cachePath(fname);
+	AtomicFile file;
+	if (!file.open(path.c_str()))
+		return false;
+
+	bool ok = file.write(&header, sizeof(header));
+	if ((ok) && (!meta.empty()))
+		ok = file.write(meta.data(), meta.size());
+
+	static const char zeros[FloatMatrix::ALIGNMENT] = {0};
+	uint64_t written = header.metaOffset + header.metaBytes;
+	for (unsigned int m = 0; (ok) && (m < MATRIX_COUNT); ++m)
+	{
+		ok = file.write(zeros, header.dataOffset[m] - written);
+		written = header.dataOffset[m];
+
+		size_t count = (size_t)header.rows[m] * header.stride[m];
+		if ((ok) && (count > 0))
+			ok = file.write(matrices[m]->rowPtr(0), count * sizeof(float));
+		written += count * sizeof(float);
+	}
+
+	// the cache can always be rebuilt, so skip the fsyncs
+	if ((!ok) || (!file.commit(false)))
+	{
+		printf("[DATA] Unable to write cache \"%s\"\n", path.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+/*!
+ * @brief map a cached dataset
+ * @details the matrices point straight into the mapping, so nothing is parsed or copied; the
+ * mapping is released by DenseInput::clear
+ * @param di cleared and filled on success
+ * @param fname the source csv
+ * @return false when there is no usable cache for the current source
+ */
+bool BinCache::load(DenseInput& di, const shmea::GString& fname)
+{
+	shmea::GString path = cachePath(fname);
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(BinHeader)))
+	{
+		close(fd);
+		return false;
+	}
+
+	size_t mapBytes = (size_t)st.st_size;
+	void* base = mmap(NULL, mapBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return false;
+
+	const char* bytes = (const char*)base;
+	BinHeader header;
+	memcpy(&header, bytes, sizeof(header));
+
+	std::string key = sourceKey(fname);
+	bool ok = (memcmp(header.magic, BIN_MAGIC, sizeof(BIN_MAGIC)) == 0) &&
+			  (header.version == VERSION) && (header.floatSize == sizeof(float)) &&
+			  (key.length() == KEY_LEN) && (memcmp(header.key, key.c_str(), KEY_LEN) == 0) &&
+			  (header.metaOffset + header.metaBytes <= mapBytes);
+
+	for (unsigned int m = 0; (ok) && (m < MATRIX_COUNT); ++m)
+	{
+		uint64_t end =
+			header.dataOffset[m] + (uint64_t)header.rows[m] * header.stride[m] * sizeof(float);
+		ok = (header.dataOffset[m] % FloatMatrix::ALIGNMENT == 0) && (end <= mapBytes) &&
+			 (header.cols[m] <= header.stride[m]);
+	}
+
+	if (!ok)
+	{
+		munmap(base, mapBytes);
+		return false;
+	}
+
+	di.clear();
+
+	// categorical flags and dictionaries
+	const char* cursor = bytes + header.metaOffset;
+	const char* stop = cursor + header.metaBytes;
+	uint32_t columnCount = 0;
+	ok = getU32(cursor, stop, columnCount);
+	for (uint32_t c = 0; (ok) && (c < columnCount); ++c)
+	{
+		uint32_t categorical = 0;
+		uint32_t classCount = 0;
+		ColumnStats cStats;
+		ok = (getU32(cursor, stop, categorical)) && (getValue(cursor, stop, cStats.count)) &&
+			 (getValue(cursor, stop, cStats.mean)) && (getValue(cursor, stop, cStats.m2)) &&
+			 (getValue(cursor, stop, cStats.min)) && (getValue(cursor, stop, cStats.max)) &&
+			 (getU32(cursor, stop, classCount));
+		if (!ok)
+			break;
+
+		glades::OHE* cOHE = NULL;
+		if (categorical)
+			cOHE = new glades::OHE();
+
+		for (uint32_t i = 0; (ok) && (i < classCount); ++i)
+		{
+			uint32_t len = 0;
+			ok = (getU32(cursor, stop, len)) && (stop - cursor >= (ptrdiff_t)len);
+			if ((ok) && (cOHE))
+				cOHE->addString(std::string(cursor, len));
+			if (ok)
+				cStats.addCategory(cursor, len);
+			if (ok)
+				cursor += len;
+		}
+
+		cStats.categorical = (categorical != 0);
+		cStats.finalize(ColumnStats::ZSCORE);
+		di.columnStats.push_back(cStats);
+
+		di.featureIsCategorical.push_back(categorical != 0);
+		di.OHEMaps.push_back(cOHE);
+	}
+	di.ownsOHE = true;
+
+	if (!ok)
+	{
+		di.clear();
+		munmap(base, mapBytes);
+		return false;
+	}
+
+	FloatMatrix* matrices[MATRIX_COUNT] = {&di.trainMatrix, &di.trainExpectedMatrix,
+										   &di.testMatrix, &di.testExpectedMatrix};
+	for (unsigned int m = 0; m < MATRIX_COUNT; ++m)
+	{
+		float* data = (float*)((char*)base + header.dataOffset[m]);
+		matrices[m]->wrap(data, header.rows[m], header.cols[m], header.stride[m]);
+	}
+
+	di.mapping = base;
+	di.mappingBytes = mapBytes;
+	di.name = fname;
+	di.loaded = true;
+	return true;
+}
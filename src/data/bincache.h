@@ -0,0 +1,60 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _BINCACHE
+#define _BINCACHE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+namespace shmea {
+class GString;
+};
+
+class DenseInput;
+
+// Binary cache of a decoded csv dataset, stored next to the source as
+// "<file>.nnbin". It holds the four float matrices (64 byte aligned, so
+// they can be used in place once mapped), the categorical flags, the
+// category dictionaries and the raw column statistics. The key covers the source size, mtime and its
+// first and last MB, so an edited csv is never served from a stale cache.
+class BinCache
+{
+private:
+	static const uint32_t VERSION = 2;
+	static const unsigned int KEY_LEN = 32;
+	static const unsigned int MATRIX_COUNT = 4;
+
+public:
+	static shmea::GString cachePath(const shmea::GString&);
+	static std::string sourceKey(const shmea::GString&);
+
+	static bool save(const DenseInput&, const shmea::GString&);
+	static bool load(DenseInput&, const shmea::GString&);
+};
+
+#endif
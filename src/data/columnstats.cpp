@@ -0,0 +1,311 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "columnstats.h"
+#include <math.h>
+#include <string.h>
+
+// slots in a fresh dictionary; it doubles when half full
+static const unsigned int INITIAL_SLOTS = 16;
+
+ColumnStats::ColumnStats()
+{
+	clear();
+}
+
+void ColumnStats::clear()
+{
+	categorical = false;
+	count = 0;
+	mean = 0.0;
+	m2 = 0.0;
+	min = 0.0f;
+	max = 0.0f;
+	categorySlots.clear();
+	categoryHashes.clear();
+	categoryOrder.clear();
+	center = 0.0f;
+	scale = 0.0f;
+}
+
+void ColumnStats::add(float value)
+{
+	if ((count == 0) || (value < min))
+		min = value;
+	if ((count == 0) || (value > max))
+		max = value;
+
+	++count;
+	double delta = value - mean;
+	mean += delta / (double)count;
+	m2 += delta * (value - mean);
+}
+
+/*!
+ * @brief add a strided run of values
+ * @details folds the run into local accumulators first and merges once, which keeps the inner
+ * loop free of the min/max branches on the shared state
+ * @param values the first value
+ * @param n the number of values
+ * @param stride floats between consecutive values
+ */
+void ColumnStats::add(const float* values, unsigned int n, unsigned int stride)
+{
+	if ((!values) || (n == 0))
+		return;
+
+	ColumnStats local;
+	float localMin = values[0];
+	float localMax = values[0];
+	double localMean = 0.0;
+	double localM2 = 0.0;
+	for (unsigned int i = 0; i < n; ++i)
+	{
+		float value = values[(size_t)i * stride];
+		localMin = value < localMin ? value : localMin;
+		localMax = value > localMax ? value : localMax;
+
+		double delta = value - localMean;
+		localMean += delta / (double)(i + 1);
+		localM2 += delta * (value - localMean);
+	}
+
+	local.count = n;
+	local.mean = localMean;
+	local.m2 = localM2;
+	local.min = localMin;
+	local.max = localMax;
+	merge(local);
+}
+
+/*!
+ * @brief FNV-1a of a category
+ * @param key the category bytes
+ * @param len the bytes
+ * @return the hash
+ */
+uint32_t ColumnStats::hashCategory(const char* key, unsigned int len)
+{
+	uint32_t hash = 2166136261u;
+	for (unsigned int i = 0; i < len; ++i)
+	{
+		hash ^= (unsigned char)key[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/*!
+ * @brief find the slot of a category, or the empty slot it belongs in
+ * @details linear probing; the stored hashes skip most string compares
+ * @param key the category bytes
+ * @param len the bytes
+ * @param hash the category's hash
+ * @return the slot
+ */
+unsigned int ColumnStats::findSlot(const char* key, unsigned int len, uint32_t hash) const
+{
+	unsigned int mask = categorySlots.size() - 1;
+	unsigned int slot = hash & mask;
+	while (categorySlots[slot] != 0)
+	{
+		unsigned int index = categorySlots[slot] - 1;
+		const std::string& cCategory = categoryOrder[index];
+		if ((categoryHashes[index] == hash) && (cCategory.size() == len) &&
+			(memcmp(cCategory.data(), key, len) == 0))
+			return slot;
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+void ColumnStats::growCategories()
+{
+	unsigned int slotCount = (categorySlots.empty()) ? INITIAL_SLOTS : categorySlots.size() * 2;
+	categorySlots.assign(slotCount, 0);
+
+	unsigned int mask = slotCount - 1;
+	for (unsigned int i = 0; i < categoryOrder.size(); ++i)
+	{
+		unsigned int slot = categoryHashes[i] & mask;
+		while (categorySlots[slot] != 0)
+			slot = (slot + 1) & mask;
+		categorySlots[slot] = i + 1;
+	}
+}
+
+/*!
+ * @brief add a category if it is new
+ * @param key the category bytes, e.g. a field still in the csv buffer
+ * @param len the bytes
+ */
+void ColumnStats::addCategory(const char* key, unsigned int len)
+{
+	if ((categoryOrder.size() + 1) * 2 > categorySlots.size())
+		growCategories();
+
+	uint32_t hash = hashCategory(key, len);
+	unsigned int slot = findSlot(key, len, hash);
+	if (categorySlots[slot] != 0)
+		return;
+
+	categoryOrder.push_back(std::string(key, len));
+	categoryHashes.push_back(hash);
+	categorySlots[slot] = categoryOrder.size();
+}
+
+void ColumnStats::addCategory(const std::string& key)
+{
+	addCategory(key.data(), key.size());
+}
+
+/*!
+ * @brief merge another partial result
+ * @details Chan's pairwise update for the mean and the squared deviations; categories are
+ * appended in the other's first-seen order, so merging ranges in file order matches one pass
+ * @param other the partial stats to fold in
+ */
+void ColumnStats::merge(const ColumnStats& other)
+{
+	for (unsigned int i = 0; i < other.categoryOrder.size(); ++i)
+		addCategory(other.categoryOrder[i]);
+
+	if (other.count == 0)
+		return;
+
+	if (count == 0)
+	{
+		count = other.count;
+		mean = other.mean;
+		m2 = other.m2;
+		min = other.min;
+		max = other.max;
+		return;
+	}
+
+	if (other.min < min)
+		min = other.min;
+	if (other.max > max)
+		max = other.max;
+
+	int64_t total = count + other.count;
+	double delta = other.mean - mean;
+	mean += delta * ((double)other.count / (double)total);
+	m2 += other.m2 + delta * delta * ((double)count * (double)other.count / (double)total);
+	count = total;
+}
+
+/*!
+ * @brief cache the scaling
+ * @param type ZSCORE for (x - mean) / stddev, MINMAX for (x - min) / (max - min)
+ */
+void ColumnStats::finalize(int type)
+{
+	if (type == MINMAX)
+	{
+		float range = max - min;
+		center = min;
+		scale = (range > 0.0f) ? 1.0f / range : 0.0f;
+		return;
+	}
+
+	float stdDev = getStdDev();
+	center = getMean();
+	scale = (stdDev > 0.0f) ? 1.0f / stdDev : 0.0f;
+}
+
+float ColumnStats::getMean() const
+{
+	return (float)mean;
+}
+
+float ColumnStats::getVariance() const
+{
+	if (count == 0)
+		return 0.0f;
+
+	return (float)(m2 / (double)count);
+}
+
+float ColumnStats::getStdDev() const
+{
+	return (float)sqrt(getVariance());
+}
+
+/*!
+ * @brief the one-hot index of a category
+ * @param key the category bytes
+ * @param len the bytes
+ * @return the index, or -1 when the category was never seen
+ */
+int ColumnStats::getCategoryIndex(const char* key, unsigned int len) const
+{
+	if (categorySlots.empty())
+		return -1;
+
+	unsigned int slot = findSlot(key, len, hashCategory(key, len));
+	return (int)categorySlots[slot] - 1;
+}
+
+int ColumnStats::getCategoryIndex(const std::string& key) const
+{
+	return getCategoryIndex(key.data(), key.size());
+}
+
+unsigned int ColumnStats::getCategoryCount() const
+{
+	return categoryOrder.size();
+}
+
+float ColumnStats::standardize(float value) const
+{
+	return (value - center) * scale;
+}
+
+float ColumnStats::unstandardize(float value) const
+{
+	if (scale == 0.0f)
+		return center;
+
+	return value / scale + center;
+}
+
+/*!
+ * @brief standardize a strided run in place
+ * @param values the first value
+ * @param n the number of values
+ * @param stride floats between consecutive values
+ */
+void ColumnStats::standardize(float* values, unsigned int n, unsigned int stride) const
+{
+	if (!values)
+		return;
+
+	const float cCenter = center;
+	const float cScale = scale;
+	for (unsigned int i = 0; i < n; ++i)
+		values[(size_t)i * stride] = (values[(size_t)i * stride] - cCenter) * cScale;
+}
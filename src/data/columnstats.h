@@ -0,0 +1,94 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _COLUMNSTATS
+#define _COLUMNSTATS
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Per column statistics gathered in a single pass. Numeric columns use
+// Welford's running mean/variance, so partial results from separate ranges
+// can be merged exactly; categorical columns keep a dictionary in first-seen
+// order. finalize() caches the scale factors so standardizing a value is one
+// subtract and one multiply. The dictionary is an open addressed table of
+// indices into categoryOrder, looked up straight from the csv buffer, so
+// each categorical field costs a hash and usually one compare, not a string
+// copy and a tree walk.
+class ColumnStats
+{
+private:
+	// categoryOrder index + 1 per slot, 0 when empty; a power of two long
+	std::vector<unsigned int> categorySlots;
+	std::vector<uint32_t> categoryHashes;
+
+	unsigned int findSlot(const char*, unsigned int, uint32_t) const;
+	void growCategories();
+
+	static uint32_t hashCategory(const char*, unsigned int);
+
+public:
+	static const int ZSCORE = 0;
+	static const int MINMAX = 1;
+
+	bool categorical;
+	int64_t count;
+	double mean;
+	double m2;
+	float min;
+	float max;
+	std::vector<std::string> categoryOrder;
+
+	// cached by finalize()
+	float center;
+	float scale;
+
+	ColumnStats();
+
+	void clear();
+	void add(float);
+	void add(const float*, unsigned int, unsigned int = 1);
+	void addCategory(const char*, unsigned int);
+	void addCategory(const std::string&);
+	void merge(const ColumnStats&);
+	void finalize(int = ZSCORE);
+
+	// gets
+	float getMean() const;
+	float getVariance() const;
+	float getStdDev() const;
+	int getCategoryIndex(const char*, unsigned int) const;
+	int getCategoryIndex(const std::string&) const;
+	unsigned int getCategoryCount() const;
+
+	float standardize(float) const;
+	float unstandardize(float) const;
+	void standardize(float*, unsigned int, unsigned int = 1) const;
+};
+
+#endif
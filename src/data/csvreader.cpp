@@ -0,0 +1,445 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "csvreader.h"
+#include "Backend/Database/GString.h"
+#include "csvscan.h"
+#include <sys/stat.h>
+
+CSVReader::CSVReader()
+{
+	fd = NULL;
+	delimiter = ',';
+	buffer = NULL;
+	bufSize = 0;
+	bufLen = 0;
+	bufPos = 0;
+	bufOffset = 0;
+	limit = -1;
+	eof = true;
+}
+
+CSVReader::CSVReader(char newDelimiter)
+{
+	fd = NULL;
+	delimiter = newDelimiter;
+	buffer = NULL;
+	bufSize = 0;
+	bufLen = 0;
+	bufPos = 0;
+	bufOffset = 0;
+	limit = -1;
+	eof = true;
+}
+
+CSVReader::~CSVReader()
+{
+	close();
+	if (buffer)
+		free(buffer);
+	buffer = NULL;
+}
+
+bool CSVReader::open(const shmea::GString& fname)
+{
+	close();
+
+	fd = fopen(fname.c_str(), "rb");
+	if (!fd)
+	{
+		printf("[CSV] Unable to open \"%s\"\n", fname.c_str());
+		return false;
+	}
+
+	if (!buffer)
+	{
+		bufSize = DEFAULT_CHUNK;
+		buffer = (char*)malloc(bufSize);
+		if (!buffer)
+		{
+			close();
+			return false;
+		}
+	}
+
+	bufLen = 0;
+	bufPos = 0;
+	bufOffset = 0;
+	limit = -1;
+	eof = false;
+	return true;
+}
+
+void CSVReader::close()
+{
+	if (fd)
+		fclose(fd);
+
+	fd = NULL;
+	bufLen = 0;
+	bufPos = 0;
+	bufOffset = 0;
+	limit = -1;
+	eof = true;
+}
+
+bool CSVReader::isOpen() const
+{
+	return fd != NULL;
+}
+
+/*!
+ * @brief seek to a record
+ * @details the offset must be the start of a record, i.e. a value returned by tell()
+ * @param offset byte offset into the file
+ * @return whether the seek succeeded
+ */
+bool CSVReader::seek(int64_t offset)
+{
+	if (!fd)
+		return false;
+
+	if (fseeko(fd, (off_t)offset, SEEK_SET) != 0)
+		return false;
+
+	bufLen = 0;
+	bufPos = 0;
+	bufOffset = offset;
+	eof = false;
+	return true;
+}
+
+/*!
+ * @brief seek to the first record at or after an offset
+ * @details used to cut a file into byte ranges on record boundaries
+ * @param offset any byte offset into the file
+ * @return whether the seek succeeded
+ */
+bool CSVReader::alignTo(int64_t offset)
+{
+	if (offset <= 0)
+		return seek(0);
+
+	// a record starts at offset only if the byte before it ends a line
+	if (!seek(offset - 1))
+		return false;
+
+	while (true)
+	{
+		if (bufPos == bufLen)
+		{
+			if (!fill())
+				return true;
+		}
+
+		const char* nl = (const char*)memchr(&buffer[bufPos], '\n', bufLen - bufPos);
+		if (nl)
+		{
+			bufPos = (nl - buffer) + 1;
+			return true;
+		}
+
+		bufPos = bufLen;
+	}
+}
+
+/*!
+ * @brief stop at an offset
+ * @details readRecord reports the end of the file once the next record starts at or past the
+ * limit; -1 removes the limit
+ * @param newLimit the end of the byte range
+ */
+void CSVReader::setLimit(int64_t newLimit)
+{
+	limit = newLimit;
+}
+
+/*!
+ * @brief current position
+ * @return the byte offset of the next record
+ */
+int64_t CSVReader::tell() const
+{
+	return bufOffset + (int64_t)bufPos;
+}
+
+/*!
+ * @brief refill the buffer
+ * @details keeps the unread tail, growing the buffer when a single record does not fit
+ * @return whether any new bytes were read
+ */
+bool CSVReader::fill()
+{
+	if ((!fd) || (eof))
+		return false;
+
+	if (bufPos > 0)
+	{
+		memmove(buffer, &buffer[bufPos], bufLen - bufPos);
+		bufOffset += (int64_t)bufPos;
+		bufLen -= bufPos;
+		bufPos = 0;
+	}
+
+	if (bufLen == bufSize)
+	{
+		char* newBuffer = (char*)realloc(buffer, bufSize * 2);
+		if (!newBuffer)
+			return false;
+
+		buffer = newBuffer;
+		bufSize *= 2;
+	}
+
+	size_t bytesRead = fread(&buffer[bufLen], 1, bufSize - bufLen, fd);
+	if (bytesRead == 0)
+	{
+		eof = true;
+		return false;
+	}
+
+	bufLen += bytesRead;
+	return true;
+}
+
+static inline bool isPadding(char c)
+{
+	return (c == ' ') || (c == '\t');
+}
+
+/*!
+ * @brief read the next record
+ * @details finds the newline with memchr and every delimiter in one CSVScan pass, strips CR/LF and
+ * surrounding spaces from each field and skips blank lines
+ * @param fields cleared and filled with the fields of the record
+ * @return false at the end of the file
+ */
+bool CSVReader::readRecord(std::vector<CSVField>& fields)
+{
+	fields.clear();
+
+	size_t scanned = 0;
+	while (true)
+	{
+		if ((limit >= 0) && (tell() >= limit))
+			return false;
+
+		// find the end of the line, without rescanning bytes already checked
+		const char* nl = NULL;
+		size_t avail = bufLen - bufPos;
+		if (avail > scanned)
+			nl = (const char*)memchr(&buffer[bufPos + scanned], '\n', avail - scanned);
+
+		size_t lineEnd = 0;
+		if (nl)
+			lineEnd = nl - buffer;
+		else
+		{
+			// make room and retry; a missing newline on the last line is fine
+			scanned = avail;
+			if (fill())
+				continue;
+
+			if (bufPos == bufLen)
+				return false;
+
+			lineEnd = bufLen;
+		}
+
+		size_t lineStart = bufPos;
+		bufPos = (lineEnd < bufLen) ? lineEnd + 1 : lineEnd;
+		scanned = 0;
+
+		size_t end = lineEnd;
+		if ((end > lineStart) && (buffer[end - 1] == '\r'))
+			--end;
+
+		if (end == lineStart)
+			continue;
+
+		// split the fields
+		const char* line = &buffer[lineStart];
+		size_t lineLen = end - lineStart;
+		if (delimiters.size() < lineLen + 1)
+			delimiters.resize(lineLen + 1);
+		size_t delimCount = CSVScan::find(line, lineLen, delimiter, &delimiters[0]);
+
+		// one field more than delimiters, sized up front instead of grown per field
+		fields.resize(delimCount + 1);
+		delimiters[delimCount] = (uint32_t)lineLen;
+		size_t fieldStart = 0;
+		for (size_t d = 0; d <= delimCount; ++d)
+		{
+			size_t fieldStop = delimiters[d];
+
+			const char* a = line + fieldStart;
+			const char* b = line + fieldStop;
+			while ((a < b) && (isPadding(*a)))
+				++a;
+			while ((b > a) && (isPadding(b[-1])))
+				--b;
+
+			fields[d].ptr = a;
+			fields[d].len = (unsigned int)(b - a);
+			fieldStart = fieldStop + 1;
+		}
+
+		return true;
+	}
+}
+
+// exact powers of ten representable in a double
+static const double POW10[] = {1e0,	 1e1,  1e2,	 1e3,  1e4,	 1e5,  1e6,	 1e7,
+							   1e8,	 1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+							   1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static bool parseFloatSlow(const CSVField& field, float& value)
+{
+	if (field.len >= 64)
+		return false;
+
+	char tmp[64];
+	memcpy(tmp, field.ptr, field.len);
+	tmp[field.len] = '\0';
+
+	char* endPtr = NULL;
+	value = strtof(tmp, &endPtr);
+	return (endPtr == &tmp[field.len]);
+}
+
+/*!
+ * @brief parse a numeric field
+ * @details plain decimal and exponent forms with up to 19 significant digits are parsed
+ * directly; anything else (inf, nan, hex, long mantissas) goes through strtof
+ * @param field the field
+ * @param value set to the parsed value on success
+ * @return whether the whole field was a number
+ */
+bool CSVReader::parseFloat(const CSVField& field, float& value)
+{
+	if (field.len == 0)
+		return false;
+
+	const char* p = field.ptr;
+	const char* stop = field.ptr + field.len;
+
+	bool negative = false;
+	if ((*p == '-') || (*p == '+'))
+	{
+		negative = (*p == '-');
+		++p;
+	}
+
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool anyDigit = false;
+
+	// integer part
+	while ((p < stop) && (*p >= '0') && (*p <= '9'))
+	{
+		if (digits < 19)
+		{
+			mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+			if (mantissa > 0)
+				++digits;
+		}
+		else
+			++exponent;
+		anyDigit = true;
+		++p;
+	}
+
+	// fraction
+	if ((p < stop) && (*p == '.'))
+	{
+		++p;
+		while ((p < stop) && (*p >= '0') && (*p <= '9'))
+		{
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				if (mantissa > 0)
+					++digits;
+				--exponent;
+			}
+			anyDigit = true;
+			++p;
+		}
+	}
+
+	if (!anyDigit)
+		return parseFloatSlow(field, value);
+
+	// exponent
+	if ((p < stop) && ((*p == 'e') || (*p == 'E')))
+	{
+		++p;
+		bool expNegative = false;
+		if ((p < stop) && ((*p == '-') || (*p == '+')))
+		{
+			expNegative = (*p == '-');
+			++p;
+		}
+
+		if ((p == stop) || (*p < '0') || (*p > '9'))
+			return false;
+
+		int expValue = 0;
+		while ((p < stop) && (*p >= '0') && (*p <= '9'))
+		{
+			if (expValue < 10000)
+				expValue = expValue * 10 + (*p - '0');
+			++p;
+		}
+
+		exponent += expNegative ? -expValue : expValue;
+	}
+
+	if (p != stop)
+		return false;
+
+	if ((digits >= 19) || (exponent < -22) || (exponent > 22))
+		return parseFloatSlow(field, value);
+
+	double result = (double)mantissa;
+	if (exponent < 0)
+		result /= POW10[-exponent];
+	else
+		result *= POW10[exponent];
+
+	value = (float)(negative ? -result : result);
+	return true;
+}
+
+int64_t CSVReader::fileSize(const shmea::GString& fname)
+{
+	struct stat st;
+	if (stat(fname.c_str(), &st) != 0)
+		return -1;
+
+	return (int64_t)st.st_size;
+}
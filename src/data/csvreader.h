@@ -0,0 +1,118 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _CSVREADER
+#define _CSVREADER
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace shmea {
+class GString;
+};
+
+// A single field of the current record. Points into the reader's buffer and
+// is only valid until the next call to readRecord.
+class CSVField
+{
+public:
+	const char* ptr;
+	unsigned int len;
+
+	CSVField()
+	{
+		ptr = NULL;
+		len = 0;
+	}
+
+	CSVField(const char* newPtr, unsigned int newLen)
+	{
+		ptr = newPtr;
+		len = newLen;
+	}
+
+	std::string toString() const
+	{
+		return std::string(ptr, len);
+	}
+
+	bool empty() const
+	{
+		return len == 0;
+	}
+};
+
+// Buffered, chunked CSV record reader. Only one chunk of the file is held in
+// memory at a time, so it can walk files larger than RAM. Records that
+// straddle a chunk boundary are carried over to the next fill.
+class CSVReader
+{
+private:
+	FILE* fd;
+	char delimiter;
+	char* buffer;
+	size_t bufSize;
+	size_t bufLen;
+	size_t bufPos;
+	int64_t bufOffset;
+	int64_t limit;
+	bool eof;
+
+	// delimiter offsets of the current line, reused across records
+	std::vector<uint32_t> delimiters;
+
+	bool fill();
+
+	// owns a FILE* and a buffer
+	CSVReader(const CSVReader&);
+	void operator=(const CSVReader&);
+
+public:
+	static const size_t DEFAULT_CHUNK = 1 << 20;
+
+	CSVReader();
+	CSVReader(char);
+	virtual ~CSVReader();
+
+	bool open(const shmea::GString&);
+	void close();
+	bool isOpen() const;
+	bool seek(int64_t);
+	bool alignTo(int64_t);
+	void setLimit(int64_t);
+	int64_t tell() const;
+
+	bool readRecord(std::vector<CSVField>&);
+
+	static bool parseFloat(const CSVField&, float&);
+	static int64_t fileSize(const shmea::GString&);
+};
+
+#endif
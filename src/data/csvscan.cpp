@@ -0,0 +1,216 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "csvscan.h"
+#include "../core/cpufeatures.h"
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+static size_t scanScalar(const char* line, size_t len, char delimiter, uint32_t* positions)
+{
+	size_t found = 0;
+	for (size_t i = 0; i < len; ++i)
+	{
+		if (line[i] == delimiter)
+			positions[found++] = (uint32_t)i;
+	}
+
+	return found;
+}
+
+// libc's memchr is vectorized already, but pays a call per field
+static size_t scanMemchr(const char* line, size_t len, char delimiter, uint32_t* positions)
+{
+	size_t found = 0;
+	const char* cursor = line;
+	const char* stop = line + len;
+	while ((cursor = (const char*)memchr(cursor, delimiter, stop - cursor)) != NULL)
+	{
+		positions[found++] = (uint32_t)(cursor - line);
+		++cursor;
+	}
+
+	return found;
+}
+
+// the bytes after the last whole block
+static inline size_t scanTail(const char* line, size_t len, size_t start, char delimiter,
+							  uint32_t* positions)
+{
+	size_t found = scanScalar(line + start, len - start, delimiter, positions);
+	for (size_t i = 0; i < found; ++i)
+		positions[i] += (uint32_t)start;
+
+	return found;
+}
+
+// one bit per matching byte of a block
+static inline size_t emitMask(uint64_t mask, size_t offset, uint32_t* positions)
+{
+	size_t found = 0;
+	while (mask)
+	{
+		positions[found++] = (uint32_t)(offset + __builtin_ctzll(mask));
+		mask &= mask - 1;
+	}
+
+	return found;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("sse2"))) static size_t scanSSE2(const char* line, size_t len,
+														char delimiter, uint32_t* positions)
+{
+	const __m128i needle = _mm_set1_epi8(delimiter);
+	size_t found = 0;
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16)
+	{
+		__m128i block = _mm_loadu_si128((const __m128i*)(line + i));
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+		found += emitMask(mask, i, positions + found);
+	}
+
+	return found + scanTail(line, len, i, delimiter, positions + found);
+}
+
+__attribute__((target("avx2"))) static size_t scanAVX2(const char* line, size_t len,
+														char delimiter, uint32_t* positions)
+{
+	const __m256i needle = _mm256_set1_epi8(delimiter);
+	size_t found = 0;
+	size_t i = 0;
+	for (; i + 32 <= len; i += 32)
+	{
+		__m256i block = _mm256_loadu_si256((const __m256i*)(line + i));
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+		found += emitMask(mask, i, positions + found);
+	}
+
+	return found + scanTail(line, len, i, delimiter, positions + found);
+}
+
+__attribute__((target("avx512f,avx512bw"))) static size_t scanAVX512(const char* line, size_t len,
+																	  char delimiter,
+																	  uint32_t* positions)
+{
+	const __m512i needle = _mm512_set1_epi8(delimiter);
+	size_t found = 0;
+	size_t i = 0;
+	for (; i + 64 <= len; i += 64)
+	{
+		__m512i block = _mm512_loadu_si512((const void*)(line + i));
+		uint64_t mask = (uint64_t)_mm512_cmpeq_epi8_mask(block, needle);
+		found += emitMask(mask, i, positions + found);
+	}
+
+	return found + scanTail(line, len, i, delimiter, positions + found);
+}
+
+#elif defined(__aarch64__)
+
+static size_t scanNEON(const char* line, size_t len, char delimiter, uint32_t* positions)
+{
+	const uint8x16_t needle = vdupq_n_u8((uint8_t)delimiter);
+	size_t found = 0;
+	size_t i = 0;
+	for (; i + 16 <= len; i += 16)
+	{
+		uint8x16_t matches = vceqq_u8(vld1q_u8((const uint8_t*)(line + i)), needle);
+
+		// narrow to four bits per byte, so a byte index is a bit index / 4
+		uint64_t mask = vget_lane_u64(
+			vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+		while (mask)
+		{
+			positions[found++] = (uint32_t)(i + (__builtin_ctzll(mask) >> 2));
+			mask &= ~(0xFULL << (__builtin_ctzll(mask) & ~3));
+		}
+	}
+
+	return found + scanTail(line, len, i, delimiter, positions + found);
+}
+
+#endif
+
+CSVScan::ScanFn CSVScan::scanFn = scanMemchr;
+const char* CSVScan::scanName = "memchr";
+
+/*!
+ * @brief pick the widest scan the CPU runs
+ * @details call once at startup, before the loaders start their threads
+ */
+void CSVScan::select()
+{
+	scanFn = scanMemchr;
+	scanName = "memchr";
+#if defined(__x86_64__) || defined(__i386__)
+	if (CPUFeatures::has(CPUFeatures::AVX512BW))
+	{
+		scanFn = scanAVX512;
+		scanName = "avx512bw";
+	}
+	else if (CPUFeatures::has(CPUFeatures::AVX2))
+	{
+		scanFn = scanAVX2;
+		scanName = "avx2";
+	}
+	else if (CPUFeatures::has(CPUFeatures::SSE2))
+	{
+		scanFn = scanSSE2;
+		scanName = "sse2";
+	}
+#elif defined(__aarch64__)
+	if (CPUFeatures::has(CPUFeatures::NEON))
+	{
+		scanFn = scanNEON;
+		scanName = "neon";
+	}
+#endif
+}
+
+const char* CSVScan::getName()
+{
+	return scanName;
+}
+
+/*!
+ * @brief find the delimiters of a line
+ * @param line the bytes, without the newline
+ * @param len the byte count
+ * @param delimiter the delimiter
+ * @param positions room for len offsets, filled in ascending order
+ * @return the number of delimiters
+ */
+size_t CSVScan::find(const char* line, size_t len, char delimiter, uint32_t* positions)
+{
+	return scanFn(line, len, delimiter, positions);
+}
@@ -0,0 +1,51 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _CSVSCAN
+#define _CSVSCAN
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Finds every delimiter of a CSV line in one pass. The vector version is
+// picked once from CPUFeatures by select(); until then, and on CPUs without
+// one, a memchr loop runs.
+class CSVScan
+{
+private:
+	typedef size_t (*ScanFn)(const char*, size_t, char, uint32_t*);
+
+	static ScanFn scanFn;
+	static const char* scanName;
+
+public:
+	static void select();
+	static const char* getName();
+
+	static size_t find(const char*, size_t, char, uint32_t*);
+};
+
+#endif
@@ -0,0 +1,206 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "datacache.h"
+#include "../core/metrics.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include "bincache.h"
+#include "csvreader.h"
+#include "denseinput.h"
+#include "distiller.h"
+#include "inputloader.h"
+#include "shardinput.h"
+#include "streaminput.h"
+#include "textinput.h"
+#include <stdio.h>
+
+static const int CACHE_HITS =
+	Metrics::counter("nncreator_data_cache_hits", "Jobs that shared an imported dataset");
+static const int CACHE_MISSES =
+	Metrics::counter("nncreator_data_cache_misses", "Jobs that imported their dataset");
+
+pthread_mutex_t DataCache::cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t DataCache::loadCond = PTHREAD_COND_INITIALIZER;
+std::map<std::string, DataCache::SharedData*> DataCache::datasets;
+std::map<const glades::DataInput*, DataCache::SharedData*> DataCache::holders;
+
+/*!
+ * @brief the cache key of a dataset
+ * @details the type and name plus the BinCache source key of the file InputLoader will read, so
+ * a dataset that is appended to or replaced gets a fresh import instead of the held one
+ * @param name the dataset name, as passed to InputLoader::load
+ * @param inputType the DataInput enum of the dataset
+ * @return the key
+ */
+std::string DataCache::keyOf(const shmea::GString& name, int inputType)
+{
+	shmea::GString path = name;
+	if ((inputType == glades::DataInput::CSV) || (inputType == glades::DataInput::TEXT))
+		path = "datasets/" + name;
+	else if (inputType == glades::DataInput::IMAGE)
+	{
+		shmea::GString packName = ShardInput::packPath(name);
+		if (CSVReader::fileSize(packName) > 0)
+			path = packName;
+	}
+
+	char typeName[16];
+	snprintf(typeName, sizeof(typeName), "%d:", inputType);
+	return std::string(typeName) + name.c_str() + ":" + BinCache::sourceKey(path);
+}
+
+/*!
+ * @brief whether concurrent jobs may read one import
+ * @details DenseInput and ShardInput serve rows from flat arrays or a read only mapping, and
+ * TextInput from plain vectors; each read builds a fresh GList, so several threads can read
+ * them at once. A StreamInput reads its file through one window that two jobs would keep
+ * stealing, so every job gets its own import of those. acquire flattens NumberInput and
+ * ImageInput, which hand out stored GLists with non atomic GPointer counts, before sharing.
+ * @param di the imported input
+ * @return true when it can be shared
+ */
+bool DataCache::shareable(const glades::DataInput* di)
+{
+	return ((dynamic_cast<const DenseInput*>(di)) || (dynamic_cast<const ShardInput*>(di)) ||
+			(dynamic_cast<const TextInput*>(di)));
+}
+
+/*!
+ * @brief get the shared import of a dataset
+ * @details imports it through InputLoader on first use; concurrent first jobs wait for a single
+ * import instead of reading the files once each. Every successful acquire must be paired with
+ * release.
+ * @param inputFName the dataset name, updated to the path that was loaded
+ * @param inputType the DataInput enum of the dataset
+ * @param threads the threads for a parallel import; 0 uses every core
+ * @return the shared input, or NULL when it does not load
+ */
+glades::DataInput* DataCache::acquire(shmea::GString& inputFName, int inputType,
+									  unsigned int threads)
+{
+	std::string key = keyOf(inputFName, inputType);
+
+	pthread_mutex_lock(&cacheMutex);
+	std::map<std::string, SharedData*>::iterator itr = datasets.find(key);
+	while ((itr != datasets.end()) && (!itr->second->ready))
+	{
+		pthread_cond_wait(&loadCond, &cacheMutex);
+		itr = datasets.find(key);
+	}
+
+	if (itr != datasets.end())
+	{
+		SharedData* cData = itr->second;
+		++cData->refs;
+		inputFName = cData->path.c_str();
+		pthread_mutex_unlock(&cacheMutex);
+		Metrics::add(CACHE_HITS);
+		printf("[DATA] Sharing \"%s\" with %u other jobs\n", inputFName.c_str(), cData->refs - 1);
+		return cData->input;
+	}
+
+	// import it outside the lock so other datasets keep loading
+	SharedData* cData = new SharedData();
+	cData->refs = 1;
+	cData->key = key;
+	datasets[key] = cData;
+	pthread_mutex_unlock(&cacheMutex);
+	Metrics::add(CACHE_MISSES);
+
+	glades::DataInput* di = InputLoader::load(inputFName, inputType, threads);
+
+	// a flat copy of stored GList rows can be read by every job
+	if ((di) && (!shareable(di)) && (!dynamic_cast<StreamInput*>(di)))
+		di = Distiller::toDense(di);
+
+	pthread_mutex_lock(&cacheMutex);
+	if (!di)
+	{
+		datasets.erase(key);
+		pthread_cond_broadcast(&loadCond);
+		pthread_mutex_unlock(&cacheMutex);
+
+		delete cData;
+		return NULL;
+	}
+
+	cData->input = di;
+	cData->path = inputFName.c_str();
+	cData->ready = true;
+	holders[di] = cData;
+
+	if (!shareable(di))
+		datasets.erase(key);
+	pthread_cond_broadcast(&loadCond);
+	pthread_mutex_unlock(&cacheMutex);
+
+	return di;
+}
+
+/*!
+ * @brief hand back an input from acquire
+ * @details the last release frees the import, so the next job reads the dataset again
+ * @param di the input
+ */
+void DataCache::release(const glades::DataInput* di)
+{
+	if (!di)
+		return;
+
+	SharedData* dropped = NULL;
+
+	pthread_mutex_lock(&cacheMutex);
+	std::map<const glades::DataInput*, SharedData*>::iterator holder = holders.find(di);
+	if ((holder != holders.end()) && (--holder->second->refs == 0))
+	{
+		dropped = holder->second;
+		holders.erase(holder);
+
+		std::map<std::string, SharedData*>::iterator itr = datasets.find(dropped->key);
+		if ((itr != datasets.end()) && (itr->second == dropped))
+			datasets.erase(itr);
+	}
+	pthread_mutex_unlock(&cacheMutex);
+
+	if (dropped)
+	{
+		InputLoader::release(dropped->input);
+		delete dropped;
+	}
+}
+
+/*!
+ * @brief the datasets currently held
+ * @return the count
+ */
+unsigned int DataCache::size()
+{
+	pthread_mutex_lock(&cacheMutex);
+	unsigned int count = datasets.size();
+	pthread_mutex_unlock(&cacheMutex);
+	return count;
+}
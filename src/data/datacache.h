@@ -0,0 +1,87 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _DATACACHE
+#define _DATACACHE
+
+#include <map>
+#include <pthread.h>
+#include <string>
+
+namespace shmea {
+class GString;
+};
+
+namespace glades {
+class DataInput;
+};
+
+// Process wide registry of imported datasets. Jobs that train or test on the
+// same dataset at the same time share one import, found by its name, type and
+// file stamp, instead of each holding a copy; the import is freed when the
+// last of them releases it. Only inputs whose rows are safe to read from
+// several threads at once are shared (see shareable): NumberInput and
+// ImageInput are flattened into a DenseInput first, and streamed files are
+// imported once per job. Shared inputs are read only: wrap
+// them in an IndexedInput or AugmentInput to change the order or the rows,
+// and load a private copy with InputLoader for anything that rewrites them
+// in place.
+class DataCache
+{
+private:
+	class SharedData
+	{
+	public:
+		unsigned int refs;
+		bool ready;
+		glades::DataInput* input;
+		std::string key;
+		std::string path;
+
+		SharedData()
+		{
+			refs = 0;
+			ready = false;
+			input = NULL;
+		}
+	};
+
+	static pthread_mutex_t cacheMutex;
+	static pthread_cond_t loadCond;
+	static std::map<std::string, SharedData*> datasets;
+	static std::map<const glades::DataInput*, SharedData*> holders;
+
+	static std::string keyOf(const shmea::GString&, int);
+
+public:
+	static glades::DataInput* acquire(shmea::GString&, int, unsigned int = 0);
+	static void release(const glades::DataInput*);
+	static bool shareable(const glades::DataInput*);
+
+	static unsigned int size();
+};
+
+#endif
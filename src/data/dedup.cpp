@@ -0,0 +1,340 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "dedup.h"
+#include "../core/profiler.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include "indexedinput.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// 64 bit multiply-rotate mixing in four independent lanes, as in xxHash
+static const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+
+static uint64_t rotl(uint64_t value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t mixLane(uint64_t lane, uint64_t word)
+{
+	return rotl(lane + word * PRIME2, 31) * PRIME1;
+}
+
+/*!
+ * @brief Dedup constructor
+ * @param newNear whether near duplicates are dropped as well as exact ones
+ * @param newWidth the image width, needed for near duplicates
+ * @param newHeight the image height, needed for near duplicates
+ */
+Dedup::Dedup(bool newNear, unsigned int newWidth, unsigned int newHeight)
+{
+	width = newWidth;
+	height = newHeight;
+	near = (newNear) && (width > 0) && (height > 0);
+}
+
+/*!
+ * @brief hash the values of a row
+ * @details four lanes over 8 bytes each per step keep the multiplies independent, so they
+ * pipeline instead of waiting on one another
+ * @param values the row
+ * @param count the values
+ * @return the hash
+ */
+uint64_t Dedup::contentHash(const float* values, unsigned int count)
+{
+	const char* bytes = (const char*)values;
+	size_t length = (size_t)count * sizeof(float);
+	uint64_t lanes[4] = {PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1};
+
+	size_t offset = 0;
+	for (; offset + 32 <= length; offset += 32)
+	{
+		uint64_t words[4];
+		memcpy(words, bytes + offset, sizeof(words));
+		for (unsigned int k = 0; k < 4; ++k)
+			lanes[k] = mixLane(lanes[k], words[k]);
+	}
+
+	uint64_t hash = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+	hash += length;
+	for (; offset + 8 <= length; offset += 8)
+	{
+		uint64_t word = 0;
+		memcpy(&word, bytes + offset, sizeof(word));
+		hash = rotl(hash ^ mixLane(0, word), 27) * PRIME1 + PRIME3;
+	}
+	for (; offset < length; ++offset)
+		hash = rotl(hash ^ ((unsigned char)bytes[offset] * PRIME3), 11) * PRIME1;
+
+	// final avalanche
+	hash ^= hash >> 33;
+	hash *= PRIME2;
+	hash ^= hash >> 29;
+	hash *= PRIME3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+/*!
+ * @brief average hash of an image row
+ * @details the channels are averaged to gray and the image to HASH_SIDE x HASH_SIDE cells; a
+ * bit is set for each cell brighter than the mean cell, so small changes in brightness,
+ * contrast or noise leave the hash alone
+ * @param values the row, pixels top row first with their channels together
+ * @param imageWidth the width
+ * @param imageHeight the height
+ * @param channels the values per pixel
+ * @return the hash
+ */
+uint64_t Dedup::perceptualHash(const float* values, unsigned int imageWidth,
+							   unsigned int imageHeight, unsigned int channels)
+{
+	float cells[HASH_SIDE * HASH_SIDE];
+	float total = 0.0f;
+	for (unsigned int cy = 0; cy < HASH_SIDE; ++cy)
+	{
+		unsigned int y0 = cy * imageHeight / HASH_SIDE;
+		unsigned int y1 = (cy + 1) * imageHeight / HASH_SIDE;
+		if (y1 <= y0)
+			y1 = y0 + 1;
+		for (unsigned int cx = 0; cx < HASH_SIDE; ++cx)
+		{
+			unsigned int x0 = cx * imageWidth / HASH_SIDE;
+			unsigned int x1 = (cx + 1) * imageWidth / HASH_SIDE;
+			if (x1 <= x0)
+				x1 = x0 + 1;
+
+			float sum = 0.0f;
+			for (unsigned int y = y0; (y < y1) && (y < imageHeight); ++y)
+			{
+				const float* row = values + ((size_t)y * imageWidth + x0) * channels;
+				unsigned int span = ((x1 < imageWidth) ? x1 : imageWidth) - x0;
+				for (unsigned int i = 0; i < span * channels; ++i)
+					sum += row[i];
+			}
+
+			cells[cy * HASH_SIDE + cx] = sum / ((y1 - y0) * (x1 - x0) * channels);
+			total += cells[cy * HASH_SIDE + cx];
+		}
+	}
+
+	float mean = total / (HASH_SIDE * HASH_SIDE);
+	uint64_t hash = 0;
+	for (unsigned int i = 0; i < HASH_SIDE * HASH_SIDE; ++i)
+	{
+		if (cells[i] > mean)
+			hash |= (1ULL << i);
+	}
+	return hash;
+}
+
+unsigned int Dedup::distance(uint64_t a, uint64_t b)
+{
+	return __builtin_popcountll(a ^ b);
+}
+
+bool Dedup::checkNear(uint64_t hash) const
+{
+	for (unsigned int b = 0; b < 4; ++b)
+	{
+		uint32_t key = (b << 16) | (uint32_t)((hash >> (16 * b)) & 0xFFFF);
+		std::map<uint32_t, std::vector<uint64_t> >::const_iterator itr = bands.find(key);
+		if (itr == bands.end())
+			continue;
+
+		for (unsigned int i = 0; i < itr->second.size(); ++i)
+		{
+			if (distance(hash, itr->second[i]) <= NEAR_BITS)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+void Dedup::add(uint64_t content, uint64_t perceptual)
+{
+	seen[content] = true;
+	if (!near)
+		return;
+
+	for (unsigned int b = 0; b < 4; ++b)
+	{
+		uint32_t key = (b << 16) | (uint32_t)((perceptual >> (16 * b)) & 0xFFFF);
+		bands[key].push_back(perceptual);
+	}
+}
+
+void* Dedup::hashRange(void* y)
+{
+	HashJob* job = (HashJob*)y;
+	unsigned int channels =
+		((job->width > 0) && (job->height > 0)) ? job->features / (job->width * job->height) : 0;
+
+	for (unsigned int r = 0; r < job->count; ++r)
+	{
+		const float* row = job->rows + (size_t)r * job->features;
+		job->content[r] = contentHash(row, job->features);
+		job->perceptual[r] = 0;
+		if ((job->near) && (channels > 0))
+			job->perceptual[r] = perceptualHash(row, job->width, job->height, channels);
+	}
+
+	return NULL;
+}
+
+/*!
+ * @brief hash every row of a split
+ * @details rows are read BLOCK_ROWS at a time on this thread, since inputs are not safe to
+ * read from several threads, and each block is hashed across the cores
+ * @param src the input
+ * @param test whether to hash the test split
+ * @param content set to the content hash of each row
+ * @param perceptual set to the average hash of each row, 0 when not needed
+ * @return the rows hashed
+ */
+unsigned int Dedup::hashRows(const glades::DataInput& src, bool test,
+							 std::vector<uint64_t>& content,
+							 std::vector<uint64_t>& perceptual) const
+{
+	unsigned int rows = (test) ? src.getTestSize() : src.getTrainSize();
+	content.assign(rows, 0);
+	perceptual.assign(rows, 0);
+	if (rows == 0)
+		return 0;
+
+	unsigned int features = ((test) ? src.getTestRow(0) : src.getTrainRow(0)).size();
+	if ((near) && ((features == 0) || (features % (width * height) != 0)))
+		return 0;
+
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned int jobCount = (cores > 0) ? (unsigned int)cores : 1;
+
+	std::vector<float> block((size_t)BLOCK_ROWS * features);
+	for (unsigned int start = 0; start < rows; start += BLOCK_ROWS)
+	{
+		unsigned int count = (start + BLOCK_ROWS <= rows) ? BLOCK_ROWS : rows - start;
+		for (unsigned int r = 0; r < count; ++r)
+		{
+			shmea::GList cRow = (test) ? src.getTestRow(start + r) : src.getTrainRow(start + r);
+			if (cRow.size() != features)
+				return 0;
+			for (unsigned int c = 0; c < features; ++c)
+				block[(size_t)r * features + c] = cRow.getFloat(c);
+		}
+
+		unsigned int perJob = (count + jobCount - 1) / jobCount;
+		std::vector<HashJob> jobs;
+		for (unsigned int first = 0; first < count; first += perJob)
+		{
+			HashJob job;
+			job.rows = &block[(size_t)first * features];
+			job.count = (first + perJob <= count) ? perJob : count - first;
+			job.features = features;
+			job.width = width;
+			job.height = height;
+			job.near = near;
+			job.content = &content[start + first];
+			job.perceptual = &perceptual[start + first];
+			jobs.push_back(job);
+		}
+
+		std::vector<pthread_t> threads(jobs.size());
+		std::vector<bool> started(jobs.size(), false);
+		for (unsigned int k = 1; k < jobs.size(); ++k)
+			started[k] = (pthread_create(&threads[k], NULL, hashRange, &jobs[k]) == 0);
+
+		hashRange(&jobs[0]);
+
+		for (unsigned int k = 1; k < jobs.size(); ++k)
+		{
+			if (started[k])
+				pthread_join(threads[k], NULL);
+			else
+				hashRange(&jobs[k]);
+		}
+	}
+
+	return rows;
+}
+
+/*!
+ * @brief keep only the first copy of each image in the training rows
+ * @param indexed the input to filter, over its source's own rows
+ * @param dropped set to the number of rows dropped
+ * @return false when the rows could not be hashed
+ */
+bool Dedup::filter(IndexedInput& indexed, unsigned int& dropped)
+{
+	NNC_PROFILE_SCOPE("data.dedup");
+	dropped = 0;
+	seen.clear();
+	bands.clear();
+
+	const glades::DataInput* src = indexed.getSource();
+	if ((!src) || (src->getTrainSize() == 0))
+		return false;
+
+	std::vector<uint64_t> content;
+	std::vector<uint64_t> perceptual;
+	unsigned int testRows = src->getTestSize();
+	if ((testRows > 0) && (hashRows(*src, true, content, perceptual) != testRows))
+		return false;
+
+	// the test split is only there to be matched against
+	for (unsigned int i = 0; i < testRows; ++i)
+		add(content[i], perceptual[i]);
+
+	unsigned int trainRows = src->getTrainSize();
+	if (hashRows(*src, false, content, perceptual) != trainRows)
+		return false;
+
+	std::vector<unsigned int> kept;
+	for (unsigned int i = 0; i < trainRows; ++i)
+	{
+		bool duplicate = (seen.find(content[i]) != seen.end());
+		if ((!duplicate) && (near))
+			duplicate = checkNear(perceptual[i]);
+
+		if (duplicate)
+		{
+			++dropped;
+			continue;
+		}
+
+		add(content[i], perceptual[i]);
+		kept.push_back(i);
+	}
+
+	return indexed.keep(kept);
+}
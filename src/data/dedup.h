@@ -0,0 +1,104 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _DEDUP
+#define _DEDUP
+
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace glades {
+class DataInput;
+};
+
+class IndexedInput;
+
+// Drops duplicate rows of an image set before it is trained or packed. Two
+// rows are the same image when their content hash matches, and near the same
+// when their 8x8 average hashes are at most NEAR_BITS bits apart; an index on
+// the four 16 bit bands of the hash finds those without comparing every pair,
+// since two hashes that close must share a band. Rows are hashed in parallel
+// blocks and kept in order, so the first copy of an image stays. Training rows
+// that repeat a test row are dropped too, so nothing leaks into the test score.
+class Dedup
+{
+private:
+	// one slice of a block being hashed
+	class HashJob
+	{
+	public:
+		const float* rows;
+		unsigned int count;
+		unsigned int features;
+		unsigned int width;
+		unsigned int height;
+		bool near;
+		uint64_t* content;
+		uint64_t* perceptual;
+
+		HashJob()
+		{
+			rows = NULL;
+			count = 0;
+			features = 0;
+			width = 0;
+			height = 0;
+			near = false;
+			content = NULL;
+			perceptual = NULL;
+		}
+	};
+
+	bool near;
+	unsigned int width;
+	unsigned int height;
+	std::map<uint64_t, bool> seen;
+	std::map<uint32_t, std::vector<uint64_t> > bands;
+
+	bool checkNear(uint64_t) const;
+	void add(uint64_t, uint64_t);
+	unsigned int hashRows(const glades::DataInput&, bool, std::vector<uint64_t>&,
+						  std::vector<uint64_t>&) const;
+
+	static void* hashRange(void*);
+
+public:
+	static const unsigned int HASH_SIDE = 8;
+	static const unsigned int NEAR_BITS = 3;
+	static const unsigned int BLOCK_ROWS = 4096;
+
+	Dedup(bool, unsigned int = 0, unsigned int = 0);
+
+	bool filter(IndexedInput&, unsigned int&);
+
+	static uint64_t contentHash(const float*, unsigned int);
+	static uint64_t perceptualHash(const float*, unsigned int, unsigned int, unsigned int);
+	static unsigned int distance(uint64_t, uint64_t);
+};
+
+#endif
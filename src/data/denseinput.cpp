@@ -0,0 +1,343 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "denseinput.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GTable.h"
+#include "Backend/Database/image.h"
+#include "Backend/Machine Learning/DataObjects/ImageInput.h"
+#include "Backend/Machine Learning/DataObjects/NumberInput.h"
+#include "Backend/Machine Learning/GMath/OHE.h"
+#include "streaminput.h"
+#include <sys/mman.h>
+
+static bool flattenTable(const shmea::GTable& src, FloatMatrix& dst)
+{
+	if (!dst.resize(src.numberOfRows(), src.numberOfCols()))
+		return false;
+
+	for (unsigned int r = 0; r < src.numberOfRows(); ++r)
+		dst.setRow(r, src[r]);
+
+	return true;
+}
+
+static bool flattenRows(const glades::DataInput& src, bool test, FloatMatrix& dst,
+						FloatMatrix& dstExpected)
+{
+	unsigned int rows = test ? src.getTestSize() : src.getTrainSize();
+	if (rows == 0)
+	{
+		dst.clear();
+		dstExpected.clear();
+		return true;
+	}
+
+	shmea::GList firstRow = test ? src.getTestRow(0) : src.getTrainRow(0);
+	shmea::GList firstExpected = test ? src.getTestExpectedRow(0) : src.getTrainExpectedRow(0);
+	if ((!dst.resize(rows, firstRow.size())) ||
+		(!dstExpected.resize(rows, firstExpected.size())))
+		return false;
+
+	for (unsigned int r = 0; r < rows; ++r)
+	{
+		dst.setRow(r, test ? src.getTestRow(r) : src.getTrainRow(r));
+		dstExpected.setRow(r, test ? src.getTestExpectedRow(r) : src.getTrainExpectedRow(r));
+	}
+
+	return true;
+}
+
+DenseInput::DenseInput()
+{
+	name = "";
+	loaded = false;
+	ownsOHE = false;
+	mapping = NULL;
+	mappingBytes = 0;
+	imageWidth = 0;
+	imageHeight = 0;
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+}
+
+DenseInput::~DenseInput()
+{
+	clear();
+}
+
+void DenseInput::clear()
+{
+	if (ownsOHE)
+	{
+		for (unsigned int i = 0; i < OHEMaps.size(); ++i)
+		{
+			if (OHEMaps[i])
+				delete OHEMaps[i];
+		}
+	}
+
+	name = "";
+	loaded = false;
+	ownsOHE = false;
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+	columnStats.clear();
+	imageWidth = 0;
+	imageHeight = 0;
+	trainMatrix.clear();
+	trainExpectedMatrix.clear();
+	testMatrix.clear();
+	testExpectedMatrix.clear();
+
+	if (mapping)
+		munmap(mapping, mappingBytes);
+	mapping = NULL;
+	mappingBytes = 0;
+}
+
+/*!
+ * @brief import a csv dataset
+ * @details runs the regular NumberInput import (parse, OHE, standardize) once and keeps only
+ * the flattened result
+ * @param newName the dataset path
+ */
+void DenseInput::import(shmea::GString newName)
+{
+	glades::NumberInput ni;
+	ni.import(newName);
+	if (!load(ni))
+	{
+		printf("[DATA] Unable to load \"%s\"\n", newName.c_str());
+		return;
+	}
+
+	name = newName;
+}
+
+/*!
+ * @brief flatten an imported NumberInput
+ * @details the OHE maps are shared with the source, which never frees them
+ * @param ni the imported number input
+ * @return whether every table was copied
+ */
+bool DenseInput::load(const glades::NumberInput& ni)
+{
+	clear();
+
+	if (!flattenTable(ni.trainTable, trainMatrix))
+		return false;
+	if (!flattenTable(ni.trainExpectedTable, trainExpectedMatrix))
+		return false;
+	if (!flattenTable(ni.testTable, testMatrix))
+		return false;
+	if (!flattenTable(ni.testExpectedTable, testExpectedMatrix))
+		return false;
+
+	OHEMaps = ni.OHEMaps;
+	featureIsCategorical = ni.featureIsCategorical;
+	name = ni.name;
+	loaded = true;
+	return true;
+}
+
+/*!
+ * @brief take over a streamed dataset
+ * @details decodes every row of both splits in parallel; the OHE maps move to this input and
+ * the StreamInput is left cleared
+ * @param si an imported stream input
+ * @return whether every row was decoded
+ */
+bool DenseInput::load(StreamInput& si)
+{
+	clear();
+
+	if (!si.decodeAll(trainMatrix, trainExpectedMatrix, testMatrix, testExpectedMatrix))
+	{
+		clear();
+		return false;
+	}
+
+	// hand the OHE maps over so si does not free them
+	OHEMaps = si.OHEMaps;
+	featureIsCategorical = si.featureIsCategorical;
+	columnStats = si.getColumnStats();
+	si.OHEMaps.clear();
+	name = si.name;
+	si.clear();
+
+	ownsOHE = true;
+	loaded = true;
+	return true;
+}
+
+/*!
+ * @brief flatten an imported image set
+ * @details the images are copied row by row, so the result holds plain floats that any number
+ * of threads can read; the image size is kept for augmentation
+ * @param images the imported image input
+ * @return whether every row was copied
+ */
+bool DenseInput::load(const glades::ImageInput& images)
+{
+	clear();
+
+	if ((!flattenRows(images, false, trainMatrix, trainExpectedMatrix)) ||
+		(!flattenRows(images, true, testMatrix, testExpectedMatrix)))
+	{
+		clear();
+		return false;
+	}
+
+	if (images.getTrainSize() > 0)
+	{
+		const shmea::GPointer<shmea::Image> firstImage = images.getTrainImage(0);
+		if (firstImage)
+		{
+			imageWidth = firstImage->getWidth();
+			imageHeight = firstImage->getHeight();
+		}
+	}
+
+	name = images.name;
+	loaded = true;
+	return true;
+}
+
+/*!
+ * @brief multi-threaded csv import
+ * @details the stats pass and the decode both run over record aligned byte ranges on all cores
+ * instead of going through the single threaded NumberInput import
+ * @param newName the dataset path
+ * @param threads number of threads, 0 for one per core
+ * @return whether the dataset was loaded
+ */
+bool DenseInput::importParallel(const shmea::GString& newName, unsigned int threads)
+{
+	StreamInput si;
+	si.setThreads(threads);
+	si.import(newName);
+	if (!si.loaded)
+		return false;
+
+	return load(si);
+}
+
+const float* DenseInput::getTrainRowPtr(unsigned int index) const
+{
+	return trainMatrix.rowPtr(index);
+}
+
+const float* DenseInput::getTrainExpectedRowPtr(unsigned int index) const
+{
+	return trainExpectedMatrix.rowPtr(index);
+}
+
+const float* DenseInput::getTestRowPtr(unsigned int index) const
+{
+	return testMatrix.rowPtr(index);
+}
+
+const float* DenseInput::getTestExpectedRowPtr(unsigned int index) const
+{
+	return testExpectedMatrix.rowPtr(index);
+}
+
+unsigned int DenseInput::getExpectedCount() const
+{
+	return trainExpectedMatrix.numberOfCols();
+}
+
+RowView DenseInput::getTrainBatch(unsigned int start, unsigned int count) const
+{
+	return trainMatrix.view(start, count);
+}
+
+RowView DenseInput::getTrainExpectedBatch(unsigned int start, unsigned int count) const
+{
+	return trainExpectedMatrix.view(start, count);
+}
+
+RowView DenseInput::getTestBatch(unsigned int start, unsigned int count) const
+{
+	return testMatrix.view(start, count);
+}
+
+RowView DenseInput::getTestExpectedBatch(unsigned int start, unsigned int count) const
+{
+	return testExpectedMatrix.view(start, count);
+}
+
+shmea::GList DenseInput::getTrainRow(unsigned int index) const
+{
+	return trainMatrix.getRow(index);
+}
+
+shmea::GList DenseInput::getTrainExpectedRow(unsigned int index) const
+{
+	return trainExpectedMatrix.getRow(index);
+}
+
+shmea::GList DenseInput::getTestRow(unsigned int index) const
+{
+	return testMatrix.getRow(index);
+}
+
+shmea::GList DenseInput::getTestExpectedRow(unsigned int index) const
+{
+	return testExpectedMatrix.getRow(index);
+}
+
+unsigned int DenseInput::getTrainSize() const
+{
+	return trainMatrix.numberOfRows();
+}
+
+unsigned int DenseInput::getTestSize() const
+{
+	return testMatrix.numberOfRows();
+}
+
+unsigned int DenseInput::getFeatureCount() const
+{
+	return trainMatrix.numberOfCols();
+}
+
+/*!
+ * @brief get the heap bytes held by the matrices
+ * @details a memory mapped cache is page cache the kernel can reclaim, so it is not counted
+ * @return the bytes
+ */
+size_t DenseInput::getBytes() const
+{
+	return trainMatrix.getBytes() + trainExpectedMatrix.getBytes() + testMatrix.getBytes() +
+		   testExpectedMatrix.getBytes();
+}
+
+int DenseInput::getType() const
+{
+	return glades::DataInput::CSV;
+}
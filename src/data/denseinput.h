@@ -0,0 +1,103 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _DENSEINPUT
+#define _DENSEINPUT
+
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include "columnstats.h"
+#include "floatmatrix.h"
+#include <vector>
+
+namespace glades {
+class ImageInput;
+class NumberInput;
+};
+
+class StreamInput;
+
+// CSV input held as contiguous float matrices. The tables are imported and
+// standardized once through NumberInput and then flattened, so readers that
+// only need raw values can use the row pointers without touching GType cells.
+class DenseInput : public glades::DataInput
+{
+public:
+	FloatMatrix trainMatrix;
+	FloatMatrix trainExpectedMatrix;
+	FloatMatrix testMatrix;
+	FloatMatrix testExpectedMatrix;
+
+	// raw column statistics, when the input was parsed by the app
+	std::vector<ColumnStats> columnStats;
+
+	// the size of the source images, 0 when the rows are not images
+	unsigned int imageWidth;
+	unsigned int imageHeight;
+
+	shmea::GString name;
+	bool loaded;
+	bool ownsOHE;
+
+	// set when the matrices view a memory mapped cache
+	void* mapping;
+	size_t mappingBytes;
+
+	DenseInput();
+	virtual ~DenseInput();
+
+	virtual void import(shmea::GString);
+	bool load(const glades::NumberInput&);
+	bool load(StreamInput&);
+	bool load(const glades::ImageInput&);
+	bool importParallel(const shmea::GString&, unsigned int = 0);
+	void clear();
+
+	// zero copy access
+	const float* getTrainRowPtr(unsigned int) const;
+	const float* getTrainExpectedRowPtr(unsigned int) const;
+	const float* getTestRowPtr(unsigned int) const;
+	const float* getTestExpectedRowPtr(unsigned int) const;
+	unsigned int getExpectedCount() const;
+	size_t getBytes() const;
+	RowView getTrainBatch(unsigned int, unsigned int) const;
+	RowView getTrainExpectedBatch(unsigned int, unsigned int) const;
+	RowView getTestBatch(unsigned int, unsigned int) const;
+	RowView getTestExpectedBatch(unsigned int, unsigned int) const;
+
+	virtual shmea::GList getTrainRow(unsigned int) const;
+	virtual shmea::GList getTrainExpectedRow(unsigned int) const;
+
+	virtual shmea::GList getTestRow(unsigned int) const;
+	virtual shmea::GList getTestExpectedRow(unsigned int) const;
+
+	virtual unsigned int getTrainSize() const;
+	virtual unsigned int getTestSize() const;
+	virtual unsigned int getFeatureCount() const;
+
+	virtual int getType() const;
+};
+
+#endif
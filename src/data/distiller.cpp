@@ -0,0 +1,266 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "distiller.h"
+#include "../core/atomicfile.h"
+#include "../core/md5.h"
+#include "Backend/Machine Learning/DataObjects/ImageInput.h"
+#include "Backend/Machine Learning/DataObjects/NumberInput.h"
+#include "bincache.h"
+#include "denseinput.h"
+#include "ensemble.h"
+#include "floatmatrix.h"
+#include "inputloader.h"
+#include "modelcache.h"
+#include "streaminput.h"
+#include <string.h>
+
+static const char SOFT_MAGIC[8] = {'N', 'N', 'S', 'O', 'F', 'T', '\0', '\0'};
+
+// fixed part of the file, followed by rows * cols packed floats
+struct SoftHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t floatSize;
+	char key[32];
+	uint32_t rows;
+	uint32_t cols;
+};
+
+/*!
+ * @brief the soft target cache of a dataset and teacher set
+ * @param fname the dataset path
+ * @param teachers the teacher names
+ * @return the cache path
+ */
+shmea::GString Distiller::cachePath(const shmea::GString& fname,
+									const std::vector<shmea::GString>& teachers)
+{
+	MD5 digest;
+	for (unsigned int i = 0; i < teachers.size(); ++i)
+	{
+		digest.update(teachers[i].c_str(), teachers[i].length());
+		digest.update(",", 1);
+	}
+
+	std::string path = std::string(fname.c_str()) + "." +
+					   digest.finalize().hexdigest().substr(0, 8) + ".nnsoft";
+	return shmea::GString(path.c_str());
+}
+
+/*!
+ * @brief the cache key of a dataset and teacher set
+ * @details covers the source, like the binary cache, and the epochs of every teacher, so a
+ * teacher that trained further invalidates the soft targets
+ * @return the key, or an empty string when the source or a teacher is missing
+ */
+std::string Distiller::teachersKey(const shmea::GString& fname,
+								   const std::vector<shmea::GString>& teachers)
+{
+	std::string sourceKey = BinCache::sourceKey(fname);
+	if (sourceKey.length() != KEY_LEN)
+		return "";
+
+	MD5 digest;
+	digest.update(sourceKey.c_str(), sourceKey.length());
+	for (unsigned int i = 0; i < teachers.size(); ++i)
+	{
+		ResidentModel* cModel = ModelCache::acquire(teachers[i]);
+		if (!cModel)
+			return "";
+
+		char stamp[64];
+		snprintf(stamp, sizeof(stamp), ":%d", cModel->network.getEpochs());
+		ModelCache::release(cModel);
+
+		digest.update(teachers[i].c_str(), teachers[i].length());
+		digest.update(stamp, strlen(stamp));
+	}
+
+	return digest.finalize().hexdigest();
+}
+
+/*!
+ * @brief average the teachers' outputs over a set of rows
+ * @details the teachers run side by side through Ensemble, in PredictBatcher sized chunks
+ * @param teachers the teacher names
+ * @param rows the input rows
+ * @param outputs resized to one row of averaged outputs per input row
+ * @return whether every teacher took the rows and gave outputs of the same width
+ */
+bool Distiller::predict(const std::vector<shmea::GString>& teachers, const FloatMatrix& rows,
+						FloatMatrix& outputs)
+{
+	unsigned int rowCount = rows.numberOfRows();
+	unsigned int inputCount = rows.numberOfCols();
+	std::vector<float> packed;
+	std::vector<float> batchOutputs;
+
+	for (unsigned int start = 0; start < rowCount; start += PredictBatcher::MAX_BATCH_ROWS)
+	{
+		unsigned int count = rowCount - start;
+		if (count > PredictBatcher::MAX_BATCH_ROWS)
+			count = PredictBatcher::MAX_BATCH_ROWS;
+
+		// packed without the row padding
+		packed.resize((size_t)count * inputCount);
+		for (unsigned int r = 0; r < count; ++r)
+			memcpy(&packed[(size_t)r * inputCount], rows.rowPtr(start + r),
+				   inputCount * sizeof(float));
+
+		if (!Ensemble::predict(teachers, &packed[0], count, inputCount, Ensemble::AVERAGE,
+							   batchOutputs))
+			return false;
+
+		unsigned int width = batchOutputs.size() / count;
+		if ((start == 0) && (!outputs.resize(rowCount, width)))
+			return false;
+
+		for (unsigned int r = 0; r < count; ++r)
+			memcpy(outputs.rowPtr(start + r), &batchOutputs[(size_t)r * width],
+				   width * sizeof(float));
+	}
+
+	return (rowCount > 0);
+}
+
+bool Distiller::save(const shmea::GString& path, const std::string& key, const FloatMatrix& targets)
+{
+	SoftHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SOFT_MAGIC, sizeof(header.magic));
+	header.version = VERSION;
+	header.floatSize = sizeof(float);
+	memcpy(header.key, key.c_str(), KEY_LEN);
+	header.rows = targets.numberOfRows();
+	header.cols = targets.numberOfCols();
+
+	std::string blob((const char*)&header, sizeof(header));
+	blob.reserve(sizeof(header) + (size_t)header.rows * header.cols * sizeof(float));
+	for (unsigned int r = 0; r < header.rows; ++r)
+		blob.append((const char*)targets.rowPtr(r), header.cols * sizeof(float));
+
+	return AtomicFile::writeFile(path.c_str(), blob.data(), blob.size());
+}
+
+bool Distiller::load(const shmea::GString& path, const std::string& key, FloatMatrix& targets)
+{
+	FILE* fd = fopen(path.c_str(), "rb");
+	if (!fd)
+		return false;
+
+	SoftHeader header;
+	bool ok = (fread(&header, sizeof(header), 1, fd) == 1) &&
+			  (memcmp(header.magic, SOFT_MAGIC, sizeof(header.magic)) == 0) &&
+			  (header.version == VERSION) && (header.floatSize == sizeof(float)) &&
+			  (memcmp(header.key, key.c_str(), KEY_LEN) == 0) && (header.cols > 0) &&
+			  (targets.resize(header.rows, header.cols));
+
+	for (unsigned int r = 0; (ok) && (r < header.rows); ++r)
+		ok = (fread(targets.rowPtr(r), sizeof(float), header.cols, fd) == header.cols);
+
+	fclose(fd);
+	if (!ok)
+		targets.clear();
+
+	return ok;
+}
+
+/*!
+ * @brief get a csv input as a DenseInput
+ * @details the soft targets replace a matrix, so small inputs read through NumberInput and
+ * large ones streamed through StreamInput are decoded into one first
+ * @param di an input from InputLoader::load, released here unless it is returned
+ * @return the dense input, or NULL when it could not be converted; the caller owns it
+ */
+DenseInput* Distiller::toDense(glades::DataInput* di)
+{
+	if (!di)
+		return NULL;
+
+	if (DenseInput* dense = dynamic_cast<DenseInput*>(di))
+		return dense;
+
+	DenseInput* dense = new DenseInput();
+	bool loaded = false;
+	if (StreamInput* stream = dynamic_cast<StreamInput*>(di))
+		loaded = dense->load(*stream);
+	else if (glades::NumberInput* numbers = dynamic_cast<glades::NumberInput*>(di))
+		loaded = dense->load(*numbers);
+	else if (glades::ImageInput* images = dynamic_cast<glades::ImageInput*>(di))
+		loaded = dense->load(*images);
+	InputLoader::release(di);
+
+	if (!loaded)
+	{
+		delete dense;
+		return NULL;
+	}
+
+	return dense;
+}
+
+/*!
+ * @brief replace the training targets with the teachers' soft outputs
+ * @param dense the input to train the student on
+ * @param fname the dataset path the input was loaded from
+ * @param teachers the teacher names; their outputs are averaged
+ * @return whether the targets were replaced; the input is unchanged when not
+ */
+bool Distiller::apply(DenseInput& dense, const shmea::GString& fname,
+					  const std::vector<shmea::GString>& teachers)
+{
+	if (teachers.empty())
+		return false;
+
+	std::string key = teachersKey(fname, teachers);
+	shmea::GString path = cachePath(fname, teachers);
+	FloatMatrix targets;
+	bool cached = (key.length() == KEY_LEN) && (load(path, key, targets)) &&
+				  (targets.numberOfRows() == dense.trainMatrix.numberOfRows());
+
+	if (!cached)
+	{
+		if (!predict(teachers, dense.trainMatrix, targets))
+			return false;
+
+		if ((key.length() == KEY_LEN) && (!save(path, key, targets)))
+			printf("[DISTILL] Unable to cache \"%s\"\n", path.c_str());
+	}
+
+	if (targets.numberOfCols() != dense.trainExpectedMatrix.numberOfCols())
+	{
+		printf("[DISTILL] Teachers give %u outputs, the data has %u\n", targets.numberOfCols(),
+			   dense.trainExpectedMatrix.numberOfCols());
+		return false;
+	}
+
+	dense.trainExpectedMatrix.swap(targets);
+	printf("[DISTILL] %s soft targets from %u teachers for \"%s\"\n",
+		   (cached) ? "Cached" : "Computed", (unsigned int)teachers.size(), fname.c_str());
+	return true;
+}
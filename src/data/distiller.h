@@ -0,0 +1,66 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _DISTILLER
+#define _DISTILLER
+
+#include "Backend/Database/GString.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace glades {
+class DataInput;
+};
+
+class DenseInput;
+class FloatMatrix;
+
+// Knowledge distillation from saved teacher networks into a student. The
+// teachers' outputs on the training rows, averaged over the ensemble, become
+// the student's expected rows; the test rows keep their real labels so the
+// student is still scored against the truth. The soft targets are computed
+// once and cached next to the dataset as "<file>.<teachers>.nnsoft", keyed on
+// the source file and on how far each teacher has been trained.
+class Distiller
+{
+private:
+	static const uint32_t VERSION = 1;
+	static const unsigned int KEY_LEN = 32;
+
+	static std::string teachersKey(const shmea::GString&, const std::vector<shmea::GString>&);
+	static bool predict(const std::vector<shmea::GString>&, const FloatMatrix&, FloatMatrix&);
+	static bool save(const shmea::GString&, const std::string&, const FloatMatrix&);
+	static bool load(const shmea::GString&, const std::string&, FloatMatrix&);
+
+public:
+	static shmea::GString cachePath(const shmea::GString&, const std::vector<shmea::GString>&);
+
+	static DenseInput* toDense(glades::DataInput*);
+	static bool apply(DenseInput&, const shmea::GString&, const std::vector<shmea::GString>&);
+};
+
+#endif
@@ -0,0 +1,182 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "ensemble.h"
+#include "../core/threadpool.h"
+#include "modelcache.h"
+#include <algorithm>
+
+// One subnet's share of an ensemble pass
+struct SubnetJob
+{
+	ResidentModel* model;
+	const float* rows;
+	unsigned int rowCount;
+	std::vector<float> outputs;
+	bool ok;
+};
+
+static void* runSubnet(void* y)
+{
+	SubnetJob* job = (SubnetJob*)y;
+	job->ok = job->model->batcher.predict(job->rows, job->rowCount, job->outputs);
+	return NULL;
+}
+
+/*!
+ * @brief split a comma separated network list
+ * @param netList eg "big,bigger"
+ * @return the network names, without empty entries
+ */
+std::vector<shmea::GString> Ensemble::parseNets(const shmea::GString& netList)
+{
+	std::vector<shmea::GString> nets;
+	std::string names = netList.c_str();
+	size_t start = 0;
+	while (start <= names.length())
+	{
+		size_t comma = names.find(',', start);
+		if (comma == std::string::npos)
+			comma = names.length();
+
+		if (comma > start)
+			nets.push_back(shmea::GString(names.substr(start, comma - start).c_str()));
+		start = comma + 1;
+	}
+
+	return nets;
+}
+
+/*!
+ * @brief parse a reduction name
+ * @param name "VOTE" or "AVERAGE"
+ * @return VOTE or AVERAGE, AVERAGE for anything else
+ */
+int Ensemble::parseReduce(const shmea::GString& name)
+{
+	if (name == "VOTE")
+		return VOTE;
+
+	return AVERAGE;
+}
+
+/*!
+ * @brief run every subnet on the same rows and reduce their outputs
+ * @details the rows are shared by every subnet and not copied here; the subnets run in parallel,
+ * one pool thread each, up to the number of cores. VOTE gives, per output, the share of subnets
+ * whose largest output it was.
+ * @param nets the subnet names
+ * @param rows rowCount packed rows of inputCount features
+ * @param rowCount the number of rows
+ * @param inputCount the width of a row, which every subnet must take
+ * @param reduce AVERAGE or VOTE
+ * @param outputs set to one row of reduced outputs per input row
+ * @return whether every subnet ran and gave outputs of the same width
+ */
+bool Ensemble::predict(const std::vector<shmea::GString>& nets, const float* rows,
+					   unsigned int rowCount, unsigned int inputCount, int reduce,
+					   std::vector<float>& outputs)
+{
+	outputs.clear();
+	if ((nets.empty()) || (!rows) || (rowCount == 0))
+		return false;
+
+	std::vector<SubnetJob> jobs(nets.size());
+	bool acquired = true;
+	for (unsigned int i = 0; i < nets.size(); ++i)
+	{
+		jobs[i].model = ModelCache::acquire(nets[i]);
+		jobs[i].rows = rows;
+		jobs[i].rowCount = rowCount;
+		jobs[i].ok = false;
+		if (!jobs[i].model)
+		{
+			printf("[ENSEMBLE] Unable to load \"%s\"\n", nets[i].c_str());
+			acquired = false;
+		}
+		else if (jobs[i].model->batcher.getInputCount() != inputCount)
+		{
+			printf("[ENSEMBLE] \"%s\" expects %u features, got %u\n", nets[i].c_str(),
+				   jobs[i].model->batcher.getInputCount(), inputCount);
+			acquired = false;
+		}
+	}
+
+	if (acquired)
+	{
+		if (jobs.size() == 1)
+			runSubnet(&jobs[0]);
+		else
+		{
+			ThreadPool pool(std::min(ThreadPool::cores(), (unsigned int)jobs.size()));
+			for (unsigned int i = 0; i < jobs.size(); ++i)
+				pool.submit(runSubnet, &jobs[i]);
+			pool.wait();
+		}
+	}
+
+	for (unsigned int i = 0; i < jobs.size(); ++i)
+	{
+		if (jobs[i].model)
+			ModelCache::release(jobs[i].model);
+	}
+
+	if (!acquired)
+		return false;
+
+	// every subnet must give the same number of outputs per row
+	unsigned int width = jobs[0].outputs.size() / rowCount;
+	for (unsigned int i = 0; i < jobs.size(); ++i)
+	{
+		if ((!jobs[i].ok) || (width == 0) || (jobs[i].outputs.size() != (size_t)rowCount * width))
+		{
+			printf("[ENSEMBLE] \"%s\" gave no outputs matching the other subnets\n",
+				   nets[i].c_str());
+			return false;
+		}
+	}
+
+	outputs.assign((size_t)rowCount * width, 0.0f);
+	float share = 1.0f / jobs.size();
+	for (unsigned int i = 0; i < jobs.size(); ++i)
+	{
+		const std::vector<float>& cOutputs = jobs[i].outputs;
+		for (unsigned int r = 0; r < rowCount; ++r)
+		{
+			const float* src = &cOutputs[(size_t)r * width];
+			float* dst = &outputs[(size_t)r * width];
+			if (reduce == VOTE)
+				dst[std::max_element(src, src + width) - src] += share;
+			else
+			{
+				for (unsigned int c = 0; c < width; ++c)
+					dst[c] += src[c] * share;
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,49 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _ENSEMBLE
+#define _ENSEMBLE
+
+#include "Backend/Database/GString.h"
+#include <string>
+#include <vector>
+
+// Combined prediction over several resident networks. Every subnet runs on
+// the same input rows, each on its own thread with its own output buffer,
+// and the outputs are reduced by averaging or by majority vote.
+class Ensemble
+{
+public:
+	static const int AVERAGE = 0;
+	static const int VOTE = 1;
+
+	static std::vector<shmea::GString> parseNets(const shmea::GString&);
+	static int parseReduce(const shmea::GString&);
+	static bool predict(const std::vector<shmea::GString>&, const float*, unsigned int,
+						unsigned int, int, std::vector<float>&);
+};
+
+#endif
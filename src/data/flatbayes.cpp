@@ -0,0 +1,384 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "flatbayes.h"
+#include "../core/confusion.h"
+#include "Backend/Database/GString.h"
+#include "csvreader.h"
+#include <float.h>
+#include <math.h>
+
+// Laplace smoothing
+const float FlatBayes::ALPHA = 1.0f;
+
+FlatBayes::FlatBayes()
+{
+	reset();
+}
+
+void FlatBayes::reset()
+{
+	featureCount = 0;
+	values.clear();
+	featureOf.clear();
+	classIndex.clear();
+	classNames.clear();
+	classCounts.clear();
+	attributeCounts.clear();
+	total = 0;
+	logPriors.clear();
+	logLikelihoods.clear();
+	attributeCount = 0;
+	trained = false;
+}
+
+int FlatBayes::attributeOf(unsigned int feature, const CSVField& field) const
+{
+	if (feature >= values.size())
+		return -1;
+
+	std::map<std::string, unsigned int>::const_iterator itr =
+		values[feature].find(field.toString());
+	if (itr == values[feature].end())
+		return -1;
+
+	return itr->second;
+}
+
+/*!
+ * @brief count one training record
+ * @details the first record fixes the feature count; unseen values and classes get new ids,
+ * so the dictionaries grow as data comes in
+ * @param record the features followed by the label
+ * @return whether the record was counted
+ */
+bool FlatBayes::add(const std::vector<CSVField>& record)
+{
+	if (record.size() < 2)
+		return false;
+
+	if (featureCount == 0)
+	{
+		featureCount = record.size() - 1;
+		values.resize(featureCount);
+	}
+
+	// label
+	std::string label = record.back().toString();
+	std::map<std::string, unsigned int>::iterator classItr = classIndex.find(label);
+	unsigned int cls = 0;
+	if (classItr == classIndex.end())
+	{
+		cls = classNames.size();
+		classIndex[label] = cls;
+		classNames.push_back(label);
+		classCounts.push_back(0);
+		attributeCounts.push_back(std::vector<int64_t>(featureOf.size(), 0));
+	}
+	else
+		cls = classItr->second;
+
+	// features
+	for (unsigned int f = 0; (f < featureCount) && (f + 1 < record.size()); ++f)
+	{
+		std::string value = record[f].toString();
+		std::map<std::string, unsigned int>::iterator itr = values[f].find(value);
+		unsigned int attribute = 0;
+		if (itr == values[f].end())
+		{
+			attribute = featureOf.size();
+			values[f][value] = attribute;
+			featureOf.push_back(f);
+			for (unsigned int c = 0; c < attributeCounts.size(); ++c)
+				attributeCounts[c].push_back(0);
+		}
+		else
+			attribute = itr->second;
+
+		++attributeCounts[cls][attribute];
+	}
+
+	++classCounts[cls];
+	++total;
+	trained = false;
+	return true;
+}
+
+/*!
+ * @brief build the log probability tables from the counts
+ * @details log P(C) and Laplace smoothed log P(x|C) per attribute, laid out class major
+ */
+void FlatBayes::finalize()
+{
+	unsigned int classCount = classNames.size();
+	attributeCount = featureOf.size();
+	logPriors.assign(classCount, -FLT_MAX);
+	logLikelihoods.assign(classCount * attributeCount, 0.0f);
+
+	for (unsigned int c = 0; c < classCount; ++c)
+	{
+		if (total > 0)
+			logPriors[c] = (float)log((double)classCounts[c] / (double)total);
+
+		float* row = logLikelihoods.empty() ? NULL : &logLikelihoods[c * attributeCount];
+		for (unsigned int a = 0; a < attributeCount; ++a)
+		{
+			double vocab = values[featureOf[a]].size();
+			row[a] = (float)log((attributeCounts[c][a] + ALPHA) /
+								(classCounts[c] + ALPHA * vocab));
+		}
+	}
+
+	trained = true;
+}
+
+/*!
+ * @brief count the next chunk of records
+ * @details adds to the existing counts without touching the trained tables; call finalize()
+ * once the data of interest has been fit
+ * @param reader an open reader past the header line
+ * @param maxRows the most records to read
+ * @return the number of records counted, 0 at the end of the file
+ */
+unsigned int FlatBayes::partialFit(CSVReader& reader, unsigned int maxRows)
+{
+	std::vector<CSVField> record;
+	unsigned int counted = 0;
+	for (unsigned int i = 0; i < maxRows; ++i)
+	{
+		if (!reader.readRecord(record))
+			break;
+
+		if (add(record))
+			++counted;
+	}
+
+	return counted;
+}
+
+/*!
+ * @brief train on a csv file
+ * @details fits the file in CHUNK_ROWS chunks on top of any earlier counts, the first line is
+ * the header
+ * @param fname the path of the csv
+ * @return whether any records have been counted
+ */
+bool FlatBayes::train(const shmea::GString& fname)
+{
+	CSVReader reader;
+	if (!reader.open(fname))
+	{
+		printf("[BAYES] Unable to open \"%s\"\n", fname.c_str());
+		return false;
+	}
+
+	std::vector<CSVField> header;
+	reader.readRecord(header);
+
+	while (partialFit(reader) > 0)
+	{
+		if (total >= CHUNK_ROWS)
+			printf("[BAYES] %lld rows fit\n", (long long)total);
+	}
+
+	finalize();
+	return total > 0;
+}
+
+/*!
+ * @brief the attribute id of each feature of a record
+ * @param record the features, optionally followed by the label
+ * @param attributes featureCount ids out, -1 for values never seen in training
+ */
+void FlatBayes::encode(const std::vector<CSVField>& record, std::vector<int>& attributes) const
+{
+	attributes.assign(featureCount, -1);
+	for (unsigned int f = 0; (f < featureCount) && (f < record.size()); ++f)
+		attributes[f] = attributeOf(f, record[f]);
+}
+
+/*!
+ * @brief predict one sample
+ * @param attributes featureCount attribute ids from encode(), -1 entries are skipped
+ * @return the class index, -1 when untrained
+ */
+int FlatBayes::predict(const int* attributes) const
+{
+	int cls = -1;
+	predictBatch(attributes, 1, &cls);
+	return cls;
+}
+
+/*!
+ * @brief predict many samples
+ * @details scores every class of one sample with a gather-sum over its attribute ids
+ * @param attributes n x featureCount attribute ids, row major
+ * @param n the number of samples
+ * @param predicted n class indexes out, -1 when untrained
+ */
+void FlatBayes::predictBatch(const int* attributes, unsigned int n, int* predicted) const
+{
+	if ((!attributes) || (!predicted))
+		return;
+
+	unsigned int classCount = logPriors.size();
+	const float* table = logLikelihoods.empty() ? NULL : &logLikelihoods[0];
+	for (unsigned int i = 0; i < n; ++i)
+	{
+		const int* sample = attributes + (size_t)i * featureCount;
+		int best = -1;
+		float bestScore = -FLT_MAX;
+		for (unsigned int c = 0; (trained) && (c < classCount); ++c)
+		{
+			const float* row = table + (size_t)c * attributeCount;
+			float score = logPriors[c];
+			for (unsigned int f = 0; f < featureCount; ++f)
+			{
+				if (sample[f] >= 0)
+					score += row[sample[f]];
+			}
+
+			if ((best < 0) || (score > bestScore))
+			{
+				best = c;
+				bestScore = score;
+			}
+		}
+		predicted[i] = best;
+	}
+}
+
+/*!
+ * @brief evaluate on a labelled csv file
+ * @details records are predicted in batches; labels never seen in training count against the
+ * accuracy but are left out of the confusion matrix
+ * @param fname the path of the csv
+ * @param results the confusion matrix to fill, rebuilt for this model's classes
+ * @return the accuracy in [0, 1]
+ */
+float FlatBayes::test(const shmea::GString& fname, ConfusionMatrix& results) const
+{
+	static const unsigned int BATCH = 1024;
+
+	results.build(classNames.size());
+	CSVReader reader;
+	if ((!trained) || (featureCount == 0) || (!reader.open(fname)))
+		return 0.0f;
+
+	std::vector<int> batch;
+	std::vector<int> actual;
+	std::vector<int> predicted(BATCH);
+	std::vector<int> attributes;
+	std::vector<CSVField> record;
+	int64_t samples = 0;
+	int64_t correct = 0;
+	bool header = true;
+	while (true)
+	{
+		bool more = reader.readRecord(record);
+		if ((more) && (header))
+		{
+			header = false;
+			continue;
+		}
+
+		if ((more) && (record.size() >= 2))
+		{
+			encode(record, attributes);
+			batch.insert(batch.end(), attributes.begin(), attributes.end());
+			actual.push_back(getClass(record.back()));
+		}
+
+		if ((actual.size() == BATCH) || ((!more) && (!actual.empty())))
+		{
+			predictBatch(&batch[0], actual.size(), &predicted[0]);
+			results.addBatch(&predicted[0], &actual[0], actual.size());
+			for (unsigned int i = 0; i < actual.size(); ++i)
+				correct += (predicted[i] == actual[i]);
+			samples += actual.size();
+			batch.clear();
+			actual.clear();
+		}
+
+		if (!more)
+			break;
+	}
+
+	if (samples == 0)
+		return 0.0f;
+
+	return (float)correct / (float)samples;
+}
+
+unsigned int FlatBayes::getFeatureCount() const
+{
+	return featureCount;
+}
+
+unsigned int FlatBayes::getClassCount() const
+{
+	return classNames.size();
+}
+
+unsigned int FlatBayes::getAttributeCount() const
+{
+	return featureOf.size();
+}
+
+int FlatBayes::getClass(const CSVField& field) const
+{
+	std::map<std::string, unsigned int>::const_iterator itr = classIndex.find(field.toString());
+	if (itr == classIndex.end())
+		return -1;
+
+	return itr->second;
+}
+
+std::string FlatBayes::getClassName(int cls) const
+{
+	if ((cls < 0) || ((unsigned int)cls >= classNames.size()))
+		return "";
+
+	return classNames[cls];
+}
+
+int64_t FlatBayes::getTotal() const
+{
+	return total;
+}
+
+bool FlatBayes::isTrained() const
+{
+	return trained;
+}
+
+void FlatBayes::print() const
+{
+	printf("[BAYES] %lld samples, %u features, %u attributes, %u classes\n", (long long)total,
+		   featureCount, (unsigned int)featureOf.size(), (unsigned int)classNames.size());
+	for (unsigned int c = 0; c < classNames.size(); ++c)
+		printf("[BAYES] %s: %lld\n", classNames[c].c_str(), (long long)classCounts[c]);
+}
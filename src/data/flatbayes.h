@@ -0,0 +1,100 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _FLATBAYES
+#define _FLATBAYES
+
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace shmea {
+class GString;
+};
+
+class CSVField;
+class CSVReader;
+class ConfusionMatrix;
+
+// Categorical naive Bayes over csv records, label in the last column. Counts
+// are kept online, so a model can be fit chunk by chunk from a CSVReader over
+// files that do not fit in memory and refit after more data arrives. Every
+// (feature, value) pair is an attribute id and the trained model is a dense
+// [class x attribute] table of log likelihoods plus the class log priors, so a
+// prediction is one gather-sum per feature followed by an argmax.
+class FlatBayes
+{
+private:
+	unsigned int featureCount;
+	std::vector<std::map<std::string, unsigned int> > values;
+	std::vector<unsigned int> featureOf;
+	std::map<std::string, unsigned int> classIndex;
+	std::vector<std::string> classNames;
+
+	// counts, one row of attributes per class
+	std::vector<int64_t> classCounts;
+	std::vector<std::vector<int64_t> > attributeCounts;
+	int64_t total;
+
+	// trained model
+	std::vector<float> logPriors;
+	std::vector<float> logLikelihoods;
+	unsigned int attributeCount;
+	bool trained;
+
+	int attributeOf(unsigned int, const CSVField&) const;
+
+public:
+	FlatBayes();
+
+	static const float ALPHA;
+	static const unsigned int CHUNK_ROWS = 65536;
+
+	void reset();
+	bool add(const std::vector<CSVField>&);
+	unsigned int partialFit(CSVReader&, unsigned int = CHUNK_ROWS);
+	void finalize();
+	bool train(const shmea::GString&);
+
+	void encode(const std::vector<CSVField>&, std::vector<int>&) const;
+	int predict(const int*) const;
+	void predictBatch(const int*, unsigned int, int*) const;
+	float test(const shmea::GString&, ConfusionMatrix&) const;
+
+	// gets
+	unsigned int getFeatureCount() const;
+	unsigned int getClassCount() const;
+	unsigned int getAttributeCount() const;
+	int getClass(const CSVField&) const;
+	std::string getClassName(int) const;
+	int64_t getTotal() const;
+	bool isTrained() const;
+	void print() const;
+};
+
+#endif
@@ -0,0 +1,293 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "floatmatrix.h"
+#include "Backend/Database/GList.h"
+
+FloatMatrix::FloatMatrix()
+{
+	data = NULL;
+	rows = 0;
+	cols = 0;
+	stride = 0;
+	owned = true;
+}
+
+FloatMatrix::FloatMatrix(unsigned int newRows, unsigned int newCols)
+{
+	data = NULL;
+	rows = 0;
+	cols = 0;
+	stride = 0;
+	owned = true;
+	resize(newRows, newCols);
+}
+
+FloatMatrix::FloatMatrix(const FloatMatrix& other)
+{
+	data = NULL;
+	rows = 0;
+	cols = 0;
+	stride = 0;
+	owned = true;
+	*this = other;
+}
+
+FloatMatrix::~FloatMatrix()
+{
+	release();
+}
+
+void FloatMatrix::release()
+{
+	if ((data) && (owned))
+		free(data);
+
+	data = NULL;
+	rows = 0;
+	cols = 0;
+	stride = 0;
+	owned = true;
+}
+
+/*!
+ * @brief resize the matrix
+ * @details drops the old contents and allocates one zeroed block; the row stride is padded up
+ * to a whole number of cache lines
+ * @param newRows the number of rows
+ * @param newCols the number of columns
+ * @return whether the allocation succeeded
+ */
+bool FloatMatrix::resize(unsigned int newRows, unsigned int newCols)
+{
+	release();
+	if ((newRows == 0) || (newCols == 0))
+		return true;
+
+	const unsigned int floatsPerLine = ALIGNMENT / sizeof(float);
+	unsigned int newStride = ((newCols + floatsPerLine - 1) / floatsPerLine) * floatsPerLine;
+	size_t bytes = (size_t)newRows * newStride * sizeof(float);
+
+	void* block = NULL;
+	if (posix_memalign(&block, ALIGNMENT, bytes) != 0)
+	{
+		printf("[DATA] Unable to allocate %u x %u matrix\n", newRows, newCols);
+		return false;
+	}
+
+	memset(block, 0, bytes);
+	data = (float*)block;
+	owned = true;
+	rows = newRows;
+	cols = newCols;
+	stride = newStride;
+	return true;
+}
+
+/*!
+ * @brief view external memory
+ * @details the matrix does not free the block; used for memory mapped caches, so the caller
+ * must keep the mapping alive for as long as the matrix is used
+ * @param newData the first row
+ * @param newRows the number of rows
+ * @param newCols the number of columns
+ * @param newStride floats between row starts
+ */
+void FloatMatrix::wrap(float* newData, unsigned int newRows, unsigned int newCols,
+					   unsigned int newStride)
+{
+	release();
+	if ((!newData) || (newRows == 0) || (newCols == 0))
+		return;
+
+	data = newData;
+	rows = newRows;
+	cols = newCols;
+	stride = newStride;
+	owned = false;
+}
+
+void FloatMatrix::swap(FloatMatrix& other)
+{
+	float* tmpData = data;
+	data = other.data;
+	other.data = tmpData;
+
+	unsigned int tmp = rows;
+	rows = other.rows;
+	other.rows = tmp;
+
+	tmp = cols;
+	cols = other.cols;
+	other.cols = tmp;
+
+	tmp = stride;
+	stride = other.stride;
+	other.stride = tmp;
+
+	bool tmpOwned = owned;
+	owned = other.owned;
+	other.owned = tmpOwned;
+}
+
+void FloatMatrix::clear()
+{
+	release();
+}
+
+unsigned int FloatMatrix::numberOfRows() const
+{
+	return rows;
+}
+
+unsigned int FloatMatrix::numberOfCols() const
+{
+	return cols;
+}
+
+unsigned int FloatMatrix::getStride() const
+{
+	return stride;
+}
+
+bool FloatMatrix::empty() const
+{
+	return rows == 0;
+}
+
+bool FloatMatrix::isOwned() const
+{
+	return owned;
+}
+
+/*!
+ * @brief get the heap bytes held by the matrix
+ * @return the padded allocation, or 0 for a wrapped buffer
+ */
+size_t FloatMatrix::getBytes() const
+{
+	if (!owned)
+		return 0;
+
+	return (size_t)rows * stride * sizeof(float);
+}
+
+float* FloatMatrix::rowPtr(unsigned int row)
+{
+	if (row >= rows)
+		return NULL;
+
+	return &data[(size_t)row * stride];
+}
+
+const float* FloatMatrix::rowPtr(unsigned int row) const
+{
+	if (row >= rows)
+		return NULL;
+
+	return &data[(size_t)row * stride];
+}
+
+float FloatMatrix::get(unsigned int row, unsigned int col) const
+{
+	if ((row >= rows) || (col >= cols))
+		return 0.0f;
+
+	return data[(size_t)row * stride + col];
+}
+
+/*!
+ * @brief row as a GList
+ * @details builds a new list from the raw floats; meant for the GList based DataInput
+ * accessors and previews, not for hot loops
+ * @param row the row index
+ * @return the row, or an empty list when out of range
+ */
+shmea::GList FloatMatrix::getRow(unsigned int row) const
+{
+	shmea::GList retList;
+	const float* cRow = rowPtr(row);
+	if (!cRow)
+		return retList;
+
+	for (unsigned int i = 0; i < cols; ++i)
+		retList.addFloat(cRow[i]);
+
+	return retList;
+}
+
+/*!
+ * @brief batch view
+ * @details the view is clipped to the end of the matrix and stays valid until the next resize
+ * @param start the first row
+ * @param count the number of rows wanted
+ * @return a view of at most count rows
+ */
+RowView FloatMatrix::view(unsigned int start, unsigned int count) const
+{
+	if (start >= rows)
+		return RowView();
+
+	if (count > rows - start)
+		count = rows - start;
+
+	return RowView(&data[(size_t)start * stride], count, cols, stride);
+}
+
+void FloatMatrix::set(unsigned int row, unsigned int col, float value)
+{
+	if ((row >= rows) || (col >= cols))
+		return;
+
+	data[(size_t)row * stride + col] = value;
+}
+
+void FloatMatrix::setRow(unsigned int row, const shmea::GList& newRow)
+{
+	float* cRow = rowPtr(row);
+	if (!cRow)
+		return;
+
+	unsigned int len = newRow.size() < cols ? newRow.size() : cols;
+	for (unsigned int i = 0; i < len; ++i)
+		cRow[i] = newRow.getFloat(i);
+}
+
+void FloatMatrix::operator=(const FloatMatrix& other)
+{
+	if (this == &other)
+		return;
+
+	if (!resize(other.rows, other.cols))
+		return;
+
+	// a wrapped source can have a different stride, so copy each row's columns
+	if (!data)
+		return;
+
+	for (unsigned int r = 0; r < rows; ++r)
+		memcpy(rowPtr(r), other.rowPtr(r), (size_t)cols * sizeof(float));
+}
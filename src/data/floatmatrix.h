@@ -0,0 +1,85 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _FLOATMATRIX
+#define _FLOATMATRIX
+
+#include "rowview.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace shmea {
+class GList;
+};
+
+// Dense row-major float matrix. Every row starts on a 64 byte boundary so a
+// row pointer can be handed straight to vector loops without realignment.
+class FloatMatrix
+{
+private:
+	float* data;
+	unsigned int rows;
+	unsigned int cols;
+	unsigned int stride;
+	bool owned;
+
+	void release();
+
+public:
+	static const unsigned int ALIGNMENT = 64;
+
+	FloatMatrix();
+	FloatMatrix(unsigned int, unsigned int);
+	FloatMatrix(const FloatMatrix&);
+	virtual ~FloatMatrix();
+
+	bool resize(unsigned int, unsigned int);
+	void wrap(float*, unsigned int, unsigned int, unsigned int);
+	void swap(FloatMatrix&);
+	void clear();
+
+	// gets
+	unsigned int numberOfRows() const;
+	unsigned int numberOfCols() const;
+	unsigned int getStride() const;
+	bool empty() const;
+	bool isOwned() const;
+	size_t getBytes() const;
+	float* rowPtr(unsigned int);
+	const float* rowPtr(unsigned int) const;
+	float get(unsigned int, unsigned int) const;
+	shmea::GList getRow(unsigned int) const;
+	RowView view(unsigned int, unsigned int) const;
+
+	// sets
+	void set(unsigned int, unsigned int, float);
+	void setRow(unsigned int, const shmea::GList&);
+
+	void operator=(const FloatMatrix&);
+};
+
+#endif
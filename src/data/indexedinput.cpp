@@ -0,0 +1,651 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "indexedinput.h"
+#include "../core/profiler.h"
+#include "../core/random.h"
+#include "Backend/Database/GList.h"
+#include "denseinput.h"
+#include "streaminput.h"
+#include <algorithm>
+
+IndexedInput::IndexedInput()
+{
+	source = NULL;
+	indexedTest = false;
+	shuffleRandom = NULL;
+	shuffleBlockRows = 0;
+	resetEpochs();
+}
+
+IndexedInput::IndexedInput(const glades::DataInput* newSource)
+{
+	source = NULL;
+	indexedTest = false;
+	shuffleRandom = NULL;
+	shuffleBlockRows = 0;
+	resetEpochs();
+	setSource(newSource);
+}
+
+IndexedInput::~IndexedInput()
+{
+	setShuffle(false);
+	source = NULL; // Not ours to delete
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+}
+
+/*!
+ * @brief set the dataset to index
+ * @details shares the source's OHE maps; every row initially belongs to the train split and the
+ * source's test rows pass through
+ * @param newSource the imported input
+ */
+void IndexedInput::setSource(const glades::DataInput* newSource)
+{
+	source = newSource;
+	trainIndex.clear();
+	testIndex.clear();
+	validationIndex.clear();
+	indexedTest = false;
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+
+	if (!source)
+		return;
+
+	OHEMaps = source->OHEMaps;
+	featureIsCategorical = source->featureIsCategorical;
+	for (unsigned int i = 0; i < source->getTrainSize(); ++i)
+		trainIndex.push_back(i);
+}
+
+const glades::DataInput* IndexedInput::getSource() const
+{
+	return source;
+}
+
+/*!
+ * @brief class of a source row
+ * @details the position of the largest expected value, which is the one-hot class for
+ * categorical labels and 0 for a single numeric output
+ * @param row the source training row
+ * @return the class index
+ */
+int IndexedInput::labelOf(unsigned int row) const
+{
+	const DenseInput* dense = dynamic_cast<const DenseInput*>(source);
+	if (dense)
+	{
+		const float* expected = dense->getTrainExpectedRowPtr(row);
+		unsigned int count = dense->getExpectedCount();
+		if ((!expected) || (count == 0))
+			return 0;
+
+		unsigned int best = 0;
+		for (unsigned int i = 1; i < count; ++i)
+		{
+			if (expected[i] > expected[best])
+				best = i;
+		}
+		return best;
+	}
+
+	shmea::GList expected = source->getTrainExpectedRow(row);
+	unsigned int best = 0;
+	for (unsigned int i = 1; i < expected.size(); ++i)
+	{
+		if (expected.getFloat(i) > expected.getFloat(best))
+			best = i;
+	}
+	return best;
+}
+
+/*!
+ * @brief source rows in split order
+ * @details a Fisher-Yates shuffle when rng is given; when stratified the rows are dealt out
+ * class by class in round robin, so any prefix or stride of the order keeps the class mix
+ * @param rng the random stream, or NULL to keep file order
+ * @param stratify whether to balance classes
+ * @return a permutation of the source training rows
+ */
+std::vector<unsigned int> IndexedInput::order(Random* rng, bool stratify) const
+{
+	std::vector<unsigned int> rows;
+	unsigned int total = source->getTrainSize();
+	for (unsigned int i = 0; i < total; ++i)
+		rows.push_back(i);
+
+	if (rng)
+	{
+		for (unsigned int i = total; i > 1; --i)
+		{
+			unsigned int j = rng->nextUInt(i);
+			unsigned int tmp = rows[i - 1];
+			rows[i - 1] = rows[j];
+			rows[j] = tmp;
+		}
+	}
+
+	if (!stratify)
+		return rows;
+
+	// bucket by class, keeping the shuffled order inside each class
+	std::vector<std::vector<unsigned int> > classes;
+	for (unsigned int i = 0; i < total; ++i)
+	{
+		int label = labelOf(rows[i]);
+		if (label >= (int)classes.size())
+			classes.resize(label + 1);
+		classes[label].push_back(rows[i]);
+	}
+
+	// deal each class evenly over the whole order
+	std::vector<std::pair<double, unsigned int> > keyed;
+	for (unsigned int c = 0; c < classes.size(); ++c)
+	{
+		for (unsigned int i = 0; i < classes[c].size(); ++i)
+		{
+			double key = ((double)i + 0.5) / (double)classes[c].size();
+			keyed.push_back(std::pair<double, unsigned int>(key, classes[c][i]));
+		}
+	}
+	std::stable_sort(keyed.begin(), keyed.end());
+
+	for (unsigned int i = 0; i < keyed.size(); ++i)
+		rows[i] = keyed[i].second;
+
+	return rows;
+}
+
+/*!
+ * @brief percentage split
+ * @details percentages use the same 0-100 convention as the NNCreatorPanel textboxes and must
+ * add up to 100
+ * @param trainPct percent of rows to train on
+ * @param testPct percent of rows to test on
+ * @param validationPct percent of rows to hold out for validation
+ * @param rng the random stream to shuffle with, or NULL to keep file order
+ * @param stratify whether each split keeps the class mix of the whole set
+ * @return whether the split was made
+ */
+bool IndexedInput::split(int64_t trainPct, int64_t testPct, int64_t validationPct, Random* rng,
+						 bool stratify)
+{
+	if (!source)
+		return false;
+
+	if ((trainPct < 0) || (testPct < 0) || (validationPct < 0) ||
+		(trainPct + testPct + validationPct != 100))
+	{
+		printf("[DATA] Invalid split %ld/%ld/%ld\n", (long)trainPct, (long)testPct,
+			   (long)validationPct);
+		return false;
+	}
+
+	std::vector<unsigned int> rows = order(rng, stratify);
+	unsigned int total = rows.size();
+	int64_t pct[3] = {trainPct, testPct, validationPct};
+	std::vector<unsigned int>* splits[3] = {&trainIndex, &testIndex, &validationIndex};
+
+	trainIndex.clear();
+	testIndex.clear();
+	validationIndex.clear();
+	indexedTest = true;
+
+	// Hand each row to the split furthest behind its share, so every prefix of a
+	// stratified order is split in proportion too
+	for (unsigned int i = 0; i < total; ++i)
+	{
+		unsigned int best = 0;
+		double bestDeficit = -1.0;
+		for (unsigned int s = 0; s < 3; ++s)
+		{
+			double deficit = ((double)(i + 1) * pct[s]) / 100.0 - (double)splits[s]->size();
+			if ((pct[s] > 0) && (deficit > bestDeficit))
+			{
+				best = s;
+				bestDeficit = deficit;
+			}
+		}
+		splits[best]->push_back(rows[i]);
+	}
+
+	return true;
+}
+
+/*!
+ * @brief k-fold split
+ * @details fold k of folds becomes the test split and the rest train; calling it with the
+ * same rng seed for every k gives disjoint test folds that cover the data once
+ * @param k the held out fold
+ * @param folds the number of folds
+ * @param rng the random stream to shuffle with, or NULL to keep file order
+ * @param stratify whether each fold keeps the class mix of the whole set
+ * @return whether the fold was made
+ */
+bool IndexedInput::fold(unsigned int k, unsigned int folds, Random* rng, bool stratify)
+{
+	if ((!source) || (folds < 2) || (k >= folds))
+		return false;
+
+	std::vector<unsigned int> rows = order(rng, stratify);
+
+	trainIndex.clear();
+	testIndex.clear();
+	validationIndex.clear();
+	indexedTest = true;
+	for (unsigned int i = 0; i < rows.size(); ++i)
+	{
+		if ((i % folds) == k)
+			testIndex.push_back(rows[i]);
+		else
+			trainIndex.push_back(rows[i]);
+	}
+
+	return true;
+}
+
+/*!
+ * @brief train on appended rows plus a replay of the old ones
+ * @details every source row from firstNew on is trained, along with a random sample of
+ * replayFraction of the rows before it so the network does not forget them; the source's test
+ * rows pass through unchanged
+ * @param firstNew the first row not trained before
+ * @param replayFraction the share of the older rows to replay, 0 to 1
+ * @param rng the random stream to sample with, or NULL to replay the most recent old rows
+ * @return whether any rows were selected
+ */
+bool IndexedInput::incremental(unsigned int firstNew, double replayFraction, Random* rng)
+{
+	if (!source)
+		return false;
+
+	unsigned int total = source->getTrainSize();
+	if (firstNew > total)
+		firstNew = total;
+	if (replayFraction < 0.0)
+		replayFraction = 0.0;
+	if (replayFraction > 1.0)
+		replayFraction = 1.0;
+
+	std::vector<unsigned int> old;
+	for (unsigned int i = 0; i < firstNew; ++i)
+		old.push_back(i);
+
+	// a partial Fisher-Yates draws the replay sample to the back of old
+	unsigned int replay = (unsigned int)(replayFraction * firstNew + 0.5);
+	if (rng)
+	{
+		for (unsigned int i = firstNew; i > firstNew - replay; --i)
+		{
+			unsigned int j = rng->nextUInt(i);
+			unsigned int tmp = old[i - 1];
+			old[i - 1] = old[j];
+			old[j] = tmp;
+		}
+	}
+
+	trainIndex.clear();
+	testIndex.clear();
+	validationIndex.clear();
+	indexedTest = false;
+	trainIndex.insert(trainIndex.end(), old.end() - replay, old.end());
+	std::sort(trainIndex.begin(), trainIndex.end());
+	for (unsigned int i = firstNew; i < total; ++i)
+		trainIndex.push_back(i);
+
+	return !trainIndex.empty();
+}
+
+/*!
+ * @brief train on a chosen subset of the rows
+ * @details the source's test rows pass through unchanged
+ * @param rows the source training rows to keep, in the order to train them
+ * @return false when a row is out of range
+ */
+bool IndexedInput::keep(const std::vector<unsigned int>& rows)
+{
+	if (!source)
+		return false;
+
+	unsigned int total = source->getTrainSize();
+	for (unsigned int i = 0; i < rows.size(); ++i)
+	{
+		if (rows[i] >= total)
+			return false;
+	}
+
+	trainIndex = rows;
+	testIndex.clear();
+	validationIndex.clear();
+	indexedTest = false;
+	return true;
+}
+
+/*!
+ * @brief move a share of the training rows into the validation split
+ * @details the test rows are left as they are; the rows that stay keep their order
+ * @param pct percent of the training rows to hold out
+ * @param rng the random stream to pick them with, or NULL to take the last rows
+ * @return false when no row would be left on either side
+ */
+bool IndexedInput::holdOut(unsigned int pct, Random* rng)
+{
+	unsigned int total = trainIndex.size();
+	unsigned int held = (unsigned int)(((uint64_t)total * pct) / 100);
+	if ((!source) || (held == 0) || (held >= total))
+		return false;
+
+	std::vector<unsigned int> picks(total);
+	for (unsigned int i = 0; i < total; ++i)
+		picks[i] = i;
+	if (rng)
+	{
+		for (unsigned int i = total; i > 1; --i)
+		{
+			unsigned int j = rng->nextUInt(i);
+			unsigned int tmp = picks[i - 1];
+			picks[i - 1] = picks[j];
+			picks[j] = tmp;
+		}
+	}
+
+	std::vector<bool> isHeld(total, false);
+	for (unsigned int i = total - held; i < total; ++i)
+		isHeld[picks[i]] = true;
+
+	std::vector<unsigned int> kept;
+	validationIndex.clear();
+	for (unsigned int i = 0; i < total; ++i)
+	{
+		if (isHeld[i])
+			validationIndex.push_back(trainIndex[i]);
+		else
+			kept.push_back(trainIndex[i]);
+	}
+	trainIndex.swap(kept);
+	return true;
+}
+
+/*!
+ * @brief permute the train order
+ * @details a Fisher-Yates shuffle of the indices; the rows themselves never move
+ * @param rng the random stream
+ */
+void IndexedInput::shuffle(Random& rng) const
+{
+	for (unsigned int i = trainIndex.size(); i > 1; --i)
+	{
+		unsigned int j = rng.nextUInt(i);
+		unsigned int tmp = trainIndex[i - 1];
+		trainIndex[i - 1] = trainIndex[j];
+		trainIndex[j] = tmp;
+	}
+}
+
+/*!
+ * @brief permute the train order block by block
+ * @details shuffles the order of the blocks of blockRows consecutive source rows, then the rows
+ * inside each block, so a disk backed source still reads one block at a time. A StreamInput
+ * source is handed the block order so its prefetcher decodes the next block of the epoch.
+ * @param rng the random stream
+ * @param blockRows the rows per block, StreamInput::WINDOW_ROWS for streamed sources
+ */
+void IndexedInput::shuffleBlocks(Random& rng, unsigned int blockRows) const
+{
+	if ((!source) || (blockRows <= 1))
+	{
+		shuffle(rng);
+		return;
+	}
+
+	// bucket the train rows by source block, keeping their current order
+	unsigned int blockCount = (source->getTrainSize() + blockRows - 1) / blockRows;
+	std::vector<std::vector<unsigned int> > blocks(blockCount);
+	for (unsigned int i = 0; i < trainIndex.size(); ++i)
+	{
+		unsigned int block = trainIndex[i] / blockRows;
+		if (block < blockCount)
+			blocks[block].push_back(trainIndex[i]);
+	}
+
+	std::vector<unsigned int> blockOrder;
+	for (unsigned int i = 0; i < blockCount; ++i)
+	{
+		if (!blocks[i].empty())
+			blockOrder.push_back(i);
+	}
+
+	for (unsigned int i = blockOrder.size(); i > 1; --i)
+	{
+		unsigned int j = rng.nextUInt(i);
+		unsigned int tmp = blockOrder[i - 1];
+		blockOrder[i - 1] = blockOrder[j];
+		blockOrder[j] = tmp;
+	}
+
+	trainIndex.clear();
+	for (unsigned int i = 0; i < blockOrder.size(); ++i)
+	{
+		std::vector<unsigned int>& rows = blocks[blockOrder[i]];
+		for (unsigned int j = rows.size(); j > 1; --j)
+		{
+			unsigned int k = rng.nextUInt(j);
+			unsigned int tmp = rows[j - 1];
+			rows[j - 1] = rows[k];
+			rows[k] = tmp;
+		}
+		trainIndex.insert(trainIndex.end(), rows.begin(), rows.end());
+	}
+
+	const StreamInput* stream = dynamic_cast<const StreamInput*>(source);
+	if ((stream) && (blockRows == StreamInput::WINDOW_ROWS))
+		stream->setTrainOrder(blockOrder);
+}
+
+/*!
+ * @brief shuffle the train order every epoch
+ * @details the order is permuted now and again whenever row 0 is requested right after the
+ * last row, which is how a new epoch starts; the stream is split off the calling thread's Random
+ * @param enabled whether to shuffle
+ * @param blockRows 0 for a full shuffle, otherwise the block size for shuffleBlocks
+ */
+void IndexedInput::setShuffle(bool enabled, unsigned int blockRows)
+{
+	if (shuffleRandom)
+		delete shuffleRandom;
+	shuffleRandom = NULL;
+	shuffleBlockRows = blockRows;
+	resetEpochs();
+
+	if (!enabled)
+	{
+		const StreamInput* stream = dynamic_cast<const StreamInput*>(source);
+		if (stream)
+			stream->setTrainOrder(std::vector<unsigned int>());
+		return;
+	}
+
+	shuffleRandom = new Random();
+	shuffleRandom->seed(Random::streamSeed("indexedinput.shuffle"));
+	if (shuffleBlockRows > 0)
+		shuffleBlocks(*shuffleRandom, shuffleBlockRows);
+	else
+		shuffle(*shuffleRandom);
+}
+
+void IndexedInput::import(shmea::GString fname)
+{
+	printf("[DATA] IndexedInput indexes an imported source, \"%s\" not loaded\n", fname.c_str());
+}
+
+void IndexedInput::resetEpochs() const
+{
+	lastFeatureRow = 0;
+	lastLabelRow = 0;
+	featureEpoch = 0;
+	labelEpoch = 0;
+	shuffledEpoch = 0;
+}
+
+/*!
+ * @brief reshuffle when a read starts a new epoch
+ * @details the features and labels keep their own cursors, and an accessor only starts a new
+ * epoch when it reads row 0 right after the last row. The order is permuted once, by whichever
+ * accessor gets there first, so out-of-order reads within an epoch (a batch of features, then
+ * its labels) never reshuffle under a row that is half read
+ * @param index the train row about to be read
+ * @param lastRow the calling accessor's cursor
+ * @param epoch the calling accessor's epoch
+ */
+void IndexedInput::noteTrainRow(unsigned int index, unsigned int& lastRow,
+								unsigned int& epoch) const
+{
+	if ((index == 0) && (trainIndex.size() > 1) && (lastRow + 1 == trainIndex.size()))
+		++epoch;
+	lastRow = index;
+
+	// a new epoch
+	if ((shuffleRandom) && (epoch > shuffledEpoch))
+	{
+		shuffledEpoch = epoch;
+		if (shuffleBlockRows > 0)
+			shuffleBlocks(*shuffleRandom, shuffleBlockRows);
+		else
+			shuffle(*shuffleRandom);
+	}
+}
+
+shmea::GList IndexedInput::getTrainRow(unsigned int index) const
+{
+	NNC_PROFILE_SCOPE("data.train_row");
+	if ((!source) || (index >= trainIndex.size()))
+		return shmea::GList();
+
+	noteTrainRow(index, lastFeatureRow, featureEpoch);
+	return source->getTrainRow(trainIndex[index]);
+}
+
+shmea::GList IndexedInput::getTrainExpectedRow(unsigned int index) const
+{
+	if ((!source) || (index >= trainIndex.size()))
+		return shmea::GList();
+
+	noteTrainRow(index, lastLabelRow, labelEpoch);
+	return source->getTrainExpectedRow(trainIndex[index]);
+}
+
+shmea::GList IndexedInput::getTestRow(unsigned int index) const
+{
+	NNC_PROFILE_SCOPE("data.test_row");
+	if (!source)
+		return shmea::GList();
+
+	if (!indexedTest)
+		return source->getTestRow(index);
+
+	if (index >= testIndex.size())
+		return shmea::GList();
+
+	return source->getTrainRow(testIndex[index]);
+}
+
+shmea::GList IndexedInput::getTestExpectedRow(unsigned int index) const
+{
+	if (!source)
+		return shmea::GList();
+
+	if (!indexedTest)
+		return source->getTestExpectedRow(index);
+
+	if (index >= testIndex.size())
+		return shmea::GList();
+
+	return source->getTrainExpectedRow(testIndex[index]);
+}
+
+shmea::GList IndexedInput::getValidationRow(unsigned int index) const
+{
+	if ((!source) || (index >= validationIndex.size()))
+		return shmea::GList();
+
+	return source->getTrainRow(validationIndex[index]);
+}
+
+shmea::GList IndexedInput::getValidationExpectedRow(unsigned int index) const
+{
+	if ((!source) || (index >= validationIndex.size()))
+		return shmea::GList();
+
+	return source->getTrainExpectedRow(validationIndex[index]);
+}
+
+unsigned int IndexedInput::getValidationSize() const
+{
+	return validationIndex.size();
+}
+
+unsigned int IndexedInput::getTrainSize() const
+{
+	return trainIndex.size();
+}
+
+unsigned int IndexedInput::getTestSize() const
+{
+	if ((source) && (!indexedTest))
+		return source->getTestSize();
+
+	return testIndex.size();
+}
+
+unsigned int IndexedInput::getFeatureCount() const
+{
+	if (!source)
+		return 0;
+
+	return source->getFeatureCount();
+}
+
+/*!
+ * @brief get the bytes held by the row indexes
+ * @details the source is not counted, it is not ours
+ * @return the bytes
+ */
+size_t IndexedInput::getBytes() const
+{
+	return (trainIndex.capacity() + testIndex.capacity() + validationIndex.capacity()) *
+		   sizeof(unsigned int);
+}
+
+int IndexedInput::getType() const
+{
+	if (!source)
+		return glades::DataInput::CSV;
+
+	return source->getType();
+}
@@ -0,0 +1,105 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _INDEXEDINPUT
+#define _INDEXEDINPUT
+
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include <stdint.h>
+#include <vector>
+
+class Random;
+
+// A split of another input described only by row indices. Train, test and
+// validation rows are all drawn from the source's training rows, so several
+// splits or folds can share one imported dataset without copying it. Until a
+// split is made the source's own test rows are passed through. With shuffling
+// on, the train order is permuted again at the start of every epoch.
+class IndexedInput : public glades::DataInput
+{
+private:
+	const glades::DataInput* source;
+	mutable std::vector<unsigned int> trainIndex;
+	std::vector<unsigned int> testIndex;
+	std::vector<unsigned int> validationIndex;
+	bool indexedTest;
+
+	mutable Random* shuffleRandom;
+	mutable unsigned int shuffleBlockRows;
+	mutable unsigned int lastFeatureRow;
+	mutable unsigned int lastLabelRow;
+	mutable unsigned int featureEpoch;
+	mutable unsigned int labelEpoch;
+	mutable unsigned int shuffledEpoch;
+
+	// owns shuffleRandom
+	IndexedInput(const IndexedInput&);
+	void operator=(const IndexedInput&);
+
+	std::vector<unsigned int> order(Random*, bool) const;
+	int labelOf(unsigned int) const;
+	void resetEpochs() const;
+	void noteTrainRow(unsigned int, unsigned int&, unsigned int&) const;
+
+public:
+	IndexedInput();
+	IndexedInput(const glades::DataInput*);
+	virtual ~IndexedInput();
+
+	void setSource(const glades::DataInput*);
+	const glades::DataInput* getSource() const;
+
+	bool split(int64_t, int64_t, int64_t, Random* = NULL, bool = false);
+	bool fold(unsigned int, unsigned int, Random* = NULL, bool = false);
+	bool incremental(unsigned int, double, Random* = NULL);
+	bool keep(const std::vector<unsigned int>&);
+	bool holdOut(unsigned int, Random* = NULL);
+
+	void shuffle(Random&) const;
+	void shuffleBlocks(Random&, unsigned int) const;
+	void setShuffle(bool, unsigned int = 0);
+
+	virtual void import(shmea::GString);
+
+	virtual shmea::GList getTrainRow(unsigned int) const;
+	virtual shmea::GList getTrainExpectedRow(unsigned int) const;
+
+	virtual shmea::GList getTestRow(unsigned int) const;
+	virtual shmea::GList getTestExpectedRow(unsigned int) const;
+
+	shmea::GList getValidationRow(unsigned int) const;
+	shmea::GList getValidationExpectedRow(unsigned int) const;
+	unsigned int getValidationSize() const;
+	size_t getBytes() const;
+
+	virtual unsigned int getTrainSize() const;
+	virtual unsigned int getTestSize() const;
+	virtual unsigned int getFeatureCount() const;
+
+	virtual int getType() const;
+};
+
+#endif
@@ -0,0 +1,170 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "inputloader.h"
+#include "../core/profiler.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Machine Learning/DataObjects/ImageInput.h"
+#include "Backend/Machine Learning/DataObjects/NumberInput.h"
+#include "augmentinput.h"
+#include "bincache.h"
+#include "csvreader.h"
+#include "denseinput.h"
+#include "indexedinput.h"
+#include "shardinput.h"
+#include "streaminput.h"
+#include "textinput.h"
+
+/*!
+ * @brief import a dataset
+ * @details csv and text names are relative to datasets/ and are rewritten to the full path
+ * @param inputFName the dataset name, updated to the path that was loaded
+ * @param inputType the DataInput enum of the dataset
+ * @param threads the threads for a parallel import; 0 uses every core
+ * @return the imported input, or NULL for unsupported types; the caller owns it
+ */
+glades::DataInput* InputLoader::load(shmea::GString& inputFName, int inputType,
+									 unsigned int threads)
+{
+	NNC_PROFILE_SCOPE("data.load");
+	glades::DataInput* di = NULL;
+	if (inputType == glades::DataInput::CSV)
+	{
+		inputFName = "datasets/" + inputFName;
+
+		int64_t inputSize = CSVReader::fileSize(inputFName);
+		if (inputSize > PARALLEL_THRESHOLD)
+		{
+			// A fresh binary cache skips parsing entirely
+			DenseInput* dense = new DenseInput();
+			if (BinCache::load(*dense, inputFName))
+			{
+				printf("[NN] Mapped cached \"%s\"\n", inputFName.c_str());
+				return dense;
+			}
+
+			if ((inputSize <= STREAM_THRESHOLD) && (dense->importParallel(inputFName, threads)))
+			{
+				BinCache::save(*dense, inputFName);
+				return dense;
+			}
+
+			delete dense;
+		}
+
+		if (inputSize > STREAM_THRESHOLD)
+			di = new StreamInput();
+		else
+			di = new glades::NumberInput();
+	}
+	else if (inputType == glades::DataInput::IMAGE)
+	{
+		// a pack from "nncreator pack" replaces the small files
+		shmea::GString packName = ShardInput::packPath(inputFName);
+		if (CSVReader::fileSize(packName) > 0)
+		{
+			ShardInput* shards = new ShardInput();
+			shards->import(packName);
+			if (shards->loaded)
+			{
+				printf("[NN] Mapped pack \"%s\"\n", packName.c_str());
+				return shards;
+			}
+			delete shards;
+		}
+
+		// inputFName = "datasets/images/" + inputFName + "/";
+		di = new glades::ImageInput();
+	}
+	else if (inputType == glades::DataInput::TEXT)
+	{
+		inputFName = "datasets/" + inputFName;
+
+		// a word list next to the dataset replaces the hashing trick
+		TextInput* text = new TextInput();
+		text->setThreads(threads);
+		shmea::GString dictName = inputFName + ".dict";
+		if (CSVReader::fileSize(dictName) > 0)
+			text->loadDictionary(dictName);
+
+		text->import(inputFName);
+		if (text->getTrainSize() == 0)
+		{
+			delete text;
+			return NULL;
+		}
+		return text;
+	}
+	else
+		return NULL;
+
+	di->import(inputFName);
+	return di;
+}
+
+/*!
+ * @brief the feature encoding load() gives a csv
+ * @details follows load's size dispatch: NumberInput up to PARALLEL_THRESHOLD, the app's parser
+ * above it, whether imported, mapped from a cache or streamed
+ * @param fname the csv path, as load resolved it
+ * @return an ENCODING_ value, ENCODING_UNKNOWN when the file is missing
+ */
+uint32_t InputLoader::encodingOf(const shmea::GString& fname)
+{
+	int64_t inputSize = CSVReader::fileSize(fname);
+	if (inputSize < 0)
+		return ENCODING_UNKNOWN;
+
+	return (inputSize > PARALLEL_THRESHOLD) ? ENCODING_APP : ENCODING_NUMBERINPUT;
+}
+
+/*!
+ * @brief delete an input from load()
+ * @details DataInput has no virtual destructor, so inputs are deleted through their own type
+ * @param di the input to delete
+ */
+void InputLoader::release(glades::DataInput* di)
+{
+	if (!di)
+		return;
+
+	if (AugmentInput* augmented = dynamic_cast<AugmentInput*>(di))
+		delete augmented;
+	else if (DenseInput* dense = dynamic_cast<DenseInput*>(di))
+		delete dense;
+	else if (StreamInput* stream = dynamic_cast<StreamInput*>(di))
+		delete stream;
+	else if (TextInput* text = dynamic_cast<TextInput*>(di))
+		delete text;
+	else if (ShardInput* shards = dynamic_cast<ShardInput*>(di))
+		delete shards;
+	else if (IndexedInput* indexed = dynamic_cast<IndexedInput*>(di))
+		delete indexed;
+	else if (glades::NumberInput* number = dynamic_cast<glades::NumberInput*>(di))
+		delete number;
+	else if (glades::ImageInput* image = dynamic_cast<glades::ImageInput*>(di))
+		delete image;
+}
@@ -0,0 +1,65 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _INPUTLOADER
+#define _INPUTLOADER
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace shmea {
+class GString;
+};
+
+namespace glades {
+class DataInput;
+};
+
+// Picks and imports the DataInput for a dataset. Large csv files are imported
+// on all cores and cached next to the source, files too big for memory are
+// streamed, and everything else goes through glades::NumberInput. Text files
+// are tokenized by TextInput, with "<file>.dict" as the word list when present.
+// NumberInput and the app's own parser encode features differently, so the
+// encoding a csv gets is recorded with the networks trained on it.
+class InputLoader
+{
+public:
+	// csv files above this size are imported on all cores
+	static const int64_t PARALLEL_THRESHOLD = 32 * 1024 * 1024;
+	// csv files above this size are streamed instead of loaded into memory
+	static const int64_t STREAM_THRESHOLD = 256 * 1024 * 1024;
+
+	// how a csv's features are encoded
+	static const uint32_t ENCODING_UNKNOWN = 0;
+	static const uint32_t ENCODING_NUMBERINPUT = 1; // glades standardization
+	static const uint32_t ENCODING_APP = 2;			// the app's z-score and one-hot
+
+	static glades::DataInput* load(shmea::GString&, int, unsigned int = 0);
+	static uint32_t encodingOf(const shmea::GString&);
+	static void release(glades::DataInput*);
+};
+
+#endif
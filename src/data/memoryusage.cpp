@@ -0,0 +1,161 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "memoryusage.h"
+#include "Backend/Database/GType.h"
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include "Backend/Machine Learning/Structure/nninfo.h"
+#include "augmentinput.h"
+#include "denseinput.h"
+#include "indexedinput.h"
+#include "shardinput.h"
+#include "streaminput.h"
+#include "textinput.h"
+#include <stdio.h>
+
+size_t MemoryUsage::budgetBytes = MemoryUsage::NO_BUDGET;
+
+// a glades table cell: the type plus its value block
+static const size_t CELL_BYTES = sizeof(shmea::GType) + sizeof(double);
+
+/*!
+ * @brief estimate the bytes of a network
+ * @details fully connected layers plus a bias per node
+ * @param cInfo the structure
+ * @return the estimate, all zero without a structure
+ */
+NetworkBytes MemoryUsage::network(const glades::NNInfo* cInfo)
+{
+	NetworkBytes bytes;
+	bytes.weights = 0;
+	bytes.gradients = 0;
+	bytes.activations = 0;
+	bytes.total = 0;
+	if (!cInfo)
+		return bytes;
+
+	size_t weights = 0;
+	size_t nodes = cInfo->getInputLayerSize();
+	size_t prevSize = cInfo->getInputLayerSize();
+	for (int i = 0; i < cInfo->numHiddenLayers(); ++i)
+	{
+		size_t cSize = cInfo->getHiddenLayerSize(i);
+		weights += (prevSize + 1) * cSize;
+		nodes += cSize;
+		prevSize = cSize;
+	}
+	weights += (prevSize + 1) * cInfo->getOutputLayerSize();
+	nodes += cInfo->getOutputLayerSize();
+
+	bytes.weights = weights * sizeof(float);
+	bytes.gradients = 2 * weights * sizeof(float);
+	bytes.activations = 2 * nodes * sizeof(float);
+	bytes.total = bytes.weights + bytes.gradients + bytes.activations;
+	return bytes;
+}
+
+/*!
+ * @brief count the bytes of a dataset
+ * @details exact for the app's inputs; the glades inputs are estimated from their row and feature
+ * counts, and a row index adds the input under it
+ * @param di the dataset
+ * @return the bytes
+ */
+size_t MemoryUsage::input(const glades::DataInput* di)
+{
+	if (!di)
+		return 0;
+
+	const IndexedInput* indexed = dynamic_cast<const IndexedInput*>(di);
+	if (indexed)
+		return indexed->getBytes() + input(indexed->getSource());
+
+	const AugmentInput* augmented = dynamic_cast<const AugmentInput*>(di);
+	if (augmented)
+		return augmented->getBytes() + input(augmented->getSource());
+
+	const DenseInput* dense = dynamic_cast<const DenseInput*>(di);
+	if (dense)
+		return dense->getBytes();
+
+	const StreamInput* streamed = dynamic_cast<const StreamInput*>(di);
+	if (streamed)
+		return streamed->getBytes();
+
+	const TextInput* text = dynamic_cast<const TextInput*>(di);
+	if (text)
+		return text->getBytes();
+
+	const ShardInput* shards = dynamic_cast<const ShardInput*>(di);
+	if (shards)
+		return shards->getBytes();
+
+	// features plus at least one expected column per row
+	size_t rows = (size_t)di->getTrainSize() + di->getTestSize();
+	return rows * (di->getFeatureCount() + 1) * CELL_BYTES;
+}
+
+void MemoryUsage::setBudget(size_t newBudget)
+{
+	budgetBytes = newBudget;
+}
+
+size_t MemoryUsage::getBudget()
+{
+	return budgetBytes;
+}
+
+/*!
+ * @brief check a total against the budget
+ * @param bytes the total
+ * @return whether it fits, always true without a budget
+ */
+bool MemoryUsage::fits(size_t bytes)
+{
+	return (budgetBytes == NO_BUDGET) || (bytes <= budgetBytes);
+}
+
+/*!
+ * @brief format a byte count for people
+ * @param bytes the count
+ * @return e.g. "12.3 MB"
+ */
+std::string MemoryUsage::format(size_t bytes)
+{
+	static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+
+	double value = (double)bytes;
+	unsigned int unit = 0;
+	while ((value >= 1024.0) && (unit < 4))
+	{
+		value /= 1024.0;
+		++unit;
+	}
+
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), (unit == 0) ? "%.0f %s" : "%.1f %s", value, units[unit]);
+	return buffer;
+}
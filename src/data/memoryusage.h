@@ -0,0 +1,71 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _MEMORYUSAGE
+#define _MEMORYUSAGE
+
+#include <stddef.h>
+#include <string>
+
+namespace glades {
+class DataInput;
+class NNInfo;
+};
+
+// Estimated bytes of one network, by what holds them
+struct NetworkBytes
+{
+	size_t weights;
+	// deltas and momentum kept per weight for the updates
+	size_t gradients;
+	// outputs and errors kept per node for the passes
+	size_t activations;
+	size_t total;
+};
+
+// Byte counts for the two things that make a run run out of memory, the
+// network and its dataset, and an optional budget to check them against
+// before the run starts. Network sizes are estimates from the layer shapes,
+// since the node graph belongs to glades.
+class MemoryUsage
+{
+private:
+	static size_t budgetBytes;
+
+public:
+	static const size_t NO_BUDGET = 0;
+
+	static NetworkBytes network(const glades::NNInfo*);
+	static size_t input(const glades::DataInput*);
+
+	static void setBudget(size_t);
+	static size_t getBudget();
+	static bool fits(size_t);
+
+	static std::string format(size_t);
+};
+
+#endif
@@ -0,0 +1,262 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "modelcache.h"
+#include "../core/metrics.h"
+#include "Backend/Machine Learning/Structure/nninfo.h"
+#include "memoryusage.h"
+#include <stdio.h>
+
+static const int CACHE_HITS =
+	Metrics::counter("nncreator_model_cache_hits", "Predict requests served by a resident model");
+static const int CACHE_MISSES =
+	Metrics::counter("nncreator_model_cache_misses", "Predict requests that loaded the model");
+static const int CACHE_EVICTIONS =
+	Metrics::counter("nncreator_model_cache_evictions", "Models evicted to fit the cache budget");
+
+pthread_mutex_t ModelCache::cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t ModelCache::loadCond = PTHREAD_COND_INITIALIZER;
+std::map<std::string, ResidentModel*> ModelCache::models;
+std::list<ResidentModel*> ModelCache::lru;
+size_t ModelCache::budgetBytes = ModelCache::DEFAULT_BUDGET;
+size_t ModelCache::residentBytes = 0;
+
+ResidentModel::ResidentModel()
+{
+	refs = 0;
+	ready = false;
+	retired = false;
+	inLRU = false;
+	bytes = 0;
+	name = "";
+}
+
+/*!
+ * @brief load a saved network for inference
+ * @param newName the network name
+ * @return whether the network and its structure loaded
+ */
+bool ResidentModel::load(const shmea::GString& newName)
+{
+	if (!network.load(newName))
+		return false;
+
+	glades::NNInfo* cInfo = network.getNNInfo();
+	if (!cInfo)
+		return false;
+
+	name = newName;
+	batcher.setNetwork(&network, cInfo->getInputLayerSize(), cInfo->getOutputLayerSize());
+	bytes = sizeof(ResidentModel) + MemoryUsage::network(cInfo).total;
+
+	return true;
+}
+
+size_t ResidentModel::getBytes() const
+{
+	return bytes;
+}
+
+/*!
+ * @brief get a resident model to run requests on
+ * @details loads the network on first use; concurrent first requests wait for a single load
+ * instead of reading the file once each. Every successful acquire must be paired with release.
+ * @param name the network name
+ * @return the model, or NULL when it does not load
+ */
+ResidentModel* ModelCache::acquire(const shmea::GString& name)
+{
+	std::string key = name.c_str();
+
+	pthread_mutex_lock(&cacheMutex);
+	std::map<std::string, ResidentModel*>::iterator itr = models.find(key);
+	while ((itr != models.end()) && (!itr->second->ready))
+	{
+		pthread_cond_wait(&loadCond, &cacheMutex);
+		itr = models.find(key);
+	}
+
+	if (itr != models.end())
+	{
+		ResidentModel* cModel = itr->second;
+		++cModel->refs;
+		lru.splice(lru.begin(), lru, cModel->lruPos);
+		pthread_mutex_unlock(&cacheMutex);
+		Metrics::add(CACHE_HITS);
+		return cModel;
+	}
+
+	// read it outside the lock so other models keep serving
+	ResidentModel* cModel = new ResidentModel();
+	cModel->name = name;
+	cModel->refs = 1;
+	models[key] = cModel;
+	pthread_mutex_unlock(&cacheMutex);
+	Metrics::add(CACHE_MISSES);
+
+	bool loaded = cModel->load(name);
+
+	pthread_mutex_lock(&cacheMutex);
+	if (!loaded)
+	{
+		itr = models.find(key);
+		if ((itr != models.end()) && (itr->second == cModel))
+			models.erase(itr);
+		pthread_cond_broadcast(&loadCond);
+		pthread_mutex_unlock(&cacheMutex);
+
+		printf("[PREDICT] Unable to load \"%s\"\n", name.c_str());
+		delete cModel;
+		return NULL;
+	}
+
+	cModel->ready = true;
+	if (!cModel->retired)
+	{
+		// invalidated mid load: serve this request, but the next one reads the new save
+		lru.push_front(cModel);
+		cModel->lruPos = lru.begin();
+		cModel->inLRU = true;
+		residentBytes += cModel->bytes;
+		evict();
+	}
+	pthread_cond_broadcast(&loadCond);
+	pthread_mutex_unlock(&cacheMutex);
+
+	printf("[PREDICT] Loaded \"%s\" (%lu KB resident)\n", name.c_str(),
+		   (unsigned long)(cModel->bytes / 1024));
+	return cModel;
+}
+
+/*!
+ * @brief hand back a model from acquire
+ * @param cModel the model
+ */
+void ModelCache::release(ResidentModel* cModel)
+{
+	if (!cModel)
+		return;
+
+	pthread_mutex_lock(&cacheMutex);
+	--cModel->refs;
+	bool drop = ((cModel->retired) && (cModel->refs == 0));
+
+	// an over budget registry could not evict this one while it was in use
+	if ((!drop) && (cModel->refs == 0))
+		evict();
+	pthread_mutex_unlock(&cacheMutex);
+
+	if (drop)
+		delete cModel;
+}
+
+/*!
+ * @brief drop the resident copy of a network
+ * @details called after a network is saved so the next request loads the new weights; requests
+ * already running keep the old copy until they release it
+ * @param name the network name
+ */
+void ModelCache::invalidate(const shmea::GString& name)
+{
+	ResidentModel* dropped = NULL;
+
+	pthread_mutex_lock(&cacheMutex);
+	std::map<std::string, ResidentModel*>::iterator itr = models.find(name.c_str());
+	if (itr != models.end())
+	{
+		ResidentModel* cModel = itr->second;
+		retire(cModel);
+		if ((cModel->ready) && (cModel->refs == 0))
+			dropped = cModel;
+	}
+	pthread_mutex_unlock(&cacheMutex);
+
+	delete dropped;
+}
+
+/*!
+ * @brief take a model out of the registry
+ * @details expects cacheMutex to be held; the caller deletes the model when nothing holds it
+ * @param cModel the model
+ */
+void ModelCache::retire(ResidentModel* cModel)
+{
+	std::map<std::string, ResidentModel*>::iterator itr = models.find(cModel->name.c_str());
+	if ((itr != models.end()) && (itr->second == cModel))
+		models.erase(itr);
+
+	if (cModel->inLRU)
+	{
+		lru.erase(cModel->lruPos);
+		cModel->inLRU = false;
+		residentBytes -= cModel->bytes;
+	}
+
+	cModel->retired = true;
+}
+
+/*!
+ * @brief evict idle models until the resident total fits the budget
+ * @details least recently used first; models in use are skipped; expects cacheMutex to be held
+ */
+void ModelCache::evict()
+{
+	std::list<ResidentModel*>::iterator itr = lru.end();
+	while ((residentBytes > budgetBytes) && (itr != lru.begin()))
+	{
+		--itr;
+		ResidentModel* cModel = *itr;
+		if (cModel->refs > 0)
+			continue;
+
+		// retire invalidates this position, resume from the one after it
+		std::list<ResidentModel*>::iterator next = itr;
+		++next;
+		printf("[PREDICT] Evicting \"%s\"\n", cModel->name.c_str());
+		retire(cModel);
+		delete cModel;
+		Metrics::add(CACHE_EVICTIONS);
+		itr = next;
+	}
+}
+
+void ModelCache::setBudget(size_t newBudget)
+{
+	pthread_mutex_lock(&cacheMutex);
+	budgetBytes = newBudget;
+	evict();
+	pthread_mutex_unlock(&cacheMutex);
+}
+
+size_t ModelCache::getBudget()
+{
+	return budgetBytes;
+}
+
+size_t ModelCache::getResidentBytes()
+{
+	return residentBytes;
+}
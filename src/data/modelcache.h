@@ -0,0 +1,99 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _MODELCACHE
+#define _MODELCACHE
+
+#include "Backend/Database/GString.h"
+#include "Backend/Machine Learning/Networks/network.h"
+#include "predictbatcher.h"
+#include <list>
+#include <map>
+#include <pthread.h>
+#include <stddef.h>
+#include <string>
+
+class ModelCache;
+
+// A network loaded for inference along with the batcher that serializes its
+// test passes. Handed out by ModelCache::acquire and returned with release.
+class ResidentModel
+{
+private:
+	friend class ModelCache;
+
+	unsigned int refs;
+	bool ready;
+	bool retired;
+	bool inLRU;
+	std::list<ResidentModel*>::iterator lruPos;
+	size_t bytes;
+
+	ResidentModel();
+
+	// owns its network
+	ResidentModel(const ResidentModel&);
+	void operator=(const ResidentModel&);
+
+public:
+	shmea::GString name;
+	glades::NNetwork network;
+	PredictBatcher batcher;
+
+	bool load(const shmea::GString&);
+	size_t getBytes() const;
+};
+
+// Process wide registry of resident models. Each saved network is read from
+// disk once and shared by every request until it is evicted, least recently
+// used first, to stay under the memory budget. A model that is invalidated or
+// evicted while requests still hold it stays alive until the last release.
+class ModelCache
+{
+private:
+	static pthread_mutex_t cacheMutex;
+	static pthread_cond_t loadCond;
+	static std::map<std::string, ResidentModel*> models;
+	static std::list<ResidentModel*> lru; // most recently used first
+	static size_t budgetBytes;
+	static size_t residentBytes;
+
+	static void retire(ResidentModel*);
+	static void evict();
+
+public:
+	static const size_t DEFAULT_BUDGET = 512 * 1024 * 1024;
+
+	static ResidentModel* acquire(const shmea::GString&);
+	static void release(ResidentModel*);
+	static void invalidate(const shmea::GString&);
+
+	static void setBudget(size_t);
+	static size_t getBudget();
+	static size_t getResidentBytes();
+};
+
+#endif
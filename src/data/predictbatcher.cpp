@@ -0,0 +1,283 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "predictbatcher.h"
+#include "../core/metrics.h"
+#include "../core/profiler.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include "Backend/Machine Learning/Networks/network.h"
+#include "floatmatrix.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static const int PREDICT_ROWS =
+	Metrics::counter("nncreator_predict_rows", "Rows run through batched inference");
+static const int PREDICT_BATCHES =
+	Metrics::counter("nncreator_predict_batches", "Forward passes run by the predict batchers");
+
+// The rows of one batch served to NNetwork::test as its test set
+class BatchInput : public glades::DataInput
+{
+public:
+	FloatMatrix rows;
+	FloatMatrix expected;
+
+	BatchInput(unsigned int rowCount, unsigned int inputCount, unsigned int outputCount)
+	{
+		rows.resize(rowCount, inputCount);
+		expected.resize(rowCount, outputCount);
+		featureIsCategorical.resize(inputCount, false);
+	}
+
+	virtual void import(shmea::GString)
+	{
+		// filled by the batcher
+	}
+
+	virtual shmea::GList getTrainRow(unsigned int) const
+	{
+		return shmea::GList();
+	}
+
+	virtual shmea::GList getTrainExpectedRow(unsigned int) const
+	{
+		return shmea::GList();
+	}
+
+	virtual shmea::GList getTestRow(unsigned int index) const
+	{
+		return rows.getRow(index);
+	}
+
+	virtual shmea::GList getTestExpectedRow(unsigned int index) const
+	{
+		return expected.getRow(index);
+	}
+
+	virtual unsigned int getTrainSize() const
+	{
+		return 0;
+	}
+
+	virtual unsigned int getTestSize() const
+	{
+		return rows.numberOfRows();
+	}
+
+	virtual unsigned int getFeatureCount() const
+	{
+		return rows.numberOfCols();
+	}
+
+	virtual int getType() const
+	{
+		return glades::DataInput::CSV;
+	}
+};
+
+PredictBatcher::PredictBatcher()
+{
+	network = NULL;
+	inputCount = 0;
+	outputCount = 0;
+	pendingRows = 0;
+	leaderActive = false;
+	pthread_mutex_init(&batchMutex, NULL);
+	pthread_cond_init(&batchCond, NULL);
+}
+
+PredictBatcher::~PredictBatcher()
+{
+	network = NULL; // Not ours to delete
+	pthread_cond_destroy(&batchCond);
+	pthread_mutex_destroy(&batchMutex);
+}
+
+/*!
+ * @brief set the network to run
+ * @details must be called before the first predict
+ * @param newNetwork the loaded network, not owned
+ * @param newInputs the width of an input row
+ * @param newOutputs the number of output nodes
+ */
+void PredictBatcher::setNetwork(glades::NNetwork* newNetwork, unsigned int newInputs,
+								unsigned int newOutputs)
+{
+	network = newNetwork;
+	inputCount = newInputs;
+	outputCount = newOutputs;
+}
+
+unsigned int PredictBatcher::getInputCount() const
+{
+	return inputCount;
+}
+
+unsigned int PredictBatcher::getOutputCount() const
+{
+	return outputCount;
+}
+
+/*!
+ * @brief predict rows
+ * @details blocks until the batch holding these rows has run; safe to call from any number of
+ * service threads at once
+ * @param rows rowCount rows of inputCount encoded features, row-major
+ * @param rowCount the number of rows
+ * @param outputs filled with the network output for each row, row-major
+ * @return whether the batch ran
+ */
+bool PredictBatcher::predict(const float* rows, unsigned int rowCount, std::vector<float>& outputs)
+{
+	outputs.clear();
+	if ((!network) || (!rows) || (rowCount == 0))
+		return false;
+
+	Request req;
+	req.rows = rows;
+	req.rowCount = rowCount;
+	req.outputs = &outputs;
+	req.done = false;
+	req.ok = false;
+
+	pthread_mutex_lock(&batchMutex);
+	pending.push_back(&req);
+	pendingRows += rowCount;
+	if (pendingRows >= MAX_BATCH_ROWS)
+		pthread_cond_broadcast(&batchCond);
+
+	while (!req.done)
+	{
+		if (leaderActive)
+		{
+			pthread_cond_wait(&batchCond, &batchMutex);
+			continue;
+		}
+
+		// lead the next batch
+		leaderActive = true;
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += MAX_WAIT_US * 1000;
+		deadline.tv_sec += deadline.tv_nsec / 1000000000;
+		deadline.tv_nsec %= 1000000000;
+		while (pendingRows < MAX_BATCH_ROWS)
+		{
+			if (pthread_cond_timedwait(&batchCond, &batchMutex, &deadline) == ETIMEDOUT)
+				break;
+		}
+
+		std::vector<Request*> batch;
+		takeBatch(batch);
+		pthread_mutex_unlock(&batchMutex);
+
+		runBatch(batch);
+
+		pthread_mutex_lock(&batchMutex);
+		for (unsigned int i = 0; i < batch.size(); ++i)
+			batch[i]->done = true;
+		leaderActive = false;
+		pthread_cond_broadcast(&batchCond);
+	}
+	pthread_mutex_unlock(&batchMutex);
+
+	return req.ok;
+}
+
+/*!
+ * @brief move the oldest pending requests into a batch
+ * @details takes requests in arrival order up to MAX_BATCH_ROWS rows, but always at least one so
+ * an oversized request still runs; expects batchMutex to be held
+ * @param batch filled with the requests to run
+ */
+void PredictBatcher::takeBatch(std::vector<Request*>& batch)
+{
+	unsigned int batchRows = 0;
+	unsigned int taken = 0;
+	while (taken < pending.size())
+	{
+		Request* cReq = pending[taken];
+		if ((taken > 0) && (batchRows + cReq->rowCount > MAX_BATCH_ROWS))
+			break;
+
+		batch.push_back(cReq);
+		batchRows += cReq->rowCount;
+		++taken;
+	}
+
+	pending.erase(pending.begin(), pending.begin() + taken);
+	pendingRows -= batchRows;
+}
+
+/*!
+ * @brief run one batch through the network
+ * @details the rows are copied into a single test set so the whole batch costs one test pass
+ * @param batch the requests to run, owned by their callers
+ */
+void PredictBatcher::runBatch(const std::vector<Request*>& batch)
+{
+	NNC_PROFILE_SCOPE("predict.batch");
+	unsigned int batchRows = 0;
+	for (unsigned int i = 0; i < batch.size(); ++i)
+		batchRows += batch[i]->rowCount;
+
+	BatchInput input(batchRows, inputCount, outputCount);
+	unsigned int cRow = 0;
+	for (unsigned int i = 0; i < batch.size(); ++i)
+	{
+		const float* src = batch[i]->rows;
+		for (unsigned int r = 0; r < batch[i]->rowCount; ++r, ++cRow)
+			memcpy(input.rows.rowPtr(cRow), src + (size_t)r * inputCount,
+				   inputCount * sizeof(float));
+	}
+
+	network->test(&input);
+	Metrics::add(PREDICT_ROWS, batchRows);
+	Metrics::add(PREDICT_BATCHES);
+
+	// one block of outputs per test row, in row order
+	shmea::GList results = network->getResults();
+	if ((results.size() == 0) || (results.size() % batchRows != 0))
+	{
+		printf("[PREDICT] %u results for a batch of %u rows\n", results.size(), batchRows);
+		return;
+	}
+
+	unsigned int width = results.size() / batchRows;
+	cRow = 0;
+	for (unsigned int i = 0; i < batch.size(); ++i)
+	{
+		std::vector<float>& outputs = *batch[i]->outputs;
+		outputs.resize((size_t)batch[i]->rowCount * width);
+		for (unsigned int j = 0; j < outputs.size(); ++j)
+			outputs[j] = results.getFloat(cRow * width + j);
+		cRow += batch[i]->rowCount;
+		batch[i]->ok = true;
+	}
+}
@@ -0,0 +1,88 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _PREDICTBATCHER
+#define _PREDICTBATCHER
+
+#include <pthread.h>
+#include <stdint.h>
+#include <vector>
+
+namespace glades {
+class NNetwork;
+};
+
+// Groups concurrent prediction requests for one network into a single
+// inference pass. There is no batching thread: the first caller to find no
+// batch in flight becomes the leader, waits up to MAX_WAIT_US for more rows,
+// runs the whole batch and hands every caller its slice of the outputs.
+class PredictBatcher
+{
+private:
+	struct Request
+	{
+		const float* rows;
+		unsigned int rowCount;
+		std::vector<float>* outputs;
+		bool done;
+		bool ok;
+	};
+
+	glades::NNetwork* network;
+	unsigned int inputCount;
+	unsigned int outputCount;
+
+	pthread_mutex_t batchMutex;
+	pthread_cond_t batchCond;
+	std::vector<Request*> pending;
+	unsigned int pendingRows;
+	bool leaderActive;
+
+	void takeBatch(std::vector<Request*>&);
+	void runBatch(const std::vector<Request*>&);
+
+	// owns its mutex and condition
+	PredictBatcher(const PredictBatcher&);
+	void operator=(const PredictBatcher&);
+
+public:
+	// a batch is run as soon as it holds this many rows
+	static const unsigned int MAX_BATCH_ROWS = 256;
+	// longest a leader waits for more rows to join its batch
+	static const int64_t MAX_WAIT_US = 2000;
+
+	PredictBatcher();
+	~PredictBatcher();
+
+	void setNetwork(glades::NNetwork*, unsigned int, unsigned int);
+
+	bool predict(const float*, unsigned int, std::vector<float>&);
+
+	unsigned int getInputCount() const;
+	unsigned int getOutputCount() const;
+};
+
+#endif
@@ -0,0 +1,271 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "previewloader.h"
+#include "Backend/Database/GList.h"
+#include "streaminput.h"
+
+PreviewLoader::PreviewLoader()
+{
+	started = false;
+	stopping = false;
+	hasRequest = false;
+	hasResult = false;
+	csvPath = "";
+	imageName = "";
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&cond, NULL);
+}
+
+PreviewLoader::~PreviewLoader()
+{
+	stop();
+	pthread_cond_destroy(&cond);
+	pthread_mutex_destroy(&mutex);
+}
+
+/*!
+ * @brief ask for a preview
+ * @details replaces any request that has not been started yet; the thread is started on the
+ * first request
+ * @param type CSV or IMAGE
+ * @param name the dataset name as listed in the dataset dropdown
+ * @param test whether to read the test split
+ * @param row the first row, or the image index
+ * @param rows the rows to read for a csv page
+ */
+void PreviewLoader::request(int type, const shmea::GString& name, bool test, unsigned int row,
+							unsigned int rows)
+{
+	pthread_mutex_lock(&mutex);
+	if (stopping)
+	{
+		pthread_mutex_unlock(&mutex);
+		return;
+	}
+
+	pending.type = type;
+	pending.name = name;
+	pending.test = test;
+	pending.row = row;
+	pending.rows = (rows > 0) ? rows : 1;
+	hasRequest = true;
+
+	if (!started)
+	{
+		if (pthread_create(&thread, NULL, loaderLoop, (void*)this) == 0)
+			started = true;
+		else
+			printf("[PREVIEW] Could not start the loader thread\n");
+	}
+
+	pthread_cond_signal(&cond);
+	pthread_mutex_unlock(&mutex);
+}
+
+/*!
+ * @brief take the newest result
+ * @param newResult set to the result when there is one
+ * @return whether a result was waiting
+ */
+bool PreviewLoader::poll(PreviewResult& newResult)
+{
+	pthread_mutex_lock(&mutex);
+	bool ready = hasResult;
+	if (ready)
+	{
+		newResult = result;
+
+		// drop the loader's copies here, image reference counts are not thread safe
+		result = PreviewResult();
+		hasResult = false;
+	}
+	pthread_mutex_unlock(&mutex);
+
+	return ready;
+}
+
+void PreviewLoader::stop()
+{
+	pthread_mutex_lock(&mutex);
+	stopping = true;
+	bool wasStarted = started;
+	started = false;
+	pthread_cond_signal(&cond);
+	pthread_mutex_unlock(&mutex);
+
+	if (wasStarted)
+		pthread_join(thread, NULL);
+}
+
+void* PreviewLoader::loaderLoop(void* y)
+{
+	PreviewLoader* loader = (PreviewLoader*)y;
+
+	pthread_mutex_lock(&loader->mutex);
+	while (!loader->stopping)
+	{
+		if (!loader->hasRequest)
+		{
+			pthread_cond_wait(&loader->cond, &loader->mutex);
+			continue;
+		}
+
+		PreviewRequest cRequest = loader->pending;
+		loader->hasRequest = false;
+
+		// read without the lock, so the GUI can queue the next request meanwhile
+		pthread_mutex_unlock(&loader->mutex);
+		PreviewResult cResult;
+		loader->load(cRequest, cResult);
+		pthread_mutex_lock(&loader->mutex);
+
+		loader->result = cResult;
+		loader->hasResult = true;
+	}
+	pthread_mutex_unlock(&loader->mutex);
+
+	return NULL;
+}
+
+void PreviewLoader::load(const PreviewRequest& cRequest, PreviewResult& cResult)
+{
+	cResult.type = cRequest.type;
+	cResult.name = cRequest.name;
+	cResult.test = cRequest.test;
+	cResult.row = cRequest.row;
+
+	if (cRequest.type == CSV)
+		cResult.ok = loadRows(cRequest, cResult);
+	else if (cRequest.type == IMAGE)
+		cResult.ok = loadImage(cRequest, cResult);
+}
+
+/*!
+ * @brief read one page of csv rows
+ * @details seeks to the closest indexed record at or before the page and records new index
+ * entries while reading forward, so paging back and forth costs at most CHECKPOINT_ROWS extra
+ * records
+ */
+bool PreviewLoader::loadRows(const PreviewRequest& cRequest, PreviewResult& cResult)
+{
+	shmea::GString path = "datasets/" + cRequest.name;
+	if (cRequest.test)
+		path = StreamInput::testSibling(path);
+
+	std::vector<CSVField> fields;
+	if ((path != csvPath) || (!reader.isOpen()))
+	{
+		csvPath = "";
+		headers.clear();
+		checkpoints.clear();
+		if (!reader.open(path))
+			return false;
+
+		if (!reader.readRecord(fields))
+			return false;
+
+		for (unsigned int i = 0; i < fields.size(); ++i)
+			headers.push_back(shmea::GString(fields[i].toString().c_str()));
+		checkpoints.push_back(reader.tell());
+		csvPath = path;
+	}
+
+	unsigned int block = cRequest.row / CHECKPOINT_ROWS;
+	if (block >= checkpoints.size())
+		block = checkpoints.size() - 1;
+	if (!reader.seek(checkpoints[block]))
+		return false;
+
+	// keep the rows of the last full page seen, in case the request is past the end
+	unsigned int last = cRequest.row + cRequest.rows;
+	std::vector<shmea::GList> rows;
+	unsigned int firstRow = block * CHECKPOINT_ROWS;
+	unsigned int row = firstRow;
+	while (row < last)
+	{
+		int64_t offset = reader.tell();
+		if (!reader.readRecord(fields))
+			break;
+
+		if (((row % CHECKPOINT_ROWS) == 0) && (row / CHECKPOINT_ROWS == checkpoints.size()))
+			checkpoints.push_back(offset);
+
+		if (rows.size() == cRequest.rows)
+		{
+			rows.erase(rows.begin());
+			++firstRow;
+		}
+
+		shmea::GList cRow;
+		for (unsigned int i = 0; i < fields.size(); ++i)
+			cRow.addString(fields[i].toString().c_str());
+		rows.push_back(cRow);
+		++row;
+	}
+
+	// a request past the end shows the last page instead
+	cResult.row = firstRow;
+	cResult.size = row;
+	cResult.more = (row == last);
+	cResult.table = shmea::GTable(',', headers);
+	for (unsigned int i = 0; i < rows.size(); ++i)
+		cResult.table.addRow(rows[i]);
+
+	return true;
+}
+
+/*!
+ * @brief read one image
+ * @details ImageInput only imports a whole set, so the set is imported once here, off the
+ * GUI thread, and kept for the next and previous images
+ */
+bool PreviewLoader::loadImage(const PreviewRequest& cRequest, PreviewResult& cResult)
+{
+	if ((cRequest.name != imageName) || (!images.loaded))
+	{
+		imageName = "";
+		images.import(cRequest.name);
+		imageName = cRequest.name;
+	}
+
+	unsigned int size = cRequest.test ? images.getTestSize() : images.getTrainSize();
+	if (size == 0)
+		return false;
+
+	unsigned int index = (cRequest.row < size) ? cRequest.row : size - 1;
+	const shmea::GPointer<shmea::Image> cImage =
+		cRequest.test ? images.getTestImage(index) : images.getTrainImage(index);
+	if (!cImage)
+		return false;
+
+	// a copy of its own, so the GUI never shares a reference count with this thread
+	cResult.image = shmea::GPointer<shmea::Image>(new shmea::Image(*cImage.get()));
+	cResult.row = index;
+	cResult.size = size;
+	cResult.more = (index + 1 < size);
+	return true;
+}
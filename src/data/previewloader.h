@@ -0,0 +1,136 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _PREVIEWLOADER
+#define _PREVIEWLOADER
+
+#include "Backend/Database/GPointer.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Database/GTable.h"
+#include "Backend/Database/image.h"
+#include "Backend/Machine Learning/DataObjects/ImageInput.h"
+#include "csvreader.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <vector>
+
+// What the GUI asked to see: a page of csv rows or one image
+class PreviewRequest
+{
+public:
+	int type;
+	shmea::GString name;
+	bool test;
+	unsigned int row;
+	unsigned int rows;
+
+	PreviewRequest()
+	{
+		type = 0;
+		name = "";
+		test = false;
+		row = 0;
+		rows = 0;
+	}
+};
+
+// What the loader read for a request. row is the first row actually read,
+// which is clamped to the end of the dataset.
+class PreviewResult
+{
+public:
+	int type;
+	shmea::GString name;
+	bool test;
+	unsigned int row;
+	unsigned int size;
+	bool more;
+	bool ok;
+	shmea::GTable table;
+	shmea::GPointer<shmea::Image> image;
+
+	PreviewResult()
+	{
+		type = 0;
+		name = "";
+		test = false;
+		row = 0;
+		size = 0;
+		more = false;
+		ok = false;
+	}
+};
+
+// Reads dataset previews on a background thread so the GUI never blocks on
+// the disk. Only the latest request is kept; the GUI polls for the result
+// once per frame. Csv pages are read through a sparse index of record
+// offsets, so a page deep into a large file does not parse the rows before it.
+class PreviewLoader
+{
+private:
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	bool started;
+	bool stopping;
+
+	bool hasRequest;
+	PreviewRequest pending;
+	bool hasResult;
+	PreviewResult result;
+
+	// loader thread only
+	shmea::GString csvPath;
+	CSVReader reader;
+	std::vector<shmea::GString> headers;
+	std::vector<int64_t> checkpoints;
+	shmea::GString imageName;
+	glades::ImageInput images;
+
+	void load(const PreviewRequest&, PreviewResult&);
+	bool loadRows(const PreviewRequest&, PreviewResult&);
+	bool loadImage(const PreviewRequest&, PreviewResult&);
+
+	static void* loaderLoop(void*);
+
+	// owns a thread
+	PreviewLoader(const PreviewLoader&);
+	void operator=(const PreviewLoader&);
+
+public:
+	static const int CSV = 0;
+	static const int IMAGE = 1;
+	static const unsigned int CHECKPOINT_ROWS = 1024;
+
+	PreviewLoader();
+	virtual ~PreviewLoader();
+
+	void request(int, const shmea::GString&, bool, unsigned int, unsigned int = 1);
+	bool poll(PreviewResult&);
+	void stop();
+};
+
+#endif
@@ -0,0 +1,466 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "shardinput.h"
+#include "../core/atomicfile.h"
+#include "../core/profiler.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GString.h"
+#include "floatmatrix.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char PACK_MAGIC[8] = {'N', 'N', 'P', 'A', 'C', 'K', '\0', '\0'};
+static const char SHARD_MAGIC[8] = {'N', 'N', 'S', 'H', 'A', 'R', 'D', '\0'};
+static const uint32_t PACK_VERSION = 2;
+
+// the index file
+struct PackHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t floatSize;
+	uint32_t shardRows;
+	uint32_t features;
+	uint32_t expected;
+	uint32_t trainRows;
+	uint32_t testRows;
+	uint32_t trainShards;
+	uint32_t testShards;
+	uint32_t width;
+	uint32_t height;
+};
+
+// the start of each shard file
+struct ShardHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t rows;
+	uint32_t features;
+	uint32_t expected;
+	uint64_t featuresOffset;
+	uint64_t expectedOffset;
+};
+
+static uint64_t alignUp(uint64_t value)
+{
+	return (value + FloatMatrix::ALIGNMENT - 1) & ~((uint64_t)FloatMatrix::ALIGNMENT - 1);
+}
+
+static std::string shardPath(const std::string& pack, bool test, unsigned int index)
+{
+	char suffix[32];
+	sprintf(suffix, ".%s.%04u", (test) ? "test" : "train", index);
+	return pack + suffix;
+}
+
+static unsigned int shardCount(unsigned int rows, unsigned int shardRows)
+{
+	return (rows + shardRows - 1) / shardRows;
+}
+
+ShardInput::ShardInput()
+{
+	shardRows = SHARD_ROWS;
+	width = 0;
+	height = 0;
+	featureCount = 0;
+	expectedCount = 0;
+	trainRows = 0;
+	testRows = 0;
+	name = "";
+	loaded = false;
+}
+
+ShardInput::~ShardInput()
+{
+	clear();
+}
+
+void ShardInput::clear()
+{
+	std::vector<Shard>* splits[2] = {&trainShards, &testShards};
+	for (unsigned int s = 0; s < 2; ++s)
+	{
+		for (unsigned int i = 0; i < splits[s]->size(); ++i)
+		{
+			Shard& cShard = (*splits[s])[i];
+			if (cShard.mapping)
+				munmap(cShard.mapping, cShard.mappingBytes);
+		}
+		splits[s]->clear();
+	}
+
+	shardRows = SHARD_ROWS;
+	width = 0;
+	height = 0;
+	featureCount = 0;
+	expectedCount = 0;
+	trainRows = 0;
+	testRows = 0;
+	name = "";
+	loaded = false;
+}
+
+/*!
+ * @brief the pack of a dataset
+ * @param setName the dataset name
+ * @return the index path, under datasets/
+ */
+shmea::GString ShardInput::packPath(const shmea::GString& setName)
+{
+	return "datasets/" + setName + ".nnpack";
+}
+
+bool ShardInput::mapShard(const std::string& path, Shard& cShard) const
+{
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || ((size_t)st.st_size < sizeof(ShardHeader)))
+	{
+		close(fd);
+		return false;
+	}
+
+	size_t mapBytes = (size_t)st.st_size;
+	void* base = mmap(NULL, mapBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return false;
+
+	// start reading the whole shard in large sequential reads, ahead of its shuffled rows
+	madvise(base, mapBytes, MADV_WILLNEED);
+
+	ShardHeader header;
+	memcpy(&header, base, sizeof(header));
+	uint64_t featuresEnd =
+		header.featuresOffset + (uint64_t)header.rows * header.features * sizeof(float);
+	uint64_t expectedEnd =
+		header.expectedOffset + (uint64_t)header.rows * header.expected * sizeof(float);
+	bool ok = (memcmp(header.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC)) == 0) &&
+			  (header.version == PACK_VERSION) && (header.features == featureCount) &&
+			  (header.expected == expectedCount) &&
+			  (header.featuresOffset % FloatMatrix::ALIGNMENT == 0) &&
+			  (header.expectedOffset % FloatMatrix::ALIGNMENT == 0) && (featuresEnd <= mapBytes) &&
+			  (expectedEnd <= mapBytes);
+	if (!ok)
+	{
+		munmap(base, mapBytes);
+		return false;
+	}
+
+	cShard.mapping = base;
+	cShard.mappingBytes = mapBytes;
+	cShard.rows = header.rows;
+	cShard.features = (const float*)((const char*)base + header.featuresOffset);
+	cShard.expected = (const float*)((const char*)base + header.expectedOffset);
+	return true;
+}
+
+/*!
+ * @brief map a pack
+ * @details every shard but the last of a split must be full, so a row's shard is a division
+ * away; a pack that does not match its index is not loaded at all
+ * @param fname the index path, as from packPath
+ */
+void ShardInput::import(shmea::GString fname)
+{
+	NNC_PROFILE_SCOPE("data.import_shards");
+	clear();
+
+	FILE* fd = fopen(fname.c_str(), "rb");
+	if (!fd)
+	{
+		printf("[DATA] Unable to open pack \"%s\"\n", fname.c_str());
+		return;
+	}
+
+	PackHeader header;
+	bool ok = (fread(&header, sizeof(header), 1, fd) == 1);
+	fclose(fd);
+	ok = (ok) && (memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0) &&
+		 (header.version == PACK_VERSION) && (header.floatSize == sizeof(float)) &&
+		 (header.shardRows > 0) &&
+		 (header.trainShards == shardCount(header.trainRows, header.shardRows)) &&
+		 (header.testShards == shardCount(header.testRows, header.shardRows));
+	if (!ok)
+	{
+		printf("[DATA] \"%s\" is not a pack\n", fname.c_str());
+		return;
+	}
+
+	shardRows = header.shardRows;
+	width = header.width;
+	height = header.height;
+	featureCount = header.features;
+	expectedCount = header.expected;
+
+	std::vector<Shard>* splits[2] = {&trainShards, &testShards};
+	unsigned int rows[2] = {header.trainRows, header.testRows};
+	for (unsigned int s = 0; (ok) && (s < 2); ++s)
+	{
+		unsigned int count = shardCount(rows[s], shardRows);
+		for (unsigned int i = 0; (ok) && (i < count); ++i)
+		{
+			Shard cShard;
+			ok = mapShard(shardPath(fname.c_str(), (s == 1), i), cShard);
+			if (ok)
+				splits[s]->push_back(cShard);
+
+			unsigned int full = (i + 1 < count) ? shardRows : rows[s] - i * shardRows;
+			ok = (ok) && (cShard.rows == full);
+		}
+	}
+
+	if (!ok)
+	{
+		printf("[DATA] Pack \"%s\" is incomplete, repack it\n", fname.c_str());
+		clear();
+		return;
+	}
+
+	trainRows = header.trainRows;
+	testRows = header.testRows;
+	name = fname;
+	loaded = true;
+}
+
+bool ShardInput::writeShard(const glades::DataInput& src, bool test, unsigned int first,
+							unsigned int count, unsigned int features, unsigned int expected,
+							const std::string& path)
+{
+	ShardHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC));
+	header.version = PACK_VERSION;
+	header.rows = count;
+	header.features = features;
+	header.expected = expected;
+	header.featuresOffset = alignUp(sizeof(header));
+	header.expectedOffset =
+		alignUp(header.featuresOffset + (uint64_t)count * features * sizeof(float));
+
+	// decoded a shard at a time, so packing never holds the whole set twice
+	std::vector<float> featureRows((size_t)count * features);
+	std::vector<float> expectedRows((size_t)count * expected);
+	for (unsigned int r = 0; r < count; ++r)
+	{
+		unsigned int row = first + r;
+		shmea::GList cRow = (test) ? src.getTestRow(row) : src.getTrainRow(row);
+		shmea::GList cExpected =
+			(test) ? src.getTestExpectedRow(row) : src.getTrainExpectedRow(row);
+		if ((cRow.size() != features) || (cExpected.size() != expected))
+		{
+			printf("[DATA] Row %u does not match the first row's width\n", row);
+			return false;
+		}
+
+		for (unsigned int c = 0; c < features; ++c)
+			featureRows[(size_t)r * features + c] = cRow.getFloat(c);
+		for (unsigned int c = 0; c < expected; ++c)
+			expectedRows[(size_t)r * expected + c] = cExpected.getFloat(c);
+	}
+
+	AtomicFile file;
+	if (!file.open(path))
+		return false;
+
+	static const char zeros[FloatMatrix::ALIGNMENT] = {0};
+	bool ok = file.write(&header, sizeof(header));
+	ok = (ok) && (file.write(zeros, header.featuresOffset - sizeof(header)));
+	if ((ok) && (!featureRows.empty()))
+		ok = file.write(&featureRows[0], featureRows.size() * sizeof(float));
+
+	uint64_t written = header.featuresOffset + featureRows.size() * sizeof(float);
+	ok = (ok) && (file.write(zeros, header.expectedOffset - written));
+	if ((ok) && (!expectedRows.empty()))
+		ok = file.write(&expectedRows[0], expectedRows.size() * sizeof(float));
+
+	// the source is still there to repack from, so skip the fsyncs
+	return (ok) && (file.commit(false));
+}
+
+/*!
+ * @brief pack an imported dataset
+ * @details the shards are written before the index, so a pack that fails part way keeps its
+ * old index, whose shards then no longer check out and are refused
+ * @param src the imported source, such as an ImageInput
+ * @param fname the index path, as from packPath
+ * @param newShardRows the rows per shard
+ * @param imageWidth the width of the source images, 0 when unknown
+ * @param imageHeight the height of the source images, 0 when unknown
+ * @return whether the whole pack was written
+ */
+bool ShardInput::pack(const glades::DataInput& src, const shmea::GString& fname,
+					  unsigned int newShardRows, unsigned int imageWidth, unsigned int imageHeight)
+{
+	NNC_PROFILE_SCOPE("data.pack_shards");
+	if ((newShardRows == 0) || (src.getTrainSize() == 0))
+		return false;
+
+	unsigned int features = src.getTrainRow(0).size();
+	unsigned int expected = src.getTrainExpectedRow(0).size();
+	if (features == 0)
+		return false;
+
+	unsigned int rows[2] = {src.getTrainSize(), src.getTestSize()};
+	for (unsigned int s = 0; s < 2; ++s)
+	{
+		unsigned int count = shardCount(rows[s], newShardRows);
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			unsigned int first = i * newShardRows;
+			unsigned int shardSize =
+				(first + newShardRows <= rows[s]) ? newShardRows : rows[s] - first;
+			std::string path = shardPath(fname.c_str(), (s == 1), i);
+			if (!writeShard(src, (s == 1), first, shardSize, features, expected, path))
+			{
+				printf("[DATA] Unable to write shard \"%s\"\n", path.c_str());
+				return false;
+			}
+		}
+	}
+
+	PackHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+	header.version = PACK_VERSION;
+	header.floatSize = sizeof(float);
+	header.shardRows = newShardRows;
+	header.features = features;
+	header.expected = expected;
+	header.trainRows = rows[0];
+	header.testRows = rows[1];
+	header.trainShards = shardCount(rows[0], newShardRows);
+	header.testShards = shardCount(rows[1], newShardRows);
+	header.width = imageWidth;
+	header.height = imageHeight;
+	return AtomicFile::writeFile(fname.c_str(), &header, sizeof(header));
+}
+
+const Shard* ShardInput::locate(const std::vector<Shard>& shards, unsigned int index,
+								unsigned int& row) const
+{
+	unsigned int shard = index / shardRows;
+	if (shard >= shards.size())
+		return NULL;
+
+	row = index % shardRows;
+	if (row >= shards[shard].rows)
+		return NULL;
+	return &shards[shard];
+}
+
+shmea::GList ShardInput::getRow(const std::vector<Shard>& shards, unsigned int index,
+								bool expected) const
+{
+	unsigned int row = 0;
+	const Shard* cShard = locate(shards, index, row);
+	if (!cShard)
+		return shmea::GList();
+
+	unsigned int width = (expected) ? expectedCount : featureCount;
+	const float* values = ((expected) ? cShard->expected : cShard->features) + (size_t)row * width;
+
+	shmea::GList cRow;
+	for (unsigned int c = 0; c < width; ++c)
+		cRow.addFloat(values[c]);
+	return cRow;
+}
+
+unsigned int ShardInput::getShardRows() const
+{
+	return shardRows;
+}
+
+unsigned int ShardInput::getWidth() const
+{
+	return width;
+}
+
+unsigned int ShardInput::getHeight() const
+{
+	return height;
+}
+
+size_t ShardInput::getBytes() const
+{
+	size_t bytes = 0;
+	for (unsigned int i = 0; i < trainShards.size(); ++i)
+		bytes += trainShards[i].mappingBytes;
+	for (unsigned int i = 0; i < testShards.size(); ++i)
+		bytes += testShards[i].mappingBytes;
+	return bytes;
+}
+
+shmea::GList ShardInput::getTrainRow(unsigned int index) const
+{
+	return getRow(trainShards, index, false);
+}
+
+shmea::GList ShardInput::getTrainExpectedRow(unsigned int index) const
+{
+	return getRow(trainShards, index, true);
+}
+
+shmea::GList ShardInput::getTestRow(unsigned int index) const
+{
+	return getRow(testShards, index, false);
+}
+
+shmea::GList ShardInput::getTestExpectedRow(unsigned int index) const
+{
+	return getRow(testShards, index, true);
+}
+
+unsigned int ShardInput::getTrainSize() const
+{
+	return trainRows;
+}
+
+unsigned int ShardInput::getTestSize() const
+{
+	return testRows;
+}
+
+unsigned int ShardInput::getFeatureCount() const
+{
+	return featureCount;
+}
+
+// packed rows are plain feature vectors, not ImageInput's images
+int ShardInput::getType() const
+{
+	return glades::DataInput::CSV;
+}
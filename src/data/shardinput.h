@@ -0,0 +1,121 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _SHARDINPUT
+#define _SHARDINPUT
+
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// One memory mapped shard file: a run of consecutive rows of one split
+class Shard
+{
+public:
+	void* mapping;
+	size_t mappingBytes;
+	unsigned int rows;
+	const float* features;
+	const float* expected;
+
+	Shard()
+	{
+		mapping = NULL;
+		mappingBytes = 0;
+		rows = 0;
+		features = NULL;
+		expected = NULL;
+	}
+};
+
+// A preprocessed dataset packed into large sequential shard files, so an
+// image set is read with a few big reads instead of one small file per
+// image. "<pack>" is the index and "<pack>.train.NNNN"/"<pack>.test.NNNN"
+// hold SHARD_ROWS rows each as 64 byte aligned float matrices of features
+// and expected values, which are mapped read only and used in place. Rows
+// are the ones the source DataInput serves, so a pack trains the same as its
+// source; the index also keeps the size of the source images. Shuffle it in
+// blocks of getShardRows() to visit the shards in a random order and each
+// shard's rows in a random order.
+class ShardInput : public glades::DataInput
+{
+private:
+	std::vector<Shard> trainShards;
+	std::vector<Shard> testShards;
+	unsigned int shardRows;
+	unsigned int width;
+	unsigned int height;
+	unsigned int featureCount;
+	unsigned int expectedCount;
+	unsigned int trainRows;
+	unsigned int testRows;
+
+	bool mapShard(const std::string&, Shard&) const;
+	const Shard* locate(const std::vector<Shard>&, unsigned int, unsigned int&) const;
+	shmea::GList getRow(const std::vector<Shard>&, unsigned int, bool) const;
+
+	static bool writeShard(const glades::DataInput&, bool, unsigned int, unsigned int,
+						   unsigned int, unsigned int, const std::string&);
+
+	// owns its mappings
+	ShardInput(const ShardInput&);
+	void operator=(const ShardInput&);
+
+public:
+	static const unsigned int SHARD_ROWS = 4096;
+
+	shmea::GString name;
+	bool loaded;
+
+	ShardInput();
+	virtual ~ShardInput();
+
+	virtual void import(shmea::GString);
+	void clear();
+	unsigned int getShardRows() const;
+	unsigned int getWidth() const;
+	unsigned int getHeight() const;
+	size_t getBytes() const;
+
+	static shmea::GString packPath(const shmea::GString&);
+	static bool pack(const glades::DataInput&, const shmea::GString&, unsigned int = SHARD_ROWS,
+					 unsigned int = 0, unsigned int = 0);
+
+	virtual shmea::GList getTrainRow(unsigned int) const;
+	virtual shmea::GList getTrainExpectedRow(unsigned int) const;
+
+	virtual shmea::GList getTestRow(unsigned int) const;
+	virtual shmea::GList getTestExpectedRow(unsigned int) const;
+
+	virtual unsigned int getTrainSize() const;
+	virtual unsigned int getTestSize() const;
+	virtual unsigned int getFeatureCount() const;
+
+	virtual int getType() const;
+};
+
+#endif
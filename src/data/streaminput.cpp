@@ -0,0 +1,894 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "streaminput.h"
+#include "../core/profiler.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Machine Learning/GMath/OHE.h"
+#include <unistd.h>
+
+StreamInput::StreamInput()
+{
+	name = "";
+	loaded = false;
+	featureCount = 0;
+	expectedCount = 0;
+	threadCount = 0;
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+	pthread_mutex_init(&windowMutex, NULL);
+	pthread_cond_init(&prefetchCond, NULL);
+	pthread_cond_init(&readyCond, NULL);
+	prefetchStarted = false;
+	prefetchStopping = false;
+	pendingSplit = NULL;
+	pendingStart = 0;
+}
+
+StreamInput::~StreamInput()
+{
+	clear();
+	pthread_cond_destroy(&readyCond);
+	pthread_cond_destroy(&prefetchCond);
+	pthread_mutex_destroy(&windowMutex);
+}
+
+void StreamInput::stopPrefetch()
+{
+	if (!prefetchStarted)
+		return;
+
+	pthread_mutex_lock(&windowMutex);
+	prefetchStopping = true;
+	pthread_cond_signal(&prefetchCond);
+	pthread_mutex_unlock(&windowMutex);
+
+	pthread_join(prefetchThread, NULL);
+	prefetchStarted = false;
+	prefetchStopping = false;
+	pendingSplit = NULL;
+}
+
+void StreamInput::clear()
+{
+	stopPrefetch();
+
+	for (unsigned int i = 0; i < OHEMaps.size(); ++i)
+	{
+		if (OHEMaps[i])
+			delete OHEMaps[i];
+	}
+
+	name = "";
+	loaded = false;
+	featureCount = 0;
+	expectedCount = 0;
+	headers.clear();
+	columns.clear();
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+
+	trainSplit.reset();
+	testSplit.reset();
+}
+
+/*!
+ * @brief test file for a dataset
+ * @details follows the naming used in datasets/, e.g. xorgate.csv -> xorgatetest.csv
+ * @param fname the training file
+ * @return the test file path
+ */
+shmea::GString StreamInput::testSibling(const shmea::GString& fname)
+{
+	std::string path = fname.c_str();
+	size_t dot = path.find_last_of('.');
+	size_t slash = path.find_last_of('/');
+	if ((dot == std::string::npos) || ((slash != std::string::npos) && (dot < slash)))
+		return shmea::GString((path + "test").c_str());
+
+	return shmea::GString((path.substr(0, dot) + "test" + path.substr(dot)).c_str());
+}
+
+/*!
+ * @brief import a csv dataset
+ * @details one streaming pass over the training file for the statistics, then a row count
+ * pass over the test file; no rows are kept in memory
+ * @param newName the training file path
+ */
+void StreamInput::import(shmea::GString newName)
+{
+	clear();
+
+	trainSplit.fname = newName;
+	if (!scan(trainSplit, true))
+	{
+		printf("[DATA] Unable to stream \"%s\"\n", newName.c_str());
+		clear();
+		return;
+	}
+
+	// cache the z-score scaling
+	for (unsigned int c = 0; c < columns.size(); ++c)
+		columns[c].finalize(ColumnStats::ZSCORE);
+
+	// OHE dictionaries in first-seen order
+	featureCount = 0;
+	for (unsigned int c = 0; c < columns.size(); ++c)
+	{
+		ColumnStats& cStats = columns[c];
+		featureIsCategorical.push_back(cStats.categorical);
+		if (!cStats.categorical)
+		{
+			OHEMaps.push_back(NULL);
+			if (c < columns.size() - 1)
+				++featureCount;
+			continue;
+		}
+
+		const std::vector<std::string>& classes = cStats.categoryOrder;
+		glades::OHE* cOHE = new glades::OHE();
+		for (unsigned int i = 0; i < classes.size(); ++i)
+			cOHE->addString(classes[i]);
+		OHEMaps.push_back(cOHE);
+
+		if (c < columns.size() - 1)
+			featureCount += classes.size();
+	}
+
+	const ColumnStats& label = columns[columns.size() - 1];
+	expectedCount = label.categorical ? label.getCategoryCount() : 1;
+
+	// optional test split
+	testSplit.fname = testSibling(newName);
+	if (CSVReader::fileSize(testSplit.fname) >= 0)
+		scan(testSplit, false);
+	else
+		testSplit.fname = "";
+
+	name = newName;
+	loaded = true;
+	printf("[DATA] Streaming \"%s\": %u train rows, %u test rows, %u features\n",
+		   newName.c_str(), trainSplit.rows, testSplit.rows, featureCount);
+}
+
+/*!
+ * @brief index a csv file
+ * @details the column types come from the first record; the rest of the file is cut into byte
+ * ranges on record boundaries that are scanned in parallel and merged in file order, so the
+ * checkpoints and category order match a sequential pass
+ * @param split the split to index
+ * @param collectStats whether this is the training file
+ * @return whether the file could be read
+ */
+bool StreamInput::scan(StreamSplit& split, bool collectStats)
+{
+	CSVReader reader;
+	if (!reader.open(split.fname))
+		return false;
+
+	std::vector<CSVField> fields;
+	if (!reader.readRecord(fields))
+		return false;
+
+	if (collectStats)
+	{
+		for (unsigned int i = 0; i < fields.size(); ++i)
+			headers.push_back(shmea::GString(fields[i].toString().c_str()));
+		columns.resize(fields.size());
+
+		if (columns.size() < 2)
+		{
+			printf("[DATA] \"%s\" needs at least one feature and a label\n", split.fname.c_str());
+			return false;
+		}
+	}
+
+	split.hasExpected = (fields.size() == columns.size());
+	split.rows = 0;
+	split.checkpoints.clear();
+
+	int64_t dataStart = reader.tell();
+	if (collectStats)
+	{
+		// the first record decides the column types
+		if (reader.readRecord(fields))
+		{
+			float value = 0.0f;
+			for (unsigned int c = 0; (c < fields.size()) && (c < columns.size()); ++c)
+				columns[c].categorical = !CSVReader::parseFloat(fields[c], value);
+		}
+	}
+
+	int64_t dataEnd = CSVReader::fileSize(split.fname);
+	if (dataEnd < dataStart)
+		dataEnd = dataStart;
+
+	// cut the data into record aligned ranges
+	unsigned int jobCount = getThreads(dataEnd - dataStart);
+	std::vector<int64_t> bounds(jobCount + 1, dataStart);
+	bounds[jobCount] = dataEnd;
+	for (unsigned int k = 1; k < jobCount; ++k)
+	{
+		int64_t rawOffset = dataStart + ((dataEnd - dataStart) / jobCount) * k;
+		bounds[k] = reader.alignTo(rawOffset) ? reader.tell() : dataEnd;
+		if (bounds[k] < bounds[k - 1])
+			bounds[k] = bounds[k - 1];
+		if (bounds[k] > dataEnd)
+			bounds[k] = dataEnd;
+	}
+	reader.close();
+
+	std::vector<RangeJob> jobs(jobCount);
+	for (unsigned int k = 0; k < jobCount; ++k)
+	{
+		jobs[k].owner = this;
+		jobs[k].split = &split;
+		jobs[k].begin = bounds[k];
+		jobs[k].end = bounds[k + 1];
+		jobs[k].collectStats = collectStats;
+		if (collectStats)
+		{
+			jobs[k].columns.resize(columns.size());
+			for (unsigned int c = 0; c < columns.size(); ++c)
+				jobs[k].columns[c].categorical = columns[c].categorical;
+		}
+	}
+
+	runJobs(jobs, scanRange);
+
+	// merge in file order
+	for (unsigned int k = 0; k < jobCount; ++k)
+	{
+		if (!jobs[k].ok)
+			return false;
+
+		for (unsigned int i = 0; i < jobs[k].checkpoints.size(); ++i)
+		{
+			const StreamCheckpoint& cp = jobs[k].checkpoints[i];
+			split.checkpoints.push_back(StreamCheckpoint(split.rows + cp.row, cp.offset));
+		}
+		split.rows += jobs[k].rows;
+
+		if (collectStats)
+		{
+			for (unsigned int c = 0; c < columns.size(); ++c)
+				columns[c].merge(jobs[k].columns[c]);
+		}
+	}
+
+	return true;
+}
+
+void* StreamInput::scanRange(void* y)
+{
+	RangeJob* job = (RangeJob*)y;
+	job->ok = false;
+
+	CSVReader reader;
+	if ((!reader.open(job->split->fname)) || (!reader.seek(job->begin)))
+		return NULL;
+	reader.setLimit(job->end);
+
+	std::vector<CSVField> fields;
+	while (true)
+	{
+		int64_t offset = reader.tell();
+		if (!reader.readRecord(fields))
+			break;
+
+		if ((job->rows % CHECKPOINT_ROWS) == 0)
+			job->checkpoints.push_back(StreamCheckpoint(job->rows, offset));
+		++job->rows;
+
+		if (!job->collectStats)
+			continue;
+
+		for (unsigned int c = 0; (c < fields.size()) && (c < job->columns.size()); ++c)
+		{
+			ColumnStats& cStats = job->columns[c];
+			if (cStats.categorical)
+			{
+				cStats.addCategory(fields[c].ptr, fields[c].len);
+				continue;
+			}
+
+			float value = 0.0f;
+			if (CSVReader::parseFloat(fields[c], value))
+				cStats.add(value);
+		}
+	}
+
+	job->ok = true;
+	return NULL;
+}
+
+void* StreamInput::decodeRange(void* y)
+{
+	RangeJob* job = (RangeJob*)y;
+	job->ok = false;
+
+	const StreamSplit* split = job->split;
+	if (job->firstCheckpoint >= split->checkpoints.size())
+	{
+		job->ok = true;
+		return NULL;
+	}
+
+	CSVReader reader;
+	if ((!reader.open(split->fname)) ||
+		(!reader.seek(split->checkpoints[job->firstCheckpoint].offset)))
+		return NULL;
+
+	unsigned int row = split->checkpoints[job->firstCheckpoint].row;
+	unsigned int endRow = split->rows;
+	if (job->lastCheckpoint < split->checkpoints.size())
+		endRow = split->checkpoints[job->lastCheckpoint].row;
+
+	std::vector<CSVField> fields;
+	for (; row < endRow; ++row)
+	{
+		if (!reader.readRecord(fields))
+			return NULL;
+
+		job->owner->decodeRecord(fields, job->features->rowPtr(row), job->expected->rowPtr(row),
+								 split->hasExpected);
+	}
+
+	job->ok = true;
+	return NULL;
+}
+
+/*!
+ * @brief run jobs fork/join
+ * @details the calling thread takes the first job
+ * @param jobs the jobs
+ * @param fnptr the job function
+ */
+void StreamInput::runJobs(std::vector<RangeJob>& jobs, void* (*fnptr)(void*))
+{
+	if (jobs.empty())
+		return;
+
+	std::vector<pthread_t> threads(jobs.size());
+	std::vector<bool> started(jobs.size(), false);
+	for (unsigned int k = 1; k < jobs.size(); ++k)
+		started[k] = (pthread_create(&threads[k], NULL, fnptr, &jobs[k]) == 0);
+
+	fnptr(&jobs[0]);
+
+	for (unsigned int k = 1; k < jobs.size(); ++k)
+	{
+		if (started[k])
+			pthread_join(threads[k], NULL);
+		else
+			fnptr(&jobs[k]);
+	}
+}
+
+unsigned int StreamInput::getThreads(int64_t bytes) const
+{
+	int64_t cores = threadCount;
+	if (cores <= 0)
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cores <= 0)
+		cores = 1;
+
+	int64_t byRange = bytes / MIN_RANGE_BYTES;
+	if (byRange < 1)
+		byRange = 1;
+
+	return (unsigned int)(cores < byRange ? cores : byRange);
+}
+
+/*!
+ * @brief set the import thread count
+ * @param newThreadCount number of threads, 0 for one per core
+ */
+void StreamInput::setThreads(unsigned int newThreadCount)
+{
+	threadCount = newThreadCount;
+}
+
+/*!
+ * @brief decode a whole split
+ * @details each thread owns a run of checkpoints and writes straight into its rows
+ * @param split the split
+ * @param features resized to rows x featureCount
+ * @param expected resized to rows x expectedCount, or emptied when there are no labels
+ * @return whether every row was decoded
+ */
+bool StreamInput::decodeSplit(const StreamSplit& split, FloatMatrix& features,
+							  FloatMatrix& expected) const
+{
+	if (!features.resize(split.rows, featureCount))
+		return false;
+	if (!expected.resize(split.rows, split.hasExpected ? expectedCount : 0))
+		return false;
+
+	if (split.rows == 0)
+		return true;
+
+	unsigned int jobCount = getThreads(((int64_t)split.rows) * featureCount * sizeof(float));
+	if (jobCount > split.checkpoints.size())
+		jobCount = split.checkpoints.size();
+
+	std::vector<RangeJob> jobs(jobCount);
+	for (unsigned int k = 0; k < jobCount; ++k)
+	{
+		jobs[k].owner = this;
+		jobs[k].split = &split;
+		jobs[k].firstCheckpoint = (split.checkpoints.size() * k) / jobCount;
+		jobs[k].lastCheckpoint = (split.checkpoints.size() * (k + 1)) / jobCount;
+		jobs[k].features = &features;
+		jobs[k].expected = &expected;
+	}
+
+	runJobs(jobs, decodeRange);
+
+	for (unsigned int k = 0; k < jobCount; ++k)
+	{
+		if (!jobs[k].ok)
+			return false;
+	}
+
+	return true;
+}
+
+/*!
+ * @brief materialize the dataset
+ * @details decodes both splits in parallel into dense matrices
+ * @return whether both splits were decoded
+ */
+bool StreamInput::decodeAll(FloatMatrix& trainFeatures, FloatMatrix& trainExpected,
+							FloatMatrix& testFeatures, FloatMatrix& testExpected) const
+{
+	if (!loaded)
+		return false;
+
+	if (!decodeSplit(trainSplit, trainFeatures, trainExpected))
+		return false;
+
+	return decodeSplit(testSplit, testFeatures, testExpected);
+}
+
+/*!
+ * @brief decode one record
+ * @details numeric features are z-scored, categorical ones one-hot encoded; a numeric label is
+ * passed through unchanged
+ * @param fields the raw fields
+ * @param featureRow featureCount floats, zeroed by the caller
+ * @param expectedRow expectedCount floats, zeroed by the caller
+ * @param hasExpected whether the record carries a label
+ */
+void StreamInput::decodeRecord(const std::vector<CSVField>& fields, float* featureRow,
+							   float* expectedRow, bool hasExpected) const
+{
+	unsigned int featureCols = columns.size() - 1;
+	unsigned int offset = 0;
+	for (unsigned int c = 0; c < featureCols; ++c)
+	{
+		const ColumnStats& cStats = columns[c];
+		if (cStats.categorical)
+		{
+			if (c < fields.size())
+			{
+				int index = cStats.getCategoryIndex(fields[c].ptr, fields[c].len);
+				if (index >= 0)
+					featureRow[offset + index] = 1.0f;
+			}
+
+			offset += cStats.getCategoryCount();
+			continue;
+		}
+
+		float value = cStats.center;
+		if (c < fields.size())
+			CSVReader::parseFloat(fields[c], value);
+
+		featureRow[offset] = cStats.standardize(value);
+		++offset;
+	}
+
+	if ((!hasExpected) || (featureCols >= fields.size()))
+		return;
+
+	const ColumnStats& label = columns[featureCols];
+	if (label.categorical)
+	{
+		int index = label.getCategoryIndex(fields[featureCols].ptr, fields[featureCols].len);
+		if (index >= 0)
+			expectedRow[index] = 1.0f;
+	}
+	else
+	{
+		float value = 0.0f;
+		CSVReader::parseFloat(fields[featureCols], value);
+		expectedRow[0] = value;
+	}
+}
+
+/*!
+ * @brief decode a window
+ * @details seeks to the last checkpoint at or before startRow unless the reader already sits on
+ * it, skips up to startRow and decodes at most WINDOW_ROWS rows
+ * @param split the split to read
+ * @param reader the reader to use
+ * @param readerRow the row the reader is positioned at, updated
+ * @param startRow the first row of the window
+ * @param features WINDOW_ROWS x featureCount destination
+ * @param expected WINDOW_ROWS x expectedCount destination
+ * @return the number of rows decoded
+ */
+unsigned int StreamInput::decodeWindow(const StreamSplit& split, CSVReader& reader,
+									   unsigned int& readerRow, unsigned int startRow,
+									   FloatMatrix& features, FloatMatrix& expected) const
+{
+	if ((startRow >= split.rows) || (split.checkpoints.empty()))
+		return 0;
+
+	if (features.numberOfRows() != WINDOW_ROWS)
+	{
+		if (!features.resize(WINDOW_ROWS, featureCount))
+			return 0;
+		if (!expected.resize(WINDOW_ROWS, expectedCount))
+			return 0;
+	}
+
+	bool reopened = !reader.isOpen();
+	if ((reopened) && (!reader.open(split.fname)))
+		return 0;
+
+	std::vector<CSVField> fields;
+	if ((reopened) || (readerRow != startRow))
+	{
+		// last checkpoint at or before the row
+		unsigned int lo = 0;
+		unsigned int hi = split.checkpoints.size();
+		while (hi - lo > 1)
+		{
+			unsigned int mid = (lo + hi) / 2;
+			if (split.checkpoints[mid].row <= startRow)
+				lo = mid;
+			else
+				hi = mid;
+		}
+		const StreamCheckpoint& cp = split.checkpoints[lo];
+
+		if (!reader.seek(cp.offset))
+			return 0;
+
+		for (readerRow = cp.row; readerRow < startRow; ++readerRow)
+		{
+			if (!reader.readRecord(fields))
+				return 0;
+		}
+	}
+
+	unsigned int decoded = 0;
+	while ((decoded < WINDOW_ROWS) && (startRow + decoded < split.rows))
+	{
+		if (!reader.readRecord(fields))
+			break;
+
+		float* featureRow = features.rowPtr(decoded);
+		float* expectedRow = expected.rowPtr(decoded);
+		memset(featureRow, 0, featureCount * sizeof(float));
+		memset(expectedRow, 0, expectedCount * sizeof(float));
+		decodeRecord(fields, featureRow, expectedRow, split.hasExpected);
+		++decoded;
+	}
+
+	readerRow = startRow + decoded;
+	return decoded;
+}
+
+/*!
+ * @brief decode the window holding a row
+ * @details synchronous fallback when the prefetched window does not cover the row
+ * @param split the split to read
+ * @param row the row that must end up in the window
+ * @return whether the window now holds the row
+ */
+bool StreamInput::loadWindow(StreamSplit& split, unsigned int row) const
+{
+	NNC_PROFILE_SCOPE("data.stream_window");
+	split.windowValid = false;
+	split.windowStart = row;
+	split.windowRows = decodeWindow(split, split.reader, split.readerRow, row, split.window,
+									split.windowExpected);
+	split.windowValid = (split.windowRows > 0);
+	return split.windowValid;
+}
+
+/*!
+ * @brief queue the next window
+ * @details double buffered: at most one window per split is decoded ahead, on a single worker
+ * thread that is started on first use; called with windowMutex held
+ * @param split the split being read
+ * @param startRow the first row of the window to decode
+ */
+void StreamInput::requestPrefetch(StreamSplit& split, unsigned int startRow) const
+{
+	if ((startRow >= split.rows) || (split.nextBusy) || (pendingSplit))
+		return;
+
+	if (!prefetchStarted)
+	{
+		prefetchStopping = false;
+		if (pthread_create(&prefetchThread, NULL, prefetchLoop, (void*)this) != 0)
+			return;
+		prefetchStarted = true;
+	}
+
+	split.nextReady = false;
+	split.nextBusy = true;
+	pendingSplit = &split;
+	pendingStart = startRow;
+	pthread_cond_signal(&prefetchCond);
+}
+
+/*!
+ * @brief the window to read after the current one
+ * @details the following rows, or the successor block when a train order is set; called with
+ * windowMutex held
+ * @param split the split being read
+ * @return the first row of the next window, split.rows when there is none
+ */
+unsigned int StreamInput::nextWindowStart(const StreamSplit& split) const
+{
+	if (split.windowOrder.empty())
+		return split.windowStart + split.windowRows;
+
+	unsigned int block = split.windowStart / WINDOW_ROWS;
+	if (block >= split.windowOrder.size())
+		return split.rows;
+
+	return split.windowOrder[block];
+}
+
+/*!
+ * @brief set the block order of the next training pass
+ * @details for epoch shuffles that permute whole WINDOW_ROWS blocks; windows are then loaded on
+ * block boundaries and the prefetcher decodes the next block of the order instead of the next
+ * rows of the file. An empty order restores plain front to back prefetching.
+ * @param blocks block indices (row / WINDOW_ROWS) in the order they will be read
+ */
+void StreamInput::setTrainOrder(const std::vector<unsigned int>& blocks) const
+{
+	pthread_mutex_lock(&windowMutex);
+
+	trainSplit.windowOrder.clear();
+	if (!blocks.empty())
+	{
+		unsigned int blockCount = (trainSplit.rows + WINDOW_ROWS - 1) / WINDOW_ROWS;
+		trainSplit.windowOrder.resize(blockCount, trainSplit.rows);
+		for (unsigned int i = 0; i + 1 < blocks.size(); ++i)
+		{
+			if (blocks[i] < blockCount)
+				trainSplit.windowOrder[blocks[i]] = blocks[i + 1] * WINDOW_ROWS;
+		}
+	}
+
+	pthread_mutex_unlock(&windowMutex);
+}
+
+void* StreamInput::prefetchLoop(void* y)
+{
+	const StreamInput* cInput = (const StreamInput*)y;
+
+	pthread_mutex_lock(&cInput->windowMutex);
+	while (!cInput->prefetchStopping)
+	{
+		if (!cInput->pendingSplit)
+		{
+			pthread_cond_wait(&cInput->prefetchCond, &cInput->windowMutex);
+			continue;
+		}
+
+		StreamSplit* split = cInput->pendingSplit;
+		unsigned int startRow = cInput->pendingStart;
+		cInput->pendingSplit = NULL;
+
+		// decode without the lock; the next buffers belong to this thread while nextBusy
+		pthread_mutex_unlock(&cInput->windowMutex);
+		unsigned int decoded =
+			cInput->decodeWindow(*split, split->prefetchReader, split->prefetchRow, startRow,
+								 split->nextWindow, split->nextWindowExpected);
+		pthread_mutex_lock(&cInput->windowMutex);
+
+		split->nextStart = startRow;
+		split->nextRows = decoded;
+		split->nextReady = (decoded > 0);
+		split->nextBusy = false;
+		pthread_cond_broadcast(&cInput->readyCond);
+	}
+	pthread_mutex_unlock(&cInput->windowMutex);
+
+	return NULL;
+}
+
+shmea::GList StreamInput::getRow(StreamSplit& split, unsigned int index, bool expected) const
+{
+	shmea::GList retList;
+	if ((index >= split.rows) || ((expected) && (!split.hasExpected)))
+		return retList;
+
+	pthread_mutex_lock(&windowMutex);
+
+	if ((!split.windowValid) || (index < split.windowStart) ||
+		(index >= split.windowStart + split.windowRows))
+	{
+		// a front to back sweep just ran off the end of the window, or an epoch order tells us
+		bool ordered = !split.windowOrder.empty();
+		bool sequential = (ordered) || ((split.windowValid)
+											? (index == split.windowStart + split.windowRows)
+											: (index == 0));
+
+		while (split.nextBusy)
+			pthread_cond_wait(&readyCond, &windowMutex);
+
+		if ((split.nextReady) && (index >= split.nextStart) &&
+			(index < split.nextStart + split.nextRows))
+		{
+			split.window.swap(split.nextWindow);
+			split.windowExpected.swap(split.nextWindowExpected);
+			split.windowStart = split.nextStart;
+			split.windowRows = split.nextRows;
+			split.windowValid = true;
+			split.nextReady = false;
+			sequential = true;
+		}
+		else if (!loadWindow(split, (ordered) ? index - (index % WINDOW_ROWS) : index))
+		{
+			pthread_mutex_unlock(&windowMutex);
+			return retList;
+		}
+
+		if (sequential)
+			requestPrefetch(split, nextWindowStart(split));
+	}
+
+	unsigned int localRow = index - split.windowStart;
+	retList = expected ? split.windowExpected.getRow(localRow) : split.window.getRow(localRow);
+
+	pthread_mutex_unlock(&windowMutex);
+	return retList;
+}
+
+unsigned int StreamInput::getColumnCount() const
+{
+	return columns.size();
+}
+
+const std::vector<ColumnStats>& StreamInput::getColumnStats() const
+{
+	return columns;
+}
+
+bool StreamInput::isCategorical(unsigned int col) const
+{
+	if (col >= columns.size())
+		return false;
+
+	return columns[col].categorical;
+}
+
+float StreamInput::getMin(unsigned int col) const
+{
+	if (col >= columns.size())
+		return 0.0f;
+
+	return columns[col].min;
+}
+
+float StreamInput::getMax(unsigned int col) const
+{
+	if (col >= columns.size())
+		return 0.0f;
+
+	return columns[col].max;
+}
+
+float StreamInput::getMean(unsigned int col) const
+{
+	if (col >= columns.size())
+		return 0.0f;
+
+	return columns[col].getMean();
+}
+
+float StreamInput::getStdDev(unsigned int col) const
+{
+	if (col >= columns.size())
+		return 0.0f;
+
+	return columns[col].getStdDev();
+}
+
+shmea::GList StreamInput::getTrainRow(unsigned int index) const
+{
+	return getRow(trainSplit, index, false);
+}
+
+shmea::GList StreamInput::getTrainExpectedRow(unsigned int index) const
+{
+	return getRow(trainSplit, index, true);
+}
+
+shmea::GList StreamInput::getTestRow(unsigned int index) const
+{
+	return getRow(testSplit, index, false);
+}
+
+shmea::GList StreamInput::getTestExpectedRow(unsigned int index) const
+{
+	return getRow(testSplit, index, true);
+}
+
+unsigned int StreamInput::getTrainSize() const
+{
+	return trainSplit.rows;
+}
+
+unsigned int StreamInput::getTestSize() const
+{
+	return testSplit.rows;
+}
+
+unsigned int StreamInput::getFeatureCount() const
+{
+	return featureCount;
+}
+
+/*!
+ * @brief get the bytes held by the decoded windows and the checkpoints
+ * @details the file itself stays on disk
+ * @return the bytes
+ */
+size_t StreamInput::getBytes() const
+{
+	const StreamSplit* splits[2] = {&trainSplit, &testSplit};
+
+	size_t bytes = 0;
+	pthread_mutex_lock(&windowMutex);
+	for (unsigned int i = 0; i < 2; ++i)
+	{
+		const StreamSplit* cSplit = splits[i];
+		bytes += cSplit->window.getBytes() + cSplit->windowExpected.getBytes();
+		bytes += cSplit->nextWindow.getBytes() + cSplit->nextWindowExpected.getBytes();
+		bytes += cSplit->checkpoints.capacity() * sizeof(StreamCheckpoint);
+		bytes += cSplit->windowOrder.capacity() * sizeof(unsigned int);
+	}
+	pthread_mutex_unlock(&windowMutex);
+
+	return bytes;
+}
+
+int StreamInput::getType() const
+{
+	return glades::DataInput::CSV;
+}
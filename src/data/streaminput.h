@@ -0,0 +1,245 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _STREAMINPUT
+#define _STREAMINPUT
+
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include "columnstats.h"
+#include "csvreader.h"
+#include "floatmatrix.h"
+#include <map>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+// A record index entry: the byte offset where a given row starts
+class StreamCheckpoint
+{
+public:
+	unsigned int row;
+	int64_t offset;
+
+	StreamCheckpoint()
+	{
+		row = 0;
+		offset = 0;
+	}
+
+	StreamCheckpoint(unsigned int newRow, int64_t newOffset)
+	{
+		row = newRow;
+		offset = newOffset;
+	}
+};
+
+// One csv file of a StreamInput: a sparse index of record offsets plus a
+// decoded window of consecutive rows.
+class StreamSplit
+{
+public:
+	shmea::GString fname;
+	unsigned int rows;
+	bool hasExpected;
+	std::vector<StreamCheckpoint> checkpoints;
+
+	// the window being read
+	CSVReader reader;
+	unsigned int readerRow;
+	FloatMatrix window;
+	FloatMatrix windowExpected;
+	unsigned int windowStart;
+	unsigned int windowRows;
+	bool windowValid;
+
+	// the window after it, decoded in the background
+	CSVReader prefetchReader;
+	unsigned int prefetchRow;
+	FloatMatrix nextWindow;
+	FloatMatrix nextWindowExpected;
+	unsigned int nextStart;
+	unsigned int nextRows;
+	bool nextReady;
+	bool nextBusy;
+
+	// epoch order of the WINDOW_ROWS blocks: the first row of the block read after each one
+	std::vector<unsigned int> windowOrder;
+
+	StreamSplit()
+	{
+		reset();
+	}
+
+	void reset()
+	{
+		fname = "";
+		rows = 0;
+		hasExpected = false;
+		checkpoints.clear();
+		reader.close();
+		readerRow = 0;
+		window.clear();
+		windowExpected.clear();
+		windowStart = 0;
+		windowRows = 0;
+		windowValid = false;
+		prefetchReader.close();
+		prefetchRow = 0;
+		nextWindow.clear();
+		nextWindowExpected.clear();
+		nextStart = 0;
+		nextRows = 0;
+		nextReady = false;
+		nextBusy = false;
+		windowOrder.clear();
+	}
+};
+
+// CSV input that never holds the whole dataset. A first pass builds the
+// per-column statistics, the OHE dictionaries and a record index; rows are
+// then decoded a window at a time on demand. Follows the datasets/README.md
+// format (header line, ',' delimiter) with the label in the last column and
+// an optional "<name>test.csv" sibling as the test split.
+class StreamInput : public glades::DataInput
+{
+private:
+	// one byte range of a parallel pass
+	class RangeJob
+	{
+	public:
+		const StreamInput* owner;
+		const StreamSplit* split;
+		int64_t begin;
+		int64_t end;
+		bool collectStats;
+
+		// scan results
+		unsigned int rows;
+		std::vector<StreamCheckpoint> checkpoints;
+		std::vector<ColumnStats> columns;
+
+		// decode targets
+		unsigned int firstCheckpoint;
+		unsigned int lastCheckpoint;
+		FloatMatrix* features;
+		FloatMatrix* expected;
+		bool ok;
+
+		RangeJob()
+		{
+			owner = NULL;
+			split = NULL;
+			begin = 0;
+			end = 0;
+			collectStats = false;
+			rows = 0;
+			firstCheckpoint = 0;
+			lastCheckpoint = 0;
+			features = NULL;
+			expected = NULL;
+			ok = false;
+		}
+	};
+
+	std::vector<shmea::GString> headers;
+	std::vector<ColumnStats> columns;
+	unsigned int featureCount;
+	unsigned int expectedCount;
+	unsigned int threadCount;
+
+	mutable StreamSplit trainSplit;
+	mutable StreamSplit testSplit;
+	mutable pthread_mutex_t windowMutex;
+
+	// background window decoding
+	mutable pthread_t prefetchThread;
+	mutable pthread_cond_t prefetchCond;
+	mutable pthread_cond_t readyCond;
+	mutable bool prefetchStarted;
+	mutable bool prefetchStopping;
+	mutable StreamSplit* pendingSplit;
+	mutable unsigned int pendingStart;
+
+	bool scan(StreamSplit&, bool);
+	bool loadWindow(StreamSplit&, unsigned int) const;
+	unsigned int decodeWindow(const StreamSplit&, CSVReader&, unsigned int&, unsigned int,
+							  FloatMatrix&, FloatMatrix&) const;
+	void requestPrefetch(StreamSplit&, unsigned int) const;
+	unsigned int nextWindowStart(const StreamSplit&) const;
+	void stopPrefetch();
+	void decodeRecord(const std::vector<CSVField>&, float*, float*, bool) const;
+	shmea::GList getRow(StreamSplit&, unsigned int, bool) const;
+	bool decodeSplit(const StreamSplit&, FloatMatrix&, FloatMatrix&) const;
+	unsigned int getThreads(int64_t) const;
+
+	static void* scanRange(void*);
+	static void* decodeRange(void*);
+	static void* prefetchLoop(void*);
+	static void runJobs(std::vector<RangeJob>&, void* (*)(void*));
+
+public:
+	static const unsigned int CHECKPOINT_ROWS = 1024;
+	static const unsigned int WINDOW_ROWS = 4096;
+	static const int64_t MIN_RANGE_BYTES = 4 * 1024 * 1024;
+
+	shmea::GString name;
+	bool loaded;
+
+	StreamInput();
+	virtual ~StreamInput();
+
+	virtual void import(shmea::GString);
+	void clear();
+	bool decodeAll(FloatMatrix&, FloatMatrix&, FloatMatrix&, FloatMatrix&) const;
+	void setThreads(unsigned int);
+	void setTrainOrder(const std::vector<unsigned int>&) const;
+
+	static shmea::GString testSibling(const shmea::GString&);
+
+	// stats
+	unsigned int getColumnCount() const;
+	const std::vector<ColumnStats>& getColumnStats() const;
+	bool isCategorical(unsigned int) const;
+	float getMin(unsigned int) const;
+	float getMax(unsigned int) const;
+	float getMean(unsigned int) const;
+	float getStdDev(unsigned int) const;
+	size_t getBytes() const;
+
+	virtual shmea::GList getTrainRow(unsigned int) const;
+	virtual shmea::GList getTrainExpectedRow(unsigned int) const;
+
+	virtual shmea::GList getTestRow(unsigned int) const;
+	virtual shmea::GList getTestExpectedRow(unsigned int) const;
+
+	virtual unsigned int getTrainSize() const;
+	virtual unsigned int getTestSize() const;
+	virtual unsigned int getFeatureCount() const;
+
+	virtual int getType() const;
+};
+
+#endif
@@ -0,0 +1,84 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "tablemodel.h"
+#include "Backend/Database/GTable.h"
+#include "Backend/Database/GType.h"
+
+GTableModel::GTableModel()
+{
+	table = NULL;
+}
+
+GTableModel::GTableModel(const shmea::GTable* newTable)
+{
+	table = newTable;
+}
+
+/*!
+ * @brief point the model at a table
+ * @param newTable the table to show, which must outlive the model or be replaced first
+ */
+void GTableModel::setTable(const shmea::GTable* newTable)
+{
+	table = newTable;
+}
+
+unsigned int GTableModel::numberOfRows() const
+{
+	if (!table)
+		return 0;
+
+	return table->numberOfRows();
+}
+
+unsigned int GTableModel::numberOfCols() const
+{
+	if (!table)
+		return 0;
+
+	return table->numberOfCols();
+}
+
+shmea::GString GTableModel::getHeader(unsigned int col) const
+{
+	if ((!table) || (col >= table->numberOfCols()))
+		return "";
+
+	shmea::GString header = table->getHeader(col);
+	if (header.length() == 0)
+		return shmea::GString::intTOstring(col);
+
+	return header;
+}
+
+shmea::GString GTableModel::getCell(unsigned int row, unsigned int col) const
+{
+	if ((!table) || (row >= table->numberOfRows()) || (col >= table->numberOfCols()))
+		return "";
+
+	return table->getCell(row, col);
+}
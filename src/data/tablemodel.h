@@ -0,0 +1,71 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _TABLEMODEL
+#define _TABLEMODEL
+
+#include "Backend/Database/GString.h"
+
+namespace shmea {
+class GTable;
+};
+
+// Read-only cell source for a VirtualTable. Only the cells that are on
+// screen are ever asked for, so a model can sit on top of a million row
+// dataset without copying it.
+class TableModel
+{
+public:
+	virtual ~TableModel()
+	{
+		//
+	}
+
+	virtual unsigned int numberOfRows() const = 0;
+	virtual unsigned int numberOfCols() const = 0;
+	virtual shmea::GString getHeader(unsigned int) const = 0;
+	virtual shmea::GString getCell(unsigned int, unsigned int) const = 0;
+};
+
+// Non-owning model over a GTable, eg a confusion matrix
+class GTableModel : public TableModel
+{
+private:
+	const shmea::GTable* table;
+
+public:
+	GTableModel();
+	GTableModel(const shmea::GTable*);
+
+	void setTable(const shmea::GTable*);
+
+	virtual unsigned int numberOfRows() const;
+	virtual unsigned int numberOfCols() const;
+	virtual shmea::GString getHeader(unsigned int) const;
+	virtual shmea::GString getCell(unsigned int, unsigned int) const;
+};
+
+#endif
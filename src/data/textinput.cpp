@@ -0,0 +1,495 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "textinput.h"
+#include "../core/profiler.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GString.h"
+#include "csvreader.h"
+#include "streaminput.h"
+#include <ctype.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+// longest token kept, longer runs are cut
+static const unsigned int MAX_TOKEN = 64;
+
+TextInput::TextInput()
+{
+	dimension = DEFAULT_DIMENSION;
+	threadCount = 0;
+}
+
+TextInput::~TextInput()
+{
+	clear();
+	dictionary.clear();
+}
+
+void TextInput::clear()
+{
+	train.reset();
+	test.reset();
+	classes.clear();
+	classIndex.clear();
+}
+
+/*!
+ * @brief map tokens through a word list instead of hashing them
+ * @details one word per line, matched lowercased; a word's id is its line among the distinct
+ * words plus one, and 0 is every word not in the list. Call before import.
+ * @param fname the word list, such as datasets/words.dict
+ * @return whether any words were read
+ */
+bool TextInput::loadDictionary(const shmea::GString& fname)
+{
+	dictionary.clear();
+
+	FILE* fd = fopen(fname.c_str(), "r");
+	if (!fd)
+	{
+		printf("[DATA] Unable to open \"%s\"\n", fname.c_str());
+		return false;
+	}
+
+	char line[256];
+	while (fgets(line, sizeof(line), fd))
+	{
+		std::string word;
+		for (unsigned int i = 0; (line[i]) && (line[i] != '\n') && (line[i] != '\r'); ++i)
+			word += (char)tolower((unsigned char)line[i]);
+
+		if ((!word.empty()) && (dictionary.find(word) == dictionary.end()))
+		{
+			uint32_t id = dictionary.size() + 1;
+			dictionary[word] = id;
+		}
+	}
+
+	fclose(fd);
+	return !dictionary.empty();
+}
+
+/*!
+ * @brief set the hashing trick width
+ * @param newDimension the buckets, and so the feature count, when there is no dictionary
+ */
+void TextInput::setDimension(unsigned int newDimension)
+{
+	dimension = (newDimension > 0) ? newDimension : DEFAULT_DIMENSION;
+}
+
+/*!
+ * @brief set the tokenizing thread count
+ * @param newThreadCount number of threads, 0 for one per core
+ */
+void TextInput::setThreads(unsigned int newThreadCount)
+{
+	threadCount = newThreadCount;
+}
+
+/*!
+ * @brief the id of one lowercased token
+ * @param word the token
+ * @param len its length
+ * @return the dictionary id, or the FNV-1a hash bucket when there is no dictionary
+ */
+uint32_t TextInput::tokenId(const char* word, unsigned int len) const
+{
+	if (!dictionary.empty())
+	{
+		std::map<std::string, uint32_t>::const_iterator itr =
+			dictionary.find(std::string(word, len));
+		return (itr == dictionary.end()) ? 0 : itr->second;
+	}
+
+	uint32_t hash = 2166136261u;
+	for (unsigned int i = 0; i < len; ++i)
+	{
+		hash ^= (unsigned char)word[i];
+		hash *= 16777619u;
+	}
+	return hash % dimension;
+}
+
+/*!
+ * @brief split text into token ids
+ * @details tokens are runs of letters, digits and apostrophes with the apostrophes at either
+ * end trimmed, lowercased before lookup
+ * @param text the bytes
+ * @param len the byte count
+ * @param ids the ids, appended in order
+ */
+void TextInput::tokenize(const char* text, unsigned int len, std::vector<uint32_t>& ids) const
+{
+	char word[MAX_TOKEN];
+	unsigned int wordLen = 0;
+	for (unsigned int i = 0; i <= len; ++i)
+	{
+		unsigned char c = (i < len) ? (unsigned char)text[i] : ' ';
+		if ((isalnum(c)) || (c == '\''))
+		{
+			if (wordLen < MAX_TOKEN)
+				word[wordLen++] = (char)tolower(c);
+			continue;
+		}
+
+		unsigned int start = 0;
+		while ((start < wordLen) && (word[start] == '\''))
+			++start;
+		while ((wordLen > start) && (word[wordLen - 1] == '\''))
+			--wordLen;
+
+		if (wordLen > start)
+			ids.push_back(tokenId(&word[start], wordLen - start));
+		wordLen = 0;
+	}
+}
+
+/*!
+ * @brief import a text dataset
+ * @details tokenizes the training file and its test sibling when there is one
+ * @param newName the training file path
+ */
+void TextInput::import(shmea::GString newName)
+{
+	NNC_PROFILE_SCOPE("data.text_import");
+	clear();
+
+	train.fname = newName;
+	if (!importSplit(train))
+	{
+		printf("[DATA] Unable to tokenize \"%s\"\n", newName.c_str());
+		clear();
+		return;
+	}
+
+	shmea::GString testName = StreamInput::testSibling(newName);
+	if (CSVReader::fileSize(testName) > 0)
+	{
+		test.fname = testName;
+		if (!importSplit(test))
+		{
+			printf("[DATA] Unable to tokenize \"%s\"\n", testName.c_str());
+			test.reset();
+		}
+	}
+
+	printf("[DATA] Tokenized \"%s\": %u train rows, %u test rows, %u features, %u classes\n",
+		   newName.c_str(), getTrainSize(), getTestSize(), getFeatureCount(), getClassCount());
+}
+
+/*!
+ * @brief tokenize one file
+ * @details record aligned ranges are tokenized in parallel and merged in file order, so the
+ * class ids do not depend on the thread count
+ * @param split the split, with its fname set
+ * @return whether every range was read
+ */
+bool TextInput::importSplit(TextSplit& split)
+{
+	CSVReader reader('\t');
+	if (!reader.open(split.fname))
+		return false;
+
+	int64_t dataEnd = CSVReader::fileSize(split.fname);
+	if (dataEnd < 0)
+		dataEnd = 0;
+
+	unsigned int jobCount = getThreads(dataEnd);
+	std::vector<int64_t> bounds(jobCount + 1, 0);
+	bounds[jobCount] = dataEnd;
+	for (unsigned int k = 1; k < jobCount; ++k)
+	{
+		int64_t rawOffset = (dataEnd / jobCount) * k;
+		bounds[k] = reader.alignTo(rawOffset) ? reader.tell() : dataEnd;
+		if (bounds[k] < bounds[k - 1])
+			bounds[k] = bounds[k - 1];
+		if (bounds[k] > dataEnd)
+			bounds[k] = dataEnd;
+	}
+	reader.close();
+
+	std::vector<RangeJob> jobs(jobCount);
+	for (unsigned int k = 0; k < jobCount; ++k)
+	{
+		jobs[k].owner = this;
+		jobs[k].fname = split.fname;
+		jobs[k].begin = bounds[k];
+		jobs[k].end = bounds[k + 1];
+	}
+
+	runJobs(jobs);
+
+	// merge in file order
+	for (unsigned int k = 0; k < jobCount; ++k)
+	{
+		if (!jobs[k].ok)
+			return false;
+
+		split.tokens.insert(split.tokens.end(), jobs[k].tokens.begin(), jobs[k].tokens.end());
+		for (unsigned int i = 0; i < jobs[k].rowLengths.size(); ++i)
+		{
+			split.rowStart.push_back(split.rowStart.back() + jobs[k].rowLengths[i]);
+
+			const std::string& label = jobs[k].labels[i];
+			std::map<std::string, uint32_t>::const_iterator itr = classIndex.find(label);
+			if (itr == classIndex.end())
+			{
+				uint32_t id = classes.size();
+				classes.push_back(label);
+				classIndex[label] = id;
+				split.labels.push_back(id);
+			}
+			else
+				split.labels.push_back(itr->second);
+		}
+	}
+
+	return true;
+}
+
+void* TextInput::tokenizeRange(void* y)
+{
+	RangeJob* job = (RangeJob*)y;
+	job->ok = false;
+
+	CSVReader reader('\t');
+	if ((!reader.open(job->fname)) || (!reader.seek(job->begin)))
+		return NULL;
+	reader.setLimit(job->end);
+
+	std::vector<CSVField> fields;
+	while (reader.readRecord(fields))
+	{
+		// the text runs from the second field to the end of the line, tabs and all
+		unsigned int before = job->tokens.size();
+		if (fields.size() >= 2)
+		{
+			const char* text = fields[1].ptr;
+			const char* textEnd = fields[fields.size() - 1].ptr + fields[fields.size() - 1].len;
+			job->owner->tokenize(text, (unsigned int)(textEnd - text), job->tokens);
+		}
+
+		job->labels.push_back(fields[0].toString());
+		job->rowLengths.push_back(job->tokens.size() - before);
+	}
+
+	job->ok = true;
+	return NULL;
+}
+
+/*!
+ * @brief run jobs fork/join
+ * @details the calling thread takes the first job
+ * @param jobs the jobs
+ */
+void TextInput::runJobs(std::vector<RangeJob>& jobs)
+{
+	if (jobs.empty())
+		return;
+
+	std::vector<pthread_t> threads(jobs.size());
+	std::vector<bool> started(jobs.size(), false);
+	for (unsigned int k = 1; k < jobs.size(); ++k)
+		started[k] = (pthread_create(&threads[k], NULL, tokenizeRange, &jobs[k]) == 0);
+
+	tokenizeRange(&jobs[0]);
+
+	for (unsigned int k = 1; k < jobs.size(); ++k)
+	{
+		if (started[k])
+			pthread_join(threads[k], NULL);
+		else
+			tokenizeRange(&jobs[k]);
+	}
+}
+
+unsigned int TextInput::getThreads(int64_t bytes) const
+{
+	int64_t cores = threadCount;
+	if (cores <= 0)
+		cores = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cores <= 0)
+		cores = 1;
+
+	int64_t byRange = bytes / MIN_RANGE_BYTES;
+	if (byRange < 1)
+		byRange = 1;
+
+	return (unsigned int)(cores < byRange ? cores : byRange);
+}
+
+/*!
+ * @brief the bag of words of a document
+ * @param split the split
+ * @param row the document
+ * @return getFeatureCount() term counts scaled to unit length
+ */
+shmea::GList TextInput::bagOf(const TextSplit& split, unsigned int row) const
+{
+	shmea::GList bag;
+	if (row >= split.rows())
+		return bag;
+
+	std::vector<float> counts(getFeatureCount(), 0.0f);
+	for (uint32_t i = split.rowStart[row]; i < split.rowStart[row + 1]; ++i)
+		counts[split.tokens[i]] += 1.0f;
+
+	double norm = 0.0;
+	for (uint32_t i = split.rowStart[row]; i < split.rowStart[row + 1]; ++i)
+		norm += counts[split.tokens[i]];
+	float scale = 0.0f;
+	if (norm > 0.0)
+	{
+		// each distinct id was visited counts[id] times, so norm is the sum of the squares
+		scale = (float)(1.0 / sqrt(norm));
+	}
+
+	for (unsigned int i = 0; i < counts.size(); ++i)
+		bag.addFloat(counts[i] * scale);
+
+	return bag;
+}
+
+shmea::GList TextInput::expectedOf(const TextSplit& split, unsigned int row) const
+{
+	shmea::GList expected;
+	if (row >= split.rows())
+		return expected;
+
+	for (unsigned int i = 0; i < classes.size(); ++i)
+		expected.addFloat((i == split.labels[row]) ? 1.0f : 0.0f);
+
+	return expected;
+}
+
+bool TextInput::sequenceOf(const TextSplit& split, unsigned int row,
+						   std::vector<uint32_t>& ids) const
+{
+	ids.clear();
+	if (row >= split.rows())
+		return false;
+
+	ids.assign(split.tokens.begin() + split.rowStart[row],
+			   split.tokens.begin() + split.rowStart[row + 1]);
+	return true;
+}
+
+shmea::GList TextInput::getTrainRow(unsigned int index) const
+{
+	return bagOf(train, index);
+}
+
+shmea::GList TextInput::getTrainExpectedRow(unsigned int index) const
+{
+	return expectedOf(train, index);
+}
+
+shmea::GList TextInput::getTestRow(unsigned int index) const
+{
+	return bagOf(test, index);
+}
+
+shmea::GList TextInput::getTestExpectedRow(unsigned int index) const
+{
+	return expectedOf(test, index);
+}
+
+/*!
+ * @brief the token ids of a training document
+ * @details in document order, for sequence models such as the RNN
+ * @param index the document
+ * @param ids the ids
+ * @return whether the document exists
+ */
+bool TextInput::getTrainSequence(unsigned int index, std::vector<uint32_t>& ids) const
+{
+	return sequenceOf(train, index, ids);
+}
+
+bool TextInput::getTestSequence(unsigned int index, std::vector<uint32_t>& ids) const
+{
+	return sequenceOf(test, index, ids);
+}
+
+unsigned int TextInput::getTrainSize() const
+{
+	return train.rows();
+}
+
+unsigned int TextInput::getTestSize() const
+{
+	return test.rows();
+}
+
+unsigned int TextInput::getFeatureCount() const
+{
+	if (!dictionary.empty())
+		return dictionary.size() + 1;
+
+	return dimension;
+}
+
+unsigned int TextInput::getClassCount() const
+{
+	return classes.size();
+}
+
+bool TextInput::hasDictionary() const
+{
+	return !dictionary.empty();
+}
+
+/*!
+ * @brief resident size
+ * @details the packed ids of both splits plus an estimate of the dictionary's map nodes
+ * @return bytes
+ */
+size_t TextInput::getBytes() const
+{
+	size_t bytes = 0;
+	const TextSplit* splits[2] = {&train, &test};
+	for (unsigned int s = 0; s < 2; ++s)
+	{
+		bytes += splits[s]->rowStart.size() * sizeof(uint32_t);
+		bytes += splits[s]->tokens.size() * sizeof(uint32_t);
+		bytes += splits[s]->labels.size() * sizeof(uint32_t);
+	}
+
+	std::map<std::string, uint32_t>::const_iterator itr = dictionary.begin();
+	for (; itr != dictionary.end(); ++itr)
+		bytes += itr->first.capacity() + sizeof(*itr) + 32;
+
+	return bytes;
+}
+
+int TextInput::getType() const
+{
+	return TEXT;
+}
@@ -0,0 +1,155 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _TEXTINPUT
+#define _TEXTINPUT
+
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// The documents of one text file, as token ids packed end to end
+class TextSplit
+{
+public:
+	shmea::GString fname;
+	std::vector<uint32_t> rowStart;
+	std::vector<uint32_t> tokens;
+	std::vector<uint32_t> labels;
+
+	TextSplit()
+	{
+		reset();
+	}
+
+	void reset()
+	{
+		fname = "";
+		rowStart.clear();
+		rowStart.push_back(0);
+		tokens.clear();
+		labels.clear();
+	}
+
+	unsigned int rows() const
+	{
+		return labels.size();
+	}
+};
+
+// Text input, one "<label><TAB><text>" document per line. Tokens are runs of
+// letters, digits and apostrophes, lowercased, and map either to their line in
+// a dictionary file such as datasets/words.dict (unknown words share id 0) or,
+// with no dictionary, through the hashing trick into a fixed number of
+// buckets. The file is tokenized once, in parallel record aligned ranges, and
+// only the token ids are kept; a row is the L2 normalized bag of words over
+// the ids, built when it is asked for. The ids themselves are available in
+// document order for sequence models. Labels are one-hot classes in order of
+// first appearance, and an optional "<name>test.<ext>" sibling is the test
+// split.
+class TextInput : public glades::DataInput
+{
+private:
+	// one byte range of the tokenizing pass
+	class RangeJob
+	{
+	public:
+		const TextInput* owner;
+		shmea::GString fname;
+		int64_t begin;
+		int64_t end;
+
+		std::vector<uint32_t> rowLengths;
+		std::vector<uint32_t> tokens;
+		std::vector<std::string> labels;
+		bool ok;
+
+		RangeJob()
+		{
+			owner = NULL;
+			begin = 0;
+			end = 0;
+			ok = false;
+		}
+	};
+
+	TextSplit train;
+	TextSplit test;
+	std::map<std::string, uint32_t> dictionary;
+	std::vector<std::string> classes;
+	std::map<std::string, uint32_t> classIndex;
+	unsigned int dimension;
+	unsigned int threadCount;
+
+	uint32_t tokenId(const char*, unsigned int) const;
+	void tokenize(const char*, unsigned int, std::vector<uint32_t>&) const;
+	bool importSplit(TextSplit&);
+	unsigned int getThreads(int64_t) const;
+	shmea::GList bagOf(const TextSplit&, unsigned int) const;
+	shmea::GList expectedOf(const TextSplit&, unsigned int) const;
+	bool sequenceOf(const TextSplit&, unsigned int, std::vector<uint32_t>&) const;
+
+	static void* tokenizeRange(void*);
+	static void runJobs(std::vector<RangeJob>&);
+
+public:
+	// hashing trick buckets when there is no dictionary
+	static const unsigned int DEFAULT_DIMENSION = 1024;
+	// smallest byte range worth its own thread
+	static const int64_t MIN_RANGE_BYTES = 4 * 1024 * 1024;
+
+	TextInput();
+	virtual ~TextInput();
+
+	bool loadDictionary(const shmea::GString&);
+	void setDimension(unsigned int);
+	void setThreads(unsigned int);
+	void clear();
+
+	virtual void import(shmea::GString);
+
+	virtual shmea::GList getTrainRow(unsigned int) const;
+	virtual shmea::GList getTrainExpectedRow(unsigned int) const;
+
+	virtual shmea::GList getTestRow(unsigned int) const;
+	virtual shmea::GList getTestExpectedRow(unsigned int) const;
+
+	bool getTrainSequence(unsigned int, std::vector<uint32_t>&) const;
+	bool getTestSequence(unsigned int, std::vector<uint32_t>&) const;
+
+	virtual unsigned int getTrainSize() const;
+	virtual unsigned int getTestSize() const;
+	virtual unsigned int getFeatureCount() const;
+	unsigned int getClassCount() const;
+	bool hasDictionary() const;
+	size_t getBytes() const;
+
+	virtual int getType() const;
+};
+
+#endif
@@ -0,0 +1,149 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "validationinput.h"
+#include "../core/profiler.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Machine Learning/Networks/network.h"
+#include "indexedinput.h"
+#include <float.h>
+#include <stdio.h>
+
+/*!
+ * @brief ValidationInput constructor
+ * @details shares the source's OHE maps
+ * @param newSource the input whose validation split to serve
+ */
+ValidationInput::ValidationInput(const IndexedInput* newSource)
+{
+	source = newSource;
+	if (!source)
+		return;
+
+	OHEMaps = source->OHEMaps;
+	featureIsCategorical = source->featureIsCategorical;
+}
+
+ValidationInput::~ValidationInput()
+{
+	source = NULL; // Not ours to delete
+	OHEMaps.clear();
+	featureIsCategorical.clear();
+}
+
+/*!
+ * @brief score a network on the validation rows
+ * @param network the network, whose last test results are replaced
+ * @return the mean squared error per output, or FLT_MAX when there are no results
+ */
+float ValidationInput::loss(glades::NNetwork& network) const
+{
+	NNC_PROFILE_SCOPE("train.validate");
+	unsigned int rows = getTestSize();
+	if (rows == 0)
+		return FLT_MAX;
+
+	network.test(const_cast<ValidationInput*>(this));
+
+	// one block of outputs per row, in row order
+	shmea::GList results = network.getResults();
+	if ((results.size() == 0) || (results.size() % rows != 0))
+		return FLT_MAX;
+
+	unsigned int width = results.size() / rows;
+	double squared = 0.0;
+	for (unsigned int r = 0; r < rows; ++r)
+	{
+		shmea::GList expected = getTestExpectedRow(r);
+		for (unsigned int c = 0; (c < width) && (c < expected.size()); ++c)
+		{
+			double error = results.getFloat(r * width + c) - expected.getFloat(c);
+			squared += error * error;
+		}
+	}
+
+	return (float)(squared / ((double)rows * width));
+}
+
+void ValidationInput::import(shmea::GString fname)
+{
+	printf("[DATA] ValidationInput serves an IndexedInput, \"%s\" not loaded\n", fname.c_str());
+}
+
+shmea::GList ValidationInput::getTrainRow(unsigned int) const
+{
+	return shmea::GList();
+}
+
+shmea::GList ValidationInput::getTrainExpectedRow(unsigned int) const
+{
+	return shmea::GList();
+}
+
+shmea::GList ValidationInput::getTestRow(unsigned int index) const
+{
+	if (!source)
+		return shmea::GList();
+
+	return source->getValidationRow(index);
+}
+
+shmea::GList ValidationInput::getTestExpectedRow(unsigned int index) const
+{
+	if (!source)
+		return shmea::GList();
+
+	return source->getValidationExpectedRow(index);
+}
+
+unsigned int ValidationInput::getTrainSize() const
+{
+	return 0;
+}
+
+unsigned int ValidationInput::getTestSize() const
+{
+	if (!source)
+		return 0;
+
+	return source->getValidationSize();
+}
+
+unsigned int ValidationInput::getFeatureCount() const
+{
+	if (!source)
+		return 0;
+
+	return source->getFeatureCount();
+}
+
+int ValidationInput::getType() const
+{
+	if (!source)
+		return glades::DataInput::CSV;
+
+	return source->getType();
+}
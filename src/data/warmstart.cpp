@@ -0,0 +1,286 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "warmstart.h"
+#include "../core/atomicfile.h"
+#include "../core/md5.h"
+#include "../core/random.h"
+#include "indexedinput.h"
+#include "inputloader.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <vector>
+
+// Next to the metrics history, <netName>.nnwarm
+static const char WARM_DIR[] = "metrics";
+
+// bytes hashed at each end of the trained prefix
+static const int64_t SAMPLE_BYTES = 1024 * 1024;
+
+static const char WARM_MAGIC[8] = {'N', 'N', 'W', 'A', 'R', 'M', '\0', '\0'};
+
+struct WarmHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t trainRows;
+	int64_t bytes;
+	char head[32];
+	char tail[32];
+	// version 2
+	uint32_t encoding;
+	uint32_t reserved;
+};
+
+WarmStart::WarmStart()
+{
+	bytes = 0;
+	trainRows = 0;
+	encoding = InputLoader::ENCODING_UNKNOWN;
+}
+
+/*!
+ * @brief hash both ends of a file prefix
+ * @param fname the dataset path
+ * @param prefix the bytes of the file to cover
+ * @param head the md5 of the first SAMPLE_BYTES of the prefix
+ * @param tail the md5 of the last SAMPLE_BYTES of the prefix
+ * @return whether the file was at least prefix bytes long and readable
+ */
+bool WarmStart::prefixKeys(const shmea::GString& fname, int64_t prefix, std::string& head,
+						   std::string& tail)
+{
+	struct stat st;
+	if ((stat(fname.c_str(), &st) != 0) || ((int64_t)st.st_size < prefix))
+		return false;
+
+	FILE* fd = fopen(fname.c_str(), "rb");
+	if (!fd)
+		return false;
+
+	int64_t sampleBytes = (prefix < SAMPLE_BYTES) ? prefix : SAMPLE_BYTES;
+	std::vector<char> sample(sampleBytes + 1);
+	bool ok = (fread(&sample[0], 1, sampleBytes, fd) == (size_t)sampleBytes);
+	if (ok)
+	{
+		MD5 digest;
+		digest.update(&sample[0], sampleBytes);
+		head = digest.finalize().hexdigest();
+	}
+
+	ok = (ok) && (fseeko(fd, (off_t)(prefix - sampleBytes), SEEK_SET) == 0) &&
+		 (fread(&sample[0], 1, sampleBytes, fd) == (size_t)sampleBytes);
+	if (ok)
+	{
+		MD5 digest;
+		digest.update(&sample[0], sampleBytes);
+		tail = digest.finalize().hexdigest();
+	}
+
+	fclose(fd);
+	return ok;
+}
+
+/*!
+ * @brief remember the dataset a network was just trained on
+ * @param fname the dataset path
+ * @param newTrainRows the training rows it had
+ * @return whether the dataset could be read
+ */
+bool WarmStart::record(const shmea::GString& fname, unsigned int newTrainRows)
+{
+	struct stat st;
+	if (stat(fname.c_str(), &st) != 0)
+		return false;
+
+	bytes = st.st_size;
+	trainRows = newTrainRows;
+	encoding = InputLoader::encodingOf(fname);
+	return prefixKeys(fname, bytes, headKey, tailKey);
+}
+
+/*!
+ * @brief whether a dataset is the recorded one with rows appended
+ * @details an unchanged file counts too, with no new rows to train
+ * @param fname the dataset path
+ * @return whether it still starts with the recorded bytes
+ */
+bool WarmStart::extends(const shmea::GString& fname) const
+{
+	if ((bytes <= 0) || (headKey.length() != KEY_LEN))
+		return false;
+
+	std::string head;
+	std::string tail;
+	return (prefixKeys(fname, bytes, head, tail)) && (head == headKey) && (tail == tailKey);
+}
+
+unsigned int WarmStart::getTrainRows() const
+{
+	return trainRows;
+}
+
+bool WarmStart::save(const std::string& fname) const
+{
+	if ((headKey.length() != KEY_LEN) || (tailKey.length() != KEY_LEN))
+		return false;
+
+	WarmHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, WARM_MAGIC, sizeof(header.magic));
+	header.version = VERSION;
+	header.trainRows = trainRows;
+	header.bytes = bytes;
+	memcpy(header.head, headKey.c_str(), KEY_LEN);
+	memcpy(header.tail, tailKey.c_str(), KEY_LEN);
+	header.encoding = encoding;
+
+	return AtomicFile::writeFile(fname, &header, sizeof(header));
+}
+
+bool WarmStart::load(const std::string& fname)
+{
+	FILE* fd = fopen(fname.c_str(), "rb");
+	if (!fd)
+		return false;
+
+	// version 1 records end before the encoding, which they did not keep
+	WarmHeader header;
+	memset(&header, 0, sizeof(header));
+	size_t got = fread(&header, 1, sizeof(header), fd);
+	fclose(fd);
+	bool ok = (got >= offsetof(WarmHeader, encoding)) &&
+			  (memcmp(header.magic, WARM_MAGIC, sizeof(header.magic)) == 0) &&
+			  (((header.version == 1) && (got == offsetof(WarmHeader, encoding))) ||
+			   ((header.version == VERSION) && (got == sizeof(header))));
+	if (!ok)
+		return false;
+
+	bytes = header.bytes;
+	trainRows = header.trainRows;
+	headKey = std::string(header.head, KEY_LEN);
+	tailKey = std::string(header.tail, KEY_LEN);
+	encoding = (header.version == 1) ? InputLoader::ENCODING_UNKNOWN : header.encoding;
+	return true;
+}
+
+/*!
+ * @brief the warm start record of a network
+ * @param netName the network
+ * @return the record path
+ */
+std::string WarmStart::path(const shmea::GString& netName)
+{
+	return std::string(WARM_DIR) + "/" + netName.c_str() + ".nnwarm";
+}
+
+/*!
+ * @brief restrict a run to the rows appended since the network last trained
+ * @details falls back to every row when there is no record or the dataset was rewritten
+ * rather than appended to
+ * @param input the indexed training input
+ * @param netName the network
+ * @param fname the dataset path
+ * @param replayFraction the share of the already trained rows to replay, 0 to 1
+ * @return whether the run was restricted
+ */
+bool WarmStart::select(IndexedInput& input, const shmea::GString& netName,
+					   const shmea::GString& fname, double replayFraction)
+{
+	WarmStart last;
+	if (!last.load(path(netName)))
+		return false;
+
+	if (!last.extends(fname))
+	{
+		printf("[DATA] \"%s\" changed since \"%s\" last trained, using every row\n",
+			   fname.c_str(), netName.c_str());
+		return false;
+	}
+
+	Random replay;
+	replay.seed(Random::streamSeed("warmstart.replay"));
+	if (!input.incremental(last.getTrainRows(), replayFraction, &replay))
+		return false;
+
+	unsigned int total = input.getSource()->getTrainSize();
+	unsigned int fresh = (total > last.getTrainRows()) ? total - last.getTrainRows() : 0;
+	printf("[DATA] \"%s\" warm starts on %u new rows and %u replayed\n", netName.c_str(), fresh,
+		   input.getTrainSize() - fresh);
+	return true;
+}
+
+/*!
+ * @brief record the dataset a network has now been trained on
+ * @param netName the network
+ * @param fname the dataset path
+ * @param trainRows the dataset's training rows
+ * @return whether the record was written
+ */
+bool WarmStart::update(const shmea::GString& netName, const shmea::GString& fname,
+					   unsigned int trainRows)
+{
+	WarmStart current;
+	if (!current.record(fname, trainRows))
+		return false;
+
+	mkdir(WARM_DIR, 0755);
+	return current.save(path(netName));
+}
+
+/*!
+ * @brief whether a network may use a csv as it would be encoded now
+ * @details NumberInput and the app's parser encode the same columns differently, and a dataset
+ * that grows past InputLoader::PARALLEL_THRESHOLD switches between them. A network that has
+ * trained is refused a dataset whose encoding differs from the one it last trained on. A trained
+ * network without a record predates the records, when every csv went through NumberInput.
+ * @param netName the network
+ * @param fname the csv path, as InputLoader resolved it
+ * @param trained whether the network has trained before
+ * @return false when the encodings are known to differ
+ */
+bool WarmStart::sameEncoding(const shmea::GString& netName, const shmea::GString& fname,
+							 bool trained)
+{
+	if (!trained)
+		return true;
+
+	uint32_t recorded = InputLoader::ENCODING_NUMBERINPUT;
+	WarmStart last;
+	if (last.load(path(netName)))
+		recorded = last.encoding;
+
+	uint32_t current = InputLoader::encodingOf(fname);
+	if ((recorded == InputLoader::ENCODING_UNKNOWN) ||
+		(current == InputLoader::ENCODING_UNKNOWN) || (recorded == current))
+		return true;
+
+	printf("[DATA] \"%s\" was trained on another encoding of \"%s\", retrain it from scratch\n",
+		   netName.c_str(), fname.c_str());
+	return false;
+}
@@ -0,0 +1,74 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _WARMSTART
+#define _WARMSTART
+
+#include "Backend/Database/GString.h"
+#include <stdint.h>
+#include <string>
+
+class IndexedInput;
+
+// What a network was last trained on, kept in "<net>.nnwarm" so a later run
+// can train only the rows appended to the dataset since then. The dataset is
+// recognised by its size and by the hashes of the first and last bytes it had;
+// a file that still starts with those bytes has only been appended to.
+// The appended rows are trained together with a replay sample of the old ones,
+// so the network does not forget what it already learned. The record also
+// keeps the csv feature encoding (see InputLoader::encodingOf), so a trained
+// network is refused a dataset that would now be encoded differently.
+class WarmStart
+{
+private:
+	static const uint32_t VERSION = 2;
+	static const unsigned int KEY_LEN = 32;
+
+	int64_t bytes;
+	uint32_t trainRows;
+	uint32_t encoding;
+	std::string headKey;
+	std::string tailKey;
+
+	static bool prefixKeys(const shmea::GString&, int64_t, std::string&, std::string&);
+
+public:
+	WarmStart();
+
+	bool record(const shmea::GString&, unsigned int);
+	bool extends(const shmea::GString&) const;
+	unsigned int getTrainRows() const;
+
+	bool save(const std::string&) const;
+	bool load(const std::string&);
+
+	static std::string path(const shmea::GString&);
+	static bool select(IndexedInput&, const shmea::GString&, const shmea::GString&, double);
+	static bool update(const shmea::GString&, const shmea::GString&, unsigned int);
+	static bool sameEncoding(const shmea::GString&, const shmea::GString&, bool);
+};
+
+#endif
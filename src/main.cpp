@@ -28,6 +28,7 @@
 #include "Backend/Networking/main.h"
 #include "Frontend/Graphics/graphics.h"
 #include "crt0.h"
+#include "core/stopwatch.h"
 #include "nncreator.h"
 
 /*!
@@ -37,6 +38,7 @@
  */
 void Frontend::run(GNet::GServer* serverInstance, bool fullscreenMode, bool compatMode)
 {
+	Stopwatch startup;
 	int newWidth = 1920;
 	int newHeight = 1080;
 
@@ -50,12 +52,14 @@ void Frontend::run(GNet::GServer* serverInstance, bool fullscreenMode, bool comp
 		printf("[MAIN] Graphics load error: %d\n", gfxInitialized);
 		return;
 	}
+	startup.lap("graphics");
 
 	// Create the GPanels
 	NNCreatorPanel* nnCreatorPanel =
 		new NNCreatorPanel(serverInstance, "nnCreatorPanel", newWidth, newHeight);
 	nnCreatorPanel->show(&cGfx);
 	cGfx.addItem(nnCreatorPanel);
+	startup.lap("panel");
 
 	// run gfx lib (blocks the main thread)
 	cGfx.run();
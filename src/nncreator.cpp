@@ -56,12 +56,48 @@
 #include "Frontend/Graphics/graphics.h"
 #include "Frontend/RUGraph/RUGraph.h"
 #include "crt0.h"
+#include "data/memoryusage.h"
 #include "main.h"
 #include "services/gui_callback.h"
+#include "virtualtable.h"
+#include <algorithm>
+#include <sys/stat.h>
 
 // using namespace shmea;
 using namespace glades;
 
+// Latest-state messages are applied once per display frame, this one until the display is known
+static const int64_t DEFAULT_FRAME_MS = 16;
+
+// RUGraph recomputes every point on update, so the graphs refresh at most this often
+static const int64_t GRAPH_UPDATE_MS = 250;
+
+// csv rows read per preview page; the preview table scrolls within the page
+static const unsigned int PREVIEW_ROWS = 256;
+
+// Activation snapshots between refreshes of the per layer statistics label
+static const int64_t STATS_REPORT_UPDATES = 100;
+
+// profiled scopes named in the profile label, costliest first
+static const unsigned int PROFILE_SCOPES_SHOWN = 4;
+
+static int64_t monotonicMs()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int64_t displayFrameMs()
+{
+	SDL_DisplayMode mode;
+	if ((SDL_GetCurrentDisplayMode(0, &mode) != 0) || (mode.refresh_rate <= 0))
+		return DEFAULT_FRAME_MS;
+
+	int64_t ms = 1000 / mode.refresh_rate;
+	return (ms > 0) ? ms : 1;
+}
+
 /*!
  * @brief NNCreatorPanel constructor
  * @details builds the NNCreator panel
@@ -75,6 +111,19 @@ NNCreatorPanel::NNCreatorPanel(const shmea::GString& name, int width, int height
 	serverInstance = NULL;
 	netCount = 0;
 	keepGraping = true;
+	trainPaused = false;
+	pauseButton = NULL;
+	nnNamesLoaded = false;
+	listingsLoaded = false;
+	clearPending();
+	frameMs = DEFAULT_FRAME_MS;
+	lastApplyMs = 0;
+	lastGraphMs = 0;
+	nn = NULL;
+	trainingRowIndex = 0;
+	testingRowIndex = 0;
+	prevImageFlag = 0;
+	previewMore = false;
 	buildPanel();
 }
 
@@ -85,6 +134,19 @@ NNCreatorPanel::NNCreatorPanel(GNet::GServer* newInstance, const shmea::GString&
 	serverInstance = newInstance;
 	netCount = 0;
 	keepGraping = true;
+	trainPaused = false;
+	pauseButton = NULL;
+	nnNamesLoaded = false;
+	listingsLoaded = false;
+	clearPending();
+	frameMs = DEFAULT_FRAME_MS;
+	lastApplyMs = 0;
+	lastGraphMs = 0;
+	nn = NULL;
+	trainingRowIndex = 0;
+	testingRowIndex = 0;
+	prevImageFlag = 0;
+	previewMore = false;
 	buildPanel();
 }
 
@@ -138,6 +200,7 @@ void NNCreatorPanel::buildPanel()
 	// Learning curve graph
 	lcGraph = new RUGraph(getWidth() / 4, getHeight() / 4, RUGraph::QUADRANTS_ONE);
 	lcGraph->setName("lcGraph");
+	lcCurve.setBuckets(lcGraph->getWidth());
 	lcGraphLayout->addSubItem(lcGraph);
 
 	// ROC Curve Graph and Label
@@ -147,7 +210,7 @@ void NNCreatorPanel::buildPanel()
 	topGraphsLayout->addSubItem(rocGraphLayout);
 
 	// ROC Curve Label
-	RULabel* lblGraphROC = new RULabel();
+	lblGraphROC = new RULabel();
 	lblGraphROC->setWidth(350);
 	lblGraphROC->setHeight(25);
 	lblGraphROC->setText("ROC Curve (False Pos, True pos)");
@@ -209,7 +272,8 @@ void NNCreatorPanel::buildPanel()
 	confTableLayout->addSubItem(lblTableConf);
 
 	// Confusion Matrix Table
-	cMatrixTable = new RUTable();
+	cMatrixTable = new VirtualTable();
+	cMatrixTable->setDiagonal(true);
 	cMatrixTable->setRowsShown(5);
 	cMatrixTable->setWidth(getWidth() / 4);
 	cMatrixTable->setHeight(getHeight() / 4);
@@ -248,6 +312,30 @@ void NNCreatorPanel::buildPanel()
 	lblAccuracy->setName("lblAccuracy");
 	statsLayout->addSubItem(lblAccuracy);
 
+	// Memory Label
+	lblMemory = new RULabel();
+	lblMemory->setWidth(240);
+	lblMemory->setHeight(26);
+	lblMemory->setText("");
+	lblMemory->setName("lblMemory");
+	statsLayout->addSubItem(lblMemory);
+
+	// Activation statistics Label
+	lblActivations = new RULabel();
+	lblActivations->setWidth(540);
+	lblActivations->setHeight(26);
+	lblActivations->setText("");
+	lblActivations->setName("lblActivations");
+	leftSideLayout->addSubItem(lblActivations);
+
+	// Profiler summary Label
+	lblProfile = new RULabel();
+	lblProfile->setWidth(540);
+	lblProfile->setHeight(26);
+	lblProfile->setText("");
+	lblProfile->setName("lblProfile");
+	leftSideLayout->addSubItem(lblProfile);
+
 	//============FORM============
 
 	// Neural Network Settings header
@@ -390,6 +478,15 @@ void NNCreatorPanel::buildPanel()
 	contButton->setName("contButton");
 	runTestLayout->addSubItem(contButton);
 
+	// Pause Button
+	pauseButton = new RUButton("blue");
+	pauseButton->setWidth(100);
+	pauseButton->setHeight(30);
+	pauseButton->setText("   Pause");
+	pauseButton->setMouseDownListener(GeneralListener(this, &NNCreatorPanel::clickedPause));
+	pauseButton->setName("pauseButton");
+	runTestLayout->addSubItem(pauseButton);
+
 	// Kill Button
 	RUButton* killButton = new RUButton("red");
 	killButton->setWidth(70);
@@ -688,7 +785,7 @@ void NNCreatorPanel::buildPanel()
 	previewTabs->setSelectedTab(1);
 
 	// Preview Table
-	previewTable = new RUTable();
+	previewTable = new VirtualTable();
 	previewTable->setRowsShown(8);
 	previewTable->setWidth(getWidth() / 4);
 	previewTable->setHeight(getHeight() / 4);
@@ -1051,12 +1148,11 @@ void NNCreatorPanel::buildPanel()
 
 	//============END OF RIGHT============
 
-	loadDDNN();
 	populateIndexToEdit();
 	populateInputLayerForm();
 	populateHLayerForm();
 
-	loadDatasets();
+	// the network and dataset dropdowns are filled on the first frame, see updateBackground
 }
 
 void NNCreatorPanel::onStart()
@@ -1066,6 +1162,9 @@ void NNCreatorPanel::onStart()
 
 NNCreatorPanel::~NNCreatorPanel()
 {
+	if (nn)
+		delete nn;
+
 	pthread_mutex_destroy(lcMutex);
 	if (lcMutex)
 		free(lcMutex);
@@ -1075,8 +1174,32 @@ NNCreatorPanel::~NNCreatorPanel()
 		free(rocMutex);
 }
 
-void NNCreatorPanel::loadDDNN()
+/*!
+ * @brief fill the network dropdown
+ * @details the saved network names are read once and then kept up to date by the save and
+ * delete handlers; only an explicit rescan reads every saved table again
+ * @param rescan whether to reload the names from the database
+ */
+void NNCreatorPanel::loadDDNN(bool rescan)
 {
+	if ((rescan) || (!nnNamesLoaded))
+	{
+		nnNames.clear();
+
+		shmea::SaveFolder nnList("neuralnetworks");
+		nnList.load();
+		const std::vector<shmea::SaveTable*>& saveTables = nnList.getItems();
+		for (unsigned int i = 0; i < saveTables.size(); ++i)
+		{
+			shmea::SaveTable* cItem = saveTables[i];
+			if (!cItem)
+				continue;
+
+			nnNames.push_back(cItem->getName());
+		}
+		nnNamesLoaded = true;
+	}
+
 	// clear the old items
 	ddNeuralNet->clearOptions();
 
@@ -1084,17 +1207,8 @@ void NNCreatorPanel::loadDDNN()
 	ddNeuralNet->addOption(" New");
 
 	// add items from nnetworks table to dropdown
-	shmea::SaveFolder* nnList = new shmea::SaveFolder("neuralnetworks");
-	nnList->load();
-	std::vector<shmea::SaveTable*> saveTables = nnList->getItems();
-	for (unsigned int i = 0; i < saveTables.size(); ++i)
-	{
-		shmea::SaveTable* cItem = saveTables[i];
-		if (!cItem)
-			continue;
-
-		ddNeuralNet->addOption(cItem->getName());
-	}
+	for (unsigned int i = 0; i < nnNames.size(); ++i)
+		ddNeuralNet->addOption(nnNames[i]);
 }
 
 /*!
@@ -1375,6 +1489,7 @@ void NNCreatorPanel::loadDatasets()
 	trainingRowIndex = 0;
 	testingRowIndex = 0;
 	prevImageFlag = 0;
+	previewMore = false;
 
 	int dataType = 0;
 	shmea::GString folderName = "datasets/";
@@ -1400,37 +1515,60 @@ void NNCreatorPanel::loadDatasets()
 	else
 		return;
 
-	DIR* dir;
-	struct dirent* ent;
-	if ((dir = opendir(folderName.c_str())) == NULL)
+	// reuse the listing while the folder is unchanged
+	struct stat folderStat;
+	if (stat(folderName.c_str(), &folderStat) != 0)
 	{
 		printf("[ML] -%s\n", folderName.c_str());
 		return;
 	}
 
-	// loop through the directory
-	while ((ent = readdir(dir)) != NULL)
+	std::string listingKey = folderName.c_str() + std::string(1, '0' + dataType);
+	std::map<std::string, std::pair<time_t, std::vector<shmea::GString> > >::iterator cached =
+		datasetListings.find(listingKey);
+	if ((cached == datasetListings.end()) || (cached->second.first != folderStat.st_mtime))
 	{
-		// don't want the current directory, parent or hidden files/folders
-		shmea::GString fname(ent->d_name);
-		if (fname[0] == '.')
-			continue;
-
-		if ((ent->d_type == DT_DIR) && (dataType == 1))
+		std::vector<shmea::GString> names;
+		DIR* dir;
+		struct dirent* ent;
+		if ((dir = opendir(folderName.c_str())) == NULL)
 		{
-			// printf("Folder[%d]: %s \n", ent->d_type, fname.c_str());
-			ddDatasets->addOption(fname);
+			printf("[ML] -%s\n", folderName.c_str());
+			return;
 		}
-		else if ((ent->d_type == DT_REG) && (dataType == 0 || dataType == 2))
+
+		// loop through the directory
+		while ((ent = readdir(dir)) != NULL)
 		{
-			// printf("File[%d]: %s \n", ent->d_type, fname.c_str());
-			ddDatasets->addOption(fname);
+			// don't want the current directory, parent or hidden files/folders
+			shmea::GString fname(ent->d_name);
+			if (fname[0] == '.')
+				continue;
+
+			if ((ent->d_type == DT_DIR) && (dataType == 1))
+			{
+				// printf("Folder[%d]: %s \n", ent->d_type, fname.c_str());
+				names.push_back(fname);
+			}
+			else if ((ent->d_type == DT_REG) && (dataType == 0 || dataType == 2))
+			{
+				// printf("File[%d]: %s \n", ent->d_type, fname.c_str());
+				names.push_back(fname);
+			}
+			else
+				continue;
 		}
-		else
-			continue;
+
+		closedir(dir);
+		datasetListings[listingKey] =
+			std::pair<time_t, std::vector<shmea::GString> >(folderStat.st_mtime, names);
+		cached = datasetListings.find(listingKey);
 	}
 
-	closedir(dir);
+	const std::vector<shmea::GString>& names = cached->second.second;
+	for (unsigned int i = 0; i < names.size(); ++i)
+		ddDatasets->addOption(names[i]);
+
 	ddDatasets->setOptionsShown(3);
 }
 
@@ -1512,6 +1650,9 @@ void NNCreatorPanel::clickedSave(const shmea::GString& cmpName, int x, int y)
 	populateHLayerForm();
 	NNetwork* network = new NNetwork(formInfo);
 	glades::saveNeuralNetwork(network);
+
+	if (std::find(nnNames.begin(), nnNames.end(), netName) == nnNames.end())
+		nnNames.push_back(netName);
 	loadDDNN();
 }
 
@@ -1606,6 +1747,9 @@ void NNCreatorPanel::clickedRun(const shmea::GString& cmpName, int x, int y)
 	// Get the event listener ready
 	resetSim();
 	keepGraping = true;
+	trainPaused = false;
+	if (pauseButton)
+		pauseButton->setText("   Pause");
 
 	// Run a machine learning service
 	shmea::GList wData;
@@ -1772,7 +1916,7 @@ void NNCreatorPanel::tbHLLoseFocus()
 
 void NNCreatorPanel::clickedLoad(const shmea::GString& cmpName, int x, int y)
 {
-	loadDDNN();
+	loadDDNN(true);
 }
 
 void NNCreatorPanel::checkedCV(const shmea::GString& cmpName, int x, int y)
@@ -1802,6 +1946,9 @@ void NNCreatorPanel::clickedKill(const shmea::GString& cmpName, int x, int y)
 		return;
 
 	keepGraping = false;
+	trainPaused = false;
+	if (pauseButton)
+		pauseButton->setText("   Pause");
 
 	// Kill a neural network instance
 	shmea::GList wData;
@@ -1812,11 +1959,47 @@ void NNCreatorPanel::clickedKill(const shmea::GString& cmpName, int x, int y)
 	serverInstance->send(cSrvc);
 }
 
+/*!
+ * @brief pause or resume the running network
+ * @details the server keeps the network loaded while it is paused, so resuming carries on from
+ * the same epoch
+ * @param cmpName the button
+ * @param x the mouse x
+ * @param y the mouse y
+ */
+void NNCreatorPanel::clickedPause(const shmea::GString& cmpName, int x, int y)
+{
+	if ((!serverInstance) || (netCount == 0))
+		return;
+
+	shmea::GString serverIP = "127.0.0.1";
+	GNet::Connection* cConnection = serverInstance->getConnection(serverIP);
+	if (!cConnection)
+		return;
+
+	trainPaused = !trainPaused;
+	if (pauseButton)
+		pauseButton->setText((trainPaused) ? "  Resume" : "   Pause");
+
+	shmea::GList wData;
+	wData.addString((trainPaused) ? "PAUSE" : "RESUME");
+
+	shmea::ServiceData* cSrvc = new shmea::ServiceData(cConnection, "ML_Train");
+	cSrvc->set("net" + shmea::GString::intTOstring(netCount - 1), wData);
+	serverInstance->send(cSrvc);
+}
+
 void NNCreatorPanel::clickedDelete(const shmea::GString& cmpName, int x, int y)
 {
 	shmea::GString netName = tbNetName->getText();
 	shmea::SaveFolder* nnList = new shmea::SaveFolder("neuralnetworks");
-	nnList->deleteItem(netName);
+	if (nnList->deleteItem(netName))
+	{
+		std::vector<shmea::GString>::iterator itr =
+			std::find(nnNames.begin(), nnNames.end(), netName);
+		if (itr != nnNames.end())
+			nnNames.erase(itr);
+	}
 	loadDDNN();
 
 	// Display a popup alert
@@ -1827,32 +2010,14 @@ void NNCreatorPanel::clickedDelete(const shmea::GString& cmpName, int x, int y)
 
 void NNCreatorPanel::clickedPreviewTrain(const shmea::GString& cmpName, int x, int y)
 {
-	if (!ddDatasets)
-		return;
-
-	shmea::GString testFName = ddDatasets->getSelectedText();
-
-	if (testFName.length() == 0)
-		return;
-
-	ii.import(testFName.c_str());
 	prevImageFlag = 0;
-	previewImage->setBGImage(ii.getTrainImage(trainingRowIndex));
+	requestPreview();
 }
 
 void NNCreatorPanel::clickedPreviewTest(const shmea::GString& cmpName, int x, int y)
 {
-	if (!ddDatasets)
-		return;
-
-	shmea::GString testFName = ddDatasets->getSelectedText();
-
-	if (testFName.length() == 0)
-		return;
-
-	ii.import(testFName.c_str());
 	prevImageFlag = 1;
-	previewImage->setBGImage(ii.getTestImage(testingRowIndex));
+	requestPreview();
 }
 
 void NNCreatorPanel::clickedPrevious(const shmea::GString& cmpName, int x, int y)
@@ -1861,30 +2026,78 @@ void NNCreatorPanel::clickedPrevious(const shmea::GString& cmpName, int x, int y
 	{
 		if (trainingRowIndex > 0)
 			--trainingRowIndex;
-		previewImage->setBGImage(ii.getTrainImage(trainingRowIndex));
 	}
 	else if (prevImageFlag == 1)
 	{
 		if (testingRowIndex > 0)
 			--testingRowIndex;
-		previewImage->setBGImage(ii.getTestImage(testingRowIndex));
 	}
+
+	requestPreview();
 }
 
 void NNCreatorPanel::clickedNext(const shmea::GString& cmpName, int x, int y)
 {
+	if (!previewMore)
+		return;
+
 	if (prevImageFlag == 0)
-	{
-		if (trainingRowIndex < ii.getTrainSize() - 1)
-			++trainingRowIndex;
-		previewImage->setBGImage(ii.getTrainImage(trainingRowIndex));
-	}
+		++trainingRowIndex;
 	else if (prevImageFlag == 1)
+		++testingRowIndex;
+
+	requestPreview();
+}
+
+/*!
+ * @brief ask the preview loader for the selected dataset
+ * @details csv datasets get a page of rows from the current row, image datasets the current
+ * image; the answer is picked up by applyPreview
+ */
+void NNCreatorPanel::requestPreview()
+{
+	if ((!ddDatasets) || (!ddDataType))
+		return;
+
+	shmea::GString datasetName = ddDatasets->getSelectedText();
+	if (datasetName.length() == 0)
+		return;
+
+	bool test = (prevImageFlag == 1);
+	unsigned int row = test ? testingRowIndex : trainingRowIndex;
+	if (ddDataType->getSelectedText() == "CSV")
+		previewLoader.request(PreviewLoader::CSV, datasetName, test, row, PREVIEW_ROWS);
+	else if (ddDataType->getSelectedText() == "Image")
+		previewLoader.request(PreviewLoader::IMAGE, datasetName, test, row);
+}
+
+/*!
+ * @brief show a preview the loader has finished
+ */
+void NNCreatorPanel::applyPreview()
+{
+	PreviewResult preview;
+	if (!previewLoader.poll(preview))
+		return;
+
+	// an answer for the other split, the user has moved on
+	if ((!preview.ok) || (preview.test != (prevImageFlag == 1)))
+		return;
+
+	if (preview.test)
+		testingRowIndex = preview.row;
+	else
+		trainingRowIndex = preview.row;
+	previewMore = preview.more;
+
+	if (preview.type == PreviewLoader::CSV)
 	{
-		if (testingRowIndex < ii.getTestSize() - 1)
-			++testingRowIndex;
-		previewImage->setBGImage(ii.getTestImage(testingRowIndex));
+		previewData = preview.table;
+		previewModel.setTable(&previewData);
+		previewTable->setModel(&previewModel);
 	}
+	else if (preview.type == PreviewLoader::IMAGE)
+		previewImage->setBGImage(preview.image);
 }
 
 void NNCreatorPanel::nnSelectorChanged(int newIndex)
@@ -1924,10 +2137,37 @@ void NNCreatorPanel::PlotLearningCurve(float newXVal, float newYVal)
 		return;
 
 	pthread_mutex_lock(lcMutex);
+	lcCurve.append(newXVal, newYVal);
+	pthread_mutex_unlock(lcMutex);
 
-	SDL_Color lineColor = RUColors::DEFAULT_COLOR_LINE;
-	lcGraph->add("lc", new Point2(newXVal, newYVal), lineColor);
+	lcPending = true;
+	graphsPending = true;
+}
+
+/*!
+ * @brief hand the decimated learning curve to the graph
+ * @details the graph gets at most two points per pixel column, so a redraw costs the same
+ * after a hundred epochs or a hundred thousand
+ */
+void NNCreatorPanel::drawLearningCurve()
+{
+	if (!lcGraph)
+		return;
 
+	std::vector<float> xs;
+	std::vector<float> ys;
+	pthread_mutex_lock(lcMutex);
+	lcCurve.points(xs, ys);
+
+	// the graph takes ownership of the points it is set with
+	std::vector<Point2*> lcPoints;
+	lcPoints.reserve(xs.size());
+	for (unsigned int i = 0; i < xs.size(); ++i)
+		lcPoints.push_back(new Point2(xs[i], ys[i]));
+
+	lcGraph->clear();
+	if (!lcPoints.empty())
+		lcGraph->set("lc", lcPoints, RUColors::DEFAULT_COLOR_LINE);
 	pthread_mutex_unlock(lcMutex);
 }
 
@@ -1950,8 +2190,120 @@ void NNCreatorPanel::PlotROCCurve(float newXVal, float newYVal)
 
 void NNCreatorPanel::updateConfMatrixTable(const shmea::GTable& newMatrix)
 {
-	cMatrixTable->import(newMatrix);
-	cMatrixTable->updateLabels();
+	// only the cells on screen go into the widget, see VirtualTable
+	confTable = newMatrix;
+	confModel.setTable(&confTable);
+	cMatrixTable->setModel(&confModel);
+}
+
+/*!
+ * @brief drop the coalesced updates that have not been drawn yet
+ */
+void NNCreatorPanel::clearPending()
+{
+	graphsPending = false;
+	lcPending = false;
+	accPending = false;
+	pendingEpochs = 0;
+	pendingAccuracy = 0.0f;
+	confPending = false;
+	pendingConfTable = shmea::GTable();
+	rocPending = false;
+	pendingROC = shmea::GList();
+	activationsPending = false;
+	pendingActivations = shmea::GList();
+	weightsPending = false;
+	pendingWeights = shmea::GList();
+}
+
+/*!
+ * @brief draw the newest coalesced updates
+ * @details only the latest ACC, CONF, ROC, ACTIVATIONS and WEIGHTS states are drawn, once per
+ * display frame, however fast the trainer sends them; the graphs are recomputed at most every
+ * GRAPH_UPDATE_MS so a long curve cannot take every frame
+ * @param force whether to draw now regardless of the intervals
+ */
+void NNCreatorPanel::applyPending(bool force)
+{
+	if ((!graphsPending) && (!accPending) && (!confPending) && (!rocPending) &&
+		(!activationsPending) && (!weightsPending))
+		return;
+
+	int64_t now = monotonicMs();
+	if ((!force) && (now - lastApplyMs < frameMs))
+		return;
+	lastApplyMs = now;
+
+	if (accPending)
+	{
+		char accBuf[64];
+		sprintf(accBuf, "%.2f", pendingAccuracy);
+		lblEpochs->setText(shmea::GString::intTOstring(pendingEpochs) + "(t)");
+		lblAccuracy->setText(shmea::GString(accBuf) + "% Accuracy");
+	}
+
+	if (confPending)
+		updateConfMatrixTable(pendingConfTable);
+
+	if (rocPending)
+	{
+		// AUC, then false alarm/recall pairs
+		char aucBuf[64];
+		sprintf(aucBuf, "%.3f", pendingROC.getFloat(0));
+		lblGraphROC->setText("ROC Curve (AUC " + shmea::GString(aucBuf) + ")");
+
+		pthread_mutex_lock(rocMutex);
+		rocCurveGraph->clear();
+		pthread_mutex_unlock(rocMutex);
+
+		for (unsigned int i = 1; i + 1 < pendingROC.size(); i += 2)
+			PlotROCCurve(pendingROC.getFloat(i), pendingROC.getFloat(i + 1));
+		graphsPending = true;
+	}
+
+	// the graph copies the visualizer on every set, so do that once per frame
+	if (((activationsPending) || (weightsPending)) && (nn))
+	{
+		if (activationsPending)
+			nn->setActivation(pendingActivations);
+		if (weightsPending)
+			nn->setWeights(pendingWeights);
+		neuralNetGraph->set("nn", nn);
+	}
+
+	bool graphsDue = (force) || (now - lastGraphMs >= GRAPH_UPDATE_MS);
+	if ((graphsPending) && (graphsDue))
+	{
+		if (lcPending)
+			drawLearningCurve();
+		lcGraph->update();
+		rocCurveGraph->update();
+		lastGraphMs = now;
+	}
+
+	bool graphsLeft = (graphsPending) && (!graphsDue);
+	bool lcLeft = (lcPending) && (!graphsDue);
+	clearPending();
+	graphsPending = graphsLeft;
+	lcPending = lcLeft;
+}
+
+void NNCreatorPanel::updateBackground(gfxpp* cGfx)
+{
+	// read the saved networks and datasets once the window is already up
+	if (!listingsLoaded)
+	{
+		listingsLoaded = true;
+		frameMs = displayFrameMs();
+		loadDDNN();
+		loadDatasets();
+	}
+
+	applyPreview();
+
+	// push out the last coalesced state once the trainer goes quiet
+	applyPending(false);
+	GPanel::updateBackground(cGfx);
 }
 
 void NNCreatorPanel::updateFromQ(const shmea::ServiceData* data)
@@ -1973,8 +2325,7 @@ void NNCreatorPanel::updateFromQ(const shmea::ServiceData* data)
 			return;
 
 		// Special case to update the candle graph
-		lcGraph->update();
-		rocCurveGraph->update();
+		graphsPending = true;
 	}
 	else if (cName == "ACC")
 	{
@@ -1989,12 +2340,9 @@ void NNCreatorPanel::updateFromQ(const shmea::ServiceData* data)
 		if (cList.size() < 2)
 			return;
 
-		int epochs = cList.getInt(0);
-		float accuracy = cList.getFloat(1);
-		char accBuf[64];
-		sprintf(accBuf, "%.2f", accuracy);
-		lblEpochs->setText(shmea::GString::intTOstring(epochs) + "(t)");
-		lblAccuracy->setText(shmea::GString(accBuf) + "% Accuracy");
+		accPending = true;
+		pendingEpochs = cList.getInt(0);
+		pendingAccuracy = cList.getFloat(1);
 	}
 	else if (cName == "CONF")
 	{
@@ -2012,8 +2360,26 @@ void NNCreatorPanel::updateFromQ(const shmea::ServiceData* data)
 		float falseAlarm = argList.getFloat(0);
 		float recall = argList.getFloat(1);
 
+		// every operating point stays on the curve, only the table is coalesced
 		PlotROCCurve(falseAlarm, recall);
-		updateConfMatrixTable(data->getTable());
+		confPending = true;
+		pendingConfTable = data->getTable();
+	}
+	else if (cName == "ROC")
+	{
+		if (!keepGraping)
+			return;
+
+		if (data->getType() != shmea::ServiceData::TYPE_LIST)
+			return;
+
+		// A whole downsampled curve, only the newest one is drawn
+		shmea::GList cList = data->getList();
+		if (cList.size() < 3)
+			return;
+
+		rocPending = true;
+		pendingROC = cList;
 	}
 	else if (cName == "PROGRESSIVE")
 	{
@@ -2035,37 +2401,126 @@ void NNCreatorPanel::updateFromQ(const shmea::ServiceData* data)
 		// Graphs
 		PlotLearningCurve(newXVal, lcPoint);
 	}
+	else if (cName == "MEMORY")
+	{
+		if (data->getType() != shmea::ServiceData::TYPE_LIST)
+			return;
+
+		// network bytes, dataset bytes
+		shmea::GList memory = data->getList();
+		if (memory.size() < 2)
+			return;
+
+		std::string memText = "Net " + MemoryUsage::format(memory.getLong(0)) + ", Data " +
+							  MemoryUsage::format(memory.getLong(1));
+		lblMemory->setText(memText.c_str());
+	}
+	else if (cName == "PROFILE")
+	{
+		if (data->getType() != shmea::ServiceData::TYPE_LIST)
+			return;
+
+		// name, count, milliseconds per profiled scope; the costliest scopes fit the label
+		shmea::GList profile = data->getList();
+		std::vector<std::pair<float, unsigned int> > scopes;
+		for (unsigned int i = 0; i + 2 < profile.size(); i += 3)
+			scopes.push_back(std::make_pair(profile.getFloat(i + 2), i));
+		std::sort(scopes.rbegin(), scopes.rend());
+
+		std::string profileText = "Profile";
+		for (unsigned int rank = 0; (rank < scopes.size()) && (rank < PROFILE_SCOPES_SHOWN);
+			 ++rank)
+		{
+			unsigned int i = scopes[rank].second;
+			char scopeBuf[128];
+			snprintf(scopeBuf, sizeof(scopeBuf), "%s %s %.1fms/%lld", (rank == 0) ? ":" : " |",
+					 profile.getString(i).c_str(), profile.getFloat(i + 2),
+					 (long long)profile.getLong(i + 1));
+			profileText += scopeBuf;
+		}
+		lblProfile->setText(profileText.c_str());
+	}
 	else if (cName == "ACTIVATIONS")
 	{
 
 		shmea::GList activations = data->getList();
+		if (activations.size() == 0)
+			return;
+
 		if (activations[0].getType() == shmea::GType::INT_TYPE)
 		{
+			// a new structure, anything pending was for the old one
+			activationsPending = false;
+			weightsPending = false;
+
+			std::vector<int> newLayers;
 			for (unsigned int i = 0; i < activations.size(); i++)
 			{
-				// Initialize the neural network visualizer
 				if (activations[i].getType() == shmea::GType::INT_TYPE)
+					newLayers.push_back(activations.getInt(i));
+			}
+
+			// the same layer sizes reuse the visualizer and only get new colors
+			if ((!nn) || (newLayers != nnLayers))
+			{
+				if (nn)
+					delete nn;
+				nnLayers = newLayers;
+
+				// wide layers are drawn with a fixed subset of their neurons
+				nnSampler.setLayers(std::vector<unsigned int>(nnLayers.begin(), nnLayers.end()));
+				nnStats.setLayers(std::vector<unsigned int>(nnLayers.begin(), nnLayers.end()));
+				std::vector<unsigned int> drawnLayers = nnSampler.getSampledSizes();
+
+				// Initialize the neural network visualizer
+				nn = new DrawNeuralNet(drawnLayers.size());
+				for (unsigned int i = 0; i < drawnLayers.size(); i++)
 				{
 					if (i == 0)
-					{
-						nn = new DrawNeuralNet(activations.size());
-						nn->setInputLayer(activations.getInt(i));
-					}
-					else if (i == activations.size() - 1)
-					{
-						nn->setOutputLayer(activations.getInt(i));
-					}
+						nn->setInputLayer(drawnLayers[i]);
+					else if (i == drawnLayers.size() - 1)
+						nn->setOutputLayer(drawnLayers[i]);
 					else
-					{
-						nn->setHiddenLayer(i, activations.getInt(i));
-					}
+						nn->setHiddenLayer(i, drawnLayers[i]);
 				}
 			}
 		}
 		else
 		{
-			nn->setActivation(activations);
-			neuralNetGraph->set("nn", nn);
+			std::vector<float> values(activations.size());
+			for (unsigned int i = 0; i < activations.size(); i++)
+				values[i] = activations.getFloat(i);
+
+			// running statistics over every neuron, drawn or not
+			if ((nnStats.update(values)) && (nnStats.getUpdates() % STATS_REPORT_UPDATES == 0))
+			{
+				// mean/variance/dead per layer
+				std::string statsText = "Activations";
+				for (unsigned int l = 0; l < nnStats.numLayers(); ++l)
+				{
+					char layerBuf[64];
+					snprintf(layerBuf, sizeof(layerBuf), "%s %.2f/%.2f/%.0f%%",
+							 (l == 0) ? ":" : " |", nnStats.getMean(l), nnStats.getVariance(l),
+							 nnStats.getDeadFraction(l) * 100.0f);
+					statsText += layerBuf;
+				}
+				lblActivations->setText(statsText.c_str());
+			}
+
+			std::vector<float> sampled;
+			if (!nnSampler.isSampling())
+			{
+				activationsPending = true;
+				pendingActivations = activations;
+			}
+			// a list that does not match the structure cannot be sampled, so it is not drawn
+			else if (nnSampler.sample(values, sampled))
+			{
+				pendingActivations = shmea::GList();
+				for (unsigned int i = 0; i < sampled.size(); i++)
+					pendingActivations.addFloat(sampled[i]);
+				activationsPending = true;
+			}
 		}
 
 		// nn->displayNeuralNet(); // DEBUGGING ONLY
@@ -2079,15 +2534,22 @@ void NNCreatorPanel::updateFromQ(const shmea::ServiceData* data)
 		if (weights.size() < 1 && nn == NULL)
 			return;
 
-		nn->setWeights(weights);
+		// the weight layout belongs to glades, so sampled networks only show activations
+		if (nnSampler.isSampling())
+			return;
+
+		weightsPending = true;
+		pendingWeights = weights;
 		// nn->displayNeuralNet(); // DEBUGGING ONLY
-		neuralNetGraph->set("nn", nn);
 	}
+
+	applyPending(false);
 }
 
 void NNCreatorPanel::resetSim()
 {
 	pthread_mutex_lock(lcMutex);
+	lcCurve.clear();
 	lcGraph->clear();
 	lcGraph->update();
 	pthread_mutex_unlock(lcMutex);
@@ -2103,6 +2565,13 @@ void NNCreatorPanel::resetSim()
 	std::swap(updateQueue, emptyQ);
 	pthread_mutex_unlock(qMutex);
 
+	nnStats.reset();
+	clearPending();
+
 	lblEpochs->setText("0(t)");
 	lblAccuracy->setText("N/A Accuracy");
+	lblMemory->setText("");
+	lblActivations->setText("");
+	lblProfile->setText("");
+	lblGraphROC->setText("ROC Curve (False Pos, True pos)");
 }
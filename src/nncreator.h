@@ -27,11 +27,19 @@
 #ifndef _RUNNCREATORPANEL
 #define _RUNNCREATORPANEL
 
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GTable.h"
 #include "Backend/Machine Learning/DataObjects/ImageInput.h"
 #include "Backend/Machine Learning/main.h"
 #include "Frontend/GItems/GPanel.h"
+#include "core/activationsampler.h"
+#include "core/activationstats.h"
+#include "core/curvedecimator.h"
+#include "data/previewloader.h"
+#include "data/tablemodel.h"
 #include <map>
 #include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -49,16 +57,12 @@ class RUButton;
 class RUDropdown;
 class RUGraph;
 class RUTable;
+class VirtualTable;
 class RUProgressBar;
 class RUTabContainer;
 class PlotType;
 class DrawNeuralNet;
 
-namespace shmea {
-class GTable;
-class GList;
-}; // namespace shmea
-
 namespace GNet {
 class GServer;
 };
@@ -71,28 +75,72 @@ class NNCreatorPanel : public GPanel
 {
 protected:
 	virtual void updateFromQ(const shmea::ServiceData*);
+	virtual void updateBackground(gfxpp*);
 	virtual void onStart();
 
 	GNet::GServer* serverInstance;
 	glades::NNInfo* formInfo;
-	glades::ImageInput ii;
 	int currentHiddenLayerIndex;
 	unsigned int netCount;
 	bool keepGraping;
+	bool trainPaused;
 	unsigned int trainingRowIndex;
 	unsigned int testingRowIndex;
 	int prevImageFlag;
+	bool previewMore;
+
+	// dataset previews are read off the GUI thread, see applyPreview
+	PreviewLoader previewLoader;
+	shmea::GTable previewData;
+	GTableModel previewModel;
+
+	// cached listings, so GUI refreshes do not rescan the disk
+	std::vector<shmea::GString> nnNames;
+	bool nnNamesLoaded;
+	bool listingsLoaded;
+	std::map<std::string, std::pair<time_t, std::vector<shmea::GString> > > datasetListings;
+
+	// newest training state not drawn yet, see applyPending
+	int64_t frameMs;
+	int64_t lastApplyMs;
+	int64_t lastGraphMs;
+	bool graphsPending;
+	bool lcPending;
+	bool accPending;
+	int pendingEpochs;
+	float pendingAccuracy;
+	bool confPending;
+	shmea::GTable pendingConfTable;
+	bool rocPending;
+	shmea::GList pendingROC;
+	bool activationsPending;
+	shmea::GList pendingActivations;
+	bool weightsPending;
+	shmea::GList pendingWeights;
+
+	void clearPending();
+	void applyPending(bool);
+	void requestPreview();
+	void applyPreview();
 
 	int64_t parsePct(const shmea::GType&);
 
 	void buildPanel();
 
+	// kept across runs with the same layer sizes, only the activations and weights change
 	DrawNeuralNet* nn;
+	std::vector<int> nnLayers;
+	ActivationSampler nnSampler;
+	ActivationStats nnStats;
 
 	RUGraph* lcGraph;
+	CurveDecimator lcCurve;
 	RUImageComponent* outputImage;
 	RUGraph* rocCurveGraph;
-	RUTable* cMatrixTable;
+	RULabel* lblGraphROC;
+	VirtualTable* cMatrixTable;
+	shmea::GTable confTable;
+	GTableModel confModel;
 
 	RUGraph* neuralNetGraph;
 
@@ -100,6 +148,9 @@ protected:
 
 	RULabel* lblEpochs;
 	RULabel* lblAccuracy;
+	RULabel* lblMemory;
+	RULabel* lblActivations;
+	RULabel* lblProfile;
 
 	RULabel* lblNeuralNet;
 	RUDropdown* ddNeuralNet;
@@ -174,7 +225,7 @@ protected:
 	RUTextbox* tbinputAP;
 
 	RUTabContainer* previewTabs;
-	RUTable* previewTable;
+	VirtualTable* previewTable;
 	GLinearLayout* previewImageLayout;
 	RUImageComponent* previewImage;
 
@@ -189,6 +240,7 @@ protected:
 	RUTextbox* tbCopyDestination;
 
 	RUButton* sendButton;
+	RUButton* pauseButton;
 
 	RUDropdown* ddDatasets;
 	RUDropdown* ddDataType;
@@ -207,13 +259,14 @@ public:
 	NNCreatorPanel(GNet::GServer*, const shmea::GString&, int, int);
 	virtual ~NNCreatorPanel();
 
-	void loadDDNN();
+	void loadDDNN(bool = false);
 	void populateIndexToEdit(int = 0);
 	void populateInputLayerForm();
 	void populateHLayerForm();
 	void syncFormVar();
 	void loadNNet(glades::NNInfo*);
 	void PlotLearningCurve(float, float);
+	void drawLearningCurve();
 	void PlotROCCurve(float, float);
 	void updateConfMatrixTable(const shmea::GTable&);
 
@@ -229,6 +282,7 @@ public:
 	void clickedLoad(const shmea::GString&, int, int);
 	void checkedCV(const shmea::GString&, int, int);
 	void clickedKill(const shmea::GString&, int, int);
+	void clickedPause(const shmea::GString&, int, int);
 	void clickedContinue(const shmea::GString&, int, int);
 	void clickedDelete(const shmea::GString&, int, int);
 	void clickedPreviewTrain(const shmea::GString&, int, int);
@@ -0,0 +1,244 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "replyrouter.h"
+#include "Backend/Database/ServiceData.h"
+#include "Backend/Networking/main.h"
+#include <errno.h>
+#include <sys/time.h>
+#include <time.h>
+
+const char ReplyRouter::SERVICE_NAME[] = "Reply_Router";
+
+pthread_mutex_t ReplyRouter::routerMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t ReplyRouter::deliveredCond = PTHREAD_COND_INITIALIZER;
+std::map<int64_t, ReplyFuture*> ReplyRouter::pending;
+
+ReplyFuture::ReplyFuture()
+{
+	pthread_mutex_init(&futureMutex, NULL);
+	pthread_cond_init(&doneCond, NULL);
+	id = 0;
+	done = false;
+	callback = NULL;
+	callbackArg = NULL;
+	delivering = false;
+}
+
+ReplyFuture::~ReplyFuture()
+{
+	ReplyRouter::cancel(this);
+	pthread_cond_destroy(&doneCond);
+	pthread_mutex_destroy(&futureMutex);
+}
+
+/*!
+ * @brief run a function when the reply arrives instead of waiting
+ * @details set before the request is sent; the callback runs on the networking thread and
+ * should hand heavy work elsewhere
+ * @param newCallback the function
+ * @param newCallbackArg its argument
+ */
+void ReplyFuture::setCallback(ReplyCallback newCallback, void* newCallbackArg)
+{
+	pthread_mutex_lock(&futureMutex);
+	callback = newCallback;
+	callbackArg = newCallbackArg;
+	pthread_mutex_unlock(&futureMutex);
+}
+
+void ReplyFuture::complete(const shmea::ServiceData* reply)
+{
+	pthread_mutex_lock(&futureMutex);
+	command = reply->getCommand();
+	list = reply->getList();
+	table = reply->getTable();
+	done = true;
+	ReplyCallback cb = callback;
+	void* cbArg = callbackArg;
+	pthread_cond_broadcast(&doneCond);
+	pthread_mutex_unlock(&futureMutex);
+
+	if (cb)
+		cb(this, cbArg);
+}
+
+/*!
+ * @brief block until the reply arrives
+ * @param timeoutMs the longest wait, or negative to wait forever
+ * @return whether the reply arrived
+ */
+bool ReplyFuture::wait(int64_t timeoutMs)
+{
+	pthread_mutex_lock(&futureMutex);
+	if (timeoutMs < 0)
+	{
+		while (!done)
+			pthread_cond_wait(&doneCond, &futureMutex);
+	}
+	else
+	{
+		struct timeval now;
+		gettimeofday(&now, NULL);
+		int64_t deadlineUs = (int64_t)now.tv_usec + timeoutMs * 1000;
+		struct timespec deadline;
+		deadline.tv_sec = now.tv_sec + deadlineUs / 1000000;
+		deadline.tv_nsec = (deadlineUs % 1000000) * 1000;
+		while (!done)
+		{
+			if (pthread_cond_timedwait(&doneCond, &futureMutex, &deadline) == ETIMEDOUT)
+				break;
+		}
+	}
+
+	bool arrived = done;
+	pthread_mutex_unlock(&futureMutex);
+	return arrived;
+}
+
+bool ReplyFuture::isDone() const
+{
+	pthread_mutex_lock(const_cast<pthread_mutex_t*>(&futureMutex));
+	bool arrived = done;
+	pthread_mutex_unlock(const_cast<pthread_mutex_t*>(&futureMutex));
+	return arrived;
+}
+
+int64_t ReplyFuture::getID() const
+{
+	return id;
+}
+
+shmea::GString ReplyFuture::getCommand() const
+{
+	return command;
+}
+
+const shmea::GList& ReplyFuture::getList() const
+{
+	return list;
+}
+
+const shmea::GTable& ReplyFuture::getTable() const
+{
+	return table;
+}
+
+/*!
+ * @brief send a request whose reply completes a future
+ * @details the request's serviceNum is assigned here and is the only id it carries; the
+ * request should already name SERVICE_NAME as its reply service
+ * @param serverInstance the local server
+ * @param request the request, sent and owned by the server from here on
+ * @param future the future to complete, reset here
+ * @return whether the request was sent
+ */
+bool ReplyRouter::send(GNet::GServer* serverInstance, shmea::ServiceData* request,
+					   ReplyFuture* future)
+{
+	if ((!serverInstance) || (!request) || (!future))
+		return false;
+
+	request->assignServiceNum();
+
+	pthread_mutex_lock(&future->futureMutex);
+	future->id = request->getServiceNum();
+	future->done = false;
+	pthread_mutex_unlock(&future->futureMutex);
+
+	pthread_mutex_lock(&routerMutex);
+	pending[future->id] = future;
+	pthread_mutex_unlock(&routerMutex);
+
+	serverInstance->send(request);
+	return true;
+}
+
+/*!
+ * @brief complete the future waiting on a reply
+ * @details matched on the reply's responseServiceNum, or its first arg when that was lost. The
+ * future is marked as being delivered before the lock is dropped, so a waiter that gives up
+ * and deletes it blocks in cancel() until the reply has been written.
+ * @param reply the reply
+ * @return whether a future was waiting for it
+ */
+bool ReplyRouter::deliver(const shmea::ServiceData* reply)
+{
+	if (!reply)
+		return false;
+
+	int64_t replyID = reply->getResponseServiceNum();
+	ReplyFuture* future = NULL;
+
+	pthread_mutex_lock(&routerMutex);
+	std::map<int64_t, ReplyFuture*>::iterator itr = pending.find(replyID);
+	if ((itr == pending.end()) && (reply->getArgList().size() > 0))
+		itr = pending.find(reply->getArgList().getLong(0));
+	if (itr != pending.end())
+	{
+		future = itr->second;
+		future->delivering = true;
+		pending.erase(itr);
+	}
+	pthread_mutex_unlock(&routerMutex);
+
+	if (!future)
+		return false;
+
+	future->complete(reply);
+
+	pthread_mutex_lock(&routerMutex);
+	future->delivering = false;
+	pthread_cond_broadcast(&deliveredCond);
+	pthread_mutex_unlock(&routerMutex);
+	return true;
+}
+
+/*!
+ * @brief stop waiting for a reply
+ * @details a reply that arrives later is dropped; one already being delivered is waited for,
+ * so the future is safe to delete once this returns
+ * @param future the future
+ */
+void ReplyRouter::cancel(ReplyFuture* future)
+{
+	pthread_mutex_lock(&routerMutex);
+	std::map<int64_t, ReplyFuture*>::iterator itr = pending.find(future->getID());
+	if ((itr != pending.end()) && (itr->second == future))
+		pending.erase(itr);
+	while (future->delivering)
+		pthread_cond_wait(&deliveredCond, &routerMutex);
+	pthread_mutex_unlock(&routerMutex);
+}
+
+unsigned int ReplyRouter::inFlight()
+{
+	pthread_mutex_lock(&routerMutex);
+	unsigned int count = pending.size();
+	pthread_mutex_unlock(&routerMutex);
+
+	return count;
+}
@@ -0,0 +1,111 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _REPLYROUTER
+#define _REPLYROUTER
+
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GTable.h"
+#include <map>
+#include <pthread.h>
+#include <stdint.h>
+
+namespace shmea {
+class ServiceData;
+};
+
+namespace GNet {
+class GServer;
+};
+
+class ReplyFuture;
+
+// Called on the networking thread when a reply arrives
+typedef void (*ReplyCallback)(ReplyFuture*, void*);
+
+// The eventual reply to one request sent through ReplyRouter. Either wait()
+// for it or give it a callback; the caller owns it and may delete it at any
+// time, which cancels it. A callback must not delete its own future.
+class ReplyFuture
+{
+private:
+	friend class ReplyRouter;
+
+	pthread_mutex_t futureMutex;
+	pthread_cond_t doneCond;
+	int64_t id;
+	bool done;
+	shmea::GString command;
+	shmea::GList list;
+	shmea::GTable table;
+	ReplyCallback callback;
+	void* callbackArg;
+	bool delivering; // guarded by ReplyRouter's lock
+
+	void complete(const shmea::ServiceData*);
+
+	// waited on by other threads
+	ReplyFuture(const ReplyFuture&);
+	void operator=(const ReplyFuture&);
+
+public:
+	ReplyFuture();
+	~ReplyFuture();
+
+	void setCallback(ReplyCallback, void*);
+	bool wait(int64_t = -1);
+	bool isDone() const;
+
+	int64_t getID() const;
+	shmea::GString getCommand() const;
+	const shmea::GList& getList() const;
+	const shmea::GTable& getTable() const;
+};
+
+// Matches replies to requests for programmatic clients, so many requests can
+// be in flight over one connection at once. send() numbers each request with
+// its serviceNum and leaves its args alone; services that support it
+// (ML_Predict) echo the number as the reply's responseServiceNum and first
+// arg, and address the reply, or an error reply when the request fails, to
+// Reply_Router, which hands it to the waiting future.
+class ReplyRouter
+{
+private:
+	static pthread_mutex_t routerMutex;
+	static pthread_cond_t deliveredCond;
+	static std::map<int64_t, ReplyFuture*> pending;
+
+public:
+	// the reply service to name in requests
+	static const char SERVICE_NAME[];
+
+	static bool send(GNet::GServer*, shmea::ServiceData*, ReplyFuture*);
+	static bool deliver(const shmea::ServiceData*);
+	static void cancel(ReplyFuture*);
+	static unsigned int inFlight();
+};
+
+#endif
@@ -8,12 +8,16 @@
 #ifndef _BAYES_TRAIN
 #define _BAYES_TRAIN
 
+#include "../core/asynclog.h"
+#include "../core/confusion.h"
 #include "../crt0.h"
+#include "../data/csvreader.h"
+#include "../data/flatbayes.h"
+#include "../data/streaminput.h"
 #include "../main.h"
 #include "Backend/Database/GList.h"
 #include "Backend/Database/GTable.h"
 #include "Backend/Database/ServiceData.h"
-#include "Backend/Machine Learning/Networks/bayes.h"
 #include "Backend/Machine Learning/Networks/network.h"
 #include "Backend/Networking/service.h"
 
@@ -51,20 +55,23 @@ public:
 			return NULL;
 
 		shmea::GString netName = cList.getString(0);
+		shmea::GString inputFName = "datasets/" + cList.getString(1);
 
-		shmea::GTable inputTable("datasets/btest.csv", ',', shmea::GTable::TYPE_FILE);
-
-		glades::NaiveBayes bModel;
-		shmea::GTable bTable = bModel.import(inputTable);
-		bTable.print();
-		bModel.train(bTable);
-
-		// predict with model
-		shmea::GList testList;
-		testList.addString("silly");
-		testList.addString("brown");
-		int cls = bModel.predict(testList);
-		printf("Predicted class %d\n", cls);
+		FlatBayes bModel;
+		if (!bModel.train(inputFName))
+			return NULL;
+		bModel.print();
+
+		// Evaluate on the test sibling when there is one
+		shmea::GString testFName = StreamInput::testSibling(inputFName);
+		if (CSVReader::fileSize(testFName) <= 0)
+			testFName = inputFName;
+
+		ConfusionMatrix results;
+		float accuracy = bModel.test(testFName, results);
+		results.print();
+		AsyncLog::write(AsyncLog::LOG_INFO, "[BAYES] \"%s\" accuracy on \"%s\": %f",
+						netName.c_str(), testFName.c_str(), accuracy);
 
 		return NULL;
 	}
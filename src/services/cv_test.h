@@ -27,53 +27,338 @@
 #ifndef _CV_TEST
 #define _CV_TEST
 
+#include "../core/asynclog.h"
+#include "../core/random.h"
+#include "../core/roc.h"
+#include "../core/scheduler.h"
+#include "../core/threadpool.h"
 #include "../crt0.h"
+#include "../data/datacache.h"
+#include "../data/indexedinput.h"
+#include "../data/streaminput.h"
 #include "../main.h"
 #include "Backend/Database/GList.h"
-#include "Backend/Database/GTable.h"
 #include "Backend/Database/ServiceData.h"
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include "Backend/Machine Learning/Networks/network.h"
 #include "Backend/Machine Learning/State/Terminator.h"
-#include "Backend/Machine Learning/Structure/hiddenlayerinfo.h"
-#include "Backend/Machine Learning/Structure/inputlayerinfo.h"
-#include "Backend/Machine Learning/Structure/nninfo.h"
-#include "Backend/Machine Learning/Structure/outputlayerinfo.h"
-#include "Backend/Machine Learning/main.h"
-#include "Backend/Machine Learning/metanetwork.h"
-#include "Backend/Machine Learning/network.h"
 #include "Backend/Networking/service.h"
-#include "Backend/Networking/socket.h"
-#include "Frontend/GUI/RUMsgBox.h"
-#include "Frontend/Graphics/graphics.h"
+#include <algorithm>
+#include <math.h>
+#include <pthread.h>
+#include <vector>
 
-class CV_Test : public Service
+// One fold of a cross validation run
+class CVFold
 {
 public:
-	GList execute(class Connection* cConnection, const GList& data)
+	glades::NNetwork* net;
+	IndexedInput* input;
+	glades::DataInput* stream; // a private import of an unshareable dataset
+	float accuracy;
+	shmea::GList results; // the network outputs for each held out row
+
+	CVFold()
 	{
-		GList retList;
-		if (data.size() < 3)
-			return retList;
-
-		std::string netName = data.getString(0);
-		std::string testFName = data.getString(1);
-		int importType = data.getInt(2);
-		int64_t maxTimeStamp = data.getLong(3);
-		int64_t maxEpoch = data.getLong(4);
-		float maxAccuracy = data.getFloat(5);
-		// int64_t trainPct = data.getLong(4), testPct = data.getLong(5),
-		// validationPct =
-		// data.getLong(6);
-
-		// Termination Conditions
-		Terminator* Arnold = new Terminator();
-		Arnold->setTimestamp(maxTimeStamp);
-		Arnold->setEpoch(maxEpoch);
-		Arnold->setAccuracy(maxAccuracy);
-
-		MetaNetwork* metanetwork = new MetaNetwork("dummy", netName, 5);
-		metanetwork->crossValidate(testFName, Arnold);
-
-		return retList;
+		net = NULL;
+		input = NULL;
+		stream = NULL;
+		accuracy = 0.0f;
 	}
 };
+
+// k-fold cross validation with every fold trained at once. The dataset is
+// loaded a single time and each fold is an IndexedInput over it, built from
+// the same seeded permutation so the held out folds are disjoint and
+// stratified by class. A streamed dataset reads through a single window and
+// train order, so every fold opens the file on its own. The held out outputs
+// of all folds together give one ROC curve over the whole dataset, which is
+// sent to the panel.
+//
+// args: netName, inputFName, inputType, folds, then optionally the
+// Terminator timestamp, epoch and accuracy limits
+class CV_Test : public GNet::Service
+{
+private:
+	GNet::GServer* serverInstance;
+	std::vector<CVFold*> running;
+	pthread_mutex_t runningMutex;
+	bool stopping;
+
+	// the Scheduler job of the current run, 0 before the first
+	int64_t jobID;
+
+	static void* runFold(void* y)
+	{
+		CVFold* fold = (CVFold*)y;
+		fold->net->train(fold->input);
+		fold->net->test(fold->input);
+		fold->accuracy = fold->net->getAccuracy();
+		fold->results = fold->net->getResults();
+		return NULL;
+	}
+
+	// pool the held out outputs and labels of every fold and send the curve to the panel
+	void sendROC(GNet::Connection* destination, const std::vector<CVFold*>& folds)
+	{
+		std::vector<float> outputs;
+		std::vector<float> expected;
+		unsigned int width = 0;
+		unsigned int samples = 0;
+		for (unsigned int k = 0; k < folds.size(); ++k)
+		{
+			const CVFold* fold = folds[k];
+			unsigned int rows = fold->input->getTestSize();
+			if ((rows == 0) || (fold->results.size() == 0) || (fold->results.size() % rows != 0))
+				continue;
+
+			unsigned int foldWidth = fold->results.size() / rows;
+			if ((width != 0) && (foldWidth != width))
+				continue;
+			width = foldWidth;
+
+			for (unsigned int r = 0; r < rows; ++r)
+			{
+				shmea::GList cExpected = fold->input->getTestExpectedRow(r);
+				if (cExpected.size() != width)
+					return;
+				for (unsigned int c = 0; c < width; ++c)
+				{
+					outputs.push_back(fold->results.getFloat(r * width + c));
+					expected.push_back(cExpected.getFloat(c));
+				}
+			}
+			samples += rows;
+		}
+
+		ROC roc;
+		if ((samples == 0) || (!roc.buildOneVsRest(&outputs[0], &expected[0], samples, width)))
+			return;
+		AsyncLog::write(AsyncLog::LOG_INFO, "[CV] AUC %f over %u held out rows", roc.getAUC(),
+						samples);
+
+		if ((!serverInstance) || (!destination))
+			return;
+
+		// AUC, then false alarm/recall pairs
+		std::vector<float> xs;
+		std::vector<float> ys;
+		roc.downsample(ROC_POINTS, xs, ys);
+		shmea::GList curve;
+		curve.addFloat(roc.getAUC());
+		for (unsigned int i = 0; i < xs.size(); ++i)
+		{
+			curve.addFloat(xs[i]);
+			curve.addFloat(ys[i]);
+		}
+
+		shmea::ServiceData* cSrvc = new shmea::ServiceData(destination, "GUI_Callback");
+		cSrvc->set("ROC", curve);
+		serverInstance->send(cSrvc);
+	}
+
+	// stop every fold; also the Scheduler cancel hook
+	static void stopFolds(void* y)
+	{
+		CV_Test* self = (CV_Test*)y;
+		pthread_mutex_lock(&self->runningMutex);
+		self->stopping = true;
+		for (unsigned int i = 0; i < self->running.size(); ++i)
+			self->running[i]->net->stop();
+		pthread_mutex_unlock(&self->runningMutex);
+	}
+
+	void clearFolds(std::vector<CVFold*>& folds)
+	{
+		pthread_mutex_lock(&runningMutex);
+		running.clear();
+		pthread_mutex_unlock(&runningMutex);
+
+		for (unsigned int i = 0; i < folds.size(); ++i)
+		{
+			delete folds[i]->net;
+			delete folds[i]->input;
+			DataCache::release(folds[i]->stream);
+			delete folds[i];
+		}
+		folds.clear();
+	}
+
+public:
+	static const int DEFAULT_FOLDS = 5;
+	// points of the ROC curve sent to the panel
+	static const unsigned int ROC_POINTS = 100;
+
+	CV_Test()
+	{
+		serverInstance = NULL;
+		stopping = false;
+		jobID = 0;
+		pthread_mutex_init(&runningMutex, NULL);
+	}
+
+	CV_Test(GNet::GServer* newInstance)
+	{
+		serverInstance = newInstance;
+		stopping = false;
+		jobID = 0;
+		pthread_mutex_init(&runningMutex, NULL);
+	}
+
+	~CV_Test()
+	{
+		serverInstance = NULL; // Not ours to delete
+		pthread_mutex_destroy(&runningMutex);
+	}
+
+	shmea::ServiceData* execute(const shmea::ServiceData* data)
+	{
+		if (data->getType() != shmea::ServiceData::TYPE_LIST)
+			return NULL;
+
+		shmea::GList cList = data->getList();
+
+		if ((cList.size() == 1) && (cList.getString(0) == "KILL"))
+		{
+			// drops a run still queued for its cores too
+			stopFolds(this);
+			if (jobID > 0)
+				Scheduler::cancel(jobID);
+			AsyncLog::write(AsyncLog::LOG_WARNING, "!!---KILLING CV---!!");
+			return NULL;
+		}
+
+		if (cList.size() < 3)
+			return NULL;
+
+		shmea::GString netName = cList.getString(0);
+		shmea::GString datasetName = cList.getString(1);
+		shmea::GString inputFName = datasetName;
+		int inputType = cList.getInt(2);
+		int foldCount = (cList.size() >= 4) ? cList.getInt(3) : DEFAULT_FOLDS;
+		if (foldCount < 2)
+			foldCount = DEFAULT_FOLDS;
+
+		// glades shares rand() between networks, so a fixed order needs one fold at a time
+		unsigned int workers = std::min(ThreadPool::cores(), (unsigned int)foldCount);
+		if (Random::isDeterministic())
+			workers = 1;
+
+		// Wait for the cores before touching the data
+		pthread_mutex_lock(&runningMutex);
+		stopping = false;
+		pthread_mutex_unlock(&runningMutex);
+		jobID = Scheduler::submit(std::string("CV ") + netName.c_str(), 0, workers, stopFolds,
+								  this);
+		if (!Scheduler::waitTurn(jobID))
+			return NULL;
+
+		glades::DataInput* di = DataCache::acquire(inputFName, inputType);
+		if (!di)
+		{
+			Scheduler::finish(jobID);
+			return NULL;
+		}
+
+		// Every fold carves the same permutation
+		uint64_t foldSeed = Random::streamSeed("cv_test.folds");
+		bool streamed = (dynamic_cast<StreamInput*>(di) != NULL);
+		bool privateRows = (!DataCache::shareable(di));
+
+		std::vector<CVFold*> folds;
+		for (int k = 0; k < foldCount; ++k)
+		{
+			CVFold* fold = new CVFold();
+			fold->net = new glades::NNetwork();
+			folds.push_back(fold);
+
+			// DataCache hands out unshareable inputs once, so each acquire is a fresh one
+			glades::DataInput* foldSource = di;
+			if ((privateRows) && (k > 0))
+			{
+				shmea::GString foldFName = datasetName;
+				fold->stream = foldSource = DataCache::acquire(foldFName, inputType);
+			}
+			fold->input = new IndexedInput(foldSource);
+
+			Random foldRandom;
+			foldRandom.seed(foldSeed);
+			if ((!foldSource) || (!fold->net->load(netName)) ||
+				(!fold->input->fold(k, foldCount, &foldRandom, true)))
+			{
+				AsyncLog::write(AsyncLog::LOG_ERROR, "[CV] Unable to set up fold %d of \"%s\"", k,
+								netName.c_str());
+				clearFolds(folds);
+				DataCache::release(di);
+				Scheduler::finish(jobID);
+				return NULL;
+			}
+			fold->input->setShuffle(true, (streamed) ? StreamInput::WINDOW_ROWS : 0);
+
+			// Termination Conditions (optional trailing args)
+			if (cList.size() >= 7)
+			{
+				fold->net->terminator.setTimestamp(cList.getLong(4));
+				fold->net->terminator.setEpoch(cList.getLong(5));
+				fold->net->terminator.setAccuracy(cList.getFloat(6));
+			}
+		}
+
+		pthread_mutex_lock(&runningMutex);
+		running = folds;
+		bool killed = stopping;
+		pthread_mutex_unlock(&runningMutex);
+		if (killed)
+		{
+			clearFolds(folds);
+			DataCache::release(di);
+			Scheduler::finish(jobID);
+			return NULL;
+		}
+
+		ThreadPool pool(workers);
+		for (unsigned int k = 0; k < folds.size(); ++k)
+			pool.submit(runFold, folds[k]);
+		pool.wait();
+
+		// Weight each fold by its share of the held out rows
+		double total = 0.0;
+		double weighted = 0.0;
+		double squared = 0.0;
+		for (unsigned int k = 0; k < folds.size(); ++k)
+		{
+			double rows = folds[k]->input->getTestSize();
+			AsyncLog::write(AsyncLog::LOG_INFO, "[CV] Fold %u: %f (%u test rows)", k,
+							folds[k]->accuracy, folds[k]->input->getTestSize());
+			total += rows;
+			weighted += rows * folds[k]->accuracy;
+			squared += rows * folds[k]->accuracy * folds[k]->accuracy;
+		}
+
+		if (total > 0.0)
+		{
+			double mean = weighted / total;
+			double variance = squared / total - mean * mean;
+			AsyncLog::write(AsyncLog::LOG_INFO, "[CV] %d folds: %f +/- %f", foldCount, mean,
+							sqrt((variance > 0.0) ? variance : 0.0));
+		}
+		sendROC(data->getConnection(), folds);
+
+		clearFolds(folds);
+		DataCache::release(di);
+		Scheduler::finish(jobID);
+		return NULL;
+	}
+
+	GNet::Service* MakeService(GNet::GServer* newInstance) const
+	{
+		return new CV_Test(newInstance);
+	}
+
+	shmea::GString getName() const
+	{
+		return "CV_Test";
+	}
+};
+
 #endif
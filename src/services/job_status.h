@@ -0,0 +1,115 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+#ifndef _JOB_STATUS
+#define _JOB_STATUS
+
+#include "../core/scheduler.h"
+#include "../crt0.h"
+#include "../main.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GTable.h"
+#include "Backend/Database/ServiceData.h"
+#include "Backend/Networking/service.h"
+#include <vector>
+
+// Status and cancellation for scheduled jobs.
+// args: "LIST", or "CANCEL" and a job id, then optionally the service to reply
+// to (GUI_Callback by default). Either way the reply is "JOBS" with one row
+// per job: id, name, state, priority, threads, seconds queued, seconds run.
+class JOB_Status : public GNet::Service
+{
+private:
+	GNet::GServer* serverInstance;
+
+public:
+	JOB_Status()
+	{
+		serverInstance = NULL;
+	}
+
+	JOB_Status(GNet::GServer* newInstance)
+	{
+		serverInstance = newInstance;
+	}
+
+	~JOB_Status()
+	{
+		serverInstance = NULL; // Not ours to delete
+	}
+
+	shmea::ServiceData* execute(const shmea::ServiceData* data)
+	{
+		class GNet::Connection* destination = data->getConnection();
+
+		if (data->getType() != shmea::ServiceData::TYPE_LIST)
+			return NULL;
+
+		shmea::GList cList = data->getList();
+		if (cList.size() < 1)
+			return NULL;
+
+		shmea::GString command = cList.getString(0);
+		unsigned int replyArg = 1;
+		if (command == "CANCEL")
+		{
+			if (cList.size() < 2)
+				return NULL;
+
+			Scheduler::cancel(cList.getLong(1));
+			replyArg = 2;
+		}
+		else if (command != "LIST")
+			return NULL;
+
+		shmea::GString replyName = "GUI_Callback";
+		if (cList.size() > replyArg)
+			replyName = cList.getString(replyArg);
+
+		time_t now = time(NULL);
+		std::vector<JobInfo> jobs = Scheduler::list();
+		shmea::GTable jobTable(',');
+		for (unsigned int i = 0; i < jobs.size(); ++i)
+		{
+			const JobInfo& cJob = jobs[i];
+			time_t started = (cJob.started > 0) ? cJob.started : now;
+			time_t finished = (cJob.finished > 0) ? cJob.finished : now;
+			int64_t queuedSec = started - cJob.submitted;
+			int64_t runSec = (cJob.started > 0) ? finished - cJob.started : 0;
+
+			shmea::GList cRow;
+			cRow.addLong(cJob.id);
+			cRow.addString(cJob.name.c_str());
+			cRow.addString(Scheduler::stateName(cJob.state));
+			cRow.addInt(cJob.priority);
+			cRow.addInt(cJob.threads);
+			cRow.addLong(queuedSec);
+			cRow.addLong(runSec);
+			jobTable.addRow(cRow);
+
+			printf("[JOB] %lld \"%s\" %s (priority %d, %u threads, %llds queued, %llds run)\n",
+				   (long long)cJob.id, cJob.name.c_str(), Scheduler::stateName(cJob.state),
+				   cJob.priority, cJob.threads, (long long)queuedSec, (long long)runSec);
+		}
+
+		shmea::ServiceData* cSrvc = new shmea::ServiceData(destination, replyName);
+		cSrvc->set("JOBS", jobTable);
+		return cSrvc;
+	}
+
+	GNet::Service* MakeService(GNet::GServer* newInstance) const
+	{
+		return new JOB_Status(newInstance);
+	}
+
+	shmea::GString getName() const
+	{
+		return "JOB_Status";
+	}
+};
+
+#endif
@@ -0,0 +1,153 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+#ifndef _METRICS_EXPORT
+#define _METRICS_EXPORT
+
+#include "../core/atomicfile.h"
+#include "../core/metrics.h"
+#include "../core/scheduler.h"
+#include "../crt0.h"
+#include "../data/modelcache.h"
+#include "../main.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GTable.h"
+#include "Backend/Database/ServiceData.h"
+#include "Backend/Networking/service.h"
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// Scraped by node_exporter's textfile collector
+static const char METRICS_TEXT_FNAME[] = "metrics/nncreator.prom";
+
+static const int JOBS_QUEUED = Metrics::gauge("nncreator_jobs_queued", "Jobs waiting for cores");
+static const int JOBS_RUNNING = Metrics::gauge("nncreator_jobs_running", "Jobs holding cores");
+static const int CACHE_BYTES =
+	Metrics::gauge("nncreator_model_cache_bytes", "Estimated bytes of resident predict models");
+static const int CACHE_BUDGET =
+	Metrics::gauge("nncreator_model_cache_budget_bytes", "Model cache budget in bytes");
+static const int RESIDENT_BYTES =
+	Metrics::gauge("nncreator_resident_memory_bytes", "Resident set size of the process");
+
+// Training and serving metrics for dashboards.
+// args: "TABLE" or "TEXT", then optionally the service to reply to
+// (GUI_Callback by default). TABLE replies "METRICS" with one name, value row
+// per metric; TEXT also rewrites METRICS_TEXT_FNAME in the OpenMetrics format
+// and replies "METRICS_TEXT" with the same text.
+class Metrics_Export : public GNet::Service
+{
+private:
+	GNet::GServer* serverInstance;
+
+	// gauges that are cheaper to read when scraped than to keep current
+	static void refresh()
+	{
+		unsigned int queued = 0;
+		unsigned int running = 0;
+		std::vector<JobInfo> jobs = Scheduler::list();
+		for (unsigned int i = 0; i < jobs.size(); ++i)
+		{
+			if (jobs[i].state == Scheduler::STATE_QUEUED)
+				++queued;
+			else if (jobs[i].state == Scheduler::STATE_RUNNING)
+				++running;
+		}
+		Metrics::set(JOBS_QUEUED, queued);
+		Metrics::set(JOBS_RUNNING, running);
+		Metrics::set(CACHE_BYTES, ModelCache::getResidentBytes());
+		Metrics::set(CACHE_BUDGET, ModelCache::getBudget());
+
+		// statm counts pages: total, then resident
+		FILE* fd = fopen("/proc/self/statm", "r");
+		if (fd)
+		{
+			unsigned long pages = 0;
+			unsigned long residentPages = 0;
+			if (fscanf(fd, "%lu %lu", &pages, &residentPages) == 2)
+				Metrics::set(RESIDENT_BYTES, (double)residentPages * sysconf(_SC_PAGESIZE));
+			fclose(fd);
+		}
+	}
+
+public:
+	Metrics_Export()
+	{
+		serverInstance = NULL;
+	}
+
+	Metrics_Export(GNet::GServer* newInstance)
+	{
+		serverInstance = newInstance;
+	}
+
+	~Metrics_Export()
+	{
+		serverInstance = NULL; // Not ours to delete
+	}
+
+	shmea::ServiceData* execute(const shmea::ServiceData* data)
+	{
+		class GNet::Connection* destination = data->getConnection();
+
+		if (data->getType() != shmea::ServiceData::TYPE_LIST)
+			return NULL;
+
+		shmea::GList cList = data->getList();
+		shmea::GString command = "TABLE";
+		if (cList.size() > 0)
+			command = cList.getString(0);
+
+		if ((command != "TABLE") && (command != "TEXT"))
+			return NULL;
+
+		shmea::GString replyName = "GUI_Callback";
+		if (cList.size() > 1)
+			replyName = cList.getString(1);
+
+		refresh();
+		shmea::ServiceData* cSrvc = new shmea::ServiceData(destination, replyName);
+		if (command == "TEXT")
+		{
+			std::string text = Metrics::openMetrics();
+			mkdir("metrics", 0755);
+			if (!AtomicFile::writeFile(METRICS_TEXT_FNAME, text.c_str(), text.length(), false))
+				printf("[METRICS] Unable to write \"%s\"\n", METRICS_TEXT_FNAME);
+
+			shmea::GList textList;
+			textList.addString(text.c_str());
+			cSrvc->set("METRICS_TEXT", textList);
+			return cSrvc;
+		}
+
+		std::vector<MetricValue> snap = Metrics::snapshot();
+		shmea::GTable metricTable(',');
+		for (unsigned int i = 0; i < snap.size(); ++i)
+		{
+			shmea::GList cRow;
+			cRow.addString(snap[i].name);
+			cRow.addDouble(snap[i].value);
+			metricTable.addRow(cRow);
+		}
+
+		cSrvc->set("METRICS", metricTable);
+		return cSrvc;
+	}
+
+	GNet::Service* MakeService(GNet::GServer* newInstance) const
+	{
+		return new Metrics_Export(newInstance);
+	}
+
+	shmea::GString getName() const
+	{
+		return "Metrics_Export";
+	}
+};
+
+#endif
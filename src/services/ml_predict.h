@@ -0,0 +1,151 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+#ifndef _ML_PREDICT
+#define _ML_PREDICT
+
+#include "../crt0.h"
+#include "../data/ensemble.h"
+#include "../data/modelcache.h"
+#include "../data/predictbatcher.h"
+#include "../main.h"
+#include "../replyrouter.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GTable.h"
+#include "Backend/Database/ServiceData.h"
+#include "Backend/Networking/service.h"
+#include <vector>
+
+// Inference on a resident model. The request is a table of encoded feature
+// rows with the net name as its first arg and, optionally, the service to
+// reply to as its second (GUI_Callback by default). The reply is "PREDICT"
+// with a table of network outputs, one row per request row. A comma
+// separated net name runs the networks as an ensemble, reduced by AVERAGE
+// or VOTE given as the third arg. A request addressed back to Reply_Router
+// is matched by its serviceNum, or by an explicit id as the fourth arg; the
+// id is echoed as the reply's first arg and responseServiceNum, and a request
+// that fails gets a "PREDICT_ERROR" reply with the reason so its ReplyFuture
+// never waits forever.
+class ML_Predict : public GNet::Service
+{
+private:
+	GNet::GServer* serverInstance;
+
+	// the error reply for a request a ReplyRouter client is waiting on
+	static shmea::ServiceData* fail(GNet::Connection* destination,
+									const shmea::GString& replyName, int64_t requestID,
+									const char* reason)
+	{
+		if (requestID == 0)
+			return NULL;
+
+		shmea::GList replyArgs;
+		replyArgs.addLong(requestID);
+		replyArgs.addString(reason);
+		shmea::ServiceData* cSrvc = new shmea::ServiceData(destination, replyName);
+		cSrvc->set("PREDICT_ERROR", replyArgs);
+		cSrvc->setArgList(replyArgs);
+		cSrvc->setResponseServiceNum(requestID);
+		return cSrvc;
+	}
+
+public:
+	ML_Predict()
+	{
+		serverInstance = NULL;
+	}
+
+	ML_Predict(GNet::GServer* newInstance)
+	{
+		serverInstance = newInstance;
+	}
+
+	~ML_Predict()
+	{
+		serverInstance = NULL; // Not ours to delete
+	}
+
+	shmea::ServiceData* execute(const shmea::ServiceData* data)
+	{
+		class GNet::Connection* destination = data->getConnection();
+
+		shmea::GList argList = data->getArgList();
+		shmea::GString replyName = "GUI_Callback";
+		if (argList.size() >= 2)
+			replyName = argList.getString(1);
+
+		// only requests someone is matching replies for carry an id
+		int64_t requestID = 0;
+		if (argList.size() >= 4)
+			requestID = argList.getLong(3);
+		else if (replyName == ReplyRouter::SERVICE_NAME)
+			requestID = data->getServiceNum();
+
+		if (data->getType() != shmea::ServiceData::TYPE_TABLE)
+			return fail(destination, replyName, requestID, "expected a table of rows");
+
+		if (argList.size() < 1)
+			return fail(destination, replyName, requestID, "no network named");
+
+		shmea::GString netName = argList.getString(0);
+		shmea::GTable inputTable = data->getTable();
+		unsigned int rowCount = inputTable.numberOfRows();
+		unsigned int inputCount = inputTable.numberOfCols();
+		if ((rowCount == 0) || (inputCount == 0))
+			return fail(destination, replyName, requestID, "no rows to predict");
+
+		std::vector<float> rows((size_t)rowCount * inputCount);
+		for (unsigned int r = 0; r < rowCount; ++r)
+		{
+			for (unsigned int c = 0; c < inputCount; ++c)
+				rows[(size_t)r * inputCount + c] = inputTable.getCell(r, c).getFloat();
+		}
+
+		// a comma separated name is an ensemble, reduced by the optional third arg
+		std::vector<shmea::GString> nets = Ensemble::parseNets(netName);
+		int reduce = Ensemble::AVERAGE;
+		if (argList.size() >= 3)
+			reduce = Ensemble::parseReduce(argList.getString(2));
+
+		std::vector<float> outputs;
+		if (!Ensemble::predict(nets, &rows[0], rowCount, inputCount, reduce, outputs))
+			return fail(destination, replyName, requestID, "unable to run the network");
+
+		unsigned int width = outputs.size() / rowCount;
+		shmea::GTable outputTable(',');
+		for (unsigned int r = 0; r < rowCount; ++r)
+		{
+			shmea::GList cRow;
+			for (unsigned int c = 0; c < width; ++c)
+				cRow.addFloat(outputs[(size_t)r * width + c]);
+			outputTable.addRow(cRow);
+		}
+
+		shmea::ServiceData* cSrvc = new shmea::ServiceData(destination, replyName);
+		cSrvc->set("PREDICT", outputTable);
+		if (requestID != 0)
+		{
+			shmea::GList replyArgs;
+			replyArgs.addLong(requestID);
+			cSrvc->setArgList(replyArgs);
+			cSrvc->setResponseServiceNum(requestID);
+		}
+		return cSrvc;
+	}
+
+	GNet::Service* MakeService(GNet::GServer* newInstance) const
+	{
+		return new ML_Predict(newInstance);
+	}
+
+	shmea::GString getName() const
+	{
+		return "ML_Predict";
+	}
+};
+
+#endif
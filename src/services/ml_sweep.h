@@ -0,0 +1,394 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+#ifndef _ML_SWEEP
+#define _ML_SWEEP
+
+#include "../core/asynclog.h"
+#include "../core/random.h"
+#include "../core/scheduler.h"
+#include "../core/threadpool.h"
+#include "../crt0.h"
+#include "../data/datacache.h"
+#include "../data/indexedinput.h"
+#include "../data/streaminput.h"
+#include "../data/validationinput.h"
+#include "../main.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/ServiceData.h"
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
+#include "Backend/Machine Learning/Networks/network.h"
+#include "Backend/Machine Learning/State/Terminator.h"
+#include "Backend/Machine Learning/Structure/nninfo.h"
+#include "Backend/Networking/service.h"
+#include <algorithm>
+#include <pthread.h>
+#include <stdlib.h>
+#include <vector>
+
+// One configuration of a sweep
+class SweepTrial
+{
+public:
+	glades::NNetwork* net;
+	IndexedInput* input;
+	ValidationInput* validation; // the held out rows the rungs are ranked on
+	glades::DataInput* stream;	 // a private import of an unshareable dataset
+	shmea::GString label;
+	float accuracy;
+
+	SweepTrial()
+	{
+		net = NULL;
+		input = NULL;
+		validation = NULL;
+		stream = NULL;
+		label = "";
+		accuracy = 0.0f;
+	}
+
+	static bool better(const SweepTrial* a, const SweepTrial* b)
+	{
+		return a->accuracy > b->accuracy;
+	}
+};
+
+// Hyperparameter sweep with successive halving. Every point of the grid is
+// trained concurrently from the same saved network, all trials reading one
+// shared dataset through their own shuffled index view. A streamed dataset
+// reads through a single window and train order, so every trial opens the
+// file on its own. After each rung only the best 1/eta keep training, for eta
+// times as many epochs.
+//
+// args: netName, inputFName, inputType, first rung epochs, eta, then pairs of
+// parameter name and comma separated values (learningRate, momentum,
+// weightDecay1, weightDecay2, dropout)
+class ML_Sweep : public GNet::Service
+{
+private:
+	GNet::GServer* serverInstance;
+	std::vector<SweepTrial*> running;
+	pthread_mutex_t runningMutex;
+	bool stopping;
+
+	// the Scheduler job of the current sweep, 0 before the first
+	int64_t jobID;
+
+	// percent of the training rows every trial holds out to be ranked on
+	static const unsigned int VALIDATION_PCT = 10;
+
+	static int parameterColumn(const shmea::GString& parameter)
+	{
+		if (parameter == "learningRate")
+			return glades::NNInfo::COL_LEARNING_RATE;
+		if (parameter == "momentum")
+			return glades::NNInfo::COL_MOMENTUM_FACTOR;
+		if (parameter == "weightDecay1")
+			return glades::NNInfo::COL_WEIGHT_DECAY1;
+		if (parameter == "weightDecay2")
+			return glades::NNInfo::COL_WEIGHT_DECAY2;
+		if (parameter == "dropout")
+			return glades::NNInfo::COL_PDROPOUT;
+		return -1;
+	}
+
+	static void parseValues(const shmea::GString& text, std::vector<float>& values)
+	{
+		const char* cursor = text.c_str();
+		while ((cursor) && (*cursor))
+		{
+			char* end = NULL;
+			float value = strtof(cursor, &end);
+			if (end == cursor)
+				break;
+
+			values.push_back(value);
+			cursor = (*end == ',') ? end + 1 : end;
+		}
+	}
+
+	static void applyParameter(glades::NNInfo* skeleton, int col, float value)
+	{
+		for (int i = 0; i < skeleton->numHiddenLayers(); ++i)
+		{
+			if (col == glades::NNInfo::COL_LEARNING_RATE)
+				skeleton->setLearningRate(i, value);
+			else if (col == glades::NNInfo::COL_MOMENTUM_FACTOR)
+				skeleton->setMomentumFactor(i, value);
+			else if (col == glades::NNInfo::COL_WEIGHT_DECAY1)
+				skeleton->setWeightDecay1(i, value);
+			else if (col == glades::NNInfo::COL_WEIGHT_DECAY2)
+				skeleton->setWeightDecay2(i, value);
+			else if (col == glades::NNInfo::COL_PDROPOUT)
+				skeleton->setPDropout(i, value);
+		}
+	}
+
+	static void* trainTrial(void* y)
+	{
+		SweepTrial* trial = (SweepTrial*)y;
+		trial->net->train(trial->input);
+
+		// training accuracy would keep the configurations that overfit the most
+		if (trial->validation)
+			trial->net->test(trial->validation);
+		trial->accuracy = trial->net->getAccuracy();
+		return NULL;
+	}
+
+	// stop every trial; also the Scheduler cancel hook
+	static void stopTrials(void* y)
+	{
+		ML_Sweep* self = (ML_Sweep*)y;
+		pthread_mutex_lock(&self->runningMutex);
+		self->stopping = true;
+		for (unsigned int i = 0; i < self->running.size(); ++i)
+			self->running[i]->net->stop();
+		pthread_mutex_unlock(&self->runningMutex);
+	}
+
+	void clearTrials(std::vector<SweepTrial*>& trials)
+	{
+		pthread_mutex_lock(&runningMutex);
+		running.clear();
+		pthread_mutex_unlock(&runningMutex);
+
+		for (unsigned int i = 0; i < trials.size(); ++i)
+		{
+			delete trials[i]->net;
+			delete trials[i]->validation;
+			delete trials[i]->input;
+			DataCache::release(trials[i]->stream);
+			delete trials[i];
+		}
+		trials.clear();
+	}
+
+public:
+	ML_Sweep()
+	{
+		serverInstance = NULL;
+		stopping = false;
+		jobID = 0;
+		pthread_mutex_init(&runningMutex, NULL);
+	}
+
+	ML_Sweep(GNet::GServer* newInstance)
+	{
+		serverInstance = newInstance;
+		stopping = false;
+		jobID = 0;
+		pthread_mutex_init(&runningMutex, NULL);
+	}
+
+	~ML_Sweep()
+	{
+		serverInstance = NULL; // Not ours to delete
+		pthread_mutex_destroy(&runningMutex);
+	}
+
+	shmea::ServiceData* execute(const shmea::ServiceData* data)
+	{
+		if (data->getType() != shmea::ServiceData::TYPE_LIST)
+			return NULL;
+
+		shmea::GList cList = data->getList();
+
+		if ((cList.size() == 1) && (cList.getString(0) == "KILL"))
+		{
+			// drops a sweep still queued for its cores too
+			stopTrials(this);
+			if (jobID > 0)
+				Scheduler::cancel(jobID);
+			AsyncLog::write(AsyncLog::LOG_WARNING, "!!---KILLING SWEEP---!!");
+			return NULL;
+		}
+
+		if (cList.size() < 5)
+			return NULL;
+
+		shmea::GString netName = cList.getString(0);
+		shmea::GString datasetName = cList.getString(1);
+		shmea::GString inputFName = datasetName;
+		int inputType = cList.getInt(2);
+		int64_t rungEpochs = cList.getLong(3);
+		int eta = cList.getInt(4);
+		if (rungEpochs < 1)
+			rungEpochs = 1;
+		if (eta < 2)
+			eta = 2;
+
+		// Expand the grid
+		std::vector<std::vector<std::pair<int, float> > > grid(1);
+		std::vector<shmea::GString> labels(1, "");
+		for (unsigned int i = 5; i + 1 < cList.size(); i += 2)
+		{
+			shmea::GString parameter = cList.getString(i);
+			int col = parameterColumn(parameter);
+			std::vector<float> values;
+			parseValues(cList.getString(i + 1), values);
+			if ((col < 0) || (values.empty()))
+			{
+				AsyncLog::write(AsyncLog::LOG_INFO, "[SWEEP] Skipping parameter \"%s\"",
+								parameter.c_str());
+				continue;
+			}
+
+			std::vector<std::vector<std::pair<int, float> > > nextGrid;
+			std::vector<shmea::GString> nextLabels;
+			for (unsigned int g = 0; g < grid.size(); ++g)
+			{
+				for (unsigned int v = 0; v < values.size(); ++v)
+				{
+					nextGrid.push_back(grid[g]);
+					nextGrid.back().push_back(std::pair<int, float>(col, values[v]));
+					nextLabels.push_back(labels[g] + " " + parameter + "=" +
+										 shmea::GString::floatTOstring(values[v]));
+				}
+			}
+			grid.swap(nextGrid);
+			labels.swap(nextLabels);
+		}
+
+		// glades shares rand() between networks, so a fixed order needs one trial at a time
+		unsigned int workers = std::min(ThreadPool::cores(), (unsigned int)grid.size());
+		if (Random::isDeterministic())
+			workers = 1;
+
+		// Wait for the cores before touching the data
+		pthread_mutex_lock(&runningMutex);
+		stopping = false;
+		pthread_mutex_unlock(&runningMutex);
+		jobID = Scheduler::submit(std::string("Sweep ") + netName.c_str(), 0, workers,
+								  stopTrials, this);
+		if (!Scheduler::waitTurn(jobID))
+			return NULL;
+
+		// Load the input data once, every trial reads it through its own index view
+		glades::DataInput* di = DataCache::acquire(inputFName, inputType);
+		if (!di)
+		{
+			Scheduler::finish(jobID);
+			return NULL;
+		}
+
+		// Every trial holds out the same rows
+		uint64_t validationSeed = Random::streamSeed("ml_sweep.validation");
+		bool streamed = (dynamic_cast<StreamInput*>(di) != NULL);
+		bool privateRows = (!DataCache::shareable(di));
+		std::vector<SweepTrial*> trials;
+		for (unsigned int g = 0; g < grid.size(); ++g)
+		{
+			SweepTrial* trial = new SweepTrial();
+			trial->net = new glades::NNetwork();
+			if (!trial->net->load(netName))
+			{
+				AsyncLog::write(AsyncLog::LOG_ERROR, "[SWEEP] Unable to load \"%s\"",
+								netName.c_str());
+				delete trial->net;
+				delete trial;
+				clearTrials(trials);
+				DataCache::release(di);
+				Scheduler::finish(jobID);
+				return NULL;
+			}
+
+			for (unsigned int p = 0; p < grid[g].size(); ++p)
+				applyParameter(trial->net->getNNInfo(), grid[g][p].first, grid[g][p].second);
+
+			trial->label = labels[g];
+			trials.push_back(trial);
+
+			// DataCache hands out unshareable inputs once, so each acquire is a fresh one
+			glades::DataInput* trialSource = di;
+			if ((privateRows) && (g > 0))
+			{
+				shmea::GString trialFName = datasetName;
+				trial->stream = trialSource = DataCache::acquire(trialFName, inputType);
+				if (!trialSource)
+				{
+					AsyncLog::write(AsyncLog::LOG_ERROR, "[SWEEP] Unable to load \"%s\"",
+									datasetName.c_str());
+					clearTrials(trials);
+					DataCache::release(di);
+					Scheduler::finish(jobID);
+					return NULL;
+				}
+			}
+
+			trial->input = new IndexedInput(trialSource);
+			Random validationRandom;
+			validationRandom.seed(validationSeed);
+			if (trial->input->holdOut(VALIDATION_PCT, &validationRandom))
+				trial->validation = new ValidationInput(trial->input);
+			else if (g == 0)
+				AsyncLog::write(AsyncLog::LOG_WARNING,
+								"[SWEEP] Too few rows to validate on, ranking on training accuracy");
+			trial->input->setShuffle(true, (streamed) ? StreamInput::WINDOW_ROWS : 0);
+		}
+
+		pthread_mutex_lock(&runningMutex);
+		running = trials;
+		bool killedEarly = stopping;
+		pthread_mutex_unlock(&runningMutex);
+
+		ThreadPool pool(workers);
+		AsyncLog::write(AsyncLog::LOG_INFO, "[SWEEP] %u trials on %u threads",
+						(unsigned int)trials.size(), pool.size());
+
+		// Successive halving
+		std::vector<SweepTrial*> alive;
+		if (!killedEarly)
+			alive = trials;
+		int64_t budget = rungEpochs;
+		while (!alive.empty())
+		{
+			for (unsigned int i = 0; i < alive.size(); ++i)
+			{
+				alive[i]->net->terminator.setEpoch(budget);
+				pool.submit(trainTrial, alive[i]);
+			}
+			pool.wait();
+
+			std::sort(alive.begin(), alive.end(), SweepTrial::better);
+			AsyncLog::write(AsyncLog::LOG_INFO, "[SWEEP] Rung of %ld epochs:", (long)budget);
+			for (unsigned int i = 0; i < alive.size(); ++i)
+				AsyncLog::write(AsyncLog::LOG_INFO, "[SWEEP]   %f%s", alive[i]->accuracy,
+								alive[i]->label.c_str());
+
+			pthread_mutex_lock(&runningMutex);
+			bool killed = stopping;
+			pthread_mutex_unlock(&runningMutex);
+			if ((killed) || (alive.size() == 1))
+				break;
+
+			alive.resize((alive.size() + eta - 1) / eta);
+			budget *= eta;
+		}
+
+		if (!alive.empty())
+			AsyncLog::write(AsyncLog::LOG_INFO, "[SWEEP] Best: %f%s", alive[0]->accuracy,
+							alive[0]->label.c_str());
+
+		clearTrials(trials);
+		DataCache::release(di);
+		Scheduler::finish(jobID);
+		return NULL;
+	}
+
+	GNet::Service* MakeService(GNet::GServer* newInstance) const
+	{
+		return new ML_Sweep(newInstance);
+	}
+
+	shmea::GString getName() const
+	{
+		return "ML_Sweep";
+	}
+};
+
+#endif
@@ -8,13 +8,38 @@
 #ifndef _ML_TRAIN
 #define _ML_TRAIN
 
+#include "../core/asynclog.h"
+#include "../core/lrschedule.h"
+#include "../core/metrics.h"
+#include "../core/metricslog.h"
+#include "../core/plateau.h"
+#include "../core/profiler.h"
+#include "../core/random.h"
+#include "../core/runcontrol.h"
+#include "../core/scheduler.h"
+#include "../core/stopwatch.h"
+#include "../core/timebudget.h"
+#include "../core/workerpool.h"
 #include "../crt0.h"
+#include "../data/augmentinput.h"
+#include "../data/autotune.h"
+#include "../data/datacache.h"
+#include "../data/denseinput.h"
+#include "../data/distiller.h"
+#include "../data/ensemble.h"
+#include "../data/indexedinput.h"
+#include "../data/inputloader.h"
+#include "../data/memoryusage.h"
+#include "../data/modelcache.h"
+#include "../data/shardinput.h"
+#include "../data/streaminput.h"
+#include "../data/validationinput.h"
+#include "../data/warmstart.h"
 #include "../main.h"
 #include "Backend/Database/GList.h"
 #include "Backend/Database/GTable.h"
 #include "Backend/Database/ServiceData.h"
-#include "Backend/Machine Learning/DataObjects/ImageInput.h"
-#include "Backend/Machine Learning/DataObjects/NumberInput.h"
+#include "Backend/Machine Learning/DataObjects/DataInput.h"
 #include "Backend/Machine Learning/Networks/metanetwork.h"
 #include "Backend/Machine Learning/Networks/network.h"
 #include "Backend/Machine Learning/State/Terminator.h"
@@ -26,24 +51,202 @@
 #include "Backend/Networking/service.h"
 #include "Frontend/GUI/RUMsgBox.h"
 #include "Frontend/Graphics/graphics.h"
+#include <sys/stat.h>
+#include <time.h>
 
 class NNInfo;
 
+// Per run metrics history, <netName>.nnmetrics
+static const char METRICS_DIR[] = "metrics";
+
+// Scraped through the Metrics_Export service
+static const int TRAIN_ACTIVE = Metrics::gauge("nncreator_train_active", "Networks training now");
+static const int TRAIN_EPOCHS = Metrics::counter("nncreator_train_epochs", "Epochs trained");
+static const int TRAIN_SAMPLES =
+	Metrics::counter("nncreator_train_samples", "Training rows run through the networks");
+static const int TRAIN_SAMPLE_RATE = Metrics::gauge(
+	"nncreator_train_samples_per_second", "Training rows per second over the last chunk");
+static const int TRAIN_EPOCH_SECONDS =
+	Metrics::gauge("nncreator_train_epoch_seconds", "Mean epoch time over the last chunk");
+static const int TRAIN_ACCURACY =
+	Metrics::gauge("nncreator_train_accuracy", "Accuracy after the last chunk");
+static const int TRAIN_LOSS = Metrics::gauge("nncreator_train_loss", "Loss after the last chunk");
+
 class ML_Train : public GNet::Service
 {
 private:
 	GNet::GServer* serverInstance;
 	glades::NNetwork cNetwork;
+	RunControl control;
+
+	// the Scheduler job of the current run, 0 before the first
+	int64_t jobID;
+
+	// the worker this coordinator handed its last job to
+	std::string workerHost;
+	std::string workerPort;
+
+	// learning rate schedule of the current run, over the hidden layers' own rates
+	LRSchedule schedule;
+	int64_t runStart;
+	std::vector<float> baseRates;
 
 public:
+	// epochs between checkpoint saves
+	static const int64_t CHECKPOINT_EPOCHS = 100;
+	// percent of the training rows held out to watch for a plateau
+	static const unsigned int VALIDATION_PCT = 10;
+
+	// send the profiler totals to the gui as name, count, milliseconds triples
+	void sendProfile(GNet::Connection* destination)
+	{
+		if ((!serverInstance) || (!destination))
+			return;
+
+		shmea::GList profile;
+		std::vector<ProfileStat> stats = Profiler::snapshot();
+		for (unsigned int i = 0; i < stats.size(); ++i)
+		{
+			profile.addString(stats[i].name);
+			profile.addLong((int64_t)stats[i].count);
+			profile.addFloat(stats[i].totalNs / 1e6f);
+		}
+
+		shmea::ServiceData* cSrvc = new shmea::ServiceData(destination, "GUI_Callback");
+		cSrvc->set("PROFILE", profile);
+		serverInstance->send(cSrvc);
+	}
+
+	// send the memory estimate to the gui as network bytes, dataset bytes
+	void sendMemory(GNet::Connection* destination, size_t networkBytes, size_t inputBytes)
+	{
+		if ((!serverInstance) || (!destination))
+			return;
+
+		shmea::GList memory;
+		memory.addLong((int64_t)networkBytes);
+		memory.addLong((int64_t)inputBytes);
+
+		shmea::ServiceData* cSrvc = new shmea::ServiceData(destination, "GUI_Callback");
+		cSrvc->set("MEMORY", memory);
+		serverInstance->send(cSrvc);
+	}
+
+	// Scheduler cancel hook
+	static void cancelJob(void* y)
+	{
+		ML_Train* self = (ML_Train*)y;
+		self->control.cancel();
+		if (self->cNetwork.getRunning())
+			self->cNetwork.stop();
+	}
+
+	// coordinator side: send a request to the worker given the last job, or pick one for a new
+	// job; false runs it here
+	bool forward(const shmea::GList& cList, bool newJob)
+	{
+		if ((!serverInstance) || (WorkerPool::isWorker()))
+			return false;
+
+		if ((newJob) && (!WorkerPool::pick(workerHost, workerPort)))
+		{
+			workerHost = "";
+			return false;
+		}
+		if (workerHost.empty())
+			return false;
+
+		GNet::Connection* worker =
+			serverInstance->getConnection(workerHost.c_str(), "Mar", workerPort.c_str());
+		if (!worker)
+		{
+			AsyncLog::write(AsyncLog::LOG_WARNING, "[NN] Unable to reach worker %s:%s",
+							workerHost.c_str(), workerPort.c_str());
+			return false;
+		}
+
+		shmea::ServiceData* cSrvc = new shmea::ServiceData(worker, "ML_Train");
+		cSrvc->set("net", cList);
+		serverInstance->send(cSrvc);
+		AsyncLog::write(AsyncLog::LOG_INFO, "[NN] Sent \"%s\" to worker %s:%s",
+						cList.getString(0).c_str(), workerHost.c_str(), workerPort.c_str());
+		return true;
+	}
+
+	// hold out the rows a plateau is measured on; the detector is turned off without them
+	static bool holdValidation(IndexedInput* indexed, Plateau& plateau)
+	{
+		if (!plateau.isActive())
+			return false;
+
+		Random validationRandom;
+		validationRandom.seed(Random::streamSeed("ml_train.validation"));
+		if (indexed->holdOut(VALIDATION_PCT, &validationRandom))
+			return true;
+
+		AsyncLog::write(AsyncLog::LOG_WARNING, "[NN] Too few rows to validate on, no plateau");
+		plateau = Plateau();
+		return false;
+	}
+
+	// free the wrappers this run made, outermost first, then hand back the shared import
+	static void releaseData(std::vector<glades::DataInput*>& layers, glades::DataInput* shared)
+	{
+		for (unsigned int i = layers.size(); i > 0; --i)
+			InputLoader::release(layers[i - 1]);
+		layers.clear();
+		DataCache::release(shared);
+	}
+
+	// train up to chunkEnd, rescaling the learning rates every UPDATE_EPOCHS on a schedule
+	void trainChunk(glades::DataInput* di, int64_t chunkEnd, GNet::Connection* destination)
+	{
+		glades::NNInfo* skeleton = cNetwork.getNNInfo();
+		if ((!schedule.isActive()) || (!skeleton))
+		{
+			cNetwork.terminator.setEpoch(chunkEnd);
+			glades::train(&cNetwork, di, serverInstance, destination);
+			return;
+		}
+
+		while (!control.isCancelled())
+		{
+			int64_t stepStart = cNetwork.getEpochs();
+			int64_t stepEnd = stepStart + LRSchedule::UPDATE_EPOCHS;
+			if (stepEnd > chunkEnd)
+				stepEnd = chunkEnd;
+			if (stepStart >= stepEnd)
+				break;
+
+			float scale = schedule.factor(stepStart - runStart);
+			for (unsigned int i = 0; i < baseRates.size(); ++i)
+				skeleton->setLearningRate(i, baseRates[i] * scale);
+
+			cNetwork.terminator.setEpoch(stepEnd);
+			glades::train(&cNetwork, di, serverInstance, destination);
+
+			// stopped by another condition
+			if (cNetwork.getEpochs() < stepEnd)
+				break;
+		}
+
+		// checkpoints keep the network's own rates
+		for (unsigned int i = 0; i < baseRates.size(); ++i)
+			skeleton->setLearningRate(i, baseRates[i]);
+	}
+
 	ML_Train()
 	{
 		serverInstance = NULL;
+		runStart = 0;
+		jobID = 0;
 	}
 
 	ML_Train(GNet::GServer* newInstance)
 	{
 		serverInstance = newInstance;
+		runStart = 0;
+		jobID = 0;
 	}
 
 	~ML_Train()
@@ -62,66 +265,393 @@ public:
 
 		if ((cList.size() == 1) && (cList.getString(0) == "KILL"))
 		{
+			if (forward(cList, false))
+				return NULL;
+
+			// also ends a chunked or paused run caught between chunks, and drops a run still
+			// queued for its cores
+			control.cancel();
+			if (jobID > 0)
+				Scheduler::cancel(jobID);
 			if (!cNetwork.getRunning())
 				return NULL;
 
 			cNetwork.stop();
-			printf("\n!!---KILLING NET---!!\n");
+			AsyncLog::write(AsyncLog::LOG_WARNING, "!!---KILLING NET---!!");
+		}
+
+		// Park the run at its current epoch, keeping the network, data and cores
+		if ((cList.size() == 1) && (cList.getString(0) == "PAUSE"))
+		{
+			if (forward(cList, false))
+				return NULL;
+
+			control.pause();
+			if (cNetwork.getRunning())
+				cNetwork.stop();
+			AsyncLog::write(AsyncLog::LOG_INFO, "[NN] Pausing");
+			return NULL;
+		}
+
+		if ((cList.size() == 1) && (cList.getString(0) == "RESUME"))
+		{
+			if (forward(cList, false))
+				return NULL;
+
+			control.resume();
+			AsyncLog::write(AsyncLog::LOG_INFO, "[NN] Resuming");
+			return NULL;
 		}
 
 		if (cList.size() < 3)
 			return NULL;
 
+		// A coordinator with live workers trains nothing itself
+		if (forward(cList, true))
+			return NULL;
+
 		shmea::GString netName = cList.getString(0);
 		shmea::GString inputFName = cList.getString(1);
 		int inputType = cList.getInt(2);
-		/*int64_t maxTimeStamp = cList.getLong(3);
-		int64_t maxEpoch = cList.getLong(4);
-		float maxAccuracy = cList.getFloat(5);*/
 		// int64_t trainPct = cList.getLong(4), testPct = cList.getLong(5), validationPct =
 		// cList.getLong(6);
 
-		// Modify the paths to properly load the data later
+		// Scheduling (optional trailing args after the termination conditions)
+		int priority = 0;
+		unsigned int threads = 1;
+		if (cList.size() >= 7)
+			priority = cList.getInt(6);
+		if (cList.size() >= 8)
+			threads = cList.getInt(7);
+
+		// Comma separated teachers to distill from (optional, after the scheduling)
+		std::vector<shmea::GString> teachers;
+		if (cList.size() >= 9)
+			teachers = Ensemble::parseNets(cList.getString(8));
+
+		// Percent of the already trained rows to replay when only the appended rows are
+		// trained (optional, after the teachers; negative trains every row)
+		int64_t replayPct = -1;
+		if (cList.size() >= 10)
+			replayPct = cList.getLong(9);
+
+		// Learning rate schedule, "type" or "type,warmup" (optional, after the replay percent)
+		schedule = LRSchedule();
+		if ((cList.size() >= 11) && (!schedule.parse(cList.getString(10).c_str())))
+			AsyncLog::write(AsyncLog::LOG_WARNING, "[NN] Unknown schedule \"%s\"",
+							cList.getString(10).c_str());
+
+		// Image augmentations, as for AugmentInput::parse (optional, after the schedule)
+		std::string augmentSpec;
+		if (cList.size() >= 12)
+			augmentSpec = cList.getString(11).c_str();
+
+		// Plateau on the validation loss, as for Plateau::parse (optional, after the
+		// augmentations); off unless given
+		Plateau plateau;
+		if ((cList.size() >= 13) && (cList.getString(12).length() > 0) &&
+			(!plateau.parse(cList.getString(12).c_str())))
+			AsyncLog::write(AsyncLog::LOG_WARNING, "[NN] Unknown plateau \"%s\"",
+							cList.getString(12).c_str());
+
+		// Wait for the cores before touching the data
+		control.reset();
+		jobID = Scheduler::submit(netName.c_str(), priority, threads, cancelJob, this);
+		if (!Scheduler::waitTurn(jobID))
+			return NULL;
+		if (control.isCancelled())
+		{
+			Scheduler::finish(jobID);
+			return NULL;
+		}
+
+		// Load the input data, shared with other jobs on the same dataset; distilling rewrites
+		// the targets, so it gets a copy of its own
+		bool distill = (!teachers.empty()) && (inputType == glades::DataInput::CSV);
+		glades::DataInput* shared = NULL;
 		glades::DataInput* di = NULL;
-		if (inputType == glades::DataInput::CSV)
+		if (distill)
+			di = InputLoader::load(inputFName, inputType, Autotune::loaderThreads(0));
+		else
+			di = shared = DataCache::acquire(inputFName, inputType, Autotune::loaderThreads(0));
+		if (!di)
+		{
+			Scheduler::finish(jobID);
+			return NULL;
+		}
+
+		// Train on the teachers' outputs instead of the labels
+		std::vector<glades::DataInput*> layers;
+		if (distill)
+		{
+			DenseInput* dense = Distiller::toDense(di);
+			if ((!dense) || (!Distiller::apply(*dense, inputFName, teachers)))
+			{
+				AsyncLog::write(AsyncLog::LOG_ERROR, "[NN] Unable to distill \"%s\"",
+								netName.c_str());
+				InputLoader::release(dense);
+				Scheduler::finish(jobID);
+				return NULL;
+			}
+			di = dense;
+			layers.push_back(di);
+		}
+
+		// Shuffle the training order every epoch without moving any rows
+		unsigned int datasetRows = di->getTrainSize();
+		IndexedInput* indexed = NULL;
+		bool rowFile =
+			(inputType == glades::DataInput::CSV) || (inputType == glades::DataInput::TEXT);
+		if (rowFile)
 		{
-			inputFName = "datasets/" + inputFName;
-			di = new glades::NumberInput();
+			IndexedInput* shuffled = new IndexedInput(di);
+			if (replayPct >= 0)
+				WarmStart::select(*shuffled, netName, inputFName, replayPct / 100.0);
+			holdValidation(shuffled, plateau);
+			bool streamed = (dynamic_cast<StreamInput*>(di) != NULL);
+			shuffled->setShuffle(true, (streamed) ? StreamInput::WINDOW_ROWS : 0);
+			di = shuffled;
+			indexed = shuffled;
+			layers.push_back(di);
 		}
-		else if (inputType == glades::DataInput::IMAGE)
+		else if (ShardInput* shards = dynamic_cast<ShardInput*>(di))
 		{
-			// inputFName = "datasets/images/" + inputFName + "/";
-			di = new glades::ImageInput();
+			// a random shard order, and a random order within each shard
+			IndexedInput* shuffled = new IndexedInput(di);
+			holdValidation(shuffled, plateau);
+			shuffled->setShuffle(true, shards->getShardRows());
+			di = shuffled;
+			indexed = shuffled;
+			layers.push_back(di);
 		}
-		else if (inputType == glades::DataInput::TEXT)
+
+		// Fresh augmentations every epoch, made on a loader thread ahead of the trainer
+		if (!augmentSpec.empty())
 		{
-			// TODO
+			AugmentInput* augmented = AugmentInput::create(di, augmentSpec.c_str());
+			if (augmented)
+			{
+				di = augmented;
+				layers.push_back(di);
+			}
+			else
+				AsyncLog::write(AsyncLog::LOG_WARNING, "[NN] Training \"%s\" without \"%s\"",
+								netName.c_str(), augmentSpec.c_str());
+		}
+
+		// Load the neural network
+		if ((cNetwork.getEpochs() == 0) && (!cNetwork.load(netName)))
+		{
+			AsyncLog::write(AsyncLog::LOG_ERROR, "[NN] Unable to load \"%s\"", netName.c_str());
+			releaseData(layers, shared);
+			Scheduler::finish(jobID);
 			return NULL;
 		}
-		else
+		if ((inputType == glades::DataInput::CSV) &&
+			(!WarmStart::sameEncoding(netName, inputFName, cNetwork.getEpochs() > 0)))
+		{
+			releaseData(layers, shared);
+			Scheduler::finish(jobID);
 			return NULL;
+		}
+		Autotune::applyBatchSize(cNetwork);
 
-		if (!di)
+		// Refuse a run that would not fit before it starts allocating
+		size_t networkBytes = MemoryUsage::network(cNetwork.getNNInfo()).total;
+		size_t inputBytes = MemoryUsage::input(di);
+		sendMemory(destination, networkBytes, inputBytes);
+		AsyncLog::write(AsyncLog::LOG_INFO, "[NN] \"%s\" uses %s, its data %s", netName.c_str(),
+						MemoryUsage::format(networkBytes).c_str(),
+						MemoryUsage::format(inputBytes).c_str());
+		if (!MemoryUsage::fits(networkBytes + inputBytes))
+		{
+			AsyncLog::write(AsyncLog::LOG_ERROR, "[NN] \"%s\" needs %s, over the %s budget",
+							netName.c_str(), MemoryUsage::format(networkBytes + inputBytes).c_str(),
+							MemoryUsage::format(MemoryUsage::getBudget()).c_str());
+			releaseData(layers, shared);
+			Scheduler::finish(jobID);
 			return NULL;
+		}
+
+		// Termination Conditions (optional trailing args)
+		if (cList.size() >= 6)
+		{
+			cNetwork.terminator.setTimestamp(cList.getLong(3));
+			cNetwork.terminator.setEpoch(cList.getLong(4));
+			cNetwork.terminator.setAccuracy(cList.getFloat(5));
+		}
 
-		// Load the input data
-		di->import(inputFName);
+		// A timestamp is a deadline for the run and its final checkpoint
+		TimeBudget budget;
+		budget.setDeadline(cNetwork.terminator.getTimestamp());
 
-		// Load the neural network
-		if ((cNetwork.getEpochs() == 0) && (!cNetwork.load(netName)))
+		// Measured after every checkpoint when a plateau was asked for
+		ValidationInput validationRows(indexed);
+		const ValidationInput* validation = NULL;
+		if ((plateau.isActive()) && (validationRows.getTestSize() > 0))
+			validation = &validationRows;
+		else if (plateau.isActive())
+			AsyncLog::write(AsyncLog::LOG_WARNING, "[NN] \"%s\" has no rows to validate on",
+							netName.c_str());
+
+		// One history row per chunk, in a log of this run's own
+		mkdir(METRICS_DIR, 0755);
+		MetricsLog metrics;
+		metrics.open(MetricsLog::runPath(METRICS_DIR, netName.c_str(), time(NULL), jobID));
+
+		// Train in chunks of CHECKPOINT_EPOCHS, saving the network in between
+		int64_t epochLimit = cNetwork.terminator.getEpoch();
+		runStart = cNetwork.getEpochs();
+		schedule.build((epochLimit > runStart) ? epochLimit - runStart : 0);
+		baseRates.clear();
+		if (cNetwork.getNNInfo())
 		{
-			printf("[NN] Unable to load \"%s\"", netName.c_str());
-			return NULL;
+			for (int i = 0; i < cNetwork.getNNInfo()->numHiddenLayers(); ++i)
+				baseRates.push_back(cNetwork.getNNInfo()->getLearningRate(i));
 		}
+		Metrics::add(TRAIN_ACTIVE, 1.0);
+		while (!control.isCancelled())
+		{
+			// A paused run waits here with everything still loaded
+			if (control.isPaused())
+			{
+				AsyncLog::write(AsyncLog::LOG_INFO, "[NN] Paused \"%s\" at epoch %d",
+								netName.c_str(), cNetwork.getEpochs());
+				if (!control.waitWhilePaused())
+					break;
+			}
 
-		// Termination Conditions
-		/*cNetwork.terminator.setTimestamp(maxTimeStamp);
-		cNetwork.terminator.setEpoch(maxEpoch);
-		cNetwork.terminator.setAccuracy(maxAccuracy);*/
+			int64_t chunkStart = cNetwork.getEpochs();
+			int64_t chunkEnd = chunkStart + CHECKPOINT_EPOCHS;
+			if ((epochLimit > 0) && (chunkEnd > epochLimit))
+				chunkEnd = epochLimit;
 
-		// Run the training and retrieve a metanetwork
-		glades::MetaNetwork* newTrainNet =
-			glades::train(&cNetwork, di, serverInstance, destination);
+			// Only as many epochs as can still be trained and saved in time
+			if (budget.isActive())
+			{
+				int64_t epochsLeft = budget.epochsLeft();
+				if (epochsLeft <= 0)
+				{
+					AsyncLog::write(AsyncLog::LOG_INFO, "[NN] \"%s\" reached its deadline",
+									netName.c_str());
+					break;
+				}
+				if (chunkEnd - chunkStart > epochsLeft)
+					chunkEnd = chunkStart + epochsLeft;
+				cNetwork.terminator.setTimestamp(budget.stopAt());
+			}
+
+			// Run the training and retrieve a metanetwork
+			Stopwatch chunkTime;
+			{
+				NNC_PROFILE_SCOPE("train.chunk");
+				trainChunk(di, chunkEnd, destination);
+			}
+
+			double chunkSec = chunkTime.elapsedMs() / 1000.0;
+			int64_t chunkEpochs = cNetwork.getEpochs() - chunkStart;
+			double chunkSamples = (double)chunkEpochs * di->getTrainSize();
+			budget.noteEpochs(chunkEpochs, chunkSec);
+			Metrics::add(TRAIN_EPOCHS, chunkEpochs);
+			Metrics::add(TRAIN_SAMPLES, chunkSamples);
+			if ((chunkEpochs > 0) && (chunkSec > 0.0))
+			{
+				Metrics::set(TRAIN_EPOCH_SECONDS, chunkSec / chunkEpochs);
+				Metrics::set(TRAIN_SAMPLE_RATE, chunkSamples / chunkSec);
+			}
+
+			MetricsRecord record = MetricsLog::emptyRecord();
+			record.epoch = cNetwork.getEpochs();
+			record.timestamp = time(NULL);
+			record.accuracy = cNetwork.getAccuracy();
+			shmea::GList learningCurve = cNetwork.getLearningCurve();
+			if (learningCurve.size() > 0)
+				record.loss = learningCurve.getFloat(learningCurve.size() - 1);
+			metrics.append(record);
+			Metrics::set(TRAIN_ACCURACY, record.accuracy);
+			Metrics::set(TRAIN_LOSS, record.loss);
+
+			// A crash or a kill from here on resumes from this save
+			bool saved = false;
+			{
+				NNC_PROFILE_SCOPE("train.checkpoint");
+				Stopwatch saveTime;
+				saved = cNetwork.save();
+				budget.noteSave(saveTime.elapsedMs() / 1000.0);
+			}
+
+			if (Profiler::enabled())
+				sendProfile(destination);
+
+			if (!saved)
+				AsyncLog::write(AsyncLog::LOG_ERROR, "[NN] Unable to checkpoint \"%s\"",
+								netName.c_str());
+			else
+			{
+				AsyncLog::write(AsyncLog::LOG_INFO, "[NN] Checkpointed \"%s\" at epoch %d",
+								netName.c_str(), cNetwork.getEpochs());
+
+				// ML_Predict picks up the new weights on its next request
+				ModelCache::invalidate(netName);
+				if (WorkerPool::isWorker())
+					WorkerPool::noteSaved(netName.c_str());
+			}
+
+			// Scale the rates down on a validation plateau, and stop once that stops helping
+			bool plateauStop = false;
+			if ((validation) && (chunkEpochs > 0) && (!control.isCancelled()))
+			{
+				float validationLoss = validation->loss(cNetwork);
+				int action = plateau.update(validationLoss);
+				AsyncLog::write(AsyncLog::LOG_INFO, "[NN] \"%s\" validation loss %f (best %f)",
+								netName.c_str(), validationLoss, plateau.getBest());
+				if (action == Plateau::REDUCE)
+				{
+					glades::NNInfo* cInfo = cNetwork.getNNInfo();
+					for (unsigned int i = 0; i < baseRates.size(); ++i)
+					{
+						baseRates[i] *= plateau.getFactor();
+						if (cInfo)
+							cInfo->setLearningRate(i, baseRates[i]);
+					}
+					AsyncLog::write(AsyncLog::LOG_INFO,
+									"[NN] \"%s\" plateaued, learning rates scaled by %f",
+									netName.c_str(), plateau.getFactor());
+				}
+				else if (action == Plateau::STOP)
+				{
+					AsyncLog::write(AsyncLog::LOG_INFO, "[NN] \"%s\" plateaued, stopping",
+									netName.c_str());
+					plateauStop = true;
+				}
+			}
+
+			// Stopped for any reason other than the end of the chunk or a pause
+			bool pausedStop = control.takePause();
+			if ((control.isCancelled()) || (plateauStop) ||
+				((!pausedStop) && (cNetwork.getEpochs() < chunkEnd)) ||
+				((epochLimit > 0) && (cNetwork.getEpochs() >= epochLimit)))
+				break;
+		}
+		cNetwork.terminator.setEpoch(epochLimit);
+		Metrics::add(TRAIN_ACTIVE, -1.0);
+
+		// The next warm start only trains the rows appended after these
+		if ((!control.isCancelled()) && (rowFile) &&
+			(!WarmStart::update(netName, inputFName, datasetRows)))
+			AsyncLog::write(AsyncLog::LOG_WARNING, "[NN] Unable to record what \"%s\" trained on",
+							netName.c_str());
+		releaseData(layers, shared);
+		Scheduler::finish(jobID);
+
+		if (Profiler::enabled())
+		{
+			std::string traceFName =
+				std::string(METRICS_DIR) + "/" + netName.c_str() + ".trace.json";
+			if (Profiler::dump(traceFName))
+				AsyncLog::write(AsyncLog::LOG_INFO, "[NN] Wrote profile \"%s\"",
+								traceFName.c_str());
+		}
 
 		return NULL;
 	}
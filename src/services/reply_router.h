@@ -0,0 +1,57 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+#ifndef _REPLY_ROUTER
+#define _REPLY_ROUTER
+
+#include "../crt0.h"
+#include "../main.h"
+#include "../replyrouter.h"
+#include "Backend/Database/ServiceData.h"
+#include "Backend/Networking/service.h"
+
+// Receives replies to requests sent through ReplyRouter and completes the
+// futures waiting on them. Replies nobody is waiting for are dropped.
+class Reply_Router : public GNet::Service
+{
+private:
+	GNet::GServer* serverInstance;
+
+public:
+	Reply_Router()
+	{
+		serverInstance = NULL;
+	}
+
+	Reply_Router(GNet::GServer* newInstance)
+	{
+		serverInstance = newInstance;
+	}
+
+	~Reply_Router()
+	{
+		serverInstance = NULL; // Not ours to delete
+	}
+
+	shmea::ServiceData* execute(const shmea::ServiceData* data)
+	{
+		ReplyRouter::deliver(data);
+		return NULL;
+	}
+
+	GNet::Service* MakeService(GNet::GServer* newInstance) const
+	{
+		return new Reply_Router(newInstance);
+	}
+
+	shmea::GString getName() const
+	{
+		return ReplyRouter::SERVICE_NAME;
+	}
+};
+
+#endif
@@ -0,0 +1,123 @@
+// Confidential, unpublished property of Robert Carneiro
+
+// The access and distribution of this material is limited solely to
+// authorized personnel.  The use, disclosure, reproduction,
+// modification, transfer, or transmittal of this work for any purpose
+// in any form or by any means without the written permission of
+// Robert Carneiro is strictly prohibited.
+#ifndef _WORKER_REGISTER
+#define _WORKER_REGISTER
+
+#include "../core/scheduler.h"
+#include "../core/threadpool.h"
+#include "../core/workerpool.h"
+#include "../crt0.h"
+#include "../data/modelcache.h"
+#include "../main.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/ServiceData.h"
+#include "Backend/Networking/connection.h"
+#include "Backend/Networking/main.h"
+#include "Backend/Networking/service.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Coordinator side of the training workers.
+// args: "REGISTER", the worker's server port, its cores, the jobs it holds,
+// then the networks it saved since its last beat. The sender's address is
+// taken from the connection. Saved networks are dropped from the ModelCache
+// so predictions reload them from the shared network store.
+class Worker_Register : public GNet::Service
+{
+private:
+	GNet::GServer* serverInstance;
+
+public:
+	Worker_Register()
+	{
+		serverInstance = NULL;
+	}
+
+	Worker_Register(GNet::GServer* newInstance)
+	{
+		serverInstance = newInstance;
+	}
+
+	~Worker_Register()
+	{
+		serverInstance = NULL; // Not ours to delete
+	}
+
+	// worker side: report to the coordinator once
+	static bool heartbeat(GNet::GServer* serverInstance)
+	{
+		if ((!serverInstance) || (!WorkerPool::isWorker()))
+			return false;
+
+		std::string host = WorkerPool::getCoordinatorHost();
+		std::string port = WorkerPool::getCoordinatorPort();
+		GNet::Connection* coordinator = NULL;
+		if (port.empty())
+			coordinator = serverInstance->getConnection(host.c_str());
+		else
+			coordinator = serverInstance->getConnection(host.c_str(), "Mar", port.c_str());
+		if (!coordinator)
+			return false;
+
+		unsigned int held = 0;
+		std::vector<JobInfo> jobs = Scheduler::list();
+		for (unsigned int i = 0; i < jobs.size(); ++i)
+		{
+			if ((jobs[i].state == Scheduler::STATE_QUEUED) ||
+				(jobs[i].state == Scheduler::STATE_RUNNING))
+				++held;
+		}
+
+		shmea::GList beat;
+		beat.addString("REGISTER");
+		beat.addString(serverInstance->getPort());
+		beat.addInt(ThreadPool::cores());
+		beat.addInt(held);
+		std::vector<std::string> saved = WorkerPool::takeSaved();
+		for (unsigned int i = 0; i < saved.size(); ++i)
+			beat.addString(saved[i].c_str());
+
+		shmea::ServiceData* cSrvc = new shmea::ServiceData(coordinator, "Worker_Register");
+		cSrvc->set("WORKER", beat);
+		serverInstance->send(cSrvc);
+		return true;
+	}
+
+	shmea::ServiceData* execute(const shmea::ServiceData* data)
+	{
+		class GNet::Connection* destination = data->getConnection();
+
+		if ((data->getType() != shmea::ServiceData::TYPE_LIST) || (!destination))
+			return NULL;
+
+		shmea::GList cList = data->getList();
+		if ((cList.size() < 4) || (cList.getString(0) != "REGISTER"))
+			return NULL;
+
+		std::string host = destination->getIP().c_str();
+		WorkerPool::update(host, cList.getString(1).c_str(), cList.getInt(2), cList.getInt(3));
+
+		for (unsigned int i = 4; i < cList.size(); ++i)
+			ModelCache::invalidate(cList.getString(i));
+
+		return NULL;
+	}
+
+	GNet::Service* MakeService(GNet::GServer* newInstance) const
+	{
+		return new Worker_Register(newInstance);
+	}
+
+	shmea::GString getName() const
+	{
+		return "Worker_Register";
+	}
+};
+
+#endif
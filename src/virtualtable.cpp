@@ -0,0 +1,156 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "virtualtable.h"
+#include "Backend/Database/GList.h"
+#include "Backend/Database/GString.h"
+#include "Backend/Database/GTable.h"
+#include "data/tablemodel.h"
+#include <stdint.h>
+#include <vector>
+
+VirtualTable::VirtualTable()
+{
+	model = NULL;
+	rowOffset = 0;
+	colOffset = 0;
+	colsShown = DEFAULT_COLS_SHOWN;
+	diagonal = false;
+}
+
+/*!
+ * @brief scroll the window with the mouse wheel
+ * @details a square table like a confusion matrix can scroll its columns with its rows, so the
+ * diagonal stays on screen
+ */
+void VirtualTable::onMouseWheel(gfxpp* cGfx, GPanel* cPanel, int eventX, int eventY,
+								int scrollType)
+{
+	int rowStep = (scrollType > 0) ? -1 : 1;
+	scroll(rowStep, diagonal ? rowStep : 0);
+}
+
+/*!
+ * @brief move the window over the model
+ * @param rowStep rows to move, negative is up
+ * @param colStep columns to move, negative is left
+ */
+void VirtualTable::scroll(int rowStep, int colStep)
+{
+	if (!model)
+		return;
+
+	int64_t newRow = (int64_t)rowOffset + rowStep;
+	int64_t newCol = (int64_t)colOffset + colStep;
+	rowOffset = (newRow > 0) ? (unsigned int)newRow : 0;
+	colOffset = (newCol > 0) ? (unsigned int)newCol : 0;
+	refresh();
+}
+
+/*!
+ * @brief rebuild the on screen window from the model
+ * @details clamps the offsets to the model first, so a model that shrank keeps a full window
+ */
+void VirtualTable::refresh()
+{
+	unsigned int modelRows = model ? model->numberOfRows() : 0;
+	unsigned int modelCols = model ? model->numberOfCols() : 0;
+	unsigned int shownRows = (getRowsShown() < modelRows) ? getRowsShown() : modelRows;
+	unsigned int shownCols = (colsShown < modelCols) ? colsShown : modelCols;
+
+	if (rowOffset + shownRows > modelRows)
+		rowOffset = modelRows - shownRows;
+	if (colOffset + shownCols > modelCols)
+		colOffset = modelCols - shownCols;
+
+	shmea::GTable window(',');
+	if ((shownRows > 0) && (shownCols > 0))
+	{
+		std::vector<shmea::GString> headers;
+		for (unsigned int c = 0; c < shownCols; ++c)
+			headers.push_back(model->getHeader(colOffset + c));
+		window.setHeaders(headers);
+
+		for (unsigned int r = 0; r < shownRows; ++r)
+		{
+			shmea::GList cRow;
+			for (unsigned int c = 0; c < shownCols; ++c)
+				cRow.addString(model->getCell(rowOffset + r, colOffset + c));
+			window.addRow(cRow);
+		}
+	}
+
+	import(window);
+	updateLabels();
+}
+
+const TableModel* VirtualTable::getModel() const
+{
+	return model;
+}
+
+unsigned int VirtualTable::getRowOffset() const
+{
+	return rowOffset;
+}
+
+unsigned int VirtualTable::getColOffset() const
+{
+	return colOffset;
+}
+
+unsigned int VirtualTable::getColsShown() const
+{
+	return colsShown;
+}
+
+bool VirtualTable::getDiagonal() const
+{
+	return diagonal;
+}
+
+/*!
+ * @brief show a model
+ * @details the model is not copied and must outlive the table or be replaced first; the scroll
+ * position is kept so a model refreshed every epoch does not jump back to the top
+ * @param newModel the model to show, or NULL to empty the table
+ */
+void VirtualTable::setModel(const TableModel* newModel)
+{
+	model = newModel;
+	refresh();
+}
+
+void VirtualTable::setColsShown(unsigned int newColsShown)
+{
+	colsShown = (newColsShown > 0) ? newColsShown : 1;
+	refresh();
+}
+
+void VirtualTable::setDiagonal(bool newDiagonal)
+{
+	diagonal = newDiagonal;
+}
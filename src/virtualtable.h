@@ -0,0 +1,77 @@
+// Copyright 2020 Robert Carneiro, Derek Meer, Matthew Tabak, Eric Lujan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and
+// associated documentation files (the "Software"), to deal in the Software
+// without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish,
+// distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom
+// the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT
+// NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+// FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+// OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#ifndef _VIRTUALTABLE
+#define _VIRTUALTABLE
+
+#include "Frontend/GUI/RUTable.h"
+#include <stdio.h>
+
+class TableModel;
+class gfxpp;
+class GPanel;
+
+// RUTable that only holds the cells on screen. The rows and columns come
+// from a TableModel; scrolling moves the window and imports just that
+// window, so the widget costs the same for a 5 row table or a 1M row one.
+class VirtualTable : public RUTable
+{
+private:
+	const TableModel* model;
+	unsigned int rowOffset;
+	unsigned int colOffset;
+	unsigned int colsShown;
+	bool diagonal;
+
+	// owns no model, and the window is rebuilt from it
+	VirtualTable(const VirtualTable&);
+	void operator=(const VirtualTable&);
+
+protected:
+	virtual void onMouseWheel(gfxpp*, GPanel*, int, int, int);
+
+public:
+	static const unsigned int DEFAULT_COLS_SHOWN = 8;
+
+	VirtualTable();
+
+	void scroll(int, int);
+	void refresh();
+
+	// gets
+	const TableModel* getModel() const;
+	unsigned int getRowOffset() const;
+	unsigned int getColOffset() const;
+	unsigned int getColsShown() const;
+	bool getDiagonal() const;
+
+	// sets
+	void setModel(const TableModel*);
+	void setColsShown(unsigned int);
+	void setDiagonal(bool);
+};
+
+#endif